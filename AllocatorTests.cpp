@@ -0,0 +1,322 @@
+//
+// Created by truefinch on 25.06.18.
+//
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <optional> // catch.h uses std::optional without including it
+#include <memory_resource>
+#include <string>
+#include <thread>
+
+#include "catch.h"
+#include "arena_allocator.hpp"
+#include "pool_allocator.hpp"
+#include "vector.hpp"
+
+namespace {
+template<typename T>
+using arena_vector = tftl::vector<T, tftl::arena_allocator<T>>;
+
+template<typename T>
+using pool_vector = tftl::vector<T, tftl::pool_allocator<T>>;
+
+// Counts the allocations which reach the upstream resource
+class counting_resource : public std::pmr::memory_resource {
+ public:
+  std::size_t allocations = 0;
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+} // namespace
+
+TEST_CASE("Monotonic arena") {
+
+  SECTION("Blocks are aligned and distinct") {
+    tftl::monotonic_arena arena(128);
+    char* a = static_cast<char*>(arena.allocate(3, 1));
+    double* b = static_cast<double*>(arena.allocate(sizeof(double), alignof(double)));
+    void* c = arena.allocate(1000, 64);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(b) % alignof(double) == 0);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(c) % 64 == 0);
+    REQUIRE(a + 3 <= reinterpret_cast<char*>(b));
+    REQUIRE(arena.bytes_used() == 3 + sizeof(double) + 1000);
+    arena.release();
+    REQUIRE(arena.bytes_used() == 0);
+  }
+
+  SECTION("Caller provided buffer is used first") {
+    alignas(16) char buffer[256];
+    tftl::monotonic_arena arena(buffer, sizeof(buffer));
+    char* block = static_cast<char*>(arena.allocate(100, 8));
+    REQUIRE(block >= buffer);
+    REQUIRE(block + 100 <= buffer + sizeof(buffer));
+  }
+
+  SECTION("Vector grows in place at the end of the arena") {
+    tftl::monotonic_arena arena(1 << 16);
+    arena_vector<int> result(arena);
+    result.reserve(16);
+    const int* first = result.data();
+    for (int i = 0; i < 1000; ++i) {
+      result.push_back(i);
+    }
+    REQUIRE(result.data() == first);
+    REQUIRE(result[999] == 999);
+  }
+
+  SECTION("Vectors of strings in an arena") {
+    tftl::monotonic_arena arena;
+    arena_vector<std::string> result(arena);
+    for (int i = 0; i < 100; ++i) {
+      const std::string value(40, static_cast<char>('a' + i % 26));
+      result.push_back(value);
+    }
+    REQUIRE(result[27] == std::string(40, 'b'));
+  }
+}
+
+TEST_CASE("Stateful allocators in vector") {
+
+  SECTION("Copies keep their own arena") {
+    tftl::monotonic_arena first;
+    tftl::monotonic_arena second;
+    arena_vector<int> source({1, 2, 3}, first);
+    arena_vector<int> result(second);
+    result = source;
+    REQUIRE(result.get_allocator().arena() == &second);
+    REQUIRE(result == source);
+  }
+
+  SECTION("Move between arenas moves the elements") {
+    tftl::monotonic_arena first;
+    tftl::monotonic_arena second;
+    arena_vector<std::string> source({"a", "b", "c"}, first);
+    arena_vector<std::string> result(second);
+    result = std::move(source);
+    REQUIRE(result.get_allocator().arena() == &second);
+    REQUIRE(result.size() == 3);
+    REQUIRE(result[2] == "c");
+    REQUIRE(source.empty());
+
+    arena_vector<std::string> moved(std::move(result), tftl::arena_allocator<std::string>(first));
+    REQUIRE(moved.get_allocator().arena() == &first);
+    REQUIRE(moved[0] == "a");
+  }
+
+  SECTION("Move within one arena takes the buffer") {
+    tftl::monotonic_arena arena;
+    arena_vector<int> source({1, 2, 3}, arena);
+    const int* data = source.data();
+    arena_vector<int> result(arena);
+    result = std::move(source);
+    REQUIRE(result.data() == data);
+  }
+
+  SECTION("Swap leaves the allocators in place") {
+    tftl::pool_resource pool;
+    pool_vector<int> a({1, 2}, pool);
+    pool_vector<int> b({3, 4, 5}, pool);
+    a.swap(b);
+    REQUIRE(a.size() == 3);
+    REQUIRE(b[1] == 2);
+    REQUIRE(a.get_allocator().pool() == &pool);
+  }
+}
+
+TEST_CASE("Pool allocators") {
+
+  SECTION("Size classes") {
+    REQUIRE(tftl::pool_resource::size_class(1) == 0);
+    REQUIRE(tftl::pool_resource::size_class(16) == 0);
+    REQUIRE(tftl::pool_resource::size_class(17) == 1);
+    REQUIRE(tftl::pool_resource::size_class(4096) == tftl::pool_resource::class_count - 1);
+  }
+
+  SECTION("Freed blocks are reused") {
+    tftl::pool_resource pool;
+    void* block = pool.allocate(24, 8);
+    pool.deallocate(block, 24, 8);
+    REQUIRE(pool.allocate(32, 8) == block);
+    void* big = pool.allocate(1 << 20, 8);
+    pool.deallocate(big, 1 << 20, 8);
+  }
+
+  SECTION("Vector in a pool") {
+    tftl::pool_resource pool;
+    pool_vector<long> result(pool);
+    for (long i = 0; i < 10000; ++i) {
+      result.push_back(i);
+    }
+    REQUIRE(result[9999] == 9999);
+  }
+
+  SECTION("Thread caches") {
+    std::vector<std::thread> threads;
+    std::vector<long> sums(4);
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([t, &sums] {
+        for (int round = 0; round < 200; ++round) {
+          tftl::vector<long, tftl::thread_cache_allocator<long>> result;
+          for (long i = 0; i < 100; ++i) {
+            result.push_back(i);
+          }
+          sums[t] += result[99];
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    REQUIRE(sums == std::vector<long>(4, 99 * 200));
+  }
+}
+
+TEST_CASE("Polymorphic allocators") {
+
+  SECTION("Monotonic buffer serves many vectors from few chunks") {
+    counting_resource direct;
+    for (int round = 0; round < 100; ++round) {
+      tftl::pmr::vector<int> result(&direct);
+      for (int i = 0; i < 100; ++i) {
+        result.push_back(i);
+      }
+    }
+
+    counting_resource upstream;
+    {
+      std::pmr::monotonic_buffer_resource buffer(&upstream);
+      for (int round = 0; round < 100; ++round) {
+        tftl::pmr::vector<int> result(&buffer);
+        for (int i = 0; i < 100; ++i) {
+          result.push_back(i);
+        }
+        REQUIRE(result[99] == 99);
+      }
+    }
+    REQUIRE(upstream.allocations * 10 < direct.allocations);
+  }
+
+  SECTION("Pool resource reuses blocks between vectors") {
+    counting_resource upstream;
+    std::pmr::unsynchronized_pool_resource pool(&upstream);
+    for (int round = 0; round < 1000; ++round) {
+      tftl::pmr::vector<long> result(&pool);
+      for (long i = 0; i < 64; ++i) {
+        result.push_back(i);
+      }
+    }
+    std::size_t warm = upstream.allocations;
+    for (int round = 0; round < 1000; ++round) {
+      tftl::pmr::vector<long> result(&pool);
+      for (long i = 0; i < 64; ++i) {
+        result.push_back(i);
+      }
+    }
+    REQUIRE(upstream.allocations == warm);
+  }
+
+  SECTION("Elements are constructed with the vector's resource") {
+    std::pmr::monotonic_buffer_resource buffer;
+    tftl::pmr::vector<std::pmr::string> result(&buffer);
+    std::pmr::string value("a string too long for the small buffer optimisation");
+    result.push_back(value);
+    result.emplace_back(value);
+    result.resize(4);
+    for (auto& element : result) {
+      REQUIRE(element.get_allocator().resource() == &buffer);
+    }
+    REQUIRE(result[1] == value);
+    REQUIRE(result.get_allocator().resource() == &buffer);
+  }
+
+  SECTION("Temporaries are built with the vector's resource too") {
+    std::pmr::monotonic_buffer_resource buffer;
+    std::pmr::string value("a string too long for the small buffer optimisation", &buffer);
+    // Any allocation from the default resource throws, it is restored however the section ends
+    struct null_default_resource {
+      std::pmr::memory_resource* previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+      ~null_default_resource() { std::pmr::set_default_resource(this->previous); }
+    } guard;
+
+    tftl::pmr::vector<std::pmr::string> result(&buffer);
+    result.emplace_back(value);
+    result.emplace(result.begin(), value);
+    result.insert(result.begin() + 1, 3, value);
+    result.insert(result.end(), result[0]);
+    result.emplace_back("another string too long for the small buffer optimisation");
+    result.resize_for_overwrite(9);
+    REQUIRE(result.size() == 9);
+    REQUIRE(result[8].empty());
+    for (auto& element : result) {
+      REQUIRE(element.get_allocator().resource() == &buffer);
+    }
+    REQUIRE(result[3] == value);
+  }
+}
+
+TEST_CASE("Aligned allocators") {
+
+  SECTION("Alignment is known at compile time") {
+    REQUIRE(tftl::vector<double>::data_alignment == alignof(double));
+    REQUIRE(tftl::vector<char, tftl::aligned_allocator<char>>::data_alignment == 64);
+    REQUIRE(tftl::vector<char, tftl::aligned_allocator<char, 32>>::data_alignment == 32);
+    REQUIRE(tftl::vector<int, tftl::malloc_allocator<int>>::data_alignment == alignof(std::max_align_t));
+    REQUIRE(tftl::vector<int, tftl::huge_page_allocator<int>>::data_alignment == 64);
+    REQUIRE(tftl::vector<int, tftl::default_init_allocator<int, tftl::aligned_allocator<int, 128>>>::data_alignment
+                == 128);
+  }
+
+  SECTION("Every block is aligned") {
+    tftl::vector<char, tftl::aligned_allocator<char, 4096>> result;
+    for (int i = 0; i < 100000; ++i) {
+      result.push_back(static_cast<char>(i));
+      REQUIRE(reinterpret_cast<std::uintptr_t>(result.data()) % 4096 == 0);
+    }
+    REQUIRE(result[99999] == static_cast<char>(99999));
+    result.shrink_to_fit();
+    REQUIRE(reinterpret_cast<std::uintptr_t>(result.data()) % 4096 == 0);
+
+    tftl::vector<std::string, tftl::aligned_allocator<std::string>> words(100, std::string(40, 'x'));
+    words.insert(words.begin(), "first");
+    REQUIRE(reinterpret_cast<std::uintptr_t>(words.data()) % 64 == 0);
+    REQUIRE(words[100] == std::string(40, 'x'));
+  }
+
+  SECTION("Huge page blocks") {
+    typedef tftl::huge_page_allocator<int> allocator;
+    tftl::vector<int, allocator> result;
+    result.push_back(1);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(result.data()) % 64 == 0);
+
+    tftl::vector<int, allocator> big;
+    big.reserve(allocator::huge_page_size);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(big.data()) % allocator::huge_page_size == 0);
+    for (int i = 0; i < (3 << 20); ++i) {
+      big.push_back(i);
+    }
+    REQUIRE(reinterpret_cast<std::uintptr_t>(big.data()) % 64 == 0);
+    for (int i = 0; i < (3 << 20); i += 4099) {
+      REQUIRE(big[i] == i);
+    }
+    big.shrink_to_fit();
+    REQUIRE(big.back() == (3 << 20) - 1);
+    big.resize(10);
+    big.shrink_to_fit();
+    REQUIRE(big[9] == 9);
+    REQUIRE(big == tftl::vector<int, allocator>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  }
+}
@@ -0,0 +1,1202 @@
+//
+// Created by truefinch on 14.06.18.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "allocator.hpp"
+#include "arena_allocator.hpp"
+#include "bench.hpp"
+#include "concurrent_vector.hpp"
+#include "cow_vector.hpp"
+#include "devector.hpp"
+#include "parallel.hpp"
+#include "persistent_vector.hpp"
+#include "pool_allocator.hpp"
+#include "serialization.hpp"
+#include "small_vector.hpp"
+#include "soa_vector.hpp"
+#include "vector.hpp"
+
+namespace {
+using tftl::bench::state;
+using tftl::bench::do_not_optimize;
+
+struct Pod64 {
+  long long payload[8];
+};
+
+// Element i of every case, its key is i
+template<typename T>
+T make(std::size_t i);
+
+template<>
+int make<int>(std::size_t i) {
+  return static_cast<int>(i);
+}
+
+template<>
+Pod64 make<Pod64>(std::size_t i) {
+  Pod64 pod{};
+  pod.payload[0] = static_cast<long long>(i);
+  return pod;
+}
+
+// Longer than the small string buffer, so every element owns a heap block
+template<>
+std::string make<std::string>(std::size_t i) {
+  std::string value = std::to_string(i);
+  return std::string(32 - value.size(), '0') + value;
+}
+
+template<>
+std::unique_ptr<int> make<std::unique_ptr<int>>(std::size_t i) {
+  return std::unique_ptr<int>(new int(static_cast<int>(i)));
+}
+
+long long key(int value) {
+  return value;
+}
+
+long long key(const Pod64& value) {
+  return value.payload[0];
+}
+
+long long key(const std::string& value) {
+  return value.back();
+}
+
+long long key(const std::unique_ptr<int>& value) {
+  return *value;
+}
+
+struct less_key {
+  template<typename T>
+  bool operator()(const T& lhs, const T& rhs) const {
+    return key(lhs) < key(rhs);
+  }
+};
+
+// Fills vector with count elements in a fixed shuffled order
+template<typename Vector>
+void fill_shuffled(Vector& vector, std::size_t count) {
+  std::vector<std::size_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937(42));
+  vector.reserve(count);
+  for (std::size_t i : order) {
+    vector.push_back(make<typename Vector::value_type>(i));
+  }
+}
+
+template<typename Vector>
+void fill(Vector& vector, std::size_t count) {
+  vector.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    vector.push_back(make<typename Vector::value_type>(i));
+  }
+}
+
+// Elements are created untimed, so only growth and relocation are measured
+template<typename Vector>
+struct push_back {
+  static void run(state& state) {
+    typedef typename Vector::value_type T;
+    std::vector<T> source;
+    while (state.keep_running()) {
+      state.pause_timing();
+      source.clear();
+      fill(source, state.elements());
+      state.resume_timing();
+
+      Vector result;
+      for (auto& element : source) {
+        if constexpr (std::is_copy_constructible<T>::value) {
+          result.push_back(element);
+        } else {
+          result.push_back(std::move(element));
+        }
+      }
+      do_not_optimize(result);
+    }
+  }
+};
+
+template<typename Vector>
+struct emplace_back {
+  static void run(state& state) {
+    typedef typename Vector::value_type T;
+    std::vector<T> source;
+    while (state.keep_running()) {
+      state.pause_timing();
+      source.clear();
+      fill(source, state.elements());
+      state.resume_timing();
+
+      Vector result;
+      for (auto& element : source) {
+        result.emplace_back(std::move(element));
+      }
+      do_not_optimize(result);
+    }
+  }
+};
+
+template<typename Vector>
+struct insert_front {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      Vector result;
+      for (std::size_t i = 0; i < state.elements(); ++i) {
+        result.emplace(result.begin(), make<typename Vector::value_type>(i));
+      }
+      do_not_optimize(result);
+    }
+  }
+};
+
+template<typename Vector>
+struct insert_middle {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      Vector result;
+      for (std::size_t i = 0; i < state.elements(); ++i) {
+        result.emplace(result.begin() + result.size() / 2, make<typename Vector::value_type>(i));
+      }
+      do_not_optimize(result);
+    }
+  }
+};
+
+// Counts the copies and moves the containers make of it
+template<typename T>
+struct counted {
+  static std::size_t copies;
+  static std::size_t moves;
+  T value;
+
+  explicit counted(T value) : value(std::move(value)) {}
+  counted(const counted& other) : value(other.value) { ++copies; }
+  counted(counted&& other) noexcept : value(std::move(other.value)) { ++moves; }
+  counted& operator=(const counted& other) {
+    value = other.value;
+    ++copies;
+    return *this;
+  }
+  counted& operator=(counted&& other) noexcept {
+    value = std::move(other.value);
+    ++moves;
+    return *this;
+  }
+};
+template<typename T>
+std::size_t counted<T>::copies = 0;
+template<typename T>
+std::size_t counted<T>::moves = 0;
+
+// A large move-only payload, the string keeps it from being trivially relocatable
+struct Blob {
+  std::unique_ptr<char[]> bytes;
+  std::string             name;
+};
+
+template<typename T>
+T make_payload(std::size_t i);
+
+template<>
+std::string make_payload<std::string>(std::size_t i) {
+  return make<std::string>(i);
+}
+
+template<>
+Blob make_payload<Blob>(std::size_t i) {
+  return Blob{std::unique_ptr<char[]>(new char[4096]), make<std::string>(i)};
+}
+
+// 100 rvalues inserted in the middle, reports what each insert copied and moved
+template<typename Vector>
+struct insert_middle_counted {
+  static void run(state& state) {
+    typedef typename Vector::value_type T;
+    std::size_t copies = 0;
+    std::size_t moves = 0;
+    while (state.keep_running()) {
+      state.pause_timing();
+      Vector result;
+      result.reserve(state.elements() + 100);
+      for (std::size_t i = 0; i < state.elements(); ++i) {
+        result.emplace_back(make_payload<decltype(T::value)>(i));
+      }
+      std::vector<T> inserted;
+      for (std::size_t i = 0; i < 100; ++i) {
+        inserted.emplace_back(make_payload<decltype(T::value)>(i));
+      }
+      T::copies = T::moves = 0;
+      state.resume_timing();
+
+      for (T& element : inserted) {
+        result.insert(result.begin() + result.size() / 2, std::move(element));
+      }
+      copies += T::copies;
+      moves += T::moves;
+      do_not_optimize(result);
+    }
+    state.counter("copies/insert", static_cast<double>(copies) / (state.iterations() * 100));
+    state.counter("moves/insert", static_cast<double>(moves) / (state.iterations() * 100));
+  }
+};
+
+// Refills a vector which already has the capacity, so only the writes are measured
+template<typename Vector, int Value>
+struct assign_fill {
+  static void run(state& state) {
+    Vector result(state.elements(), 1);
+    while (state.keep_running()) {
+      result.assign(state.elements(), Value);
+      do_not_optimize(result);
+    }
+    double bytes = static_cast<double>(state.elements() * sizeof(int) * state.iterations());
+    state.counter("GB/s", bytes / state.elapsed_ns());
+  }
+};
+
+// Sums a working set, as the other threads of the box do while a big copy runs
+long long scan(const std::vector<long long>& working_set) {
+  return std::accumulate(working_set.begin(), working_set.end(), 0LL);
+}
+
+double thread_cpu_ns() {
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+// Copies a big buffer while a neighbour thread scans an 8 MiB working set. Reports the copy
+// bandwidth and the CPU time of a neighbour scan against the same scan without the copies.
+template<bool Streaming>
+struct copy_with_neighbour {
+  static void run(state& state) {
+    std::size_t threshold = tftl::streaming_threshold();
+    tftl::set_streaming_threshold(Streaming ? 0 : std::numeric_limits<std::size_t>::max());
+    tftl::vector<float> source(state.elements(), 1.5f);
+    tftl::vector<float> target(state.elements(), 0.0f);
+    std::vector<long long> working_set((std::size_t(8) << 20) / sizeof(long long), 1);
+
+    std::atomic<bool> copying{false};
+    std::atomic<bool> stop{false};
+    double ns[2] = {0, 0};
+    std::size_t scans[2] = {0, 0};
+    std::thread neighbour([&] {
+      while (!stop.load()) {
+        bool during = copying.load();
+        double start = thread_cpu_ns();
+        long long total = scan(working_set);
+        do_not_optimize(total);
+        ns[during] += thread_cpu_ns() - start;
+        ++scans[during];
+      }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    copying = true;
+    while (state.keep_running()) {
+      target = source;
+      do_not_optimize(target);
+    }
+    stop = true;
+    neighbour.join();
+    tftl::set_streaming_threshold(threshold);
+
+    double bytes = static_cast<double>(state.elements() * sizeof(float) * state.iterations());
+    state.counter("GB/s", bytes / state.elapsed_ns());
+    if (scans[0] != 0 && scans[1] != 0) {
+      state.counter("neighbour_slowdown", (ns[1] / scans[1]) / (ns[0] / scans[0]));
+    }
+  }
+};
+
+// Erases the middle half at once, then the rest in 64 slices from the front
+template<typename Vector>
+struct erase_range {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      state.pause_timing();
+      Vector result;
+      fill(result, state.elements());
+      state.resume_timing();
+
+      std::size_t size = result.size();
+      result.erase(result.begin() + size / 4, result.begin() + size / 4 * 3);
+      std::size_t slice = std::max<std::size_t>(result.size() / 64, 1);
+      while (result.size() > slice) {
+        result.erase(result.begin(), result.begin() + slice);
+      }
+      do_not_optimize(result);
+    }
+  }
+};
+
+template<typename Vector>
+struct copy_construct {
+  static void run(state& state) {
+    Vector source;
+    fill(source, state.elements());
+    while (state.keep_running()) {
+      Vector result(source);
+      do_not_optimize(result);
+    }
+  }
+};
+
+template<typename Vector>
+struct move_construct {
+  static void run(state& state) {
+    Vector source;
+    fill(source, state.elements());
+    while (state.keep_running()) {
+      Vector result(std::move(source));
+      do_not_optimize(result);
+      source = std::move(result);
+    }
+  }
+};
+
+template<typename Vector>
+struct reserve_fill {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      Vector result;
+      result.reserve(state.elements());
+      for (std::size_t i = 0; i < state.elements(); ++i) {
+        result.push_back(make<typename Vector::value_type>(i));
+      }
+      do_not_optimize(result);
+    }
+  }
+};
+
+template<typename Vector>
+struct iterate {
+  static void run(state& state) {
+    Vector source;
+    fill(source, state.elements());
+    while (state.keep_running()) {
+      long long sum = 0;
+      for (const auto& element : source) {
+        sum += key(element);
+      }
+      do_not_optimize(sum);
+    }
+  }
+};
+
+template<typename Vector>
+struct sort {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      state.pause_timing();
+      Vector result;
+      fill_shuffled(result, state.elements());
+      state.resume_timing();
+
+      std::sort(result.begin(), result.end(), less_key());
+      do_not_optimize(result);
+    }
+  }
+};
+
+// The vector is sorted by tftl::parallel on the shared pool, Stable picks stable_sort
+template<typename T, bool Stable>
+struct parallel_sort {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      state.pause_timing();
+      tftl::vector<T> result;
+      fill_shuffled(result, state.elements());
+      state.resume_timing();
+
+      if (Stable) {
+        tftl::parallel::stable_sort(result, less_key());
+      } else {
+        tftl::parallel::sort(result, less_key());
+      }
+      do_not_optimize(result);
+    }
+  }
+};
+
+// A 64-byte record of which the scan reads two fields, stored as rows and as columns
+struct Order {
+  double    price;
+  double    quantity;
+  long long fields[6];
+};
+
+typedef tftl::soa_vector<double, double, long long, long long, long long, long long, long long, long long> order_columns;
+
+struct scan_rows {
+  static void run(state& state) {
+    tftl::vector<Order> orders;
+    for (std::size_t i = 0; i < state.elements(); ++i) {
+      orders.push_back(Order{static_cast<double>(i % 100), 2.0, {}});
+    }
+    while (state.keep_running()) {
+      double total = 0;
+      for (const Order& order : orders) {
+        total += order.price * order.quantity;
+      }
+      do_not_optimize(total);
+    }
+  }
+};
+
+struct scan_columns {
+  static void run(state& state) {
+    order_columns orders;
+    for (std::size_t i = 0; i < state.elements(); ++i) {
+      orders.emplace_back(static_cast<double>(i % 100), 2.0, 0, 0, 0, 0, 0, 0);
+    }
+    while (state.keep_running()) {
+      const double* price = orders.data<0>();
+      const double* quantity = orders.data<1>();
+      double total = 0;
+      for (std::size_t i = 0; i < orders.size(); ++i) {
+        total += price[i] * quantity[i];
+      }
+      do_not_optimize(total);
+    }
+  }
+};
+
+// Reads at random positions of a big table, each one misses the TLB unless the pages are huge
+template<typename Vector>
+struct random_reads {
+  static void run(state& state) {
+    Vector table(state.elements(), 1);
+    std::size_t mask = state.elements() - 1; // elements is a power of two
+    while (state.keep_running()) {
+      std::uint64_t position = 12345;
+      long long total = 0;
+      for (std::size_t i = 0; i < 1000000; ++i) {
+        position = position * 6364136223846793005ULL + 1442695040888963407ULL;
+        total += table[(position >> 20) & mask];
+      }
+      do_not_optimize(total);
+    }
+  }
+};
+
+// Every update publishes a snapshot for the readers: a full copy of the table, or a new persistent version
+struct snapshot_copy_update {
+  static void run(state& state) {
+    tftl::vector<int> table(state.elements(), 1);
+    std::size_t position = 0;
+    while (state.keep_running()) {
+      position = (position * 7919 + 1) % state.elements();
+      tftl::vector<int> snapshot(table);
+      snapshot[position] = static_cast<int>(position);
+      table = std::move(snapshot);
+      do_not_optimize(table);
+    }
+  }
+};
+
+struct snapshot_persistent_update {
+  static void run(state& state) {
+    tftl::persistent_vector<int> table(tftl::vector<int>(state.elements(), 1));
+    std::size_t position = 0;
+    while (state.keep_running()) {
+      position = (position * 7919 + 1) % state.elements();
+      table = table.set(position, static_cast<int>(position));
+      do_not_optimize(table);
+    }
+  }
+};
+
+struct snapshot_copy_append {
+  static void run(state& state) {
+    tftl::vector<int> table(state.elements(), 1);
+    while (state.keep_running()) {
+      tftl::vector<int> snapshot;
+      snapshot.reserve(table.size() + 1);
+      snapshot.insert(snapshot.end(), table.data(), table.data() + table.size());
+      snapshot.push_back(2);
+      table = std::move(snapshot);
+      do_not_optimize(table);
+    }
+  }
+};
+
+struct snapshot_persistent_append {
+  static void run(state& state) {
+    tftl::persistent_vector<int> table(tftl::vector<int>(state.elements(), 1));
+    while (state.keep_running()) {
+      table = table.push_back(2);
+      do_not_optimize(table);
+    }
+  }
+};
+
+// A batch of 1000 updates behind one snapshot
+struct snapshot_copy_batch {
+  static void run(state& state) {
+    tftl::vector<int> table(state.elements(), 1);
+    std::size_t position = 0;
+    while (state.keep_running()) {
+      tftl::vector<int> snapshot(table);
+      for (int i = 0; i < 1000; ++i) {
+        position = (position * 7919 + 1) % state.elements();
+        snapshot[position] = i;
+      }
+      table = std::move(snapshot);
+      do_not_optimize(table);
+    }
+  }
+};
+
+struct snapshot_transient_batch {
+  static void run(state& state) {
+    tftl::persistent_vector<int> table(tftl::vector<int>(state.elements(), 1));
+    std::size_t position = 0;
+    while (state.keep_running()) {
+      tftl::transient_vector<int> batch = table.transient();
+      for (int i = 0; i < 1000; ++i) {
+        position = (position * 7919 + 1) % state.elements();
+        batch.set(position, i);
+      }
+      table = batch.persistent();
+      do_not_optimize(table);
+    }
+  }
+};
+
+// Reading everything back: a flat array against the leaves of the trie
+struct scan_flat {
+  static void run(state& state) {
+    tftl::vector<int> table(state.elements(), 1);
+    while (state.keep_running()) {
+      long long total = 0;
+      for (int value : table) {
+        total += value;
+      }
+      do_not_optimize(total);
+    }
+  }
+};
+
+template<bool Chunked>
+struct scan_persistent {
+  static void run(state& state) {
+    tftl::persistent_vector<int> table(tftl::vector<int>(state.elements(), 1));
+    while (state.keep_running()) {
+      long long total = 0;
+      if constexpr (Chunked) {
+        table.for_each_chunk([&total](tftl::span<const int> chunk) {
+          for (int value : chunk) {
+            total += value;
+          }
+        });
+      } else {
+        for (int value : table) {
+          total += value;
+        }
+      }
+      do_not_optimize(total);
+    }
+  }
+};
+
+// The same table handed to 32 consumers, which read a little of it each
+template<typename Vector>
+struct fanout_handoff {
+  static void run(state& state) {
+    tftl::vector<int> source(state.elements(), 1);
+    Vector table(std::move(source));
+    std::vector<Vector> consumers(32);
+    while (state.keep_running()) {
+      long long total = 0;
+      for (Vector& consumer : consumers) {
+        consumer = table;
+        total += consumer[consumer.size() / 2];
+      }
+      do_not_optimize(total);
+    }
+  }
+};
+
+// tftl::vector has no push_front, the front is reached by insert
+template<typename Vector>
+void push_front(Vector& vector, int value) {
+  vector.push_front(value);
+}
+
+void push_front(tftl::vector<int>& vector, int value) {
+  vector.insert(vector.begin(), value);
+}
+
+void pop_front(std::deque<int>& deque) {
+  deque.pop_front();
+}
+
+void pop_front(tftl::devector<int>& devector) {
+  devector.pop_front();
+}
+
+template<typename Vector>
+struct push_front_n {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      Vector vector;
+      for (std::size_t i = 0; i < state.elements(); ++i) {
+        push_front(vector, static_cast<int>(i));
+      }
+      do_not_optimize(vector);
+    }
+  }
+};
+
+// A queue of 1024 elements: each step pushes at the back and pops at the front
+template<typename Vector>
+struct sliding_window {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      Vector window(1024, 0);
+      long long total = 0;
+      for (std::size_t i = 0; i < state.elements(); ++i) {
+        window.push_back(static_cast<int>(i));
+        total += window.front();
+        pop_front(window);
+      }
+      do_not_optimize(total);
+    }
+  }
+};
+
+// Records of Pod64, the hand-rolled format is a count followed by the elements one at a time
+void record_throughput(state& state) {
+  double bytes = static_cast<double>(state.elements() * sizeof(Pod64) * state.iterations());
+  state.counter("GB/s", bytes / state.elapsed_ns());
+}
+
+tftl::vector<Pod64> make_records(std::size_t count) {
+  tftl::vector<Pod64> records;
+  for (std::size_t i = 0; i < count; ++i) {
+    records.push_back(Pod64{{static_cast<long long>(i)}});
+  }
+  return records;
+}
+
+std::vector<char> loop_serialize(const tftl::vector<Pod64>& records) {
+  std::vector<char> buffer;
+  std::uint64_t count = records.size();
+  buffer.insert(buffer.end(), reinterpret_cast<const char*>(&count), reinterpret_cast<const char*>(&count + 1));
+  for (const Pod64& record : records) {
+    buffer.insert(buffer.end(), reinterpret_cast<const char*>(&record), reinterpret_cast<const char*>(&record + 1));
+  }
+  return buffer;
+}
+
+struct serialize_loop {
+  static void run(state& state) {
+    tftl::vector<Pod64> records = make_records(state.elements());
+    while (state.keep_running()) {
+      std::vector<char> buffer = loop_serialize(records);
+      do_not_optimize(buffer);
+    }
+    record_throughput(state);
+  }
+};
+
+struct serialize_record {
+  static void run(state& state) {
+    tftl::vector<Pod64> records = make_records(state.elements());
+    while (state.keep_running()) {
+      tftl::vector<char, tftl::default_init_allocator<char>> buffer;
+      buffer.resize(tftl::serialization::serialized_size(records));
+      tftl::serialization::serialize_to(buffer.data(), buffer.size(), records);
+      do_not_optimize(buffer);
+    }
+    record_throughput(state);
+  }
+};
+
+struct deserialize_loop {
+  static void run(state& state) {
+    std::vector<char> buffer = loop_serialize(make_records(state.elements()));
+    while (state.keep_running()) {
+      std::uint64_t count;
+      std::memcpy(&count, buffer.data(), sizeof(count));
+      tftl::vector<Pod64> records;
+      records.reserve(count);
+      for (std::uint64_t i = 0; i < count; ++i) {
+        Pod64 record;
+        std::memcpy(&record, buffer.data() + sizeof(count) + i * sizeof(Pod64), sizeof(Pod64));
+        records.push_back(record);
+      }
+      do_not_optimize(records);
+    }
+    record_throughput(state);
+  }
+};
+
+template<bool Verify>
+struct deserialize_record {
+  static void run(state& state) {
+    tftl::vector<Pod64> source = make_records(state.elements());
+    std::vector<char> buffer(tftl::serialization::serialized_size(source));
+    tftl::serialization::serialize_to(buffer.data(), buffer.size(), source);
+    while (state.keep_running()) {
+      tftl::vector<Pod64> records;
+      tftl::serialization::deserialize_from(buffer.data(), buffer.size(), records, Verify);
+      do_not_optimize(records);
+    }
+    record_throughput(state);
+  }
+};
+
+template<bool Verify>
+struct view_record {
+  static void run(state& state) {
+    tftl::vector<Pod64> source = make_records(state.elements());
+    std::vector<char> buffer(tftl::serialization::serialized_size(source));
+    tftl::serialization::serialize_to(buffer.data(), buffer.size(), source);
+    while (state.keep_running()) {
+      tftl::serialization::view<Pod64> records(buffer.data(), buffer.size(), Verify);
+      long long last = records.back().payload[0];
+      do_not_optimize(last);
+    }
+    record_throughput(state);
+  }
+};
+
+// Result buffers filled by producer threads: a mutex around tftl::vector against tftl::concurrent_vector
+struct locked_vector {
+  std::mutex        mutex;
+  tftl::vector<int> values;
+
+  void push_back(int value) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->values.push_back(value);
+  }
+};
+
+template<typename Sink, std::size_t Threads>
+struct concurrent_append {
+  static void run(state& state) {
+    std::size_t per_thread = state.elements() / Threads;
+    while (state.keep_running()) {
+      Sink sink;
+      std::vector<std::thread> producers;
+      for (std::size_t t = 0; t < Threads; ++t) {
+        producers.emplace_back([&sink, per_thread] {
+          for (std::size_t i = 0; i < per_thread; ++i) {
+            sink.push_back(static_cast<int>(i));
+          }
+        });
+      }
+      for (auto& producer : producers) {
+        producer.join();
+      }
+      do_not_optimize(sink);
+    }
+    state.counter("threads", Threads);
+  }
+};
+
+template<std::size_t Threads>
+void add_concurrent_append(tftl::bench::suite& suite, std::size_t elements) {
+  suite.add({"concurrent_append/int/" + std::to_string(Threads) + "_threads", elements, 0, {
+      {"tftl::vector + std::mutex", &concurrent_append<locked_vector, Threads>::run},
+      {"tftl::concurrent_vector", &concurrent_append<tftl::concurrent_vector<int>, Threads>::run}
+  }});
+}
+
+template<typename T>
+void append(std::vector<T>& vector, const std::vector<T>& batch) {
+  vector.insert(vector.end(), batch.begin(), batch.end());
+}
+
+template<typename T>
+void append(tftl::vector<T>& vector, const std::vector<T>& batch) {
+  vector.append_range(batch);
+}
+
+// Ingestion appends batches of 4K to 64K records
+template<typename Vector>
+struct append_batches {
+  static void run(state& state) {
+    typedef typename Vector::value_type T;
+    std::vector<std::vector<T>> batches;
+    for (std::size_t size = 4096, total = 0; total < state.elements(); size = size * 2 > 65536 ? 4096 : size * 2) {
+      batches.emplace_back();
+      fill(batches.back(), size);
+      total += size;
+    }
+    while (state.keep_running()) {
+      Vector result;
+      for (const auto& batch : batches) {
+        append(result, batch);
+      }
+      do_not_optimize(result);
+    }
+  }
+};
+
+// A buffer sized for a read() which then fills all of it
+template<typename Vector>
+struct resize_then_read {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      Vector buffer;
+      buffer.resize(state.elements());
+      std::memset(buffer.data(), 'x', buffer.size());
+      do_not_optimize(buffer);
+    }
+  }
+};
+
+template<typename Vector>
+struct overwrite_then_read {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      Vector buffer;
+      buffer.resize_and_overwrite(state.elements(), [](char* data, std::size_t count) {
+        std::memset(data, 'x', count);
+        return count;
+      });
+      do_not_optimize(buffer);
+    }
+  }
+};
+
+// Duplicate candidates: equal up to the last element, so the whole vector is scanned
+template<typename Vector>
+struct equal_scan {
+  static void run(state& state) {
+    Vector lhs, rhs;
+    for (std::size_t i = 0; i < state.elements(); ++i) {
+      lhs.push_back(static_cast<typename Vector::value_type>(i % 251));
+    }
+    rhs = lhs;
+    rhs.back() = static_cast<typename Vector::value_type>(lhs.back() + 1);
+    while (state.keep_running()) {
+      bool equal = lhs == rhs;
+      do_not_optimize(equal);
+    }
+  }
+};
+
+template<typename Vector>
+struct less_scan {
+  static void run(state& state) {
+    Vector lhs, rhs;
+    for (std::size_t i = 0; i < state.elements(); ++i) {
+      lhs.push_back(static_cast<typename Vector::value_type>(i % 251));
+    }
+    rhs = lhs;
+    rhs.back() = static_cast<typename Vector::value_type>(lhs.back() + 1);
+    while (state.keep_running()) {
+      bool less = lhs < rhs;
+      do_not_optimize(less);
+    }
+  }
+};
+
+template<typename T>
+void add_comparisons(tftl::bench::suite& suite, const char* type, std::size_t elements) {
+  std::string label = std::string("tftl::vector ") + tftl::simd::name(tftl::simd::detect());
+  for (std::size_t size : {std::size_t(256), elements}) {
+    suite.add({std::string("equal/") + type + "/" + std::to_string(size), size, 0, {
+        {"std::vector", &equal_scan<std::vector<T>>::run},
+        {label, &equal_scan<tftl::vector<T>>::run}
+    }});
+    suite.add({std::string("less/") + type + "/" + std::to_string(size), size, 0, {
+        {"std::vector", &less_scan<std::vector<T>>::run},
+        {label, &less_scan<tftl::vector<T>>::run}
+    }});
+  }
+}
+
+template<template<typename> class Case, typename T>
+void compare(tftl::bench::suite& suite, const std::string& name, const char* type, std::size_t elements) {
+  suite.add({name + "/" + type, elements, 0, {
+      {"std::vector", &Case<std::vector<T>>::run},
+      {"tftl::vector", &Case<tftl::vector<T>>::run}
+  }});
+}
+
+template<typename T>
+void add_cases(tftl::bench::suite& suite, const char* type, std::size_t elements) {
+  compare<push_back, T>(suite, "push_back", type, elements);
+  compare<emplace_back, T>(suite, "emplace_back", type, elements);
+  compare<insert_front, T>(suite, "insert_front", type, elements / 100);
+  compare<insert_middle, T>(suite, "insert_middle", type, elements / 100);
+  compare<erase_range, T>(suite, "erase_range", type, elements);
+  if constexpr (std::is_copy_constructible<T>::value) {
+    compare<append_batches, T>(suite, "append_batches", type, elements);
+    compare<copy_construct, T>(suite, "copy_construct", type, elements);
+  }
+  compare<move_construct, T>(suite, "move_construct", type, elements);
+  compare<reserve_fill, T>(suite, "reserve_fill", type, elements);
+  compare<iterate, T>(suite, "iterate", type, elements);
+  compare<sort, T>(suite, "sort", type, elements);
+}
+
+// Runs the push_back loop in a child process, so its peak RSS is not hidden by earlier cases
+template<typename Vector>
+struct push_back_rss {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      std::size_t count = state.elements();
+      pid_t child = fork();
+      if (child == 0) {
+        Vector result;
+        for (std::size_t i = 0; i < count; ++i) {
+          result.push_back(static_cast<int>(i));
+        }
+        _exit(0);
+      }
+      int status = 0;
+      rusage usage{};
+      wait4(child, &status, 0, &usage);
+      state.counter("peak_rss_kb", usage.ru_maxrss);
+    }
+  }
+};
+
+// Short-lived vectors of a few elements, as built when parsing a request
+template<typename Vector>
+struct tiny_vectors {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      long long checksum = 0;
+      for (std::size_t i = 0; i < state.elements(); ++i) {
+        Vector result;
+        for (std::size_t j = 0; j < 6; ++j) {
+          result.push_back(static_cast<int>(i + j));
+        }
+        checksum += result[3];
+      }
+      do_not_optimize(checksum);
+    }
+  }
+};
+
+// A request builds 100 temporary vectors, which are all dropped when it ends
+template<typename Vectors>
+struct requests {
+  static void run(state& state) {
+    while (state.keep_running()) {
+      long long checksum = 0;
+      for (std::size_t request = 0; request < state.elements(); ++request) {
+        Vectors vectors;
+        for (std::size_t i = 0; i < vectors.size(); ++i) {
+          for (int j = 0; j < 20; ++j) {
+            vectors[i].push_back(j);
+          }
+          checksum += vectors[i].back();
+        }
+      }
+      do_not_optimize(checksum);
+    }
+  }
+};
+
+template<typename Vector>
+struct default_vectors {
+  std::vector<Vector> vectors = std::vector<Vector>(100);
+
+  std::size_t size() const { return vectors.size(); }
+  Vector& operator[](std::size_t i) { return vectors[i]; }
+};
+
+struct arena_vectors {
+  typedef tftl::vector<int, tftl::arena_allocator<int>> vector;
+
+  tftl::monotonic_arena arena;
+  std::vector<vector>   vectors = std::vector<vector>(100, vector(arena));
+
+  std::size_t size() const { return vectors.size(); }
+  vector& operator[](std::size_t i) { return vectors[i]; }
+};
+
+struct pool_vectors {
+  typedef tftl::vector<int, tftl::pool_allocator<int>> vector;
+
+  static tftl::pool_resource& pool() {
+    static tftl::pool_resource pool;
+    return pool;
+  }
+
+  std::vector<vector> vectors = std::vector<vector>(100, vector(pool()));
+
+  std::size_t size() const { return vectors.size(); }
+  vector& operator[](std::size_t i) { return vectors[i]; }
+};
+} // namespace
+
+int main(int argc, char** argv) {
+  tftl::bench::options options = tftl::bench::parse(argc, argv);
+  std::size_t count = options.elements;
+  tftl::bench::suite suite;
+
+  // Peak RSS cases go first, while this process is still small
+  suite.add({"push_back_peak_rss/int", count * 10, 1, {
+      {"std::vector", &push_back_rss<std::vector<int>>::run},
+      {"tftl::vector", &push_back_rss<tftl::vector<int>>::run},
+      {"tftl::vector + malloc_allocator", &push_back_rss<tftl::vector<int, tftl::malloc_allocator<int>>>::run},
+      {"tftl::vector + growth_factor<3, 2>",
+       &push_back_rss<tftl::vector<int, std::allocator<int>, tftl::growth_factor<3, 2>>>::run},
+      {"tftl::vector + power_of_two_growth",
+       &push_back_rss<tftl::vector<int, std::allocator<int>, tftl::power_of_two_growth>>::run}
+  }});
+  suite.add({"push_back_peak_rss/exact_growth/int", count / 10, 1, {
+      {"std::vector", &push_back_rss<std::vector<int>>::run},
+      {"tftl::vector + exact_growth", &push_back_rss<tftl::vector<int, std::allocator<int>, tftl::exact_growth>>::run}
+  }});
+
+  add_cases<int>(suite, "int", count);
+  add_cases<Pod64>(suite, "pod64", count / 4);
+  add_cases<std::string>(suite, "std::string", count / 4);
+  add_cases<std::unique_ptr<int>>(suite, "std::unique_ptr<int>", count / 4);
+
+  std::string threads = std::to_string(tftl::parallel::thread_pool::shared().concurrency()) + " threads";
+  suite.add({"parallel_sort/int", count, 0, {
+      {"std::vector std::sort", &sort<std::vector<int>>::run},
+      {"tftl::parallel::sort, " + threads, &parallel_sort<int, false>::run},
+      {"tftl::parallel::stable_sort, " + threads, &parallel_sort<int, true>::run}
+  }});
+  suite.add({"parallel_sort/std::string", count / 4, 0, {
+      {"std::vector std::sort", &sort<std::vector<std::string>>::run},
+      {"tftl::parallel::sort, " + threads, &parallel_sort<std::string, false>::run},
+      {"tftl::parallel::stable_sort, " + threads, &parallel_sort<std::string, true>::run}
+  }});
+
+  add_comparisons<unsigned char>(suite, "uint8", count);
+  add_comparisons<int>(suite, "int", count);
+  add_comparisons<float>(suite, "float", count);
+  add_comparisons<double>(suite, "double", count);
+
+  for (std::size_t bytes : {std::size_t(1) << 20, std::size_t(1) << 26, std::size_t(1) << 30}) {
+    suite.add({"io_buffer/" + std::to_string(bytes >> 20) + "MB", bytes, 0, {
+        {"std::vector resize", &resize_then_read<std::vector<char>>::run},
+        {"tftl::vector resize", &resize_then_read<tftl::vector<char>>::run},
+        {"tftl::vector resize_and_overwrite", &overwrite_then_read<tftl::vector<char>>::run},
+        {"tftl::vector + default_init_allocator resize",
+         &resize_then_read<tftl::vector<char, tftl::default_init_allocator<char>>>::run}
+    }});
+  }
+  suite.add({"insert_middle_counted/std::string", count / 100, 0, {
+      {"std::vector", &insert_middle_counted<std::vector<counted<std::string>>>::run},
+      {"tftl::vector", &insert_middle_counted<tftl::vector<counted<std::string>>>::run}
+  }});
+  suite.add({"insert_middle_counted/move_only_4KB_blob", count / 100, 0, {
+      {"std::vector", &insert_middle_counted<std::vector<counted<Blob>>>::run},
+      {"tftl::vector", &insert_middle_counted<tftl::vector<counted<Blob>>>::run}
+  }});
+  suite.add({"assign_fill/int/zero", count * 100, 0, {
+      {"std::vector", &assign_fill<std::vector<int>, 0>::run},
+      {"tftl::vector", &assign_fill<tftl::vector<int>, 0>::run}
+  }});
+  suite.add({"assign_fill/int/pattern", count * 100, 0, {
+      {"std::vector", &assign_fill<std::vector<int>, 7>::run},
+      {"tftl::vector", &assign_fill<tftl::vector<int>, 7>::run}
+  }});
+  suite.add({"copy_with_neighbour/float/64MB", std::size_t(16) << 20, 0, {
+      {"memcpy", &copy_with_neighbour<false>::run},
+      {"non-temporal stores", &copy_with_neighbour<true>::run}
+  }});
+  suite.add({"random_reads/256MB", std::size_t(1) << 26, 0, {
+      {"std::allocator", &random_reads<tftl::vector<int>>::run},
+      {"tftl::aligned_allocator", &random_reads<tftl::vector<int, tftl::aligned_allocator<int>>>::run},
+      {"tftl::huge_page_allocator", &random_reads<tftl::vector<int, tftl::huge_page_allocator<int>>>::run}
+  }});
+  suite.add({"snapshot_update/int", count, 0, {
+      {"tftl::vector copy", &snapshot_copy_update::run},
+      {"tftl::persistent_vector::set", &snapshot_persistent_update::run}
+  }});
+  suite.add({"snapshot_append/int", count, 0, {
+      {"tftl::vector copy", &snapshot_copy_append::run},
+      {"tftl::persistent_vector::push_back", &snapshot_persistent_append::run}
+  }});
+  suite.add({"snapshot_batch_of_1000/int", count, 0, {
+      {"tftl::vector copy", &snapshot_copy_batch::run},
+      {"tftl::transient_vector", &snapshot_transient_batch::run}
+  }});
+  suite.add({"snapshot_scan/int", count, 0, {
+      {"tftl::vector", &scan_flat::run},
+      {"tftl::persistent_vector iterators", &scan_persistent<false>::run},
+      {"tftl::persistent_vector::for_each_chunk", &scan_persistent<true>::run}
+  }});
+  suite.add({"fanout_handoff/int/32_consumers", count, 0, {
+      {"tftl::vector copy", &fanout_handoff<tftl::vector<int>>::run},
+      {"tftl::cow_vector", &fanout_handoff<tftl::cow_vector<int>>::run}
+  }});
+  suite.add({"push_front/int", count / 100, 0, {
+      {"tftl::vector::insert(begin())", &push_front_n<tftl::vector<int>>::run},
+      {"std::deque", &push_front_n<std::deque<int>>::run},
+      {"tftl::devector", &push_front_n<tftl::devector<int>>::run}
+  }});
+  suite.add({"push_front/int/large", count, 0, {
+      {"std::deque", &push_front_n<std::deque<int>>::run},
+      {"tftl::devector", &push_front_n<tftl::devector<int>>::run}
+  }});
+  suite.add({"sliding_window_of_1024/int", count, 0, {
+      {"std::deque", &sliding_window<std::deque<int>>::run},
+      {"tftl::devector", &sliding_window<tftl::devector<int>>::run}
+  }});
+  suite.add({"column_scan/64_byte_records", count, 0, {
+      {"tftl::vector<Order>", &scan_rows::run},
+      {"tftl::soa_vector, 8 columns", &scan_columns::run}
+  }});
+  suite.add({"serialize/pod64", count / 4, 0, {
+      {"element loop", &serialize_loop::run},
+      {"tftl::serialization::serialize_to", &serialize_record::run}
+  }});
+  suite.add({"deserialize/pod64", count / 4, 0, {
+      {"element loop", &deserialize_loop::run},
+      {"tftl::serialization::deserialize_from", &deserialize_record<true>::run},
+      {"tftl::serialization::deserialize_from, unverified", &deserialize_record<false>::run},
+      {"tftl::serialization::view", &view_record<true>::run},
+      {"tftl::serialization::view, unverified", &view_record<false>::run}
+  }});
+  add_concurrent_append<1>(suite, count);
+  add_concurrent_append<2>(suite, count);
+  add_concurrent_append<4>(suite, count);
+  add_concurrent_append<8>(suite, count);
+  add_concurrent_append<16>(suite, count);
+  add_concurrent_append<32>(suite, count);
+  add_concurrent_append<64>(suite, count);
+  suite.add({"tiny_vectors_of_6/int", count / 10, 0, {
+      {"std::vector", &tiny_vectors<std::vector<int>>::run},
+      {"tftl::vector", &tiny_vectors<tftl::vector<int>>::run},
+      {"tftl::small_vector<int, 8>", &tiny_vectors<tftl::small_vector<int, 8>>::run}
+  }});
+  suite.add({"requests_of_100_vectors/int", count / 10000, 0, {
+      {"std::vector", &requests<default_vectors<std::vector<int>>>::run},
+      {"tftl::vector", &requests<default_vectors<tftl::vector<int>>>::run},
+      {"tftl::vector + arena_allocator", &requests<arena_vectors>::run},
+      {"tftl::vector + pool_allocator", &requests<pool_vectors>::run},
+      {"tftl::vector + thread_cache_allocator",
+       &requests<default_vectors<tftl::vector<int, tftl::thread_cache_allocator<int>>>>::run}
+  }});
+
+  return suite.run(options);
+}
@@ -0,0 +1,196 @@
+//
+// Created by truefinch on 09.07.18.
+//
+
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <optional> // catch.h uses std::optional without including it
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "catch.h"
+#include "concurrent_vector.hpp"
+
+namespace {
+struct throwing {
+  explicit throwing(int value) : value(value) {
+    if (value < 0) {
+      throw std::invalid_argument("negative");
+    }
+  }
+  throwing(throwing&&) noexcept = default;
+
+  int value;
+};
+
+// Fails once allocations reaches limit, and counts the blocks not yet returned
+int allocations = 0;
+int allocation_limit = 0;
+int outstanding = 0;
+
+template<typename T>
+struct limited_allocator {
+  typedef T value_type;
+
+  limited_allocator() = default;
+  template<typename U>
+  limited_allocator(const limited_allocator<U>&) noexcept {}
+
+  T* allocate(std::size_t count) {
+    if (++allocations == allocation_limit) {
+      throw std::bad_alloc();
+    }
+    ++outstanding;
+    return std::allocator<T>().allocate(count);
+  }
+  void deallocate(T* pointer, std::size_t count) noexcept {
+    --outstanding;
+    std::allocator<T>().deallocate(pointer, count);
+  }
+  bool operator==(const limited_allocator&) const noexcept { return true; }
+  bool operator!=(const limited_allocator&) const noexcept { return false; }
+};
+} // namespace
+
+TEST_CASE("Concurrent vector") {
+
+  SECTION("A failed allocation in a constructor frees the earlier segments") {
+    typedef tftl::concurrent_vector<int, limited_allocator<int>> limited_vector;
+    allocations = 0;
+    allocation_limit = 2;
+    outstanding = 0;
+    // 20 elements take the segments of 8 and of 16, the second allocation fails
+    REQUIRE_THROWS_AS(limited_vector({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20}),
+                      std::bad_alloc);
+    REQUIRE(outstanding == 0);
+
+    allocation_limit = 0;
+    limited_vector source = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20};
+    allocations = 0;
+    allocation_limit = 2;
+    REQUIRE_THROWS_AS(limited_vector(source), std::bad_alloc);
+    REQUIRE(outstanding == 2);
+    allocation_limit = 0;
+  }
+
+  SECTION("Sequential use") {
+    tftl::concurrent_vector<int> values = {1, 2, 3};
+    REQUIRE(values.size() == 3);
+    REQUIRE(values.capacity() == 8);
+    for (int i = 4; i <= 100; ++i) {
+      REQUIRE(*values.push_back(i) == i);
+    }
+    REQUIRE(values.size() == 100);
+    REQUIRE(values.front() == 1);
+    REQUIRE(values.back() == 100);
+    REQUIRE(values.at(41) == 42);
+    REQUIRE_THROWS_AS(values.at(100), std::out_of_range);
+    REQUIRE(std::accumulate(values.begin(), values.end(), 0) == 5050);
+    REQUIRE(std::equal(values.rbegin(), values.rbegin() + 3, std::vector<int>{100, 99, 98}.begin()));
+
+    tftl::concurrent_vector<int>::const_iterator first = values.begin();
+    REQUIRE(values.cend() - first == 100);
+    REQUIRE(first[7] == 8);
+    REQUIRE(*(first + 8) == 9);
+  }
+
+  SECTION("Addresses are stable") {
+    tftl::concurrent_vector<std::string> values;
+    values.push_back("first string, long enough to live on the heap");
+    const std::string* first = &values[0];
+    for (int i = 0; i < 10000; ++i) {
+      values.emplace_back(std::to_string(i));
+    }
+    REQUIRE(first == &values[0]);
+    REQUIRE(*first == "first string, long enough to live on the heap");
+    REQUIRE(values[10000] == "9999");
+  }
+
+  SECTION("Grow by") {
+    tftl::concurrent_vector<int> values;
+    values.reserve(100);
+    REQUIRE(values.capacity() >= 100);
+    auto block = values.grow_by(10, 7);
+    REQUIRE(block - values.begin() == 0);
+    REQUIRE(std::count(values.begin(), values.end(), 7) == 10);
+
+    std::vector<int> tail = {1, 2, 3};
+    auto appended = values.grow_by(tail.begin(), tail.end());
+    REQUIRE(appended.index() == 10);
+    REQUIRE(std::equal(appended, values.end(), tail.begin()));
+
+    values.grow_by(5);
+    REQUIRE(values.size() == 18);
+    REQUIRE(values.back() == 0);
+  }
+
+  SECTION("Random access algorithms") {
+    tftl::concurrent_vector<int> values;
+    for (int i = 0; i < 1000; ++i) {
+      values.push_back((i * 37) % 1000);
+    }
+    std::sort(values.begin(), values.end());
+    REQUIRE(std::is_sorted(values.begin(), values.end()));
+    REQUIRE(std::lower_bound(values.begin(), values.end(), 500) - values.begin() == 500);
+  }
+
+  SECTION("A throwing constructor leaves no hole") {
+    tftl::concurrent_vector<throwing> values;
+    values.emplace_back(1);
+    REQUIRE_THROWS_AS(values.emplace_back(-1), std::invalid_argument);
+    values.emplace_back(2);
+    REQUIRE(values.size() == 2);
+    REQUIRE(values[1].value == 2);
+  }
+
+  SECTION("Copy, move and clear") {
+    tftl::concurrent_vector<std::string> values = {"a", "b", "c"};
+    tftl::concurrent_vector<std::string> copy = values;
+    tftl::concurrent_vector<std::string> moved = std::move(values);
+    REQUIRE(values.empty());
+    REQUIRE(std::equal(copy.begin(), copy.end(), moved.begin(), moved.end()));
+    copy = moved;
+    moved.clear();
+    REQUIRE(moved.empty());
+    REQUIRE(copy.size() == 3);
+    moved.push_back("d");
+    REQUIRE(moved.front() == "d");
+  }
+
+  SECTION("Concurrent appends") {
+    const int threads = 4;
+    const int per_thread = 20000;
+    tftl::concurrent_vector<int> values;
+    std::atomic<int> misplaced{0}; // Catch assertions are not thread-safe
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+      producers.emplace_back([&values, &misplaced, t, per_thread] {
+        for (int i = 0; i < per_thread; ++i) {
+          int value = t * per_thread + i;
+          if (i % 100 == 0) {
+            values.grow_by(1, value);
+          } else {
+            if (*values.push_back(value) != value) {
+              ++misplaced;
+            }
+          }
+        }
+      });
+    }
+    for (auto& producer : producers) {
+      producer.join();
+    }
+    REQUIRE(misplaced == 0);
+    REQUIRE(values.size() == threads * per_thread);
+    std::vector<int> sorted(values.begin(), values.end());
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<int> expected(threads * per_thread);
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(sorted == expected);
+  }
+}
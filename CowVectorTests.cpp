@@ -0,0 +1,153 @@
+//
+// Created by truefinch on 20.07.18.
+//
+
+#include <numeric>
+#include <optional> // catch.h uses std::optional without including it
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "catch.h"
+#include "cow_vector.hpp"
+
+TEST_CASE("Copy-on-write vector") {
+
+  SECTION("Copies share the buffer") {
+    tftl::vector<int> source(1000);
+    std::iota(source.begin(), source.end(), 0);
+    const int* buffer = source.data();
+    tftl::cow_vector<int> values(std::move(source));
+    REQUIRE(values.data() == buffer);
+    REQUIRE(values.use_count() == 1);
+
+    tftl::cow_vector<int> copy = values;
+    REQUIRE(copy.data() == buffer);
+    REQUIRE(values.use_count() == 2);
+    REQUIRE_FALSE(copy.unique());
+    REQUIRE(copy == values);
+    REQUIRE(&copy.values() == &values.values());
+
+    REQUIRE(copy.size() == 1000);
+    REQUIRE(copy[999] == 999);
+    REQUIRE(copy.at(3) == 3);
+    REQUIRE_THROWS_AS(copy.at(1000), std::out_of_range);
+    REQUIRE(copy.front() == 0);
+    REQUIRE(copy.back() == 999);
+    REQUIRE(std::accumulate(copy.begin(), copy.end(), 0) == 999 * 500);
+    REQUIRE(*copy.rbegin() == 999);
+    REQUIRE(copy.cend() - copy.cbegin() == 1000);
+
+    // Iterators cannot write into the shared buffer
+    REQUIRE_FALSE(std::is_assignable<decltype(*copy.begin()), int>::value);
+    REQUIRE_FALSE(std::is_assignable<decltype(*copy.cbegin()), int>::value);
+    REQUIRE_FALSE(std::is_assignable<decltype(*copy.rbegin()), int>::value);
+    REQUIRE_FALSE(std::is_assignable<decltype(copy.begin()[1]), int>::value);
+  }
+
+  SECTION("The first change clones") {
+    tftl::cow_vector<std::string> words{"one", "two", "three"};
+    tftl::cow_vector<std::string> copy = words;
+    copy.set(0, "uno");
+    REQUIRE(copy[0] == "uno");
+    REQUIRE(words[0] == "one");
+    REQUIRE(words.unique());
+    REQUIRE(copy.unique());
+    REQUIRE(copy != words);
+
+    // Unique buffers are changed in place
+    copy.reserve(8);
+    const std::string* buffer = copy.data();
+    copy.set(1, "dos");
+    copy.push_back("cuatro");
+    REQUIRE(copy.size() == 4);
+    copy.pop_back();
+    REQUIRE(copy.data() == buffer);
+
+    // An element of the shared buffer may be passed
+    tftl::cow_vector<std::string> more = words;
+    more.push_back(more[2]);
+    more.insert(more.begin(), more[1]);
+    more.set(1, more[3]);
+    REQUIRE(more.size() == 5);
+    REQUIRE(more[0] == "two");
+    REQUIRE(more[1] == "three");
+    REQUIRE(more[4] == "three");
+    REQUIRE(words.size() == 3);
+
+    tftl::cow_vector<std::string> erased = words;
+    REQUIRE(*erased.erase(erased.begin()) == "two");
+    REQUIRE(erased.size() == 2);
+    REQUIRE(words.size() == 3);
+    erased.emplace_back(3, 'x');
+    REQUIRE(erased.back() == "xxx");
+  }
+
+  SECTION("unshare hands out the vector") {
+    tftl::cow_vector<int> values{1, 2, 3};
+    tftl::cow_vector<int> copy = values;
+    tftl::vector<int>& owned = copy.unshare();
+    owned.push_back(4);
+    owned[0] = 0;
+    REQUIRE(copy.size() == 4);
+    REQUIRE(copy[0] == 0);
+    REQUIRE(values[0] == 1);
+    REQUIRE(&copy.unshare() == &owned);
+
+    copy.resize(10);
+    copy.reserve(100);
+    REQUIRE(copy.capacity() >= 100);
+    copy.shrink_to_fit();
+    REQUIRE(copy.capacity() == 10);
+  }
+
+  SECTION("Empty vectors have no buffer") {
+    tftl::cow_vector<int> values;
+    REQUIRE(values.empty());
+    REQUIRE(values.use_count() == 0);
+    REQUIRE(values.begin() == values.end());
+    values.push_back(1);
+    REQUIRE(values.size() == 1);
+
+    tftl::cow_vector<int> copy = values;
+    copy.clear();
+    REQUIRE(copy.empty());
+    REQUIRE(values.size() == 1);
+    REQUIRE(values.unique());
+
+    tftl::cow_vector<int> moved = std::move(values);
+    REQUIRE(values.empty());
+    REQUIRE(moved[0] == 1);
+    swap(moved, values);
+    REQUIRE(values[0] == 1);
+  }
+
+  SECTION("Copies are handed to other threads") {
+    tftl::vector<long long> source(10000);
+    std::iota(source.begin(), source.end(), 0);
+    tftl::cow_vector<long long> shared(std::move(source));
+
+    std::vector<std::thread> readers;
+    std::vector<long long> totals(8);
+    for (std::size_t i = 0; i < totals.size(); ++i) {
+      readers.emplace_back([snapshot = shared, &total = totals[i]]() mutable {
+        for (int round = 0; round < 100; ++round) {
+          tftl::cow_vector<long long> copy = snapshot;
+          total = std::accumulate(copy.begin(), copy.end(), 0LL);
+        }
+        snapshot.set(0, -1); // clones, the others keep reading the original
+      });
+    }
+    shared.set(1, 0);
+    for (std::thread& reader : readers) {
+      reader.join();
+    }
+    for (long long total : totals) {
+      REQUIRE(total == 9999LL * 10000 / 2);
+    }
+    REQUIRE(shared[0] == 0);
+    REQUIRE(shared[1] == 0);
+    REQUIRE(shared.unique());
+  }
+}
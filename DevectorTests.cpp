@@ -0,0 +1,295 @@
+//
+// Created by truefinch on 21.07.18.
+//
+
+#include <algorithm>
+#include <deque>
+#include <numeric>
+#include <optional> // catch.h uses std::optional without including it
+#include <string>
+#include <vector>
+
+#include "catch.h"
+#include "devector.hpp"
+
+namespace {
+// Counts the live instances, so leaked or doubly destroyed elements show up
+struct Counted {
+  static int alive;
+  int value;
+
+  Counted(int value = 0) : value(value) { ++alive; }
+  Counted(const Counted& other) : value(other.value) { ++alive; }
+  Counted(Counted&& other) noexcept : value(other.value) { ++alive; }
+  Counted& operator=(const Counted&) = default;
+  Counted& operator=(Counted&&) noexcept = default;
+  ~Counted() { --alive; }
+};
+int Counted::alive = 0;
+
+template<typename Container>
+std::string joined(const Container& values) {
+  return std::accumulate(values.begin(), values.end(), std::string());
+}
+} // namespace
+
+TEST_CASE("Double ended vector") {
+
+  SECTION("push_front and pop_front") {
+    tftl::devector<int> values;
+    for (int i = 0; i < 1000; ++i) {
+      values.push_front(i);
+    }
+    REQUIRE(values.size() == 1000);
+    REQUIRE(values.front() == 999);
+    REQUIRE(values.back() == 0);
+    for (int i = 0; i < 1000; ++i) {
+      REQUIRE(values[i] == 999 - i);
+    }
+    REQUIRE(std::is_sorted(values.rbegin(), values.rend()));
+    REQUIRE(values.at(999) == 0);
+    REQUIRE_THROWS_AS(values.at(1000), std::out_of_range);
+
+    values.emplace_front(1000);
+    values.emplace_back(-1);
+    REQUIRE(values.front() == 1000);
+    REQUIRE(values.back() == -1);
+    values.pop_front();
+    values.pop_back();
+    while (values.size() > 1) {
+      values.pop_front();
+    }
+    REQUIRE(values.front() == 0);
+    values.pop_back();
+    REQUIRE(values.empty());
+    // Emptied devectors start again from the middle
+    REQUIRE(values.front_free_capacity() == values.capacity() / 2);
+  }
+
+  SECTION("Pushes on one end reallocate a logarithmic number of times") {
+    tftl::devector<int> values;
+    std::size_t reallocations = 0;
+    const int* buffer = nullptr;
+    for (int i = 0; i < 100000; ++i) {
+      values.push_front(i);
+      if (values.data() + values.size() != buffer) {
+        ++reallocations;
+      }
+      buffer = values.data() + values.size();
+    }
+    REQUIRE(reallocations < 40);
+  }
+
+  SECTION("A sliding window keeps its capacity") {
+    tftl::devector<std::string> window;
+    for (int i = 0; i < 16; ++i) {
+      window.push_back(std::to_string(i));
+    }
+    std::size_t capacity = 0;
+    for (int i = 16; i < 10000; ++i) {
+      window.push_back(std::to_string(i));
+      window.pop_front();
+      if (i == 1000) {
+        capacity = window.capacity();
+      }
+    }
+    REQUIRE(window.size() == 16);
+    REQUIRE(window.front() == "9984");
+    REQUIRE(window.back() == "9999");
+    REQUIRE(window.capacity() == capacity);
+
+    tftl::devector<int> numbers(16, 7);
+    for (int i = 0; i < 10000; ++i) {
+      numbers.push_front(i);
+      numbers.pop_back();
+      if (i == 1000) {
+        capacity = numbers.capacity();
+      }
+    }
+    REQUIRE(numbers.capacity() == capacity);
+    REQUIRE(numbers.front() == 9999);
+  }
+
+  SECTION("Inserts and erases shift the shorter side") {
+    tftl::devector<int> values(100);
+    std::iota(values.begin(), values.end(), 0);
+    values.reserve_front(10);
+    values.reserve_back(10);
+    const int* first = &values.front();
+    const int* last = &values.back();
+
+    values.insert(values.begin() + 10, -1);
+    REQUIRE(&values.front() == first - 1);
+    REQUIRE(&values.back() == last);
+    values.insert(values.end() - 10, -2);
+    REQUIRE(&values.front() == first - 1);
+    REQUIRE(&values.back() == last + 1);
+    REQUIRE(values.size() == 102);
+    REQUIRE(values[10] == -1);
+    REQUIRE(values[9] == 9);
+    REQUIRE(values[11] == 10);
+    REQUIRE(values[91] == -2);
+    REQUIRE(values[92] == 90);
+
+    REQUIRE(*values.erase(values.begin() + 10) == 10);
+    REQUIRE(&values.front() == first);
+    REQUIRE(*values.erase(values.begin() + 90, values.begin() + 92) == 91);
+    REQUIRE(&values.back() == last - 1);
+    REQUIRE(values.size() == 99);
+
+    values.insert(values.begin(), -3);
+    values.insert(values.end(), -4);
+    REQUIRE(values.front() == -3);
+    REQUIRE(values.back() == -4);
+  }
+
+  SECTION("Elements of the devector itself may be inserted") {
+    tftl::devector<std::string> words{"a", "b", "c", "d"};
+    words.shrink_to_fit();
+    REQUIRE(words.capacity() == 4);
+    words.push_front(words.back());
+    words.push_back(words.front());
+    words.insert(words.begin() + 2, words[1]);
+    words.insert(words.end() - 2, words[0]);
+    REQUIRE(joined(words) == "daabcddd");
+    words.emplace(words.begin() + 1, 3, 'x');
+    REQUIRE(words[1] == "xxx");
+    words.resize(10, words[0]);
+    REQUIRE(joined(words) == "dxxxaabcdddd");
+    words.resize(2);
+    REQUIRE(joined(words) == "dxxx");
+  }
+
+  SECTION("Copies, moves and comparison") {
+    Counted::alive = 0;
+    {
+      tftl::devector<Counted> values;
+      for (int i = 0; i < 100; ++i) {
+        values.push_front(Counted(i));
+        values.push_back(Counted(-i));
+      }
+      values.insert(values.begin() + 50, Counted(1000));
+      values.insert(values.begin() + 150, Counted(1001));
+      values.erase(values.begin() + 20, values.begin() + 30);
+      values.erase(values.begin() + 170, values.begin() + 180);
+      REQUIRE(Counted::alive == 182);
+
+      tftl::devector<Counted> copy = values;
+      REQUIRE(copy.capacity() == copy.size());
+      REQUIRE(std::equal(copy.begin(), copy.end(), values.begin(),
+                         [](const Counted& lhs, const Counted& rhs) { return lhs.value == rhs.value; }));
+      tftl::devector<Counted> moved = std::move(values);
+      REQUIRE(values.empty());
+      values = copy;
+      swap(values, moved);
+      REQUIRE(values.size() == 182);
+      copy.clear();
+      REQUIRE(copy.empty());
+    }
+    REQUIRE(Counted::alive == 0);
+
+    tftl::devector<int> lhs{1, 2, 3};
+    tftl::devector<int> rhs;
+    rhs.push_front(3);
+    rhs.push_front(2);
+    rhs.push_front(1);
+    REQUIRE(lhs == rhs);
+    rhs.pop_front();
+    REQUIRE(lhs != rhs);
+  }
+}
+
+TEST_CASE("Gap buffer") {
+
+  SECTION("Editing at the cursor") {
+    tftl::gap_buffer<char> text;
+    std::string hello = "hello world";
+    text.insert(hello.begin(), hello.end());
+    REQUIRE(text.size() == 11);
+    REQUIRE(text.cursor() == 11);
+
+    text.move_cursor(5);
+    text.insert(',');
+    REQUIRE(text.cursor() == 6);
+    REQUIRE(std::string(text.begin(), text.end()) == "hello, world");
+
+    text.move_cursor(0);
+    text.erase_after();
+    text.insert('H');
+    text.move_cursor(text.size());
+    text.erase_before(5);
+    std::string there = "there!";
+    text.insert(there.begin(), there.end());
+    REQUIRE(std::string(text.begin(), text.end()) == "Hello, there!");
+    REQUIRE(text[7] == 't');
+    REQUIRE(text.at(0) == 'H');
+    REQUIRE_THROWS_AS(text.at(13), std::out_of_range);
+    REQUIRE_THROWS_AS(text.move_cursor(14), std::out_of_range);
+
+    text.move_cursor(3);
+    REQUIRE(text.end() - text.begin() == 13);
+    REQUIRE(std::string(text.begin() + 2, text.begin() + 9) == "llo, th");
+    std::reverse(text.begin(), text.end());
+    REQUIRE(std::string(text.begin(), text.end()) == "!ereht ,olleH");
+  }
+
+  SECTION("Cursor moves keep non relocatable elements") {
+    Counted::alive = 0;
+    {
+      tftl::gap_buffer<std::string> lines;
+      for (int i = 0; i < 100; ++i) {
+        lines.emplace(std::to_string(i));
+      }
+      lines.move_cursor(50);
+      lines.insert(lines[10]);
+      lines.move_cursor(90);
+      lines.insert("x");
+      REQUIRE(lines.size() == 102);
+      REQUIRE(lines[50] == "10");
+      REQUIRE(lines[51] == "50");
+      REQUIRE(lines[90] == "x");
+      REQUIRE(lines[101] == "99");
+
+      tftl::gap_buffer<std::string> copy = lines;
+      REQUIRE(copy.cursor() == lines.cursor());
+      REQUIRE(std::equal(copy.begin(), copy.end(), lines.begin()));
+      copy.move_cursor(0);
+      copy.erase_after(100);
+      REQUIRE(copy.size() == 2);
+      REQUIRE(copy[1] == "99");
+
+      tftl::gap_buffer<Counted> counted;
+      for (int i = 0; i < 64; ++i) {
+        counted.emplace(i);
+        counted.move_cursor(i / 2);
+      }
+      counted.erase_before(10);
+      REQUIRE(Counted::alive == 54);
+      tftl::gap_buffer<Counted> moved = std::move(counted);
+      REQUIRE(counted.empty());
+      REQUIRE(moved.size() == 54);
+    }
+    REQUIRE(Counted::alive == 0);
+  }
+
+  SECTION("The cursor moves through a full buffer") {
+    // Long strings own heap memory, moving one onto itself would lose it
+    std::vector<std::string> expected;
+    for (int i = 0; i < 10; ++i) {
+      expected.push_back(std::string(40, static_cast<char>('a' + i)));
+    }
+    tftl::gap_buffer<std::string> lines;
+    lines.reserve(10);
+    lines.insert(expected.begin(), expected.end());
+    REQUIRE(lines.size() == lines.capacity());
+
+    lines.move_cursor(0);
+    REQUIRE(lines.cursor() == 0);
+    REQUIRE(std::equal(lines.begin(), lines.end(), expected.begin()));
+    lines.move_cursor(10);
+    REQUIRE(std::equal(lines.begin(), lines.end(), expected.begin()));
+    lines.move_cursor(4);
+    REQUIRE(lines[4] == expected[4]);
+    REQUIRE(std::equal(lines.begin(), lines.end(), expected.begin()));
+  }
+}
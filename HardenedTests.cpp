@@ -0,0 +1,82 @@
+//
+// Created by truefinch on 18.07.18.
+//
+
+#include <optional> // catch.h uses std::optional without including it
+#include <string>
+#include <utility>
+
+#include "catch.h"
+#include "vector.hpp"
+
+#if defined(TFTL_HARDENED)
+
+TEST_CASE("Hardened mode") {
+
+  SECTION("Iterators of a reallocated buffer are stale") {
+    tftl::vector<int> values{1, 2, 3};
+    tftl::vector<int>::iterator first = values.begin();
+    REQUIRE(*first == 1);
+    values.shrink_to_fit();
+    values.push_back(4);
+    REQUIRE_THROWS_AS(*first, tftl::hardening_error);
+    REQUIRE_THROWS_AS(first[1], tftl::hardening_error);
+    REQUIRE_NOTHROW(*values.begin());
+
+    tftl::vector<std::string>::iterator word;
+    {
+      tftl::vector<std::string> words{"one", "two"};
+      word = words.begin();
+      REQUIRE(word->size() == 3);
+      words.clear();
+      REQUIRE_THROWS_AS(word->size(), tftl::hardening_error);
+      words.emplace_back("three");
+      word = words.begin();
+    }
+    REQUIRE_THROWS_AS(*word, tftl::hardening_error);
+  }
+
+  SECTION("Iterators survive a move and a swap") {
+    tftl::vector<int> values{1, 2, 3};
+    tftl::vector<int>::iterator second = values.begin() + 1;
+    tftl::vector<int> moved = std::move(values);
+    REQUIRE(*second == 2);
+
+    tftl::vector<int> other{4, 5};
+    other.swap(moved);
+    REQUIRE(*second == 2);
+    REQUIRE(other.erase(second) == other.begin() + 1);
+    REQUIRE(other.size() == 2);
+
+    tftl::vector<int> assigned;
+    assigned = std::move(other);
+    REQUIRE(assigned[1] == 3);
+  }
+
+  SECTION("Indices and positions are checked") {
+    tftl::vector<int> values{1, 2, 3};
+    tftl::vector<int> other{1, 2, 3};
+    REQUIRE_THROWS_AS(values[3], tftl::hardening_error);
+    REQUIRE_THROWS_AS(values.insert(other.begin(), 0), tftl::hardening_error);
+    REQUIRE_THROWS_AS(values.insert(values.end() + 1, 0), tftl::hardening_error);
+    REQUIRE_THROWS_AS(values.erase(values.end()), tftl::hardening_error);
+    REQUIRE_THROWS_AS(values.erase(values.begin() + 2, values.begin() + 1), tftl::hardening_error);
+    REQUIRE(values.size() == 3);
+
+    values.insert(values.end(), 4);
+    values.erase(values.begin(), values.end());
+    REQUIRE(values.empty());
+    REQUIRE_THROWS_AS(values.front(), tftl::hardening_error);
+    REQUIRE_THROWS_AS(values.back(), tftl::hardening_error);
+    REQUIRE_THROWS_AS(values.pop_back(), tftl::hardening_error);
+  }
+}
+
+#else
+
+TEST_CASE("Hardened mode") {
+  // Without TFTL_HARDENED the checks cost nothing, not even space
+  REQUIRE(sizeof(tftl::vector<int>::iterator) == sizeof(int*));
+}
+
+#endif
@@ -0,0 +1,170 @@
+//
+// Created by truefinch on 11.07.18.
+//
+
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <optional> // catch.h uses std::optional without including it
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "catch.h"
+#include "mapped_vector.hpp"
+
+namespace {
+struct record {
+  int key;
+  double value;
+};
+
+// A file name unique to this process, removed when the test is done with it
+struct temp_file {
+  temp_file() : path("/tmp/tftl_mapped_vector_" + std::to_string(::getpid())) {
+    std::remove(this->path.c_str());
+  }
+  ~temp_file() {
+    std::remove(this->path.c_str());
+  }
+
+  long long length() const {
+    struct stat status;
+    return ::stat(this->path.c_str(), &status) == 0 ? static_cast<long long>(status.st_size) : -1;
+  }
+
+  std::string path;
+};
+} // namespace
+
+TEST_CASE("Mapped vector") {
+  temp_file file;
+
+  SECTION("Appended elements are in the file after close") {
+    {
+      tftl::mapped_vector<int> values(file.path, tftl::map_mode::read_write);
+      REQUIRE(values.is_open());
+      REQUIRE(values.empty());
+      for (int i = 0; i < 10000; ++i) {
+        values.push_back(i);
+      }
+      REQUIRE(values.size() == 10000);
+      REQUIRE(values.capacity() >= 10000);
+      REQUIRE(file.length() == static_cast<long long>(values.capacity() * sizeof(int)));
+    }
+    REQUIRE(file.length() == static_cast<long long>(10000 * sizeof(int)));
+
+    tftl::mapped_vector<int> values(file.path);
+    REQUIRE(values.mode() == tftl::map_mode::read_only);
+    REQUIRE(values.size() == 10000);
+    std::vector<int> expected(10000);
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(std::equal(values.begin(), values.end(), expected.begin(), expected.end()));
+    REQUIRE(std::equal(values.rbegin(), values.rend(), expected.rbegin(), expected.rend()));
+    REQUIRE(values.front() == 0);
+    REQUIRE(values.back() == 9999);
+    REQUIRE(values.at(1234) == 1234);
+    REQUIRE_THROWS_AS(values.at(10000), std::out_of_range);
+    REQUIRE_THROWS_AS(values.push_back(1), std::logic_error);
+  }
+
+  SECTION("Modifiers") {
+    tftl::mapped_vector<record> records(file.path, tftl::map_mode::read_write);
+    records.emplace_back(record{1, 0.5});
+    records.resize(5, record{7, 2.0});
+    REQUIRE(records.size() == 5);
+    REQUIRE(records[4].key == 7);
+    records.pop_back();
+    REQUIRE(records.size() == 4);
+
+    // Appending a range of the vector itself must survive the mapping moving
+    records.append_range(std::vector<record>(records.begin(), records.end()));
+    for (int i = 0; i < 6; ++i) {
+      records.append_range(records);
+    }
+    REQUIRE(records.size() == 4 * 2 * 64);
+    REQUIRE(records[256].key == 1);
+    REQUIRE(records[257].key == 7);
+    REQUIRE(records.back().value == 2.0);
+
+    records.resize(3);
+    records.shrink_to_fit();
+    REQUIRE(records.capacity() == 3);
+    REQUIRE(file.length() == static_cast<long long>(3 * sizeof(record)));
+    records.sync();
+    records.sync(false);
+
+    records.clear();
+    records.shrink_to_fit();
+    REQUIRE(records.data() == nullptr);
+    records.push_back(record{9, 9.0});
+    REQUIRE(records.front().key == 9);
+  }
+
+  SECTION("Copy on write changes are private") {
+    {
+      tftl::mapped_vector<int> values(file.path, tftl::map_mode::read_write);
+      values.resize(4096, 1);
+    }
+    tftl::mapped_vector<int> shared(file.path);
+    tftl::mapped_vector<int> copy(file.path, tftl::map_mode::copy_on_write);
+    copy[0] = 2;
+    std::fill(copy.begin() + 2048, copy.end(), 3);
+    REQUIRE(copy[0] == 2);
+    REQUIRE(copy[4095] == 3);
+    REQUIRE(shared[0] == 1);
+    REQUIRE(shared[4095] == 1);
+    REQUIRE_THROWS_AS(copy.reserve(8192), std::logic_error);
+    copy.close();
+
+    tftl::mapped_vector<int> reopened(file.path);
+    REQUIRE(std::all_of(reopened.begin(), reopened.end(), [](int value) { return value == 1; }));
+  }
+
+  SECTION("Read write mappings are shared") {
+    tftl::mapped_vector<int> writer(file.path, tftl::map_mode::read_write);
+    writer.resize(100, 5);
+    writer.shrink_to_fit();
+    tftl::mapped_vector<int> reader(file.path);
+    REQUIRE(reader.size() == 100);
+    writer[50] = 42;
+    REQUIRE(reader[50] == 42);
+  }
+
+  SECTION("Advice") {
+    tftl::mapped_vector<double> values(file.path, tftl::map_mode::read_write);
+    values.resize(100000, 1.5);
+    values.advise(tftl::access_advice::sequential);
+    values.advise(tftl::access_advice::will_need, 5000, 1000);
+    values.advise(tftl::access_advice::random, 99999, 100);
+    values.advise(tftl::access_advice::normal);
+    REQUIRE_THROWS_AS(values.advise(tftl::access_advice::normal, 100001, 1), std::out_of_range);
+    REQUIRE(values[77777] == 1.5);
+  }
+
+  SECTION("Move and swap") {
+    tftl::mapped_vector<int> first(file.path, tftl::map_mode::read_write);
+    first.push_back(1);
+    tftl::mapped_vector<int> second(std::move(first));
+    REQUIRE_FALSE(first.is_open());
+    REQUIRE(second.size() == 1);
+    first = std::move(second);
+    REQUIRE(first[0] == 1);
+    first.swap(second);
+    REQUIRE(second.back() == 1);
+    REQUIRE(first.empty());
+  }
+
+  SECTION("Errors") {
+    REQUIRE_THROWS_AS(tftl::mapped_vector<int>("/nonexistent/tftl/file"), std::system_error);
+    {
+      tftl::mapped_vector<char> bytes(file.path, tftl::map_mode::read_write);
+      bytes.resize(7);
+    }
+    REQUIRE_THROWS_AS(tftl::mapped_vector<int>(file.path), std::invalid_argument);
+  }
+}
@@ -0,0 +1,310 @@
+//
+// Created by truefinch on 04.07.18.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <string>
+
+#include "bench.hpp"
+#include "numeric.hpp"
+
+namespace {
+using tftl::bench::state;
+using tftl::bench::do_not_optimize;
+using tftl::numeric::summation;
+
+template<typename T>
+tftl::vector<T> make(std::size_t count, std::size_t seed) {
+  tftl::vector<T> values;
+  values.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    values.push_back(static_cast<T>((i * 2654435761u + seed) % 1000) / 10);
+  }
+  return values;
+}
+
+// Plain loops as a compiler at -O2 sees them, without -ffast-math floating point sums stay scalar
+template<typename T>
+struct naive {
+  static tftl::numeric::accumulator_t<T> sum(const tftl::vector<T>& values) {
+    tftl::numeric::accumulator_t<T> total = 0;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      total += values[i];
+    }
+    return total;
+  }
+
+  static T dot(const tftl::vector<T>& lhs, const tftl::vector<T>& rhs) {
+    T total = 0;
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+      total += lhs[i] * rhs[i];
+    }
+    return total;
+  }
+
+  static T min(const tftl::vector<T>& values) {
+    T result = values[0];
+    for (std::size_t i = 1; i < values.size(); ++i) {
+      result = values[i] < result ? values[i] : result;
+    }
+    return result;
+  }
+
+  static std::size_t argmax(const tftl::vector<T>& values) {
+    std::size_t result = 0;
+    for (std::size_t i = 1; i < values.size(); ++i) {
+      if (values[result] < values[i]) {
+        result = i;
+      }
+    }
+    return result;
+  }
+
+  static void axpy(T factor, const tftl::vector<T>& x, tftl::vector<T>& y) {
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      y[i] += factor * x[i];
+    }
+  }
+
+  static void clamp(tftl::vector<T>& values, T low, T high) {
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      values[i] = std::clamp(values[i], low, high);
+    }
+  }
+};
+
+template<typename T>
+struct sum_naive {
+  static void run(state& state) {
+    tftl::vector<T> values = make<T>(state.elements(), 1);
+    while (state.keep_running()) {
+      auto total = naive<T>::sum(values);
+      do_not_optimize(total);
+    }
+  }
+};
+
+template<typename T>
+struct sum_accumulate {
+  static void run(state& state) {
+    tftl::vector<T> values = make<T>(state.elements(), 1);
+    while (state.keep_running()) {
+      auto total = std::accumulate(values.begin(), values.end(), tftl::numeric::accumulator_t<T>(0));
+      do_not_optimize(total);
+    }
+  }
+};
+
+template<typename T, summation Mode>
+struct sum_numeric {
+  static void run(state& state) {
+    tftl::vector<T> values = make<T>(state.elements(), 1);
+    while (state.keep_running()) {
+      auto total = tftl::numeric::sum(values, Mode);
+      do_not_optimize(total);
+    }
+  }
+};
+
+template<typename T>
+struct dot_naive {
+  static void run(state& state) {
+    tftl::vector<T> lhs = make<T>(state.elements(), 1);
+    tftl::vector<T> rhs = make<T>(state.elements(), 2);
+    while (state.keep_running()) {
+      T total = naive<T>::dot(lhs, rhs);
+      do_not_optimize(total);
+    }
+  }
+};
+
+template<typename T>
+struct dot_inner_product {
+  static void run(state& state) {
+    tftl::vector<T> lhs = make<T>(state.elements(), 1);
+    tftl::vector<T> rhs = make<T>(state.elements(), 2);
+    while (state.keep_running()) {
+      T total = std::inner_product(lhs.begin(), lhs.end(), rhs.begin(), T(0));
+      do_not_optimize(total);
+    }
+  }
+};
+
+template<typename T, summation Mode>
+struct dot_numeric {
+  static void run(state& state) {
+    tftl::vector<T> lhs = make<T>(state.elements(), 1);
+    tftl::vector<T> rhs = make<T>(state.elements(), 2);
+    while (state.keep_running()) {
+      T total = tftl::numeric::dot(lhs, rhs, Mode);
+      do_not_optimize(total);
+    }
+  }
+};
+
+template<typename T>
+struct min_naive {
+  static void run(state& state) {
+    tftl::vector<T> values = make<T>(state.elements(), 1);
+    while (state.keep_running()) {
+      T result = naive<T>::min(values);
+      do_not_optimize(result);
+    }
+  }
+};
+
+template<typename T>
+struct min_element {
+  static void run(state& state) {
+    tftl::vector<T> values = make<T>(state.elements(), 1);
+    while (state.keep_running()) {
+      T result = *std::min_element(values.begin(), values.end());
+      do_not_optimize(result);
+    }
+  }
+};
+
+template<typename T>
+struct min_numeric {
+  static void run(state& state) {
+    tftl::vector<T> values = make<T>(state.elements(), 1);
+    while (state.keep_running()) {
+      T result = tftl::numeric::min(values);
+      do_not_optimize(result);
+    }
+  }
+};
+
+template<typename T>
+struct argmax_naive {
+  static void run(state& state) {
+    tftl::vector<T> values = make<T>(state.elements(), 1);
+    while (state.keep_running()) {
+      std::size_t result = naive<T>::argmax(values);
+      do_not_optimize(result);
+    }
+  }
+};
+
+template<typename T>
+struct argmax_numeric {
+  static void run(state& state) {
+    tftl::vector<T> values = make<T>(state.elements(), 1);
+    while (state.keep_running()) {
+      std::size_t result = tftl::numeric::argmax(values);
+      do_not_optimize(result);
+    }
+  }
+};
+
+template<typename T>
+struct axpy_naive {
+  static void run(state& state) {
+    tftl::vector<T> x = make<T>(state.elements(), 1);
+    tftl::vector<T> y = make<T>(state.elements(), 2);
+    while (state.keep_running()) {
+      naive<T>::axpy(T(1), x, y);
+      do_not_optimize(y);
+    }
+  }
+};
+
+template<typename T>
+struct axpy_numeric {
+  static void run(state& state) {
+    tftl::vector<T> x = make<T>(state.elements(), 1);
+    tftl::vector<T> y = make<T>(state.elements(), 2);
+    while (state.keep_running()) {
+      tftl::numeric::axpy(T(1), x, y);
+      do_not_optimize(y);
+    }
+  }
+};
+
+template<typename T>
+struct clamp_naive {
+  static void run(state& state) {
+    tftl::vector<T> values = make<T>(state.elements(), 1);
+    while (state.keep_running()) {
+      naive<T>::clamp(values, T(10), T(90));
+      do_not_optimize(values);
+    }
+  }
+};
+
+template<typename T>
+struct clamp_numeric {
+  static void run(state& state) {
+    tftl::vector<T> values = make<T>(state.elements(), 1);
+    while (state.keep_running()) {
+      tftl::numeric::clamp(values, T(10), T(90));
+      do_not_optimize(values);
+    }
+  }
+};
+
+template<typename T>
+void add_kernels(tftl::bench::suite& suite, const char* type, std::size_t elements) {
+  std::string level = tftl::simd::name(tftl::simd::detect());
+  for (std::size_t size : {std::size_t(4096), elements}) {
+    std::string suffix = std::string("/") + type + "/" + std::to_string(size);
+    if constexpr (std::is_floating_point<T>::value) {
+      suite.add({"sum" + suffix, size, 0, {
+          {"naive loop", &sum_naive<T>::run},
+          {"std::accumulate", &sum_accumulate<T>::run},
+          {"tftl::numeric::sum " + level, &sum_numeric<T, summation::fast>::run},
+          {"tftl::numeric::sum deterministic", &sum_numeric<T, summation::deterministic>::run},
+          {"tftl::numeric::sum compensated", &sum_numeric<T, summation::compensated>::run}
+      }});
+      suite.add({"dot" + suffix, size, 0, {
+          {"naive loop", &dot_naive<T>::run},
+          {"std::inner_product", &dot_inner_product<T>::run},
+          {"tftl::numeric::dot " + level, &dot_numeric<T, summation::fast>::run},
+          {"tftl::numeric::dot deterministic", &dot_numeric<T, summation::deterministic>::run},
+          {"tftl::numeric::dot compensated", &dot_numeric<T, summation::compensated>::run}
+      }});
+    } else {
+      suite.add({"sum" + suffix, size, 0, {
+          {"naive loop", &sum_naive<T>::run},
+          {"std::accumulate", &sum_accumulate<T>::run},
+          {"tftl::numeric::sum " + level, &sum_numeric<T, summation::fast>::run}
+      }});
+      suite.add({"dot" + suffix, size, 0, {
+          {"naive loop", &dot_naive<T>::run},
+          {"std::inner_product", &dot_inner_product<T>::run},
+          {"tftl::numeric::dot " + level, &dot_numeric<T, summation::fast>::run}
+      }});
+    }
+    suite.add({"min" + suffix, size, 0, {
+        {"naive loop", &min_naive<T>::run},
+        {"std::min_element", &min_element<T>::run},
+        {"tftl::numeric::min " + level, &min_numeric<T>::run}
+    }});
+    suite.add({"argmax" + suffix, size, 0, {
+        {"naive loop", &argmax_naive<T>::run},
+        {"tftl::numeric::argmax " + level, &argmax_numeric<T>::run}
+    }});
+    suite.add({"axpy" + suffix, size, 0, {
+        {"naive loop", &axpy_naive<T>::run},
+        {"tftl::numeric::axpy " + level, &axpy_numeric<T>::run}
+    }});
+    suite.add({"clamp" + suffix, size, 0, {
+        {"naive loop", &clamp_naive<T>::run},
+        {"tftl::numeric::clamp " + level, &clamp_numeric<T>::run}
+    }});
+  }
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  tftl::bench::options options = tftl::bench::parse(argc, argv);
+  tftl::bench::suite suite;
+
+  add_kernels<int>(suite, "int", options.elements);
+  add_kernels<float>(suite, "float", options.elements);
+  add_kernels<double>(suite, "double", options.elements);
+
+  return suite.run(options);
+}
@@ -0,0 +1,194 @@
+//
+// Created by truefinch on 04.07.18.
+//
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <optional> // catch.h uses std::optional without including it
+#include <stdexcept>
+
+#include "catch.h"
+#include "numeric.hpp"
+
+namespace {
+const std::size_t sizes[] = {0, 1, 3, 15, 16, 17, 63, 64, 65, 200, 1001};
+
+template<typename T>
+tftl::vector<T> make(std::size_t size, std::size_t seed) {
+  tftl::vector<T> values;
+  for (std::size_t i = 0; i < size; ++i) {
+    values.push_back(static_cast<T>(static_cast<long long>((i * 37 + seed) % 101) - 50));
+  }
+  return values;
+}
+
+template<typename T>
+bool same_bits(T lhs, T rhs) {
+  return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+}
+
+// Small integral values keep every floating point result exact, so all levels must agree with a plain loop
+template<typename T>
+void check_kernels() {
+  using namespace tftl::numeric;
+  for (int level = 0; level <= static_cast<int>(tftl::simd::detect()); ++level) {
+    auto isa = static_cast<tftl::simd::isa>(level);
+    for (std::size_t size : sizes) {
+      tftl::vector<T> x = make<T>(size, 3);
+      tftl::vector<T> y = make<T>(size, 11);
+      const T* left = x.data();
+      const T* right = y.data();
+
+      accumulator_t<T> total = detail::run(isa, [=]() __attribute__((always_inline)) {
+        return detail::sum_kernel<T, accumulator_t<T>>(left, size);
+      });
+      REQUIRE(total == std::accumulate(x.begin(), x.end(), accumulator_t<T>(0)));
+
+      T product = detail::run(isa, [=]() __attribute__((always_inline)) {
+        return detail::dot_kernel<T>(left, right, size);
+      });
+      REQUIRE(product == std::inner_product(x.begin(), x.end(), y.begin(), T(0)));
+
+      if (size > 0) {
+        T smallest = detail::run(isa, [=]() __attribute__((always_inline)) {
+          return detail::extremum_kernel<false, T>(left, size);
+        });
+        T largest = detail::run(isa, [=]() __attribute__((always_inline)) {
+          return detail::extremum_kernel<true, T>(left, size);
+        });
+        REQUIRE(smallest == *std::min_element(x.begin(), x.end()));
+        REQUIRE(largest == *std::max_element(x.begin(), x.end()));
+      }
+
+      T low = std::is_signed<T>::value ? T(-20) : T(10);
+      tftl::vector<T> expected = y;
+      for (std::size_t i = 0; i < size; ++i) {
+        expected[i] = std::clamp(static_cast<T>(expected[i] + 2 * x[i]), low, T(20));
+      }
+      T* target = y.data();
+      detail::run(isa, [=]() __attribute__((always_inline)) {
+        detail::axpy_kernel<T>(2, left, target, size);
+        detail::clamp_kernel<T>(low, 20, target, size);
+      });
+      REQUIRE(y == expected);
+    }
+  }
+}
+
+template<typename T>
+void check_determinism() {
+  using namespace tftl::numeric;
+  tftl::vector<T> x;
+  tftl::vector<T> y;
+  for (std::size_t i = 0; i < 1001; ++i) {
+    x.push_back(std::sin(static_cast<T>(i)) * 1e4);
+    y.push_back(std::cos(static_cast<T>(i)) / 3);
+  }
+  const T* left = x.data();
+  const T* right = y.data();
+  auto last = std::min(tftl::simd::detect(), tftl::simd::isa::avx2);
+
+  T total = detail::run(tftl::simd::isa::generic, [=]() __attribute__((always_inline)) {
+    return detail::sum_kernel<T, T>(left, x.size());
+  });
+  T product = detail::run(tftl::simd::isa::generic, [=]() __attribute__((always_inline)) {
+    return detail::dot_kernel<T>(left, right, x.size());
+  });
+  T compensated = detail::run(tftl::simd::isa::generic, [=]() __attribute__((always_inline)) {
+    return detail::compensated_kernel<T>(left, right, x.size());
+  });
+  for (int level = 1; level <= static_cast<int>(last); ++level) {
+    auto isa = static_cast<tftl::simd::isa>(level);
+    REQUIRE(same_bits(total, detail::run(isa, [=]() __attribute__((always_inline)) {
+      return detail::sum_kernel<T, T>(left, x.size());
+    })));
+    REQUIRE(same_bits(product, detail::run(isa, [=]() __attribute__((always_inline)) {
+      return detail::dot_kernel<T>(left, right, x.size());
+    })));
+    REQUIRE(same_bits(compensated, detail::run(isa, [=]() __attribute__((always_inline)) {
+      return detail::compensated_kernel<T>(left, right, x.size());
+    })));
+  }
+  REQUIRE(same_bits(tftl::numeric::dot(x, y, summation::deterministic), product));
+  REQUIRE(same_bits(tftl::numeric::dot(x, y, summation::compensated), compensated));
+}
+} // namespace
+
+TEST_CASE("Numeric kernels") {
+
+  SECTION("Kernels agree with plain loops on every level") {
+    check_kernels<int>();
+    check_kernels<unsigned>();
+    check_kernels<long long>();
+    check_kernels<float>();
+    check_kernels<double>();
+  }
+
+  SECTION("Deterministic modes give the same bits on every level") {
+    check_determinism<float>();
+    check_determinism<double>();
+  }
+
+  SECTION("Compensated summation") {
+    tftl::vector<float> values;
+    values.push_back(1e8f);
+    for (int i = 0; i < 10000; ++i) {
+      values.push_back(1.0f);
+    }
+    values.push_back(-1e8f);
+    REQUIRE(tftl::numeric::sum(values, tftl::numeric::summation::compensated) == 10000.0f);
+
+    tftl::vector<float> prefix = values;
+    tftl::numeric::prefix_sum(prefix, tftl::numeric::summation::compensated);
+    REQUIRE(prefix.back() == 10000.0f);
+  }
+
+  SECTION("Integer sums are widened") {
+    tftl::vector<int> values(1000, 1 << 30);
+    REQUIRE(tftl::numeric::sum(values) == 1000LL << 30);
+  }
+
+  SECTION("Arg extrema are the first occurrence") {
+    tftl::vector<double> values = {3.0, -1.0, 5.0, -1.0, 5.0};
+    REQUIRE(tftl::numeric::argmin(values) == 1);
+    REQUIRE(tftl::numeric::argmax(values) == 2);
+    REQUIRE(tftl::numeric::min(values) == -1.0);
+    REQUIRE(tftl::numeric::max(values) == 5.0);
+
+    tftl::vector<double> empty;
+    REQUIRE(tftl::numeric::argmin(empty) == 0);
+    REQUIRE_THROWS_AS(tftl::numeric::min(empty), std::out_of_range);
+    REQUIRE_THROWS_AS(tftl::numeric::max(empty), std::out_of_range);
+  }
+
+  SECTION("Elementwise operations") {
+    tftl::vector<float> x = make<float>(100, 1);
+    tftl::vector<float> y = make<float>(100, 2);
+    std::vector<float> expected(y.begin(), y.end());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      expected[i] = std::clamp((expected[i] + 0.5f * x[i]) * 4.0f, -30.0f, 40.0f);
+    }
+    tftl::numeric::axpy(0.5f, x, y);
+    tftl::numeric::scale(y, 4.0f);
+    tftl::numeric::clamp(y, -30.0f, 40.0f);
+    REQUIRE(y == expected);
+
+    tftl::vector<int> scan = make<int>(100, 5);
+    std::vector<int> partial(scan.size());
+    std::partial_sum(scan.begin(), scan.end(), partial.begin());
+    tftl::numeric::prefix_sum(scan);
+    REQUIRE(scan == partial);
+  }
+
+  SECTION("Invalid arguments") {
+    tftl::vector<double> x(3, 1.0);
+    tftl::vector<double> y(4, 1.0);
+    REQUIRE_THROWS_AS(tftl::numeric::dot(x, y), std::invalid_argument);
+    REQUIRE_THROWS_AS(tftl::numeric::axpy(1.0, x, y), std::invalid_argument);
+    REQUIRE_THROWS_AS(tftl::numeric::clamp(x, 1.0, 0.0), std::invalid_argument);
+  }
+}
@@ -0,0 +1,171 @@
+//
+// Created by truefinch on 06.07.18.
+//
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <optional> // catch.h uses std::optional without including it
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "catch.h"
+#include "parallel.hpp"
+
+namespace {
+// Chunks of 64 ints, so a few thousand elements already take every parallel path
+tftl::parallel::thread_pool& pool() {
+  static tftl::parallel::thread_pool pool(4, 256);
+  return pool;
+}
+
+tftl::vector<int> shuffled(std::size_t count, int range) {
+  std::mt19937 random(static_cast<unsigned>(count));
+  std::uniform_int_distribution<int> distribution(0, range);
+  tftl::vector<int> values;
+  for (std::size_t i = 0; i < count; ++i) {
+    values.push_back(distribution(random));
+  }
+  return values;
+}
+} // namespace
+
+TEST_CASE("Parallel algorithms") {
+
+  SECTION("Sort") {
+    for (std::size_t count : {0, 1, 63, 64, 65, 1000, 20000}) {
+      tftl::vector<int> values = shuffled(count, 1000);
+      std::vector<int> expected(values.begin(), values.end());
+      std::sort(expected.begin(), expected.end());
+      tftl::parallel::sort(pool(), values);
+      REQUIRE(values == expected);
+
+      tftl::parallel::sort(pool(), values, std::greater<>());
+      REQUIRE(std::is_sorted(values.begin(), values.end(), std::greater<>()));
+    }
+
+    tftl::vector<std::string> words;
+    for (int value : shuffled(5000, 100000)) {
+      words.push_back(std::to_string(value) + " is long enough to leave the small string buffer");
+    }
+    std::vector<std::string> expected(words.begin(), words.end());
+    std::sort(expected.begin(), expected.end());
+    tftl::parallel::sort(pool(), words);
+    REQUIRE(words == expected);
+  }
+
+  SECTION("Stable sort keeps the order of equal keys") {
+    tftl::vector<int> keys = shuffled(10000, 20);
+    tftl::vector<std::pair<int, std::size_t>> values;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      values.emplace_back(keys[i], i);
+    }
+    std::vector<std::pair<int, std::size_t>> expected(values.begin(), values.end());
+    auto by_key = [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; };
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    tftl::parallel::stable_sort(pool(), values, by_key);
+    REQUIRE(values == expected);
+  }
+
+  SECTION("Sort with a grain of one element") {
+    // 64-byte records fill a whole 64-byte grain alone, so the merges split down to single elements
+    struct Record {
+      long long key;
+      long long padding[7];
+    };
+    tftl::parallel::thread_pool single_record(4, 64);
+    for (std::size_t count : {2, 8, 100}) {
+      tftl::vector<Record> records;
+      for (int key : shuffled(count, 10)) {
+        records.push_back(Record{key, {}});
+      }
+      auto by_key = [](const Record& lhs, const Record& rhs) { return lhs.key < rhs.key; };
+      tftl::parallel::sort(single_record, records, by_key);
+      REQUIRE(std::is_sorted(records.begin(), records.end(), by_key));
+      tftl::parallel::stable_sort(single_record, records, by_key);
+      REQUIRE(std::is_sorted(records.begin(), records.end(), by_key));
+    }
+  }
+
+  SECTION("Element-wise algorithms") {
+    tftl::vector<int> values = shuffled(10000, 1000);
+    tftl::vector<int> expected = values;
+    std::for_each(expected.begin(), expected.end(), [](int& value) { value *= 3; });
+    tftl::parallel::for_each(pool(), values, [](int& value) { value *= 3; });
+    REQUIRE(values == expected);
+
+    tftl::parallel::transform(pool(), values, [](int value) { return value + 1; });
+    tftl::vector<std::string> strings;
+    tftl::parallel::transform(pool(), values, strings, [](int value) { return std::to_string(value); });
+    REQUIRE(strings.size() == values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      REQUIRE(strings[i] == std::to_string(expected[i] + 1));
+    }
+  }
+
+  SECTION("Reduce does not depend on the number of threads") {
+    tftl::vector<int> values = shuffled(10000, 1000);
+    REQUIRE(tftl::parallel::reduce(pool(), values, 0LL) == std::accumulate(values.begin(), values.end(), 0LL));
+
+    tftl::vector<float> fractions;
+    for (int value : values) {
+      fractions.push_back(value / 7.0f);
+    }
+    tftl::parallel::thread_pool single(1, 256);
+    REQUIRE(tftl::parallel::reduce(pool(), fractions, 0.0f) == tftl::parallel::reduce(single, fractions, 0.0f));
+    REQUIRE(tftl::parallel::reduce(pool(), values, 1, [](int lhs, int rhs) { return std::max(lhs, rhs); })
+                == *std::max_element(values.begin(), values.end()));
+  }
+
+  SECTION("Compaction") {
+    for (std::size_t count : {0, 10, 1000, 10000}) {
+      tftl::vector<int> values = shuffled(count, 10);
+      std::vector<int> expected(values.begin(), values.end());
+      auto odd = [](int value) { return value % 2 != 0; };
+
+      tftl::vector<int> selected = {-1};
+      std::vector<int> expected_selected = {-1};
+      std::copy_if(expected.begin(), expected.end(), std::back_inserter(expected_selected), odd);
+      tftl::parallel::copy_if(pool(), values, selected, odd);
+      REQUIRE(selected == expected_selected);
+
+      tftl::vector<int> removed = values;
+      std::vector<int> expected_removed = expected;
+      expected_removed.erase(std::remove_if(expected_removed.begin(), expected_removed.end(), odd), expected_removed.end());
+      REQUIRE(tftl::parallel::remove_if(pool(), removed, odd) == expected_removed.size());
+      REQUIRE(removed == expected_removed);
+
+      tftl::vector<int> runs = values;
+      std::sort(runs.begin(), runs.end());
+      std::vector<int> expected_runs(runs.begin(), runs.end());
+      expected_runs.erase(std::unique(expected_runs.begin(), expected_runs.end()), expected_runs.end());
+      tftl::parallel::unique(pool(), runs);
+      REQUIRE(runs == expected_runs);
+
+      tftl::parallel::unique(pool(), values);
+      expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+      REQUIRE(values == expected);
+    }
+  }
+
+  SECTION("Exceptions reach the caller") {
+    tftl::vector<int> values = shuffled(10000, 1000);
+    REQUIRE_THROWS_AS(tftl::parallel::for_each(pool(), values, [](int& value) {
+      if (value == 1000) {
+        throw std::runtime_error("found");
+      }
+    }), std::runtime_error);
+    REQUIRE(tftl::parallel::reduce(pool(), values, 0LL) == std::accumulate(values.begin(), values.end(), 0LL));
+  }
+
+  SECTION("The shared pool") {
+    tftl::vector<int> values = shuffled(100000, 1000000);
+    tftl::parallel::sort(values);
+    REQUIRE(std::is_sorted(values.begin(), values.end()));
+    std::size_t size = tftl::parallel::unique(values);
+    REQUIRE(size == values.size());
+    REQUIRE(std::adjacent_find(values.begin(), values.end()) == values.end());
+  }
+}
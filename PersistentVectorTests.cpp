@@ -0,0 +1,198 @@
+//
+// Created by truefinch on 19.07.18.
+//
+
+#include <algorithm>
+#include <numeric>
+#include <optional> // catch.h uses std::optional without including it
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch.h"
+#include "persistent_vector.hpp"
+
+namespace {
+// Counts the live instances, so leaked or doubly destroyed nodes show up
+struct Counted {
+  static int alive;
+  int value;
+
+  Counted(int value = 0) : value(value) { ++alive; }
+  Counted(const Counted& other) : value(other.value) { ++alive; }
+  Counted& operator=(const Counted&) = default;
+  ~Counted() { --alive; }
+};
+int Counted::alive = 0;
+
+// Copies throw once the countdown reaches zero
+struct Fragile : Counted {
+  static int countdown;
+
+  Fragile(int value = 0) : Counted(value) {}
+  Fragile(const Fragile& other) : Counted(other) {
+    if (--countdown == 0) {
+      throw std::runtime_error("copy");
+    }
+  }
+  Fragile& operator=(const Fragile&) = default;
+};
+int Fragile::countdown = 0;
+} // namespace
+
+TEST_CASE("Persistent vector") {
+
+  SECTION("push_back returns new versions and leaves the old ones alone") {
+    std::vector<tftl::persistent_vector<int>> versions(1);
+    for (int i = 0; i < 2000; ++i) {
+      versions.push_back(versions.back().push_back(i));
+    }
+    for (std::size_t size = 0; size < versions.size(); size += 97) {
+      REQUIRE(versions[size].size() == size);
+      for (std::size_t i = 0; i < size; ++i) {
+        REQUIRE(versions[size][i] == static_cast<int>(i));
+      }
+    }
+    REQUIRE(versions.back().front() == 0);
+    REQUIRE(versions.back().back() == 1999);
+    REQUIRE(versions.front().empty());
+    REQUIRE_THROWS_AS(versions.back().at(2000), std::out_of_range);
+  }
+
+  SECTION("Deep tries") {
+    // 32 * 32 * 32 + 32 elements need a root three levels up
+    tftl::persistent_vector<int> values;
+    const int count = 32 * 32 * 32 + 100;
+    for (int i = 0; i < count; ++i) {
+      values = values.push_back(i);
+    }
+    REQUIRE(values.size() == static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i) {
+      REQUIRE(values[i] == i);
+    }
+    REQUIRE(std::equal(values.begin(), values.end(), values.to_vector().begin()));
+  }
+
+  SECTION("set copies one path") {
+    tftl::persistent_vector<std::string> words;
+    for (int i = 0; i < 1500; ++i) {
+      words = words.push_back(std::to_string(i));
+    }
+    tftl::persistent_vector<std::string> changed = words.set(5, "five").set(1499, "last").set(1024, "1k");
+    REQUIRE(changed[5] == "five");
+    REQUIRE(changed[1499] == "last");
+    REQUIRE(changed[1024] == "1k");
+    REQUIRE(changed[6] == "6");
+    REQUIRE(words[5] == "5");
+    REQUIRE(words[1499] == "1499");
+    REQUIRE(words[1024] == "1024");
+    REQUIRE(&changed[6] != &words[6]); // the leaf of element 5 was copied
+    REQUIRE(&changed[100] == &words[100]); // the untouched ones are shared
+    REQUIRE_THROWS_AS(words.set(1500, "out"), std::out_of_range);
+
+    // An element of the vector itself may be passed
+    tftl::persistent_vector<std::string> copied = words.set(0, words[1000]).push_back(words[1]);
+    REQUIRE(copied[0] == "1000");
+    REQUIRE(copied.back() == "1");
+  }
+
+  SECTION("Transients change unshared nodes in place") {
+    tftl::persistent_vector<int> base{1, 2, 3};
+    tftl::transient_vector<int> batch = base.transient();
+    for (int i = 4; i <= 3000; ++i) {
+      batch.push_back(i);
+    }
+    batch.set(0, 100);
+    REQUIRE(batch.size() == 3000);
+    REQUIRE(batch[2999] == 3000);
+    tftl::persistent_vector<int> result = batch.persistent();
+    REQUIRE(batch.empty());
+    REQUIRE(result.size() == 3000);
+    REQUIRE(result[0] == 100);
+    REQUIRE(base.size() == 3);
+    REQUIRE(base[0] == 1);
+
+    const int* before = &result[10];
+    tftl::transient_vector<int> again = std::move(result).transient();
+    again.set(10, -10);
+    again.set(11, -11);
+    tftl::persistent_vector<int> updated = again.persistent();
+    REQUIRE(&updated[10] == before); // nobody else held the leaf
+    REQUIRE(updated[11] == -11);
+  }
+
+  SECTION("Iteration reads leaf by leaf") {
+    tftl::persistent_vector<int> values;
+    tftl::transient_vector<int> batch;
+    for (int i = 0; i < 5000; ++i) {
+      batch.push_back(i);
+    }
+    values = batch.persistent();
+    REQUIRE(std::accumulate(values.begin(), values.end(), 0LL) == 4999LL * 5000 / 2);
+    REQUIRE(values.end() - values.begin() == 5000);
+    REQUIRE(values.begin()[4097] == 4097);
+    REQUIRE(*(values.end() - 1) == 4999);
+    REQUIRE(*values.rbegin() == 4999);
+    REQUIRE(std::distance(values.rbegin(), values.rend()) == 5000);
+
+    std::size_t chunks = 0;
+    long long total = 0;
+    values.for_each_chunk([&](tftl::span<const int> chunk) {
+      REQUIRE(chunk.size() <= tftl::persistent_vector<int>::chunk_size);
+      total += std::accumulate(chunk.begin(), chunk.end(), 0LL);
+      ++chunks;
+    });
+    REQUIRE(chunks == (5000 + 31) / 32);
+    REQUIRE(total == 4999LL * 5000 / 2);
+  }
+
+  SECTION("Conversion from and to tftl::vector") {
+    tftl::vector<int> source(1000);
+    std::iota(source.begin(), source.end(), 0);
+    tftl::persistent_vector<int> values(source);
+    REQUIRE(values.size() == 1000);
+    REQUIRE(values[999] == 999);
+
+    tftl::vector<int> back = values.set(3, -3).to_vector();
+    REQUIRE(back.size() == 1000);
+    REQUIRE(back[3] == -3);
+    REQUIRE(std::equal(back.begin() + 4, back.end(), source.begin() + 4));
+    std::vector<int> standard = values.to_vector<std::vector<int>>();
+    REQUIRE(standard.size() == 1000);
+    REQUIRE(standard[500] == 500);
+  }
+
+  SECTION("Nodes are freed with the last version") {
+    Counted::alive = 0;
+    {
+      tftl::persistent_vector<Counted> values;
+      std::vector<tftl::persistent_vector<Counted>> versions;
+      for (int i = 0; i < 1100; ++i) {
+        values = values.push_back(Counted(i));
+        if (i % 100 == 0) {
+          versions.push_back(values.set(i / 2, Counted(-i)));
+        }
+      }
+      tftl::persistent_vector<Counted> moved = std::move(values);
+      REQUIRE(values.empty());
+      REQUIRE(moved[1099].value == 1099);
+      REQUIRE(versions[3][150].value == -300);
+      versions.clear();
+      REQUIRE(Counted::alive == 1100);
+    }
+    REQUIRE(Counted::alive == 0);
+  }
+
+  SECTION("A throwing copy during construction frees the nodes") {
+    Counted::alive = 0;
+    {
+      Fragile::countdown = 0;
+      tftl::vector<Fragile> source(200);
+      Fragile::countdown = 100;
+      REQUIRE_THROWS_AS(tftl::persistent_vector<Fragile>(source), std::runtime_error);
+      REQUIRE(Counted::alive == 200);
+      Fragile::countdown = 0;
+    }
+    REQUIRE(Counted::alive == 0);
+  }
+}
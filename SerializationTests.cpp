@@ -0,0 +1,203 @@
+//
+// Created by truefinch on 12.07.18.
+//
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <optional> // catch.h uses std::optional without including it
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "catch.h"
+#include "serialization.hpp"
+
+namespace {
+struct point {
+  float x;
+  float y;
+  int   id;
+};
+} // namespace
+
+namespace tftl {
+namespace serialization {
+template<>
+struct type_tag<point> {
+  static constexpr std::uint64_t value = 0x706F696E74; // "point"
+};
+} // namespace serialization
+} //namespace truefinch template library
+
+namespace {
+template<typename T>
+tftl::vector<T> iota(std::size_t size) {
+  tftl::vector<T> values;
+  for (std::size_t i = 0; i < size; ++i) {
+    values.push_back(static_cast<T>(i * 3 + 1));
+  }
+  return values;
+}
+
+// A buffer aligned for any arithmetic T holding the record of values
+template<typename T>
+tftl::vector<std::uint64_t> record(const tftl::vector<T>& values) {
+  std::size_t size = tftl::serialization::serialized_size(values);
+  tftl::vector<std::uint64_t> buffer(size / sizeof(std::uint64_t), 0);
+  REQUIRE(tftl::serialization::serialize_to(buffer.data(), size, values) == size);
+  return buffer;
+}
+} // namespace
+
+TEST_CASE("Serialization") {
+  using namespace tftl::serialization;
+
+  SECTION("Buffer round trip") {
+    for (std::size_t size : {0, 1, 15, 16, 17, 1000}) {
+      tftl::vector<double> values = iota<double>(size);
+      std::vector<unsigned char> buffer(serialized_size(values));
+      REQUIRE(buffer.size() % alignment == 0);
+      REQUIRE(serialize_to(buffer.data(), buffer.size(), values) == buffer.size());
+
+      tftl::vector<double> copy(3, 1.0);
+      REQUIRE(deserialize_from(buffer.data(), buffer.size(), copy) == buffer.size());
+      REQUIRE(copy == values);
+    }
+
+    tftl::vector<point> points;
+    points.push_back({1.5f, 2.5f, 7});
+    points.push_back({-1.0f, 0.0f, 8});
+    std::vector<unsigned char> buffer(serialized_size(points));
+    serialize_to(buffer.data(), buffer.size(), points);
+    tftl::vector<point> copy;
+    deserialize_from(buffer.data(), buffer.size(), copy);
+    REQUIRE(copy.size() == 2);
+    REQUIRE(copy[1].id == 8);
+    REQUIRE(copy[0].y == 2.5f);
+  }
+
+  SECTION("Concatenated records in a file") {
+    std::string path = "/tmp/tftl_serialization_" + std::to_string(::getpid());
+    tftl::vector<int> first = iota<int>(100001);
+    tftl::vector<short> second = iota<short>(3);
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    REQUIRE(fd >= 0);
+    serialize_to(fd, first);
+    serialize_to(fd, second);
+    serialize_to(fd, tftl::vector<int>());
+    REQUIRE(::lseek(fd, 0, SEEK_SET) == 0);
+
+    tftl::vector<int> ints;
+    tftl::vector<short> shorts;
+    deserialize_from(fd, ints);
+    deserialize_from(fd, shorts);
+    REQUIRE(ints == first);
+    REQUIRE(shorts == second);
+    deserialize_from(fd, ints);
+    REQUIRE(ints.empty());
+    REQUIRE_THROWS_AS(deserialize_from(fd, ints), format_error);
+
+    // A corrupted count is caught before the vector grows to it
+    header head;
+    REQUIRE(::pread(fd, &head, sizeof(head), 0) == sizeof(head));
+    for (std::uint64_t count : {std::uint64_t(100002), std::uint64_t(1) << 40, std::uint64_t(1) << 60}) {
+      head.count = count;
+      REQUIRE(::pwrite(fd, &head, sizeof(head), 0) == sizeof(head));
+      REQUIRE(::lseek(fd, 0, SEEK_SET) == 0);
+      REQUIRE_THROWS_AS(deserialize_from(fd, ints), format_error);
+      REQUIRE(ints.capacity() == 0);
+    }
+    ::close(fd);
+    std::remove(path.c_str());
+  }
+
+  SECTION("View") {
+    tftl::vector<int> values = iota<int>(1000);
+    tftl::vector<std::uint64_t> buffer = record(values);
+    std::size_t size = buffer.size() * sizeof(std::uint64_t);
+    view<int> ints(buffer.data(), size);
+    REQUIRE(ints.size() == 1000);
+    REQUIRE(reinterpret_cast<const unsigned char*>(ints.data())
+                == reinterpret_cast<const unsigned char*>(buffer.data()) + sizeof(header));
+    REQUIRE(std::equal(ints.begin(), ints.end(), values.begin(), values.end()));
+    std::vector<int> reversed(values.begin(), values.end());
+    std::reverse(reversed.begin(), reversed.end());
+    REQUIRE(std::equal(ints.rbegin(), ints.rend(), reversed.begin(), reversed.end()));
+    REQUIRE(ints.front() == 1);
+    REQUIRE(ints.back() == values.back());
+    REQUIRE(ints.at(10) == 31);
+    REQUIRE_THROWS_AS(ints.at(1000), std::out_of_range);
+    REQUIRE(ints.record_size() == serialized_size(values));
+
+    tftl::vector<char> unaligned(size + 1);
+    std::memcpy(unaligned.data() + 1, buffer.data(), size);
+    const char* start = unaligned.data() + 1;
+    if (reinterpret_cast<std::uintptr_t>(start + sizeof(header)) % alignof(int) != 0) {
+      REQUIRE_THROWS_AS(view<int>(start, size), std::invalid_argument);
+    }
+  }
+
+  SECTION("Corrupted records are rejected") {
+    tftl::vector<float> values = iota<float>(100);
+    std::vector<unsigned char> buffer(serialized_size(values));
+    serialize_to(buffer.data(), buffer.size(), values);
+    tftl::vector<float> copy;
+
+    std::vector<unsigned char> corrupted = buffer;
+    corrupted[sizeof(header) + 17] ^= 1;
+    REQUIRE_THROWS_AS(deserialize_from(corrupted.data(), corrupted.size(), copy), format_error);
+    REQUIRE(deserialize_from(corrupted.data(), corrupted.size(), copy, false) == buffer.size());
+    REQUIRE_THROWS_AS(view<float>(corrupted.data(), corrupted.size()), format_error);
+
+    REQUIRE_THROWS_AS(deserialize_from(buffer.data(), buffer.size() - 1, copy), format_error);
+    REQUIRE_THROWS_AS(deserialize_from(buffer.data(), sizeof(header) - 1, copy), format_error);
+
+    tftl::vector<int> ints;
+    REQUIRE_THROWS_AS(deserialize_from(buffer.data(), buffer.size(), ints), format_error);
+    tftl::vector<point> points;
+    REQUIRE_THROWS_AS(deserialize_from(buffer.data(), buffer.size(), points), format_error);
+
+    corrupted = buffer;
+    corrupted[0] = 'X';
+    REQUIRE_THROWS_AS(deserialize_from(corrupted.data(), corrupted.size(), copy), format_error);
+    corrupted = buffer;
+    corrupted[offsetof(header, version)] = 9;
+    REQUIRE_THROWS_AS(deserialize_from(corrupted.data(), corrupted.size(), copy), format_error);
+
+    std::vector<unsigned char> small(buffer.size() - 1);
+    REQUIRE_THROWS_AS(serialize_to(small.data(), small.size(), values), std::length_error);
+  }
+
+  SECTION("Records of the other byte order are converted") {
+    tftl::vector<std::uint32_t> values = iota<std::uint32_t>(37);
+    std::vector<unsigned char> buffer(serialized_size(values));
+    serialize_to(buffer.data(), buffer.size(), values);
+
+    // Rewrite the record as a host of the other byte order would have written it
+    header head;
+    std::memcpy(&head, buffer.data(), sizeof(head));
+    head.version = tftl::serialization::detail::swap_bytes(head.version);
+    head.byte_order = tftl::serialization::detail::swap_bytes(head.byte_order);
+    head.element_size = tftl::serialization::detail::swap_bytes(head.element_size);
+    head.type_tag = tftl::serialization::detail::swap_bytes(head.type_tag);
+    head.count = tftl::serialization::detail::swap_bytes(head.count);
+    head.checksum = 0;
+    auto payload = reinterpret_cast<std::uint32_t*>(buffer.data() + sizeof(header));
+    tftl::serialization::detail::swap_elements(payload, values.size());
+    std::uint64_t sum = tftl::serialization::detail::checksum(payload, values.size() * sizeof(std::uint32_t));
+    head.checksum = tftl::serialization::detail::swap_bytes(
+        tftl::serialization::detail::checksum(&head, sizeof(head), sum));
+    std::memcpy(buffer.data(), &head, sizeof(head));
+
+    tftl::vector<std::uint32_t> copy;
+    deserialize_from(buffer.data(), buffer.size(), copy);
+    REQUIRE(copy == values);
+    REQUIRE_THROWS_AS(view<std::uint32_t>(buffer.data(), buffer.size()), format_error);
+  }
+}
@@ -0,0 +1,182 @@
+//
+// Created by truefinch on 21.06.18.
+//
+
+#include <vector>
+#include <optional> // catch.h uses std::optional without including it
+#include <memory>
+#include <string>
+
+#include "catch.h"
+#include "small_vector.hpp"
+
+namespace {
+// Counts live instances to catch leaks and double destructions
+struct Tracked {
+  static int alive;
+  std::string value;
+
+  Tracked(std::string value = "") : value(std::move(value)) { ++alive; }
+  Tracked(const Tracked& other) : value(other.value) { ++alive; }
+  Tracked(Tracked&& other) noexcept : value(std::move(other.value)) { ++alive; }
+  Tracked& operator=(const Tracked&) = default;
+  Tracked& operator=(Tracked&&) = default;
+  ~Tracked() { --alive; }
+
+  bool operator==(const Tracked& other) const { return value == other.value; }
+};
+int Tracked::alive = 0;
+
+template<typename Vector>
+std::vector<std::string> values(const Vector& vector) {
+  std::vector<std::string> result;
+  for (auto it = vector.begin(); it != vector.end(); ++it) {
+    result.push_back(it->value);
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("Small vector storage") {
+
+  SECTION("Stays inline up to N elements") {
+    tftl::small_vector<int, 4> result;
+    REQUIRE(result.capacity() == 4);
+    for (int i = 0; i < 4; ++i) {
+      result.push_back(i);
+    }
+    REQUIRE(result.is_inline());
+    result.push_back(4);
+    REQUIRE_FALSE(result.is_inline());
+    REQUIRE(result.capacity() >= 5);
+    for (int i = 0; i < 5; ++i) {
+      REQUIRE(result[i] == i);
+    }
+  }
+
+  SECTION("Shrink moves the elements back inline") {
+    tftl::small_vector<int, 4> result = {1, 2, 3, 4, 5, 6};
+    REQUIRE_FALSE(result.is_inline());
+    result.erase(result.begin() + 1, result.begin() + 4);
+    result.shrink_to_fit();
+    REQUIRE(result.is_inline());
+    std::vector<int> expected = {1, 5, 6};
+    REQUIRE(std::vector<int>(result.begin(), result.end()) == expected);
+  }
+
+  SECTION("Works with std algorithms") {
+    tftl::small_vector<int, 8> result = {5, 3, 2, 4, 1, 0};
+    std::sort(result.begin(), result.end());
+    std::vector<int> expected = {0, 1, 2, 3, 4, 5};
+    REQUIRE(std::vector<int>(result.begin(), result.end()) == expected);
+  }
+}
+
+TEST_CASE("Small vector modifications") {
+
+  SECTION("Insert and erase of non-relocatable elements") {
+    Tracked::alive = 0;
+    {
+      tftl::small_vector<Tracked, 2> result;
+      result.emplace_back("b");
+      result.emplace_back("d");
+      result.insert(result.begin(), Tracked("a"));
+      result.emplace(result.begin() + 2, "c");
+      result.insert(result.end(), 2, Tracked("e"));
+      std::vector<std::string> expected = {"a", "b", "c", "d", "e", "e"};
+      REQUIRE(values(result) == expected);
+      result.erase(result.begin() + 1, result.begin() + 3);
+      expected = {"a", "d", "e", "e"};
+      REQUIRE(values(result) == expected);
+      REQUIRE(Tracked::alive == 4);
+    }
+    REQUIRE(Tracked::alive == 0);
+  }
+
+  SECTION("Insert a range in the middle") {
+    tftl::small_vector<int, 3> result = {1, 5};
+    std::vector<int> source = {2, 3, 4};
+    result.insert(result.begin() + 1, source.begin(), source.end());
+    std::vector<int> expected = {1, 2, 3, 4, 5};
+    REQUIRE(std::vector<int>(result.begin(), result.end()) == expected);
+  }
+
+  SECTION("Emplace an element of the vector itself") {
+    tftl::small_vector<std::string, 2> result = {"a", "b"};
+    result.push_back(result[0]);
+    result.emplace(result.begin(), result[2]);
+    std::vector<std::string> expected = {"a", "a", "b", "a"};
+    REQUIRE(std::vector<std::string>(result.begin(), result.end()) == expected);
+  }
+
+  SECTION("Resize") {
+    tftl::small_vector<int, 4> result;
+    result.resize(3);
+    REQUIRE(result.size() == 3);
+    REQUIRE(result[2] == 0);
+    result.resize(6, 7);
+    REQUIRE(result[5] == 7);
+    result.resize(1);
+    REQUIRE(result.size() == 1);
+  }
+}
+
+TEST_CASE("Small vector moves and swaps") {
+
+  SECTION("Move inline and heap vectors") {
+    Tracked::alive = 0;
+    {
+      tftl::small_vector<Tracked, 2> local = {Tracked("a")};
+      tftl::small_vector<Tracked, 2> heap = {Tracked("x"), Tracked("y"), Tracked("z")};
+
+      tftl::small_vector<Tracked, 2> moved_local(std::move(local));
+      tftl::small_vector<Tracked, 2> moved_heap(std::move(heap));
+      REQUIRE(values(moved_local) == std::vector<std::string>{"a"});
+      REQUIRE(values(moved_heap) == std::vector<std::string>{"x", "y", "z"});
+      REQUIRE(local.empty());
+      REQUIRE(heap.empty());
+      REQUIRE(heap.is_inline());
+
+      moved_local = std::move(moved_heap);
+      REQUIRE(values(moved_local) == std::vector<std::string>{"x", "y", "z"});
+      REQUIRE(moved_heap.empty());
+      REQUIRE(Tracked::alive == 3);
+    }
+    REQUIRE(Tracked::alive == 0);
+  }
+
+  SECTION("Swap every combination of states") {
+    Tracked::alive = 0;
+    {
+      tftl::small_vector<Tracked, 3> a = {Tracked("a")};
+      tftl::small_vector<Tracked, 3> b = {Tracked("b"), Tracked("c"), Tracked("d")};
+      tftl::small_vector<Tracked, 3> c = {Tracked("1"), Tracked("2"), Tracked("3"), Tracked("4")};
+      tftl::small_vector<Tracked, 3> d = {Tracked("5"), Tracked("6"), Tracked("7"), Tracked("8")};
+
+      a.swap(b);
+      REQUIRE(values(a) == std::vector<std::string>{"b", "c", "d"});
+      REQUIRE(values(b) == std::vector<std::string>{"a"});
+
+      b.swap(c);
+      REQUIRE(values(b) == std::vector<std::string>{"1", "2", "3", "4"});
+      REQUIRE(values(c) == std::vector<std::string>{"a"});
+      REQUIRE(c.is_inline());
+      REQUIRE_FALSE(b.is_inline());
+
+      swap(b, d);
+      REQUIRE(values(b) == std::vector<std::string>{"5", "6", "7", "8"});
+      REQUIRE(values(d) == std::vector<std::string>{"1", "2", "3", "4"});
+      REQUIRE(Tracked::alive == 12);
+    }
+    REQUIRE(Tracked::alive == 0);
+  }
+
+  SECTION("Copy") {
+    tftl::small_vector<std::string, 2> source = {"a", "b", "c"};
+    tftl::small_vector<std::string, 2> result(source);
+    REQUIRE(result == source);
+    result = tftl::small_vector<std::string, 2>{"x"};
+    REQUIRE(result.size() == 1);
+    REQUIRE(source < result);
+  }
+}
@@ -0,0 +1,210 @@
+//
+// Created by truefinch on 16.07.18.
+//
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <optional> // catch.h uses std::optional without including it
+#include <stdexcept>
+#include <string>
+
+#include "catch.h"
+#include "soa_vector.hpp"
+
+namespace {
+// Copies throw once the countdown reaches zero, and moves copy
+struct Fragile {
+  static int countdown;
+  int value;
+
+  Fragile(int value = 0) : value(value) {}
+  Fragile(const Fragile& other) : value(other.value) {
+    if (--countdown == 0) {
+      throw std::runtime_error("copy");
+    }
+  }
+  Fragile& operator=(const Fragile&) = default;
+};
+int Fragile::countdown = 0;
+
+typedef tftl::soa_vector<int, double, std::string> table;
+
+table make(int rows) {
+  table result;
+  for (int i = 0; i < rows; ++i) {
+    result.emplace_back(i, i * 0.5, std::to_string(i));
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("Structure of arrays vector") {
+
+  SECTION("Rows are appended to every column") {
+    table rows = make(1000);
+    REQUIRE(rows.size() == 1000);
+    REQUIRE(rows.capacity() >= 1000);
+    for (int i = 0; i < 1000; ++i) {
+      REQUIRE(std::get<0>(rows[i]) == i);
+      REQUIRE(std::get<1>(rows[i]) == i * 0.5);
+      REQUIRE(std::get<2>(rows[i]) == std::to_string(i));
+    }
+    rows.push_back(std::make_tuple(-1, -1.0, std::string("last")));
+    REQUIRE(std::get<2>(rows.back()) == "last");
+    REQUIRE(std::get<0>(rows.front()) == 0);
+    REQUIRE(std::get<1>(rows.at(3)) == 1.5);
+    REQUIRE_THROWS_AS(rows.at(1001), std::out_of_range);
+
+    std::get<1>(rows[5]) = 42.0;
+    REQUIRE(rows.data<1>()[5] == 42.0);
+
+    rows.pop_back();
+    REQUIRE(rows.size() == 1000);
+  }
+
+  SECTION("Columns are contiguous and aligned") {
+    table rows = make(100);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(rows.data<0>()) % 64 == 0);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(rows.data<1>()) % 64 == 0);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(rows.data<2>()) % 64 == 0);
+
+    tftl::span<double> halves = rows.column<1>();
+    REQUIRE(halves.size() == 100);
+    REQUIRE(std::accumulate(halves.begin(), halves.end(), 0.0) == 2475.0);
+    const table& constant = rows;
+    tftl::span<const int> keys = constant.column<0>();
+    REQUIRE(keys.back() == 99);
+    REQUIRE(constant.data<2>()[7] == "7");
+  }
+
+  SECTION("Iterators") {
+    table rows = make(10);
+    REQUIRE(rows.end() - rows.begin() == 10);
+    REQUIRE(std::get<0>(*(rows.begin() + 3)) == 3);
+    REQUIRE(std::get<0>(rows.begin()[4]) == 4);
+    REQUIRE(std::get<0>(*rows.rbegin()) == 9);
+    REQUIRE(std::distance(rows.rbegin(), rows.rend()) == 10);
+
+    table::const_iterator first = rows.begin();
+    REQUIRE(first == rows.cbegin());
+    REQUIRE(first < rows.cend());
+    int total = 0;
+    for (auto row : rows) {
+      total += std::get<0>(row);
+    }
+    REQUIRE(total == 45);
+
+    table::value_type copy = *rows.begin();
+    std::get<0>(copy) = 100;
+    REQUIRE(std::get<0>(rows[0]) == 0);
+  }
+
+  SECTION("Algorithms move whole rows") {
+    table rows = make(200);
+    std::reverse(rows.begin(), rows.end());
+    REQUIRE(std::get<2>(rows[0]) == "199");
+
+    std::sort(rows.begin(), rows.end(), [](const auto& lhs, const auto& rhs) {
+      return std::get<1>(lhs) < std::get<1>(rhs);
+    });
+    for (int i = 0; i < 200; ++i) {
+      REQUIRE(std::get<0>(rows[i]) == i);
+      REQUIRE(std::get<2>(rows[i]) == std::to_string(i));
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const auto& lhs, const auto& rhs) {
+      return std::get<2>(lhs) < std::get<2>(rhs);
+    });
+    REQUIRE(std::get<2>(rows[1]) == "1");
+    REQUIRE(std::get<2>(rows[2]) == "10");
+    REQUIRE(std::get<0>(rows[2]) == 10);
+
+    std::swap_ranges(rows.begin(), rows.begin() + 1, rows.begin() + 1);
+    REQUIRE(std::get<2>(rows[0]) == "1");
+    REQUIRE(std::get<0>(rows[1]) == 0);
+  }
+
+  SECTION("Copy, move and resize") {
+    table rows = make(50);
+    table copy = rows;
+    REQUIRE(copy.size() == 50);
+    REQUIRE(std::get<2>(copy[49]) == "49");
+    REQUIRE(copy.data<0>() != rows.data<0>());
+
+    table moved = std::move(copy);
+    REQUIRE(copy.empty());
+    REQUIRE(std::get<1>(moved[10]) == 5.0);
+    copy = moved;
+    REQUIRE(std::get<2>(copy[10]) == "10");
+
+    rows.resize(60, std::make_tuple(7, 7.0, std::string("seven")));
+    REQUIRE(std::get<2>(rows[59]) == "seven");
+    rows.resize(20);
+    REQUIRE(rows.size() == 20);
+    rows.resize(25);
+    REQUIRE(std::get<0>(rows[24]) == 0);
+    REQUIRE(std::get<2>(rows[24]).empty());
+
+    rows.shrink_to_fit();
+    REQUIRE(rows.capacity() == 25);
+    REQUIRE(std::get<2>(rows[19]) == "19");
+    rows.clear();
+    REQUIRE(rows.empty());
+    REQUIRE(rows.capacity() == 0);
+    rows.emplace_back(1, 1.0, "one");
+    REQUIRE(rows.size() == 1);
+  }
+
+  SECTION("Appending a row of the vector itself") {
+    // exact_growth reallocates on every append
+    tftl::basic_soa_vector<tftl::exact_growth, int, std::string> rows;
+    rows.emplace_back(1, std::string(100, 'x'));
+    for (int i = 0; i < 10; ++i) {
+      REQUIRE(rows.size() == rows.capacity());
+      rows.emplace_back(std::get<0>(rows.back()), std::get<1>(rows.back()));
+    }
+    REQUIRE(std::get<1>(rows[10]) == std::string(100, 'x'));
+  }
+
+  SECTION("A throwing copy during growth leaves the vector untouched") {
+    tftl::soa_vector<int, Fragile, std::unique_ptr<int>> rows;
+    for (int i = 0; i < 8; ++i) {
+      Fragile::countdown = 0;
+      rows.emplace_back(i, Fragile(i), std::make_unique<int>(i));
+    }
+    REQUIRE(rows.size() == rows.capacity());
+
+    Fragile::countdown = 5;
+    REQUIRE_THROWS_AS(rows.emplace_back(8, Fragile(8), std::make_unique<int>(8)), std::runtime_error);
+    REQUIRE(rows.size() == 8);
+    for (int i = 0; i < 8; ++i) {
+      REQUIRE(std::get<0>(rows[i]) == i);
+      REQUIRE(std::get<1>(rows[i]).value == i);
+      REQUIRE(*std::get<2>(rows[i]) == i);
+    }
+    Fragile::countdown = 0;
+
+    // The moved column comes first, it is only moved once the copies succeeded
+    typedef tftl::soa_vector<std::string, Fragile> named_rows;
+    named_rows named;
+    for (int i = 0; i < 8; ++i) {
+      named.emplace_back(std::to_string(i), Fragile(i));
+    }
+    REQUIRE(named.size() == named.capacity());
+    Fragile::countdown = 5;
+    REQUIRE_THROWS_AS(named.emplace_back("8", Fragile(8)), std::runtime_error);
+    REQUIRE(named.size() == 8);
+    for (int i = 0; i < 8; ++i) {
+      REQUIRE(std::get<0>(named[i]) == std::to_string(i));
+      REQUIRE(std::get<1>(named[i]).value == i);
+    }
+
+    // A throwing copy constructor frees its block, the sanitizer build reports a leak otherwise
+    Fragile::countdown = 5;
+    REQUIRE_THROWS_AS(named_rows(named), std::runtime_error);
+    Fragile::countdown = 0;
+  }
+}
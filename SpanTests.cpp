@@ -0,0 +1,213 @@
+//
+// Created by truefinch on 13.07.18.
+//
+
+#include <vector>
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <optional> // catch.h uses std::optional without including it
+#include <stdexcept>
+#include <thread>
+
+#include "catch.h"
+#include "span.hpp"
+#include "vector.hpp"
+
+namespace {
+tftl::vector<int> iota(std::size_t size) {
+  tftl::vector<int> values;
+  for (std::size_t i = 0; i < size; ++i) {
+    values.push_back(static_cast<int>(i));
+  }
+  return values;
+}
+
+int sum(tftl::span<const int> values) {
+  return std::accumulate(values.begin(), values.end(), 0);
+}
+} // namespace
+
+TEST_CASE("Span") {
+  tftl::vector<int> values = iota(100);
+
+  SECTION("Construction shares the memory") {
+    tftl::span<int> all(values);
+    REQUIRE(all.data() == values.data());
+    REQUIRE(all.size() == 100);
+    REQUIRE(all.size_bytes() == 100 * sizeof(int));
+
+    tftl::span<int> middle(values.begin() + 10, values.begin() + 20);
+    REQUIRE(middle.data() == values.data() + 10);
+    REQUIRE(middle.size() == 10);
+    REQUIRE(tftl::span<int>(values.begin() + 90, 10).back() == 99);
+    REQUIRE(tftl::span<int>(values.begin(), values.end()).size() == 100);
+    REQUIRE(tftl::span<int>(values.data() + 5, values.data() + 7).size() == 2);
+
+    middle[0] = -1;
+    REQUIRE(values[10] == -1);
+    REQUIRE(sum(middle) == std::accumulate(values.begin() + 10, values.begin() + 20, 0));
+
+    const tftl::vector<int>& constant = values;
+    tftl::span<const int> readonly(constant);
+    REQUIRE(readonly.front() == 0);
+    REQUIRE_FALSE((std::is_constructible<tftl::span<int>, const tftl::vector<int>&>::value));
+    REQUIRE_FALSE((std::is_constructible<tftl::span<int>, tftl::span<const int>>::value));
+    REQUIRE((std::is_constructible<tftl::span<const int>, tftl::span<int>>::value));
+
+    std::vector<int> standard(5, 2);
+    std::array<int, 3> array = {1, 2, 3};
+    int plain[4] = {1, 1, 1, 1};
+    REQUIRE(sum(standard) == 10);
+    REQUIRE(sum(array) == 6);
+    REQUIRE(sum(plain) == 4);
+
+    tftl::span<int> empty;
+    REQUIRE(empty.empty());
+    REQUIRE(empty.begin() == empty.end());
+  }
+
+  SECTION("Element access and iteration") {
+    tftl::span<int> all(values);
+    REQUIRE(all.at(42) == 42);
+    REQUIRE_THROWS_AS(all.at(100), std::out_of_range);
+    REQUIRE(all.front() == 0);
+    REQUIRE(all.back() == 99);
+    REQUIRE(*all.rbegin() == 99);
+    REQUIRE(std::distance(all.rbegin(), all.rend()) == 100);
+    std::sort(all.begin(), all.end(), std::greater<int>());
+    REQUIRE(values.front() == 99);
+  }
+
+  SECTION("Slices") {
+    tftl::span<int> all(values);
+    REQUIRE(all.first(3).back() == 2);
+    REQUIRE(all.last(3).front() == 97);
+    REQUIRE(all.subspan(10, 5).front() == 10);
+    REQUIRE(all.subspan(95).size() == 5);
+    REQUIRE(all.subspan(100).empty());
+    REQUIRE(all.first(0).empty());
+    REQUIRE_THROWS_AS(all.first(101), std::out_of_range);
+    REQUIRE_THROWS_AS(all.last(101), std::out_of_range);
+    REQUIRE_THROWS_AS(all.subspan(101), std::out_of_range);
+    REQUIRE_THROWS_AS(all.subspan(90, 11), std::out_of_range);
+  }
+
+  SECTION("Split and chunks cover the span once") {
+    tftl::span<int> all(values);
+    for (std::size_t parts : {1, 3, 7, 100, 150}) {
+      auto split = all.split(parts);
+      REQUIRE(split.size() == std::min<std::size_t>(parts, 100));
+      int* next = values.data();
+      std::size_t smallest = 100;
+      std::size_t largest = 0;
+      for (tftl::span<int> chunk : split) {
+        REQUIRE(chunk.data() == next);
+        next += chunk.size();
+        smallest = std::min(smallest, chunk.size());
+        largest = std::max(largest, chunk.size());
+      }
+      REQUIRE(next == values.data() + 100);
+      REQUIRE(largest - smallest <= 1);
+    }
+
+    auto chunks = all.chunks(30);
+    REQUIRE(chunks.size() == 4);
+    REQUIRE(chunks[0].size() == 30);
+    REQUIRE(chunks[3].size() == 10);
+    REQUIRE(chunks[3].back() == 99);
+    REQUIRE(all.chunks(100).size() == 1);
+    REQUIRE(tftl::span<int>().split(4).empty());
+    REQUIRE(tftl::span<int>().chunks(4).empty());
+    REQUIRE_THROWS_AS(all.split(0), std::invalid_argument);
+    REQUIRE_THROWS_AS(all.chunks(0), std::invalid_argument);
+  }
+
+#if defined(__cpp_lib_span)
+  SECTION("std::span interop") {
+    std::span<int> standard = tftl::span<int>(values).subspan(10, 5);
+    REQUIRE(standard.data() == values.data() + 10);
+    REQUIRE(standard.size() == 5);
+    tftl::span<const int> back(standard);
+    REQUIRE(back.data() == standard.data());
+    REQUIRE(sum(standard.first(2)) == 21);
+  }
+#endif
+
+  SECTION("Workers fill their own chunks") {
+    tftl::vector<int> results(1000, 0);
+    auto parts = tftl::span<int>(results).split(4);
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+      workers.emplace_back([part = parts[i], i] {
+        std::fill(part.begin(), part.end(), static_cast<int>(i + 1));
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    REQUIRE(results[0] == 1);
+    REQUIRE(results[999] == 4);
+    REQUIRE(std::count(results.begin(), results.end(), 0) == 0);
+  }
+}
+
+TEST_CASE("Strided span") {
+  // A 4 x 5 row-major matrix
+  tftl::vector<int> matrix = iota(20);
+
+  SECTION("Columns and rows") {
+    tftl::strided_span<int> column(matrix.data() + 2, 4, 5);
+    REQUIRE(column.size() == 4);
+    REQUIRE(column.stride() == 5);
+    REQUIRE(column[0] == 2);
+    REQUIRE(column.back() == 17);
+    REQUIRE(column.at(2) == 12);
+    REQUIRE_THROWS_AS(column.at(4), std::out_of_range);
+    REQUIRE(std::accumulate(column.begin(), column.end(), 0) == 2 + 7 + 12 + 17);
+    REQUIRE(*column.rbegin() == 17);
+    REQUIRE(column.end() - column.begin() == 4);
+
+    std::fill(column.begin(), column.end(), -1);
+    REQUIRE(matrix[7] == -1);
+    REQUIRE(matrix[8] == 8);
+
+    tftl::strided_span<const int> readonly = column;
+    REQUIRE(readonly.front() == -1);
+
+    tftl::strided_span<int> backwards(matrix.data() + 19, 20, -1);
+    REQUIRE(backwards[0] == 19);
+    REQUIRE(backwards.back() == 0);
+  }
+
+  SECTION("Slices and steps") {
+    tftl::span<int> all(matrix);
+    tftl::strided_span<int> even = all.strided(2);
+    REQUIRE(even.size() == 10);
+    REQUIRE(even.back() == 18);
+    REQUIRE(all.strided(3).size() == 7);
+    REQUIRE(all.strided(3).back() == 18);
+
+    tftl::strided_span<int> fourth = even.strided(2);
+    REQUIRE(fourth.stride() == 4);
+    REQUIRE(fourth.size() == 5);
+    REQUIRE(fourth.last(2).front() == 12);
+    REQUIRE(fourth.first(2).back() == 4);
+    REQUIRE(fourth.subspan(1, 3).back() == 12);
+    REQUIRE(fourth.subspan(5).empty());
+    REQUIRE_THROWS_AS(fourth.subspan(6), std::out_of_range);
+    REQUIRE_THROWS_AS(fourth.strided(0), std::invalid_argument);
+
+    std::sort(even.begin(), even.end(), std::greater<int>());
+    REQUIRE(matrix[0] == 18);
+    REQUIRE(matrix[1] == 1);
+    REQUIRE(matrix[18] == 0);
+
+    auto parts = even.split(3);
+    REQUIRE(parts.size() == 3);
+    REQUIRE(parts[0].size() == 4);
+    REQUIRE(parts[2].size() == 3);
+    REQUIRE(parts[1].front() == 10);
+    REQUIRE(even.chunks(4)[2].size() == 2);
+  }
+}
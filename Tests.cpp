@@ -4,9 +4,23 @@
 #define CATCH_CONFIG_MAIN
 
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <exception>
+#include <optional> // catch.h uses std::optional without including it
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <numeric>
+#include <iterator>
+#include <sstream>
+#include <string>
 
 #include "catch.h"
+#include "allocator.hpp"
+#include "simd.hpp"
 #include "vector.hpp"
 
 TEST_CASE("STL compatibility", "[]") {
@@ -333,6 +347,17 @@ TEST_CASE("Vector exceptions") {
 
   struct Error {
     const int a = 1;
+    bool throwOnCopy = true;
+
+    Error() = default;
+
+    explicit Error(bool throwOnCopy) : throwOnCopy(throwOnCopy) {}
+
+    Error(const Error& other) : throwOnCopy(other.throwOnCopy) {
+      if (throwOnCopy) {
+        throw std::exception();
+      }
+    }
 
     Error& operator=(const Error&) {
       throw std::exception();
@@ -390,7 +415,7 @@ TEST_CASE("Vector exceptions") {
   }
 
   SECTION("Exception on copy") {
-    tftl::vector<Error> result(1, Error());
+    tftl::vector<Error> result(1, Error(false));
     REQUIRE_THROWS(result.push_back(Error()));
   }
 
@@ -522,4 +547,766 @@ TEST_CASE("Modifier elements methods") {
     REQUIRE(result.size() == expected.size());
     REQUIRE(result[1] == expected[1]);
   }
-}
\ No newline at end of file
+  SECTION("Modifiers of non-relocatable elements") {
+    std::string tail(40, 'z');
+    tftl::vector<std::string> result;
+    result.push_back(std::string(40, 'a'));
+    result.push_back(tail);
+    result.emplace(result.begin() + 1, "b");
+    result.insert(result.begin(), 2, "c");
+    std::vector<std::string> source = {"d", "e"};
+    result.insert(result.end() - 1, source.begin(), source.end());
+    std::vector<std::string> expected = {"c", "c", std::string(40, 'a'), "b", "d", "e", tail};
+    REQUIRE(std::vector<std::string>(result.begin(), result.end()) == expected);
+    REQUIRE(result.emplace_back("f") == "f");
+    result.erase(result.begin() + 1, result.begin() + 4);
+    result.erase(result.begin());
+    expected = {"d", "e", tail, "f"};
+    REQUIRE(std::vector<std::string>(result.begin(), result.end()) == expected);
+    REQUIRE(result.back() == "f");
+    REQUIRE(result.size() == 4);
+  }
+}
+
+namespace {
+// Owns a pointer to itself, so it must never be moved by memcpy
+struct SelfReferencing {
+  int value;
+  SelfReferencing* self;
+
+  SelfReferencing(int value = 0) : value(value), self(this) {}
+  SelfReferencing(const SelfReferencing& other) : value(other.value), self(this) {}
+  SelfReferencing& operator=(const SelfReferencing& other) {
+    value = other.value;
+    return *this;
+  }
+};
+
+// Not trivially copyable, but safe to move around as bytes
+struct Handle {
+  int* resource;
+
+  explicit Handle(int value) : resource(new int(value)) {}
+  Handle(Handle&& other) noexcept : resource(other.resource) { other.resource = nullptr; }
+  Handle& operator=(Handle&& other) noexcept {
+    std::swap(resource, other.resource);
+    return *this;
+  }
+  ~Handle() { delete resource; }
+};
+
+// Copies throw once the countdown reaches zero, moves may throw as well
+struct ThrowingCopy {
+  static int countdown;
+  int value;
+
+  ThrowingCopy(int value = 0) : value(value) {}
+  ThrowingCopy(const ThrowingCopy& other) : value(other.value) {
+    if (--countdown == 0) {
+      throw std::runtime_error("copy");
+    }
+  }
+  ThrowingCopy(ThrowingCopy&& other) : ThrowingCopy(static_cast<const ThrowingCopy&>(other)) {}
+  ThrowingCopy& operator=(const ThrowingCopy&) = default;
+};
+int ThrowingCopy::countdown = 0;
+
+// Allocation fails once the countdown reaches zero
+int allocation_countdown = 0;
+
+template<typename T>
+struct ThrowingAllocator {
+  typedef T value_type;
+
+  ThrowingAllocator() = default;
+  template<typename U>
+  ThrowingAllocator(const ThrowingAllocator<U>&) noexcept {}
+
+  T* allocate(std::size_t count) {
+    if (--allocation_countdown == 0) {
+      throw std::bad_alloc();
+    }
+    return std::allocator<T>().allocate(count);
+  }
+  void deallocate(T* pointer, std::size_t count) noexcept {
+    std::allocator<T>().deallocate(pointer, count);
+  }
+  bool operator==(const ThrowingAllocator&) const noexcept { return true; }
+  bool operator!=(const ThrowingAllocator&) const noexcept { return false; }
+};
+} // namespace
+
+template<>
+struct tftl::is_trivially_relocatable<Handle> : std::true_type {};
+
+TEST_CASE("Element relocation") {
+
+  SECTION("Relocatability trait") {
+    REQUIRE(tftl::is_trivially_relocatable_v<int>);
+    REQUIRE(tftl::is_trivially_relocatable_v<std::unique_ptr<int>>);
+    REQUIRE(tftl::is_trivially_relocatable_v<Handle>);
+    REQUIRE_FALSE(tftl::is_trivially_relocatable_v<SelfReferencing>);
+  }
+
+  SECTION("Growth keeps move-only relocatable elements") {
+    tftl::vector<std::unique_ptr<int>> result;
+    for (int i = 0; i < 100; ++i) {
+      result.emplace_back(new int(i));
+    }
+    REQUIRE(result.size() == 100);
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(*result[i] == i);
+    }
+  }
+
+  SECTION("Insert and erase in the middle of opted-in type") {
+    tftl::vector<Handle> result;
+    for (int i = 0; i < 10; ++i) {
+      result.emplace_back(i);
+    }
+    result.emplace(result.begin() + 5, 42);
+    REQUIRE(result.size() == 11);
+    REQUIRE(*result[5].resource == 42);
+    REQUIRE(*result[6].resource == 5);
+    result.erase(result.begin() + 2, result.begin() + 4);
+    REQUIRE(result.size() == 9);
+    REQUIRE(*result[2].resource == 4);
+    REQUIRE(*result[8].resource == 9);
+  }
+
+  SECTION("Emplace an element of the vector itself") {
+    tftl::vector<int> result = {1, 2, 3};
+    result.emplace(result.begin(), result[2]);
+    std::vector<int> expected = {3, 1, 2, 3};
+    REQUIRE(result == expected);
+    result.insert(result.begin() + 1, 2, result[0]);
+    expected = {3, 3, 3, 1, 2, 3};
+    REQUIRE(result == expected);
+  }
+
+  SECTION("Growth of non-relocatable type goes through constructors") {
+    tftl::vector<SelfReferencing> result;
+    for (int i = 0; i < 50; ++i) {
+      const SelfReferencing element(i);
+      result.push_back(element);
+    }
+    result.reserve(200);
+    for (int i = 0; i < 50; ++i) {
+      REQUIRE(result[i].value == i);
+      REQUIRE(result[i].self == &result[i]);
+    }
+  }
+
+  SECTION("Throwing relocation leaves vector untouched") {
+    ThrowingCopy::countdown = 0;
+    tftl::vector<ThrowingCopy> result;
+    result.reserve(4);
+    for (int i = 0; i < 4; ++i) {
+      result.emplace_back(i);
+    }
+    size_t capacity = result.capacity();
+    ThrowingCopy::countdown = 3;
+    REQUIRE_THROWS(result.reserve(capacity + 1));
+    REQUIRE(result.capacity() == capacity);
+    REQUIRE(result.size() == 4);
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(result[i].value == i);
+    }
+  }
+
+  SECTION("Failed growth destroys the element built for emplace") {
+    allocation_countdown = 0;
+    tftl::vector<std::shared_ptr<int>, ThrowingAllocator<std::shared_ptr<int>>> result;
+    result.emplace_back(std::make_shared<int>(1));
+    std::shared_ptr<int> shared = std::make_shared<int>(2);
+    allocation_countdown = 1;
+    REQUIRE_THROWS_AS(result.emplace(result.begin(), shared), std::bad_alloc);
+    REQUIRE(shared.use_count() == 1);
+    REQUIRE(result.size() == 1);
+    REQUIRE(*result[0] == 1);
+  }
+}
+
+namespace {
+// Counts its copies and moves, and is not relocatable because of the std::string
+struct Tracked {
+  static int copies;
+  static int moves;
+  std::string value;
+
+  Tracked(int value = 0) : value(std::to_string(value)) {}
+  Tracked(const Tracked& other) : value(other.value) { ++copies; }
+  Tracked(Tracked&& other) noexcept : value(std::move(other.value)) { ++moves; }
+  Tracked& operator=(const Tracked& other) {
+    value = other.value;
+    ++copies;
+    return *this;
+  }
+  Tracked& operator=(Tracked&& other) noexcept {
+    value = std::move(other.value);
+    ++moves;
+    return *this;
+  }
+
+  static void reset() { copies = moves = 0; }
+};
+int Tracked::copies = 0;
+int Tracked::moves = 0;
+
+tftl::vector<Tracked> tracked(int count) {
+  tftl::vector<Tracked> result;
+  result.reserve(count * 2);
+  for (int i = 0; i < count; ++i) {
+    result.emplace_back(i);
+  }
+  Tracked::reset();
+  return result;
+}
+
+struct Member {
+  int value;
+};
+} // namespace
+
+TEST_CASE("Move-aware shifting") {
+
+  SECTION("Inserting an rvalue only moves the tail") {
+    tftl::vector<Tracked> result = tracked(100);
+    result.insert(result.begin() + 50, Tracked(-1));
+    REQUIRE(Tracked::copies == 0);
+    REQUIRE(Tracked::moves == 51); // into the new last slot, 49 shifts and into the gap
+    REQUIRE(result[50].value == "-1");
+    REQUIRE(result[51].value == "50");
+    REQUIRE(result[100].value == "99");
+
+    Tracked::reset();
+    result.emplace(result.begin(), 7);
+    REQUIRE(Tracked::copies == 0);
+    REQUIRE(result[0].value == "7");
+    REQUIRE(result[1].value == "0");
+  }
+
+  SECTION("Erase moves down") {
+    tftl::vector<Tracked> result = tracked(100);
+    result.erase(result.begin() + 10, result.begin() + 20);
+    REQUIRE(Tracked::copies == 0);
+    REQUIRE(Tracked::moves == 80);
+    REQUIRE(result[10].value == "20");
+  }
+
+  SECTION("Inserted values are the only copies") {
+    std::vector<Tracked> source(10, Tracked(-1));
+    for (int at : {0, 5, 95, 100}) {
+      tftl::vector<Tracked> result = tracked(100);
+      result.insert(result.begin() + at, source.begin(), source.end());
+      REQUIRE(Tracked::copies == 10);
+      REQUIRE(result.size() == 110);
+      REQUIRE(result[at].value == "-1");
+      REQUIRE(result[at + 9].value == "-1");
+      if (at < 100) {
+        REQUIRE(result[at + 10].value == std::to_string(at));
+      }
+      REQUIRE(result.back().value == (at == 100 ? "-1" : "99"));
+
+      result = tracked(100);
+      result.insert(result.begin() + at, 10, result[0]);
+      REQUIRE(Tracked::copies == 11); // and the one made aside, as the value lives in the vector
+      REQUIRE(result[at].value == "0");
+      REQUIRE(result[at + 9].value == "0");
+      REQUIRE(result.back().value == (at == 100 ? "0" : "99"));
+    }
+  }
+
+  SECTION("Appending an element of the vector itself while it grows") {
+    tftl::vector<std::string> words = {std::string(100, 'x')};
+    tftl::vector<int> numbers = {42};
+    for (int i = 0; i < 100; ++i) {
+      words.push_back(words[0]);
+      words.emplace_back(words.back());
+      numbers.push_back(numbers[0]);
+      numbers.push_back(std::move(numbers.back()));
+    }
+    REQUIRE(words.size() == 201);
+    REQUIRE(words[200] == std::string(100, 'x'));
+    REQUIRE(std::count(numbers.begin(), numbers.end(), 42) == 201);
+  }
+}
+
+TEST_CASE("Bulk construction") {
+
+  SECTION("Fills of repeated bytes and of patterns") {
+    for (std::size_t size : {std::size_t(0), std::size_t(1), std::size_t(1000), std::size_t(5) << 20}) {
+      for (int value : {0, -1, 7, 0x01020304}) {
+        tftl::vector<int> result(size, value);
+        REQUIRE(result.size() == size);
+        REQUIRE(std::count(result.begin(), result.end(), value) == static_cast<std::ptrdiff_t>(size));
+      }
+    }
+
+    // Non-temporal stores start at the first 16-byte boundary
+    std::allocator<std::uint16_t> alloc;
+    std::vector<std::uint16_t> buffer((std::size_t(9) << 20) + 3, 0);
+    std::uint16_t* last = tftl::uninitialized_fill_n(buffer.data() + 1, buffer.size() - 2, std::uint16_t(0x1234), alloc);
+    REQUIRE(last == buffer.data() + buffer.size() - 1);
+    REQUIRE(buffer.front() == 0);
+    REQUIRE(buffer.back() == 0);
+    REQUIRE(std::count(buffer.begin(), buffer.end(), 0x1234) == static_cast<std::ptrdiff_t>(buffer.size() - 2));
+  }
+
+  SECTION("Value initialization") {
+    tftl::vector<double> zeros(1000);
+    REQUIRE(std::count(zeros.begin(), zeros.end(), 0.0) == 1000);
+    zeros.assign(10, 1.5);
+    zeros.resize(20);
+    REQUIRE(zeros[9] == 1.5);
+    REQUIRE(zeros[19] == 0.0);
+
+    // Null pointers to members are not zero bytes
+    tftl::vector<int Member::*> members(100);
+    REQUIRE(members[0] == nullptr);
+    REQUIRE(members[99] == nullptr);
+  }
+
+  SECTION("Allocators with their own construct are called") {
+    REQUIRE(tftl::has_plain_construct<std::allocator<int>, int>::value);
+    REQUIRE_FALSE(tftl::has_plain_construct<tftl::default_init_allocator<int>, int>::value);
+    REQUIRE(tftl::has_plain_construct<tftl::default_init_allocator<int>, int, const int&>::value);
+    REQUIRE(tftl::has_plain_construct<std::pmr::polymorphic_allocator<int>, int, const int&>::value);
+    REQUIRE_FALSE(tftl::has_plain_construct<std::pmr::polymorphic_allocator<std::pmr::string>,
+                                            std::pmr::string, const std::pmr::string&>::value);
+
+    tftl::vector<int, tftl::default_init_allocator<int>> result(1000, 5);
+    tftl::vector<int, tftl::default_init_allocator<int>> copy = result;
+    REQUIRE(copy == result);
+    result.resize(0);
+    result.resize(1000);
+    REQUIRE(result[999] == 5);
+  }
+
+  SECTION("Streaming copies") {
+    std::size_t threshold = tftl::streaming_threshold();
+    tftl::set_streaming_threshold(1);
+    for (std::size_t size : {0, 1, 15, 16, 17, 63, 64, 65, 1001}) {
+      tftl::vector<float> source;
+      for (std::size_t i = 0; i < size; ++i) {
+        source.push_back(static_cast<float>(i) * 0.5f);
+      }
+      tftl::vector<float> copy = source;
+      REQUIRE(copy == source);
+      tftl::vector<float> assigned = {1.0f};
+      assigned = source;
+      REQUIRE(assigned == source);
+      assigned.reserve(assigned.capacity() + 100);
+      REQUIRE(assigned == source);
+
+      // Destinations and sources off the 16-byte boundary
+      tftl::vector<char> bytes(size + 3, 'x');
+      tftl::vector<char> shifted = {'a', 'b', 'c'};
+      shifted.insert(shifted.begin() + 1, bytes.begin() + 3, bytes.end());
+      REQUIRE(shifted.size() == size + 3);
+      REQUIRE(std::count(shifted.begin(), shifted.end(), 'x') == static_cast<std::ptrdiff_t>(size));
+      REQUIRE(shifted.back() == 'c');
+
+      tftl::vector<float> streamed = {2.0f, 3.0f};
+      streamed.copy_streaming(source);
+      REQUIRE(streamed == source);
+    }
+    tftl::set_streaming_threshold(threshold);
+    REQUIRE(tftl::streaming_threshold() == threshold);
+  }
+
+  SECTION("Copies keep their elements") {
+    tftl::vector<std::string> words(10, "word");
+    tftl::vector<std::string> copy = words;
+    REQUIRE(copy[9] == "word");
+    tftl::vector<std::string> other = {"a", "b"};
+    other = copy;
+    REQUIRE(other.size() == 10);
+    REQUIRE(other[9] == "word");
+  }
+}
+
+namespace {
+// Counts how often the block had to be copied instead of expanded
+template<typename T>
+struct ExpandCounting : tftl::malloc_allocator<T, 4096> {
+  static int expanded;
+  static int refused;
+
+  ExpandCounting() = default;
+
+  template<typename U>
+  ExpandCounting(const ExpandCounting<U>&) noexcept {}
+
+  template<typename U>
+  struct rebind {
+    typedef ExpandCounting<U> other;
+  };
+
+  T* try_expand(T* ptr, std::size_t old_n, std::size_t new_n) noexcept {
+    T* result = tftl::malloc_allocator<T, 4096>::try_expand(ptr, old_n, new_n);
+    ++(result != nullptr ? expanded : refused);
+    return result;
+  }
+};
+template<typename T>
+int ExpandCounting<T>::expanded = 0;
+template<typename T>
+int ExpandCounting<T>::refused = 0;
+} // namespace
+
+TEST_CASE("In-place growth") {
+
+  SECTION("Extension point detection") {
+    REQUIRE(tftl::has_try_expand_v<tftl::malloc_allocator<int>>);
+    REQUIRE_FALSE(tftl::has_try_expand_v<std::allocator<int>>);
+  }
+
+  SECTION("Heap and mapped blocks keep their contents") {
+    tftl::vector<int, tftl::malloc_allocator<int, 4096>> result;
+    for (int i = 0; i < 100000; ++i) {
+      result.push_back(i);
+    }
+    result.reserve(1 << 20);
+    REQUIRE(result.size() == 100000);
+    for (int i = 0; i < 100000; ++i) {
+      REQUIRE(result[i] == i);
+    }
+    result.shrink_to_fit();
+    REQUIRE(result.capacity() == result.size());
+    REQUIRE(result[99999] == 99999);
+  }
+
+  SECTION("Growth asks the allocator before copying") {
+    ExpandCounting<int>::expanded = ExpandCounting<int>::refused = 0;
+    tftl::vector<int, ExpandCounting<int>> result;
+    for (int i = 0; i < 10000; ++i) {
+      result.push_back(i);
+    }
+    REQUIRE(ExpandCounting<int>::expanded + ExpandCounting<int>::refused > 0);
+    REQUIRE(ExpandCounting<int>::expanded > 0);
+    for (int i = 0; i < 10000; ++i) {
+      REQUIRE(result[i] == i);
+    }
+  }
+
+  SECTION("Non-relocatable elements never use it") {
+    ExpandCounting<SelfReferencing>::expanded = ExpandCounting<SelfReferencing>::refused = 0;
+    tftl::vector<SelfReferencing, ExpandCounting<SelfReferencing>> result;
+    for (int i = 0; i < 100; ++i) {
+      const SelfReferencing element(i);
+      result.push_back(element);
+    }
+    REQUIRE(ExpandCounting<SelfReferencing>::expanded + ExpandCounting<SelfReferencing>::refused == 0);
+    REQUIRE(result[99].self == &result[99]);
+  }
+}
+
+TEST_CASE("Growth policies") {
+
+  SECTION("Policies are stateless") {
+    REQUIRE(sizeof(tftl::vector<int>) == sizeof(tftl::vector<int, std::allocator<int>, tftl::exact_growth>));
+#if defined(TFTL_HARDENED)
+    REQUIRE(sizeof(tftl::vector<int>) <= 5 * sizeof(int*)); // and the generation counter
+#else
+    REQUIRE(sizeof(tftl::vector<int>) <= 4 * sizeof(int*));
+#endif
+  }
+
+  SECTION("Default policy doubles") {
+    tftl::vector<int> result;
+    result.reserve(8);
+    for (int i = 0; i < 9; ++i) {
+      result.push_back(i);
+    }
+    REQUIRE(result.capacity() == 16);
+  }
+
+  SECTION("Growth by half") {
+    tftl::vector<int, std::allocator<int>, tftl::growth_factor<3, 2>> result;
+    result.reserve(8);
+    for (int i = 0; i < 9; ++i) {
+      result.push_back(i);
+    }
+    REQUIRE(result.capacity() == 12);
+    REQUIRE(result[8] == 8);
+  }
+
+  SECTION("Power of two byte sizes") {
+    struct Triple {
+      int a, b, c;
+    };
+    tftl::vector<Triple, std::allocator<Triple>, tftl::power_of_two_growth> result;
+    for (int i = 0; i < 1000; ++i) {
+      result.push_back(Triple{i, i, i});
+      size_t bytes = result.capacity() * sizeof(Triple);
+      size_t block = 1;
+      while (block < bytes) {
+        block <<= 1;
+      }
+      REQUIRE(block - bytes < sizeof(Triple));
+    }
+    REQUIRE(result[999].c == 999);
+  }
+
+  SECTION("Exact policy never over-allocates") {
+    tftl::vector<int, std::allocator<int>, tftl::exact_growth> result;
+    result.reserve(100);
+    for (int i = 0; i < 100; ++i) {
+      result.push_back(i);
+    }
+    REQUIRE(result.capacity() == 100);
+    result.push_back(100);
+    REQUIRE(result.capacity() == 101);
+  }
+}
+
+namespace {
+struct StatsTag {
+  static constexpr const char* name = "tests.stats";
+};
+
+template<typename T>
+using stats_vector = tftl::vector<T, std::allocator<T>, tftl::default_growth, tftl::tagged_stats<StatsTag>>;
+} // namespace
+
+TEST_CASE("Stats policy") {
+
+  SECTION("Disabled stats cost nothing") {
+    REQUIRE(std::is_empty<tftl::no_stats>::value);
+    REQUIRE(sizeof(tftl::vector<int>) == sizeof(stats_vector<int>));
+  }
+
+  SECTION("Growth is counted") {
+    tftl::stats_record& stats = tftl::tagged_stats<StatsTag>::record();
+    stats.reset();
+    {
+      stats_vector<int> result;
+      for (int i = 0; i < 100; ++i) {
+        result.push_back(i);
+      }
+      REQUIRE(stats.reallocations == 8);
+      REQUIRE(stats.bytes_moved == 127 * sizeof(int));
+    }
+    REQUIRE(stats.constructions == 100);
+    REQUIRE(stats.destructions == 100);
+    REQUIRE(stats.peak_size_bytes == 100 * sizeof(int));
+    REQUIRE(stats.peak_capacity_bytes == 128 * sizeof(int));
+    REQUIRE(stats.peak_wasted_bytes == 28 * sizeof(int));
+  }
+
+  SECTION("Erase and shrink see the peak") {
+    tftl::stats_record& stats = tftl::tagged_stats<StatsTag>::record();
+    stats.reset();
+    stats_vector<std::string> result(10, "value");
+    result.erase(result.begin() + 2, result.end());
+    result.shrink_to_fit();
+    REQUIRE(stats.peak_size_bytes == 10 * sizeof(std::string));
+    REQUIRE(stats.destructions == 8);
+    REQUIRE(result.capacity() == 2);
+  }
+
+  SECTION("Dump writes JSON per tag") {
+    tftl::tagged_stats<StatsTag>::record().reset();
+    stats_vector<int> result = {1, 2, 3};
+    std::ostringstream out;
+    tftl::dump_stats(out);
+    REQUIRE(out.str().find("\"tests.stats\": {\"constructions\": 3,") != std::string::npos);
+  }
+}
+
+namespace {
+struct RangeTag {
+  static constexpr const char* name = "tests.range";
+};
+
+// Hands out its numbers once, like a socket or a file read in a single pass
+struct InputOnly {
+  std::istringstream stream;
+
+  explicit InputOnly(const std::string& text) : stream(text) {}
+  std::istream_iterator<int> begin() { return std::istream_iterator<int>(stream); }
+  std::istream_iterator<int> end() { return std::istream_iterator<int>(); }
+};
+} // namespace
+
+TEST_CASE("Range operations") {
+
+  SECTION("Append a sized range with one reallocation") {
+    tftl::stats_record& stats = tftl::tagged_stats<RangeTag>::record();
+    stats.reset();
+    tftl::vector<int, std::allocator<int>, tftl::default_growth, tftl::tagged_stats<RangeTag>> result = {1, 2};
+    std::vector<int> batch(1000);
+    std::iota(batch.begin(), batch.end(), 3);
+    stats.reset();
+    result.append_range(batch);
+    REQUIRE(stats.reallocations == 1);
+    REQUIRE(stats.constructions == 1000);
+    REQUIRE(result.size() == 1002);
+    REQUIRE(result[2] == 3);
+    REQUIRE(result[1001] == 1002);
+  }
+
+  SECTION("Insert ranges in the middle") {
+    tftl::vector<int> numbers = {1, 5};
+    int middle[] = {2, 3, 4};
+    auto it = numbers.insert_range(numbers.begin() + 1, middle);
+    REQUIRE(*it == 2);
+    REQUIRE(numbers == std::vector<int>{1, 2, 3, 4, 5});
+
+    tftl::vector<std::string> words = {"a", "e"};
+    std::vector<std::string> source = {"b", "c", "d"};
+    words.insert_range(words.begin() + 1, source);
+    REQUIRE(std::vector<std::string>(words.begin(), words.end()) == std::vector<std::string>{"a", "b", "c", "d", "e"});
+  }
+
+  SECTION("Input-only ranges") {
+    tftl::vector<int> result = {0, 9};
+    InputOnly input("1 2 3 4 5 6 7 8");
+    result.insert_range(result.begin() + 1, input);
+    REQUIRE(result == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+
+    std::istringstream stream("10 11");
+    result.insert(result.end(), std::istream_iterator<int>(stream), std::istream_iterator<int>());
+    REQUIRE(result.size() == 12);
+    REQUIRE(result[11] == 11);
+  }
+
+  SECTION("Assign a range keeps the buffer") {
+    tftl::vector<std::string> result(16, "old");
+    std::size_t capacity = result.capacity();
+    std::string* data = result.data();
+    result.assign_range(std::vector<std::string>{"x", "y"});
+    REQUIRE(std::vector<std::string>(result.begin(), result.end()) == std::vector<std::string>{"x", "y"});
+    REQUIRE(result.capacity() == capacity);
+    REQUIRE(result.data() == data);
+
+    tftl::vector<long> widened;
+    widened.assign_range(std::vector<int>{1, 2, 3});
+    REQUIRE(widened[2] == 3);
+  }
+}
+
+TEST_CASE("Uninitialized resize") {
+
+  SECTION("Resize for overwrite keeps the old bytes") {
+    tftl::vector<unsigned char> result(64, 7);
+    unsigned char* data = result.data();
+    result.resize(0);
+    result.resize_for_overwrite(64);
+    REQUIRE(result.data() == data);
+    REQUIRE(result.size() == 64);
+    REQUIRE(result[63] == 7);
+    result.resize(0);
+    result.resize(64);
+    REQUIRE(result[63] == 0);
+  }
+
+  SECTION("Default init allocator") {
+    tftl::vector<unsigned char, tftl::default_init_allocator<unsigned char>> result(64, 7);
+    result.resize(0);
+    result.resize(64);
+    REQUIRE(result[63] == 7);
+    result.push_back(9);
+    REQUIRE(result[64] == 9);
+
+    tftl::vector<std::string, tftl::default_init_allocator<std::string>> words;
+    words.resize(3);
+    words.emplace_back("word");
+    REQUIRE(words[0].empty());
+    REQUIRE(words[3] == "word");
+  }
+
+  SECTION("Non-trivial elements are default constructed") {
+    tftl::vector<std::string> result = {"a"};
+    result.resize_for_overwrite(3);
+    REQUIRE(result[0] == "a");
+    REQUIRE(result[2].empty());
+    result.resize(5, std::string(40, 'x'));
+    REQUIRE(result[4] == std::string(40, 'x'));
+  }
+
+  SECTION("Resize and overwrite keeps what was written") {
+    tftl::vector<char> result = {'>'};
+    result.resize_and_overwrite(1 << 16, [](char* data, std::size_t count) {
+      REQUIRE(count == 1 << 16);
+      REQUIRE(data[0] == '>');
+      std::memcpy(data + 1, "abc", 3);
+      return 4;
+    });
+    REQUIRE(std::string(result.begin(), result.end()) == ">abc");
+    REQUIRE(result.capacity() >= 1 << 16);
+  }
+}
+
+namespace {
+// Checks every kernel level the CPU has against the generic loop and std::lexicographical_compare
+template<typename T>
+void check_kernels() {
+  for (int level = 0; level <= static_cast<int>(tftl::simd::detect()); ++level) {
+    auto isa = static_cast<tftl::simd::isa>(level);
+    for (std::size_t size : {0, 1, 3, 15, 16, 17, 63, 64, 65, 200}) {
+      std::vector<T> lhs(size), rhs;
+      for (std::size_t i = 0; i < size; ++i) {
+        lhs[i] = static_cast<T>((i * 7) % 100);
+      }
+      for (std::size_t at = 0; at <= size; ++at) {
+        rhs = lhs;
+        if (at < size) {
+          rhs[at] = static_cast<T>(rhs[at] + 1);
+        }
+        REQUIRE(tftl::simd::mismatch(lhs.data(), rhs.data(), size, isa) == at);
+        int order = tftl::simd::compare(lhs.data(), size, rhs.data(), size, isa);
+        REQUIRE((order < 0) == std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()));
+        REQUIRE((order == 0) == (at == size));
+        REQUIRE(tftl::simd::compare(rhs.data(), size, lhs.data(), size, isa) == -order);
+      }
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("Vectorized comparison") {
+
+  SECTION("Kernels agree with the generic path") {
+    check_kernels<char>();
+    check_kernels<unsigned char>();
+    check_kernels<short>();
+    check_kernels<int>();
+    check_kernels<long long>();
+    check_kernels<float>();
+    check_kernels<double>();
+  }
+
+  SECTION("Floating point semantics") {
+    tftl::vector<double> zero = {1.0, 0.0, 2.0};
+    tftl::vector<double> negative_zero = {1.0, -0.0, 2.0};
+    REQUIRE(zero == negative_zero);
+    REQUIRE(tftl::compare(zero, negative_zero) == 0);
+
+    tftl::vector<float> nan = {1.0f, NAN, 2.0f};
+    REQUIRE(nan != nan);
+    REQUIRE_FALSE(nan < nan);
+    tftl::vector<float> larger = {1.0f, NAN, 3.0f};
+    REQUIRE(nan < larger);
+  }
+
+  SECTION("Relational operators") {
+    tftl::vector<int> short_one = {1, 2};
+    tftl::vector<int> long_one = {1, 2, 0};
+    tftl::vector<int> bigger = {1, 3};
+    REQUIRE(short_one < long_one);
+    REQUIRE(long_one < bigger);
+    REQUIRE(bigger > short_one);
+    REQUIRE(short_one <= short_one);
+    REQUIRE(bigger >= long_one);
+    REQUIRE(tftl::compare(bigger, long_one) == 1);
+    REQUIRE(tftl::compare(short_one, long_one) == -1);
+
+    tftl::vector<std::string> words = {"a", "b"};
+    tftl::vector<std::string> other = {"a", "c"};
+    REQUIRE(words != other);
+    REQUIRE(words < other);
+    REQUIRE(tftl::compare(other, words) == 1);
+  }
+}
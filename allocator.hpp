@@ -0,0 +1,438 @@
+//
+// Created by truefinch on 16.06.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "memory.hpp"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace tftl {
+/**
+ * @brief tftl::has_try_expand detects the optional allocator extension
+ *
+ *   pointer try_expand(pointer ptr, size_type old_n, size_type new_n);
+ *
+ * It resizes the block ptr of old_n elements to new_n elements keeping its bytes, and returns
+ * the (possibly moved) block, or nullptr if it could not, in which case ptr is still valid.
+ * Containers only use it for trivially relocatable elements, since the bytes may be moved
+ * without calling any constructor.
+ */
+template<typename Allocator, typename = void>
+struct has_try_expand : std::false_type {};
+
+template<typename Allocator>
+struct has_try_expand<Allocator, std::void_t<decltype(std::declval<Allocator&>().try_expand(
+    std::declval<typename std::allocator_traits<Allocator>::pointer>(), std::size_t(), std::size_t()))>>
+    : std::true_type {};
+
+template<typename Allocator>
+constexpr bool has_try_expand_v = has_try_expand<Allocator>::value;
+
+/**
+ * @brief Calls alloc.try_expand if the allocator provides it, otherwise reports failure.
+ */
+template<typename Allocator>
+typename std::allocator_traits<Allocator>::pointer try_expand(Allocator& alloc,
+                                                              typename std::allocator_traits<Allocator>::pointer ptr,
+                                                              std::size_t old_n,
+                                                              std::size_t new_n) {
+  if constexpr (has_try_expand_v<Allocator>) {
+    return alloc.try_expand(ptr, old_n, new_n);
+  } else {
+    return nullptr;
+  }
+}
+
+/**
+ * @brief tftl::allocator_alignment is the alignment every block from Allocator is guaranteed to have.
+ * Allocators promise more than alignof(value_type) with a static constexpr std::size_t alignment member.
+ */
+template<typename Allocator, typename = void>
+struct allocator_alignment
+    : std::integral_constant<std::size_t, alignof(typename std::allocator_traits<Allocator>::value_type)> {};
+
+template<typename Allocator>
+struct allocator_alignment<Allocator, std::void_t<decltype(Allocator::alignment)>>
+    : std::integral_constant<std::size_t, Allocator::alignment> {};
+
+template<typename Allocator>
+constexpr std::size_t allocator_alignment_v = allocator_alignment<Allocator>::value;
+
+/**
+ * @brief Tells the compiler that ptr is aligned to Alignment bytes, as C++20 std::assume_aligned.
+ */
+template<std::size_t Alignment, typename T>
+inline T* assume_aligned(T* ptr) noexcept {
+  static_assert((Alignment & (Alignment - 1)) == 0, "tftl::assume_aligned: Alignment must be a power of two");
+  return static_cast<T*>(__builtin_assume_aligned(ptr, Alignment));
+}
+
+/**
+ * @brief tftl::malloc_allocator takes small blocks from malloc and maps big ones directly,
+ * so both can grow in place: with realloc on the heap and with mremap for the mappings.
+ *
+ * @tparam T The type of the elements.
+ * @tparam MapThreshold Blocks of at least that many bytes are mmap-backed.
+ */
+template<typename T, std::size_t MapThreshold = (std::size_t(1) << 20)>
+class malloc_allocator {
+  // malloc and realloc align to max_align_t only, over-aligned types need tftl::aligned_allocator
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "tftl::malloc_allocator: T must not be over-aligned, use tftl::aligned_allocator");
+ public:
+  // @formatter:off
+  typedef T              value_type;
+  typedef T*             pointer;
+  typedef std::size_t    size_type;
+  typedef std::true_type is_always_equal;
+  // @formatter:on
+
+  static constexpr std::size_t alignment = alignof(std::max_align_t);
+
+  template<typename U>
+  struct rebind {
+    typedef malloc_allocator<U, MapThreshold> other;
+  };
+
+  malloc_allocator() noexcept = default;
+
+  template<typename U>
+  malloc_allocator(const malloc_allocator<U, MapThreshold>&) noexcept {}
+
+  pointer allocate(size_type n);
+  void    deallocate(pointer ptr, size_type n) noexcept;
+  pointer try_expand(pointer ptr, size_type old_n, size_type new_n) noexcept;
+
+ private:
+  static bool        is_mapped(size_type n) noexcept;
+  static std::size_t mapping_size(size_type n) noexcept;
+};
+
+template<typename T, std::size_t MapThreshold>
+bool malloc_allocator<T, MapThreshold>::is_mapped(size_type n) noexcept {
+#if defined(__linux__)
+  return n * sizeof(T) >= MapThreshold;
+#else
+  return false;
+#endif
+}
+
+template<typename T, std::size_t MapThreshold>
+std::size_t malloc_allocator<T, MapThreshold>::mapping_size(size_type n) noexcept {
+#if defined(__linux__)
+  static const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  return (n * sizeof(T) + page - 1) / page * page;
+#else
+  return n * sizeof(T);
+#endif
+}
+
+template<typename T, std::size_t MapThreshold>
+typename malloc_allocator<T, MapThreshold>::pointer malloc_allocator<T, MapThreshold>::allocate(size_type n) {
+  void* block = nullptr;
+#if defined(__linux__)
+  if (is_mapped(n)) {
+    block = mmap(nullptr, mapping_size(n), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (block == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    return static_cast<pointer>(block);
+  }
+#endif
+  block = std::malloc(n * sizeof(T));
+  if (block == nullptr && n != 0) {
+    throw std::bad_alloc();
+  }
+  return static_cast<pointer>(block);
+}
+
+template<typename T, std::size_t MapThreshold>
+void malloc_allocator<T, MapThreshold>::deallocate(pointer ptr, size_type n) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+#if defined(__linux__)
+  if (is_mapped(n)) {
+    munmap(ptr, mapping_size(n));
+    return;
+  }
+#endif
+  std::free(ptr);
+}
+
+template<typename T, std::size_t MapThreshold>
+typename malloc_allocator<T, MapThreshold>::pointer malloc_allocator<T, MapThreshold>::try_expand(pointer ptr,
+                                                                                                  size_type old_n,
+                                                                                                  size_type new_n) noexcept {
+  if (ptr == nullptr || new_n == 0 || is_mapped(old_n) != is_mapped(new_n)) {
+    return nullptr;
+  }
+#if defined(__linux__)
+  if (is_mapped(old_n)) {
+    void* block = mremap(ptr, mapping_size(old_n), mapping_size(new_n), MREMAP_MAYMOVE);
+    return block == MAP_FAILED ? nullptr : static_cast<pointer>(block);
+  }
+#endif
+  return static_cast<pointer>(std::realloc(ptr, new_n * sizeof(T)));
+}
+
+template<typename T, typename U, std::size_t MapThreshold>
+bool operator==(const malloc_allocator<T, MapThreshold>&, const malloc_allocator<U, MapThreshold>&) noexcept {
+  return true;
+}
+
+template<typename T, typename U, std::size_t MapThreshold>
+bool operator!=(const malloc_allocator<T, MapThreshold>&, const malloc_allocator<U, MapThreshold>&) noexcept {
+  return false;
+}
+
+/**
+ * @brief tftl::aligned_allocator returns blocks aligned to Alignment bytes, so vectors using it
+ * can be scanned with aligned 32 or 64-byte loads from data().
+ *
+ * @tparam T The type of the elements.
+ * @tparam Alignment The alignment of every block, a power of two.
+ */
+template<typename T, std::size_t Alignment = 64>
+class aligned_allocator {
+  static_assert((Alignment & (Alignment - 1)) == 0, "tftl::aligned_allocator: Alignment must be a power of two");
+
+ public:
+  // @formatter:off
+  typedef T              value_type;
+  typedef T*             pointer;
+  typedef std::size_t    size_type;
+  typedef std::true_type is_always_equal;
+  // @formatter:on
+
+  static constexpr std::size_t alignment = std::max(Alignment, alignof(T));
+
+  template<typename U>
+  struct rebind {
+    typedef aligned_allocator<U, Alignment> other;
+  };
+
+  aligned_allocator() noexcept = default;
+
+  template<typename U>
+  aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+  pointer allocate(size_type n);
+  void    deallocate(pointer ptr, size_type n) noexcept;
+};
+
+template<typename T, std::size_t Alignment>
+typename aligned_allocator<T, Alignment>::pointer aligned_allocator<T, Alignment>::allocate(size_type n) {
+  if (n > std::numeric_limits<size_type>::max() / sizeof(T)) {
+    throw std::bad_array_new_length();
+  }
+  return static_cast<pointer>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+}
+
+template<typename T, std::size_t Alignment>
+void aligned_allocator<T, Alignment>::deallocate(pointer ptr, size_type n) noexcept {
+  ::operator delete(ptr, n * sizeof(T), std::align_val_t(alignment));
+}
+
+template<typename T, typename U, std::size_t Alignment>
+bool operator==(const aligned_allocator<T, Alignment>&, const aligned_allocator<U, Alignment>&) noexcept {
+  return true;
+}
+
+template<typename T, typename U, std::size_t Alignment>
+bool operator!=(const aligned_allocator<T, Alignment>&, const aligned_allocator<U, Alignment>&) noexcept {
+  return false;
+}
+
+/**
+ * @brief tftl::huge_page_allocator backs big blocks with 2 MiB pages, so long scans over them
+ * take a TLB miss every 2 MiB instead of every 4 KiB. Smaller blocks come 64-byte aligned from operator new.
+ *
+ * A big block is mapped from the explicit huge page pool (MAP_HUGETLB) when the administrator
+ * reserved one, which fails at mmap time rather than at the first touch because private
+ * mappings reserve their pages. Otherwise it is mapped 2 MiB aligned with ordinary pages and
+ * marked with madvise(MADV_HUGEPAGE) for the kernel to promote to transparent huge pages.
+ * Both kinds of mappings grow with mremap, see tftl::has_try_expand.
+ *
+ * @tparam T The type of the elements.
+ * @tparam HugeThreshold Blocks of at least that many bytes are backed by huge pages.
+ */
+template<typename T, std::size_t HugeThreshold = (std::size_t(2) << 20)>
+class huge_page_allocator {
+ public:
+  // @formatter:off
+  typedef T              value_type;
+  typedef T*             pointer;
+  typedef std::size_t    size_type;
+  typedef std::true_type is_always_equal;
+  // @formatter:on
+
+  static constexpr std::size_t alignment = std::max(std::size_t(64), alignof(T));
+  static constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+  template<typename U>
+  struct rebind {
+    typedef huge_page_allocator<U, HugeThreshold> other;
+  };
+
+  huge_page_allocator() noexcept = default;
+
+  template<typename U>
+  huge_page_allocator(const huge_page_allocator<U, HugeThreshold>&) noexcept {}
+
+  pointer allocate(size_type n);
+  void    deallocate(pointer ptr, size_type n) noexcept;
+  pointer try_expand(pointer ptr, size_type old_n, size_type new_n) noexcept;
+
+ private:
+  static bool        is_mapped(size_type n) noexcept;
+  static std::size_t mapping_size(size_type n) noexcept;
+};
+
+template<typename T, std::size_t HugeThreshold>
+bool huge_page_allocator<T, HugeThreshold>::is_mapped(size_type n) noexcept {
+#if defined(__linux__)
+  return n * sizeof(T) >= HugeThreshold;
+#else
+  return false;
+#endif
+}
+
+template<typename T, std::size_t HugeThreshold>
+std::size_t huge_page_allocator<T, HugeThreshold>::mapping_size(size_type n) noexcept {
+  return (n * sizeof(T) + huge_page_size - 1) / huge_page_size * huge_page_size;
+}
+
+template<typename T, std::size_t HugeThreshold>
+typename huge_page_allocator<T, HugeThreshold>::pointer huge_page_allocator<T, HugeThreshold>::allocate(size_type n) {
+  if (n > (std::numeric_limits<size_type>::max() - huge_page_size) / sizeof(T)) {
+    throw std::bad_array_new_length();
+  }
+#if defined(__linux__)
+  if (is_mapped(n)) {
+    std::size_t size = mapping_size(n);
+    void* block = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+    block = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (block != MAP_FAILED) {
+      return static_cast<pointer>(block);
+    }
+#endif
+    // Transparent huge pages only back aligned 2 MiB ranges: map one page more and trim both ends
+    block = mmap(nullptr, size + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (block == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    char* first = static_cast<char*>(block);
+    char* aligned = reinterpret_cast<char*>(
+        (reinterpret_cast<std::uintptr_t>(first) + huge_page_size - 1) & ~(huge_page_size - 1));
+    if (aligned != first) {
+      munmap(first, static_cast<std::size_t>(aligned - first));
+    }
+    if (aligned + size != first + size + huge_page_size) {
+      munmap(aligned + size, static_cast<std::size_t>(first + huge_page_size - aligned));
+    }
+#if defined(MADV_HUGEPAGE)
+    madvise(aligned, size, MADV_HUGEPAGE); // Only a hint, the block works without it
+#endif
+    return reinterpret_cast<pointer>(aligned);
+  }
+#endif
+  return static_cast<pointer>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+}
+
+template<typename T, std::size_t HugeThreshold>
+void huge_page_allocator<T, HugeThreshold>::deallocate(pointer ptr, size_type n) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+#if defined(__linux__)
+  if (is_mapped(n)) {
+    munmap(ptr, mapping_size(n));
+    return;
+  }
+#endif
+  ::operator delete(ptr, n * sizeof(T), std::align_val_t(alignment));
+}
+
+template<typename T, std::size_t HugeThreshold>
+typename huge_page_allocator<T, HugeThreshold>::pointer huge_page_allocator<T, HugeThreshold>::try_expand(pointer ptr,
+                                                                                                          size_type old_n,
+                                                                                                          size_type new_n) noexcept {
+#if defined(__linux__)
+  if (ptr != nullptr && is_mapped(old_n) && is_mapped(new_n)) {
+    void* block = mremap(ptr, mapping_size(old_n), mapping_size(new_n), MREMAP_MAYMOVE);
+    return block == MAP_FAILED ? nullptr : static_cast<pointer>(block);
+  }
+#endif
+  return nullptr;
+}
+
+template<typename T, typename U, std::size_t HugeThreshold>
+bool operator==(const huge_page_allocator<T, HugeThreshold>&, const huge_page_allocator<U, HugeThreshold>&) noexcept {
+  return true;
+}
+
+template<typename T, typename U, std::size_t HugeThreshold>
+bool operator!=(const huge_page_allocator<T, HugeThreshold>&, const huge_page_allocator<U, HugeThreshold>&) noexcept {
+  return false;
+}
+
+/**
+ * @brief tftl::default_init_allocator wraps Allocator and default-initializes elements constructed
+ * without arguments, so resize() of a vector of trivial types leaves the new elements uninitialized
+ * instead of zeroing them. Every other construction and all the memory handling go to Allocator.
+ *
+ * @tparam T The type of the elements.
+ * @tparam Allocator The wrapped allocator.
+ */
+template<typename T, typename Allocator = std::allocator<T>>
+class default_init_allocator : public Allocator {
+  typedef std::allocator_traits<Allocator> base_traits;
+
+ public:
+  template<typename U>
+  struct rebind {
+    typedef default_init_allocator<U, typename base_traits::template rebind_alloc<U>> other;
+  };
+
+  using Allocator::Allocator;
+
+  default_init_allocator() = default;
+
+  default_init_allocator(const Allocator& alloc) noexcept : Allocator(alloc) {}
+
+  template<typename U, typename OtherAllocator>
+  default_init_allocator(const default_init_allocator<U, OtherAllocator>& other) noexcept
+      : Allocator(static_cast<const OtherAllocator&>(other)) {}
+
+  template<typename U>
+  void construct(U* ptr) noexcept(std::is_nothrow_default_constructible<U>::value) {
+    ::new(static_cast<void*>(ptr)) U;
+  }
+
+  template<typename U, typename... Args>
+  void construct(U* ptr, Args&&... args) {
+    base_traits::construct(static_cast<Allocator&>(*this), ptr, std::forward<Args>(args)...);
+  }
+};
+
+// Only the construction without arguments differs from Allocator
+template<typename T, typename Allocator, typename U, typename First, typename... Rest>
+struct has_plain_construct<default_init_allocator<T, Allocator>, U, First, Rest...>
+    : has_plain_construct<Allocator, U, First, Rest...> {};
+} //namespace truefinch template library
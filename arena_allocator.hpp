@@ -0,0 +1,188 @@
+//
+// Created by truefinch on 24.06.18.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tftl {
+/**
+ * @brief tftl::monotonic_arena hands out memory by bumping a pointer through a list of chunks
+ * and frees it all at once.
+ *
+ * deallocate only takes back the most recent block, everything else is released in O(chunks)
+ * by release() or the destructor, which makes it a good fit for per-request scratch memory.
+ * It is not thread safe.
+ */
+class monotonic_arena {
+ public:
+  explicit monotonic_arena(std::size_t initial_size = 4096) noexcept;
+  monotonic_arena(void* buffer, std::size_t size) noexcept;
+  monotonic_arena(const monotonic_arena&) = delete;
+  monotonic_arena& operator=(const monotonic_arena&) = delete;
+  ~monotonic_arena();
+
+  void*       allocate(std::size_t bytes, std::size_t alignment);
+  void        deallocate(void* ptr, std::size_t bytes) noexcept;
+  void*       try_expand(void* ptr, std::size_t old_bytes, std::size_t new_bytes) noexcept;
+  void        release() noexcept;
+  std::size_t bytes_used() const noexcept;
+
+ private:
+  struct chunk {
+    chunk*      next;
+    std::size_t size;
+  };
+
+  chunk*      chunks_ = nullptr;  //Chunks taken from malloc, newest first
+  char*       cursor_ = nullptr;  //First free byte of the current chunk
+  char*       limit_ = nullptr;   //End of the current chunk
+  char*       last_ = nullptr;    //Start of the most recent block
+  char*       buffer_ = nullptr;  //Caller provided initial buffer, never freed
+  std::size_t buffer_size_ = 0;
+  std::size_t next_size_;
+  std::size_t used_ = 0;
+
+  void add_chunk(std::size_t min_bytes);
+};
+
+inline monotonic_arena::monotonic_arena(std::size_t initial_size) noexcept
+    : next_size_(initial_size < 64 ? 64 : initial_size) {}
+
+inline monotonic_arena::monotonic_arena(void* buffer, std::size_t size) noexcept
+    : cursor_(static_cast<char*>(buffer)), limit_(static_cast<char*>(buffer) + size),
+      buffer_(static_cast<char*>(buffer)), buffer_size_(size), next_size_(size < 64 ? 64 : size) {}
+
+inline monotonic_arena::~monotonic_arena() {
+  this->release();
+}
+
+inline void* monotonic_arena::allocate(std::size_t bytes, std::size_t alignment) {
+  std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(this->cursor_) + alignment - 1) & ~(alignment - 1);
+  if (this->cursor_ == nullptr || aligned + bytes > reinterpret_cast<std::uintptr_t>(this->limit_)) {
+    this->add_chunk(bytes + alignment);
+    aligned = (reinterpret_cast<std::uintptr_t>(this->cursor_) + alignment - 1) & ~(alignment - 1);
+  }
+
+  this->last_ = reinterpret_cast<char*>(aligned);
+  this->cursor_ = this->last_ + bytes;
+  this->used_ += bytes;
+  return this->last_;
+}
+
+// Only the most recent block can be given back, the rest waits for release()
+inline void monotonic_arena::deallocate(void* ptr, std::size_t bytes) noexcept {
+  if (ptr != nullptr && ptr == this->last_ && this->last_ + bytes == this->cursor_) {
+    this->cursor_ = this->last_;
+    this->used_ -= bytes;
+  }
+}
+
+// The most recent block grows in place while its chunk has room
+inline void* monotonic_arena::try_expand(void* ptr, std::size_t old_bytes, std::size_t new_bytes) noexcept {
+  if (ptr == nullptr || ptr != this->last_ || this->last_ + old_bytes != this->cursor_
+      || this->last_ + new_bytes > this->limit_) {
+    return nullptr;
+  }
+  this->cursor_ = this->last_ + new_bytes;
+  this->used_ = this->used_ - old_bytes + new_bytes;
+  return ptr;
+}
+
+inline void monotonic_arena::release() noexcept {
+  while (this->chunks_ != nullptr) {
+    chunk* next = this->chunks_->next;
+    std::free(this->chunks_);
+    this->chunks_ = next;
+  }
+  this->cursor_ = this->buffer_;
+  this->limit_ = this->buffer_ + this->buffer_size_;
+  this->last_ = nullptr;
+  this->used_ = 0;
+}
+
+inline std::size_t monotonic_arena::bytes_used() const noexcept {
+  return this->used_;
+}
+
+inline void monotonic_arena::add_chunk(std::size_t min_bytes) {
+  std::size_t size = this->next_size_;
+  while (size < min_bytes + sizeof(chunk)) {
+    size *= 2;
+  }
+
+  chunk* block = static_cast<chunk*>(std::malloc(size));
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  block->next = this->chunks_;
+  block->size = size;
+  this->chunks_ = block;
+  this->cursor_ = reinterpret_cast<char*>(block + 1);
+  this->limit_ = reinterpret_cast<char*>(block) + size;
+  this->next_size_ = size * 2;
+}
+
+/**
+ * @brief tftl::arena_allocator allocates from a tftl::monotonic_arena.
+ *
+ * Like std::pmr allocators it never propagates: a container keeps its arena for its whole life,
+ * and moving between containers of different arenas moves the elements one by one.
+ *
+ * @tparam T The type of the elements.
+ */
+template<typename T>
+class arena_allocator {
+ public:
+  // @formatter:off
+  typedef T               value_type;
+  typedef T*              pointer;
+  typedef std::size_t     size_type;
+  typedef std::false_type propagate_on_container_copy_assignment;
+  typedef std::false_type propagate_on_container_move_assignment;
+  typedef std::false_type propagate_on_container_swap;
+  typedef std::false_type is_always_equal;
+  // @formatter:on
+
+  arena_allocator(monotonic_arena& arena) noexcept : arena_(&arena) {}
+
+  template<typename U>
+  arena_allocator(const arena_allocator<U>& other) noexcept : arena_(other.arena()) {}
+
+  pointer allocate(size_type n) {
+    return static_cast<pointer>(this->arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(pointer ptr, size_type n) noexcept {
+    this->arena_->deallocate(ptr, n * sizeof(T));
+  }
+
+  pointer try_expand(pointer ptr, size_type old_n, size_type new_n) noexcept {
+    return static_cast<pointer>(this->arena_->try_expand(ptr, old_n * sizeof(T), new_n * sizeof(T)));
+  }
+
+  monotonic_arena* arena() const noexcept {
+    return this->arena_;
+  }
+
+ private:
+  monotonic_arena* arena_;
+};
+
+template<typename T, typename U>
+bool operator==(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) noexcept {
+  return lhs.arena() == rhs.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) noexcept {
+  return !(lhs == rhs);
+}
+} //namespace truefinch template library
@@ -0,0 +1,263 @@
+//
+// Created by truefinch on 27.06.18.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tftl {
+namespace bench {
+/**
+ * @brief tftl::bench::state drives the timed loop of one benchmark run, in the spirit of Google Benchmark:
+ *
+ *   while (state.keep_running()) { ... }
+ *
+ * Setup which must not be timed goes between pause_timing() and resume_timing().
+ */
+class state {
+ public:
+  // @formatter:off
+  typedef std::chrono::steady_clock clock;
+  // @formatter:on
+
+  state(std::size_t elements, std::size_t iterations) noexcept;
+
+  bool        keep_running();
+  void        pause_timing();
+  void        resume_timing();
+  std::size_t elements() const noexcept;
+  std::size_t iterations() const noexcept;
+  double      elapsed_ns() const noexcept;
+
+  void                                 counter(const std::string& name, double value);
+  const std::map<std::string, double>& counters() const noexcept;
+
+ private:
+  std::size_t                   elements_;
+  std::size_t                   iterations_;
+  std::size_t                   done_ = 0;
+  bool                          started_ = false;
+  clock::time_point             start_;
+  double                        elapsed_ns_ = 0;
+  std::map<std::string, double> counters_;
+};
+
+inline state::state(std::size_t elements, std::size_t iterations) noexcept
+    : elements_(elements), iterations_(iterations) {}
+
+inline bool state::keep_running() {
+  if (!this->started_) {
+    this->started_ = true;
+    this->start_ = clock::now();
+    return this->iterations_ > 0;
+  }
+  if (++(this->done_) < this->iterations_) {
+    return true;
+  }
+  this->pause_timing();
+  return false;
+}
+
+inline void state::pause_timing() {
+  std::chrono::duration<double, std::nano> elapsed = clock::now() - this->start_;
+  this->elapsed_ns_ += elapsed.count();
+}
+
+inline void state::resume_timing() {
+  this->start_ = clock::now();
+}
+
+inline std::size_t state::elements() const noexcept {
+  return this->elements_;
+}
+
+inline std::size_t state::iterations() const noexcept {
+  return this->iterations_;
+}
+
+inline double state::elapsed_ns() const noexcept {
+  return this->elapsed_ns_;
+}
+
+inline void state::counter(const std::string& name, double value) {
+  this->counters_[name] = value;
+}
+
+inline const std::map<std::string, double>& state::counters() const noexcept {
+  return this->counters_;
+}
+
+// Keeps the optimizer from dropping a computation whose result is otherwise unused
+template<typename T>
+inline void do_not_optimize(T& value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+typedef void (*function)(state&);
+
+/**
+ * @brief One case run by several contenders. The first contender is the baseline
+ * the others are reported against: std::vector in vector_bench, a plain loop in numeric_bench.
+ */
+struct benchmark {
+  std::string                                   name;
+  std::size_t                                   elements;
+  std::size_t                                   iterations; //0 calibrates against min_time
+  std::vector<std::pair<std::string, function>> contenders;
+};
+
+struct options {
+  std::size_t elements = 1000000;
+  double      min_time = 0.2;
+  std::string filter;
+  bool        json = true;
+};
+
+/**
+ * @brief Reads --elements=N, --min_time=SECONDS, --filter=SUBSTRING and --format=json|console.
+ */
+inline options parse(int argc, char** argv) {
+  options result;
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (std::strncmp(arg, "--elements=", 11) == 0) {
+      result.elements = std::strtoull(arg + 11, nullptr, 10);
+    } else if (std::strncmp(arg, "--min_time=", 11) == 0) {
+      result.min_time = std::strtod(arg + 11, nullptr);
+    } else if (std::strncmp(arg, "--filter=", 9) == 0) {
+      result.filter = arg + 9;
+    } else if (std::strcmp(arg, "--format=console") == 0) {
+      result.json = false;
+    } else if (std::strcmp(arg, "--format=json") == 0) {
+      result.json = true;
+    } else {
+      std::fprintf(stderr, "usage: %s [--elements=N] [--min_time=SECONDS] [--filter=SUBSTRING] "
+                           "[--format=json|console]\n", argv[0]);
+      std::exit(1);
+    }
+  }
+  return result;
+}
+
+class suite {
+ public:
+  void add(benchmark case_);
+  int  run(const options& opts) const;
+
+ private:
+  struct measurement {
+    std::string                   label;
+    std::size_t                   iterations;
+    double                        ns;
+    std::map<std::string, double> counters;
+  };
+
+  std::vector<benchmark> benchmarks_;
+
+  static measurement measure(const benchmark& case_, const std::pair<std::string, function>& contender, double min_time);
+  static std::string escape(const std::string& text);
+};
+
+inline void suite::add(benchmark case_) {
+  this->benchmarks_.push_back(std::move(case_));
+}
+
+// Doubles the iteration count, at most a hundredfold per step, until a run lasts min_time
+inline suite::measurement suite::measure(const benchmark& case_,
+                                         const std::pair<std::string, function>& contender,
+                                         double min_time) {
+  std::size_t iterations = case_.iterations == 0 ? 1 : case_.iterations;
+  while (true) {
+    state run(case_.elements, iterations);
+    contender.second(run);
+    double min_ns = min_time * 1e9;
+    if (case_.iterations != 0 || run.elapsed_ns() >= min_ns || iterations >= 1000000000) {
+      return {contender.first, iterations, run.elapsed_ns() / iterations, run.counters()};
+    }
+    double scale = run.elapsed_ns() <= 0 ? 100 : 1.4 * min_ns / run.elapsed_ns();
+    scale = scale < 2 ? 2 : (scale > 100 ? 100 : scale);
+    iterations = static_cast<std::size_t>(iterations * scale);
+  }
+}
+
+inline std::string suite::escape(const std::string& text) {
+  std::string result;
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+    }
+    result += c;
+  }
+  return result;
+}
+
+inline int suite::run(const options& opts) const {
+  if (opts.json) {
+    std::printf("{\n  \"context\": {\n");
+    std::printf("    \"elements\": %zu,\n    \"min_time\": %g,\n", opts.elements, opts.min_time);
+#ifdef NDEBUG
+    std::printf("    \"library_build_type\": \"release\"\n");
+#else
+    std::printf("    \"library_build_type\": \"debug\"\n");
+#endif
+    std::printf("  },\n  \"benchmarks\": [");
+  } else {
+    std::printf("%-36s %-46s %12s %16s %10s\n", "benchmark", "container", "iterations", "ns/iteration", "vs std");
+  }
+
+  bool first = true;
+  for (const benchmark& case_ : this->benchmarks_) {
+    if (case_.name.find(opts.filter) == std::string::npos) {
+      continue;
+    }
+
+    std::vector<measurement> results;
+    for (const auto& contender : case_.contenders) {
+      results.push_back(measure(case_, contender, opts.min_time));
+    }
+
+    if (opts.json) {
+      std::printf("%s\n    {\n      \"name\": \"%s\",\n      \"elements\": %zu,\n      \"baseline\": \"%s\",\n"
+                  "      \"results\": [", first ? "" : ",", escape(case_.name).c_str(), case_.elements,
+                  escape(results.front().label).c_str());
+      for (std::size_t i = 0; i < results.size(); ++i) {
+        const measurement& result = results[i];
+        std::printf("%s\n        {\"label\": \"%s\", \"iterations\": %zu, \"real_time\": %.2f, \"time_unit\": \"ns\", "
+                    "\"relative_to_baseline\": %.4f", i == 0 ? "" : ",", escape(result.label).c_str(),
+                    result.iterations, result.ns, result.ns / results.front().ns);
+        for (const auto& counter : result.counters) {
+          std::printf(", \"%s\": %.2f", escape(counter.first).c_str(), counter.second);
+        }
+        std::printf("}");
+      }
+      std::printf("\n      ]\n    }");
+    } else {
+      for (const measurement& result : results) {
+        std::printf("%-36s %-46s %12zu %16.1f %10.3f", case_.name.c_str(), result.label.c_str(), result.iterations,
+                    result.ns, result.ns / results.front().ns);
+        for (const auto& counter : result.counters) {
+          std::printf("  %s=%.0f", counter.first.c_str(), counter.second);
+        }
+        std::printf("\n");
+      }
+    }
+    std::fflush(stdout);
+    first = false;
+  }
+
+  if (opts.json) {
+    std::printf("\n  ]\n}\n");
+  }
+  return 0;
+}
+} // namespace bench
+} //namespace truefinch template library
@@ -0,0 +1,466 @@
+//
+// Created by truefinch on 09.07.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "vector.hpp"
+
+namespace tftl {
+/**
+ * @brief tftl::concurrent_vector is an append-only sequence that many threads may grow at once.
+ *
+ * Elements live in segments of 8, 16, 32, ... elements which are never moved or freed while the
+ * container lives, so pointers, references and iterators stay valid however much it grows.
+ * push_back, emplace_back, grow_by, reserve, operator[], at, size and capacity are safe to call concurrently;
+ * clear, assignment, swap and destruction are not. The size counts slots as soon as they are reserved,
+ * so an element may only be read by a thread that knows its construction finished, e.g. the thread
+ * that appended it or any thread after the producers are joined.
+ *
+ * Appends reserve their slots with a compare-and-swap on the size once the segments they need exist,
+ * so a failing allocation never leaves a hole. An element whose constructor may throw is built
+ * before its slot is reserved and moved in, which requires a non-throwing move constructor.
+ */
+template<typename T, typename Allocator = std::allocator<T>>
+class concurrent_vector {
+  // @formatter:off
+  typedef std::allocator_traits<Allocator>                 alloc_traits;
+ public:
+  typedef T                                                value_type;
+  typedef Allocator                                        allocator_type;
+  typedef std::size_t                                      size_type;
+  typedef std::ptrdiff_t                                   difference_type;
+  typedef value_type&                                      reference;
+  typedef const value_type&                                const_reference;
+  typedef typename alloc_traits::pointer                   pointer;
+  typedef typename alloc_traits::const_pointer             const_pointer;
+  typedef indexed_iterator<concurrent_vector, T>           iterator;
+  typedef indexed_iterator<const concurrent_vector, const T> const_iterator;
+  typedef std::reverse_iterator<iterator>                  reverse_iterator;
+  typedef std::reverse_iterator<const_iterator>            const_reverse_iterator;
+  // @formatter:on
+
+  concurrent_vector() noexcept(noexcept(Allocator())) : concurrent_vector(Allocator()) {}
+  explicit concurrent_vector(const Allocator& alloc) noexcept;
+  concurrent_vector(std::initializer_list<T> init, const Allocator& alloc = Allocator());
+  concurrent_vector(const concurrent_vector& other);
+  concurrent_vector(concurrent_vector&& other) noexcept;
+  ~concurrent_vector();
+
+  concurrent_vector& operator=(concurrent_vector other) noexcept;
+  void               swap(concurrent_vector& other) noexcept;
+  allocator_type     get_allocator() const;
+
+  //Element access
+  reference       at(size_type pos);
+  const_reference at(size_type pos) const;
+  reference       operator[](size_type pos);
+  const_reference operator[](size_type pos) const;
+  reference       front();
+  const_reference front() const;
+  reference       back();
+  const_reference back() const;
+
+  //Iterators
+  iterator               begin() noexcept;
+  const_iterator         begin() const noexcept;
+  const_iterator         cbegin() const noexcept;
+  iterator               end() noexcept;
+  const_iterator         end() const noexcept;
+  const_iterator         cend() const noexcept;
+  reverse_iterator       rbegin() noexcept;
+  const_reverse_iterator rbegin() const noexcept;
+  reverse_iterator       rend() noexcept;
+  const_reverse_iterator rend() const noexcept;
+
+  //Capacity
+  bool      empty() const noexcept;
+  size_type size() const noexcept;
+  size_type max_size() const noexcept;
+  size_type capacity() const noexcept;
+  void      reserve(size_type new_cap);
+
+  //Modifiers, all but clear are thread-safe
+  iterator push_back(const T& value);
+  iterator push_back(T&& value);
+  template<class... Args>
+  iterator emplace_back(Args&& ... args);
+  iterator grow_by(size_type count);
+  iterator grow_by(size_type count, const T& value);
+  template<class ForwardIt, class = typename std::enable_if<!std::is_integral<ForwardIt>::value>::type>
+  iterator grow_by(ForwardIt first, ForwardIt last);
+  void     clear() noexcept;
+
+ private:
+  static constexpr size_type first_log = 3;
+  static constexpr size_type segment_count = sizeof(size_type) * 8 - first_log;
+
+  static size_type segment_of(size_type index) noexcept;
+  static size_type segment_begin(size_type segment) noexcept;
+  static size_type segment_size(size_type segment) noexcept;
+
+  pointer   slot(size_type index) const noexcept;
+  void      allocate_segments(size_type count);
+  size_type reserve_slots(size_type count);
+  template<class Construct>
+  iterator  construct_slots(size_type count, Construct construct);
+  void      destroy_all() noexcept;
+
+  Allocator                alloc_;
+  std::atomic<size_type>   size_{0};
+  std::atomic<pointer>     segments_[segment_count] = {};
+};
+
+// Segment s holds the indices [8 * 2^s - 8, 8 * 2^(s + 1) - 8)
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::size_type concurrent_vector<T, Allocator>::segment_of(size_type index) noexcept {
+  return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(index + (size_type(1) << first_log)) - first_log;
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::size_type concurrent_vector<T, Allocator>::segment_begin(size_type segment) noexcept {
+  return (size_type(1) << (segment + first_log)) - (size_type(1) << first_log);
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::size_type concurrent_vector<T, Allocator>::segment_size(size_type segment) noexcept {
+  return size_type(1) << (segment + first_log);
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::pointer concurrent_vector<T, Allocator>::slot(size_type index) const noexcept {
+  size_type segment = segment_of(index);
+  return this->segments_[segment].load(std::memory_order_acquire) + (index - segment_begin(segment));
+}
+
+// Makes sure the first count slots have memory; racing threads allocate at most one extra segment each.
+// Segments are allocated in order, so the last one needed being there is enough
+template<typename T, typename Allocator>
+void concurrent_vector<T, Allocator>::allocate_segments(size_type count) {
+  if (count == 0 || this->segments_[segment_of(count - 1)].load(std::memory_order_acquire) != nullptr) {
+    return;
+  }
+  for (size_type segment = 0; segment <= segment_of(count - 1); ++segment) {
+    if (this->segments_[segment].load(std::memory_order_acquire) != nullptr) {
+      continue;
+    }
+    pointer memory = alloc_traits::allocate(this->alloc_, segment_size(segment));
+    pointer expected = nullptr;
+    if (!this->segments_[segment].compare_exchange_strong(expected, memory, std::memory_order_acq_rel)) {
+      alloc_traits::deallocate(this->alloc_, memory, segment_size(segment));
+    }
+  }
+}
+
+// Returns the first of count consecutive slots now owned by the caller
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::size_type concurrent_vector<T, Allocator>::reserve_slots(size_type count) {
+  if (count > this->max_size()) {
+    throw std::length_error("tftl::concurrent_vector::grow_by: count exceeds max_size()");
+  }
+  size_type index = this->size_.load(std::memory_order_relaxed);
+  do {
+    if (index > this->max_size() - count) {
+      throw std::length_error("tftl::concurrent_vector: size would exceed max_size()");
+    }
+    this->allocate_segments(index + count);
+  } while (!this->size_.compare_exchange_weak(index, index + count, std::memory_order_relaxed));
+  return index;
+}
+
+// construct(slot, i) must not throw, the slots are already counted by size()
+template<typename T, typename Allocator>
+template<class Construct>
+typename concurrent_vector<T, Allocator>::iterator concurrent_vector<T, Allocator>::construct_slots(size_type count,
+                                                                                                   Construct construct) {
+  size_type first = this->reserve_slots(count);
+  for (size_type i = 0; i < count; ++i) {
+    construct(this->slot(first + i), i);
+  }
+  return iterator(this, first);
+}
+
+template<typename T, typename Allocator>
+void concurrent_vector<T, Allocator>::destroy_all() noexcept {
+  size_type count = this->size_.load(std::memory_order_relaxed);
+  for (size_type segment = 0; segment < segment_count && segment_begin(segment) < count; ++segment) {
+    pointer memory = this->segments_[segment].load(std::memory_order_relaxed);
+    size_type end = std::min(segment_size(segment), count - segment_begin(segment));
+    for (size_type i = 0; i < end; ++i) {
+      alloc_traits::destroy(this->alloc_, std::addressof(memory[i]));
+    }
+  }
+  this->size_.store(0, std::memory_order_relaxed);
+}
+
+template<typename T, typename Allocator>
+concurrent_vector<T, Allocator>::concurrent_vector(const Allocator& alloc) noexcept : alloc_(alloc) {}
+
+// The constructors below delegate first, so the destructor frees the segments installed before a throw
+
+template<typename T, typename Allocator>
+concurrent_vector<T, Allocator>::concurrent_vector(std::initializer_list<T> init, const Allocator& alloc)
+    : concurrent_vector(alloc) {
+  this->grow_by(init.begin(), init.end());
+}
+
+template<typename T, typename Allocator>
+concurrent_vector<T, Allocator>::concurrent_vector(const concurrent_vector& other)
+    : concurrent_vector(alloc_traits::select_on_container_copy_construction(other.alloc_)) {
+  this->grow_by(other.begin(), other.end());
+}
+
+template<typename T, typename Allocator>
+concurrent_vector<T, Allocator>::concurrent_vector(concurrent_vector&& other) noexcept : alloc_(std::move(other.alloc_)) {
+  this->size_.store(other.size_.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+  for (size_type segment = 0; segment < segment_count; ++segment) {
+    this->segments_[segment].store(other.segments_[segment].exchange(nullptr, std::memory_order_relaxed),
+                                   std::memory_order_relaxed);
+  }
+}
+
+template<typename T, typename Allocator>
+concurrent_vector<T, Allocator>::~concurrent_vector() {
+  this->destroy_all();
+  for (size_type segment = 0; segment < segment_count; ++segment) {
+    pointer memory = this->segments_[segment].load(std::memory_order_relaxed);
+    if (memory != nullptr) {
+      alloc_traits::deallocate(this->alloc_, memory, segment_size(segment));
+    }
+  }
+}
+
+template<typename T, typename Allocator>
+concurrent_vector<T, Allocator>& concurrent_vector<T, Allocator>::operator=(concurrent_vector other) noexcept {
+  this->swap(other);
+  return *this;
+}
+
+template<typename T, typename Allocator>
+void concurrent_vector<T, Allocator>::swap(concurrent_vector& other) noexcept {
+  using std::swap;
+  swap(this->alloc_, other.alloc_);
+  this->size_.store(other.size_.exchange(this->size_.load(std::memory_order_relaxed), std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+  for (size_type segment = 0; segment < segment_count; ++segment) {
+    pointer mine = this->segments_[segment].load(std::memory_order_relaxed);
+    this->segments_[segment].store(other.segments_[segment].exchange(mine, std::memory_order_relaxed),
+                                   std::memory_order_relaxed);
+  }
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::allocator_type concurrent_vector<T, Allocator>::get_allocator() const {
+  return this->alloc_;
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::reference concurrent_vector<T, Allocator>::at(size_type pos) {
+  if (pos >= this->size()) {
+    throw std::out_of_range("tftl::concurrent_vector::at: pos >= size()");
+  }
+  return (*this)[pos];
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::const_reference concurrent_vector<T, Allocator>::at(size_type pos) const {
+  if (pos >= this->size()) {
+    throw std::out_of_range("tftl::concurrent_vector::at: pos >= size()");
+  }
+  return (*this)[pos];
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::reference concurrent_vector<T, Allocator>::operator[](size_type pos) {
+  return *this->slot(pos);
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::const_reference concurrent_vector<T, Allocator>::operator[](size_type pos) const {
+  return *this->slot(pos);
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::reference concurrent_vector<T, Allocator>::front() {
+  return (*this)[0];
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::const_reference concurrent_vector<T, Allocator>::front() const {
+  return (*this)[0];
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::reference concurrent_vector<T, Allocator>::back() {
+  return (*this)[this->size() - 1];
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::const_reference concurrent_vector<T, Allocator>::back() const {
+  return (*this)[this->size() - 1];
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::iterator concurrent_vector<T, Allocator>::begin() noexcept {
+  return iterator(this, 0);
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::const_iterator concurrent_vector<T, Allocator>::begin() const noexcept {
+  return const_iterator(this, 0);
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::const_iterator concurrent_vector<T, Allocator>::cbegin() const noexcept {
+  return this->begin();
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::iterator concurrent_vector<T, Allocator>::end() noexcept {
+  return iterator(this, this->size());
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::const_iterator concurrent_vector<T, Allocator>::end() const noexcept {
+  return const_iterator(this, this->size());
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::const_iterator concurrent_vector<T, Allocator>::cend() const noexcept {
+  return this->end();
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::reverse_iterator concurrent_vector<T, Allocator>::rbegin() noexcept {
+  return reverse_iterator(this->end());
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::const_reverse_iterator concurrent_vector<T, Allocator>::rbegin() const noexcept {
+  return const_reverse_iterator(this->end());
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::reverse_iterator concurrent_vector<T, Allocator>::rend() noexcept {
+  return reverse_iterator(this->begin());
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::const_reverse_iterator concurrent_vector<T, Allocator>::rend() const noexcept {
+  return const_reverse_iterator(this->begin());
+}
+
+template<typename T, typename Allocator>
+bool concurrent_vector<T, Allocator>::empty() const noexcept {
+  return this->size() == 0;
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::size_type concurrent_vector<T, Allocator>::size() const noexcept {
+  return this->size_.load(std::memory_order_acquire);
+}
+
+// The last segment would end past the largest size_type
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::size_type concurrent_vector<T, Allocator>::max_size() const noexcept {
+  return std::min<size_type>(segment_begin(segment_count - 1), alloc_traits::max_size(this->alloc_));
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::size_type concurrent_vector<T, Allocator>::capacity() const noexcept {
+  size_type segment = 0;
+  while (segment < segment_count && this->segments_[segment].load(std::memory_order_acquire) != nullptr) {
+    ++segment;
+  }
+  return segment_begin(segment);
+}
+
+template<typename T, typename Allocator>
+void concurrent_vector<T, Allocator>::reserve(size_type new_cap) {
+  if (new_cap > this->max_size()) {
+    throw std::length_error("tftl::concurrent_vector::reserve: new_cap > max_size()");
+  }
+  this->allocate_segments(new_cap);
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::iterator concurrent_vector<T, Allocator>::push_back(const T& value) {
+  return this->emplace_back(value);
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::iterator concurrent_vector<T, Allocator>::push_back(T&& value) {
+  return this->emplace_back(std::move(value));
+}
+
+template<typename T, typename Allocator>
+template<class... Args>
+typename concurrent_vector<T, Allocator>::iterator concurrent_vector<T, Allocator>::emplace_back(Args&& ... args) {
+  if constexpr (std::is_nothrow_constructible<T, Args&&...>::value) {
+    return this->construct_slots(1, [&](pointer slot, size_type) {
+      alloc_traits::construct(this->alloc_, std::addressof(*slot), std::forward<Args>(args)...);
+    });
+  } else {
+    static_assert(std::is_nothrow_move_constructible<T>::value,
+                  "tftl::concurrent_vector: T must be constructible from the arguments or movable without exceptions");
+    T value(std::forward<Args>(args)...);
+    return this->construct_slots(1, [&](pointer slot, size_type) {
+      alloc_traits::construct(this->alloc_, std::addressof(*slot), std::move(value));
+    });
+  }
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::iterator concurrent_vector<T, Allocator>::grow_by(size_type count) {
+  if constexpr (std::is_nothrow_default_constructible<T>::value) {
+    return this->construct_slots(count, [&](pointer slot, size_type) {
+      alloc_traits::construct(this->alloc_, std::addressof(*slot));
+    });
+  } else {
+    tftl::vector<T> values(count);
+    return this->grow_by(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+  }
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::iterator concurrent_vector<T, Allocator>::grow_by(size_type count, const T& value) {
+  if constexpr (std::is_nothrow_copy_constructible<T>::value) {
+    return this->construct_slots(count, [&](pointer slot, size_type) {
+      alloc_traits::construct(this->alloc_, std::addressof(*slot), value);
+    });
+  } else {
+    tftl::vector<T> values(count, value);
+    return this->grow_by(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+  }
+}
+
+template<typename T, typename Allocator>
+template<class ForwardIt, class>
+typename concurrent_vector<T, Allocator>::iterator concurrent_vector<T, Allocator>::grow_by(ForwardIt first, ForwardIt last) {
+  if constexpr (std::is_nothrow_constructible<T, typename std::iterator_traits<ForwardIt>::reference>::value) {
+    return this->construct_slots(std::distance(first, last), [&](pointer slot, size_type) {
+      alloc_traits::construct(this->alloc_, std::addressof(*slot), *first);
+      ++first;
+    });
+  } else {
+    static_assert(std::is_nothrow_move_constructible<T>::value,
+                  "tftl::concurrent_vector: T must be constructible from the elements or movable without exceptions");
+    tftl::vector<T> values(first, last);
+    return this->grow_by(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+  }
+}
+
+template<typename T, typename Allocator>
+void concurrent_vector<T, Allocator>::clear() noexcept {
+  this->destroy_all();
+}
+} //namespace truefinch template library
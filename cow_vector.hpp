@@ -0,0 +1,412 @@
+//
+// Created by truefinch on 20.07.18.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace tftl {
+/**
+ * @brief tftl::cow_vector shares one tftl::vector between its copies: a copy costs an atomic
+ * increment, and the elements are cloned only when a copy that still shares them is changed.
+ *
+ * The const interface is the one of tftl::vector, so readers take a cow_vector where they took a
+ * const vector&. There is no non-const element access, which would clone on every read through a
+ * non-const object: writers call set(), the modifiers, or unshare() for the vector itself.
+ *
+ * Reference counts are atomic, so copies may be handed to other threads. A single cow_vector object
+ * is not synchronized, as a vector is not. References and iterators taken from it are valid until it
+ * is changed or destroyed, and references from unshare() only until it is copied again.
+ */
+template<typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = tftl::default_growth,
+    typename Stats = tftl::no_stats>
+class cow_vector {
+ public:
+  // @formatter:off
+  typedef tftl::vector<T, Allocator, GrowthPolicy, Stats>  vector_type;
+  typedef typename vector_type::value_type                 value_type;
+  typedef typename vector_type::allocator_type             allocator_type;
+  typedef typename vector_type::size_type                  size_type;
+  typedef typename vector_type::difference_type            difference_type;
+  typedef typename vector_type::const_reference            const_reference;
+  typedef typename vector_type::const_pointer              const_pointer;
+  typedef typename vector_type::iterator                   iterator;
+  typedef tftl::iterator<const T>                          const_iterator;
+  typedef std::reverse_iterator<const_iterator>            const_reverse_iterator;
+  // @formatter:on
+
+  // construct/copy/destroy:
+  cow_vector() noexcept = default;
+  explicit cow_vector(vector_type values);
+  cow_vector(std::initializer_list<T> init);
+  cow_vector(const cow_vector& other) noexcept;
+  cow_vector(cow_vector&& other) noexcept;
+  ~cow_vector();
+
+  cow_vector& operator=(cow_vector other) noexcept;
+
+  // Element access:
+  const_reference at(size_type pos) const;
+  const_reference operator[](size_type pos) const;
+  const_reference front() const;
+  const_reference back() const;
+  const T*        data() const noexcept;
+
+  // Iterators:
+  const_iterator         begin() const noexcept;
+  const_iterator         cbegin() const noexcept;
+  const_iterator         end() const noexcept;
+  const_iterator         cend() const noexcept;
+  const_reverse_iterator rbegin() const noexcept;
+  const_reverse_iterator crbegin() const noexcept;
+  const_reverse_iterator rend() const noexcept;
+  const_reverse_iterator crend() const noexcept;
+
+  // Capacity:
+  bool      empty() const noexcept;
+  size_type size() const noexcept;
+  size_type max_size() const noexcept;
+  size_type capacity() const noexcept;
+  void      reserve(size_type new_cap);
+  void      shrink_to_fit();
+
+  // Sharing:
+  const vector_type& values() const noexcept;
+  size_type          use_count() const noexcept;
+  bool               unique() const noexcept;
+  vector_type&       unshare();
+
+  // Modifier:
+  void     clear() noexcept;
+  void     set(size_type pos, const T& value);
+  void     set(size_type pos, T&& value);
+  iterator insert(const_iterator pos, const T& value);
+  iterator insert(const_iterator pos, T&& value);
+  iterator erase(const_iterator pos);
+  iterator erase(const_iterator first, const_iterator last);
+  void     push_back(const T& value);
+  void     push_back(T&& value);
+  template<class... Args>
+  const_reference emplace_back(Args&&... args);
+  void     pop_back();
+  void     resize(size_type count);
+  void     resize(size_type count, const value_type& value);
+
+  void     swap(cow_vector& other) noexcept;
+
+ private:
+  struct block {
+    std::atomic<std::size_t> references{1};
+    vector_type              values;
+
+    explicit block(vector_type values) : values(std::move(values)) {}
+  };
+
+  block* block_ = nullptr; //Shared buffer, nullptr while the vector is empty and has no capacity
+
+  static const vector_type& empty_values() noexcept;
+  void release() noexcept;
+};
+
+// construct/copy/destroy:
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+cow_vector<T, Allocator, GrowthPolicy, Stats>::cow_vector(vector_type values) : block_(new block(std::move(values))) {
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+cow_vector<T, Allocator, GrowthPolicy, Stats>::cow_vector(std::initializer_list<T> init) : cow_vector(vector_type(init)) {
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+cow_vector<T, Allocator, GrowthPolicy, Stats>::cow_vector(const cow_vector& other) noexcept : block_(other.block_) {
+  if (this->block_ != nullptr) {
+    this->block_->references.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+cow_vector<T, Allocator, GrowthPolicy, Stats>::cow_vector(cow_vector&& other) noexcept : block_(other.block_) {
+  other.block_ = nullptr;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+cow_vector<T, Allocator, GrowthPolicy, Stats>::~cow_vector() {
+  this->release();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+cow_vector<T, Allocator, GrowthPolicy, Stats>& cow_vector<T, Allocator, GrowthPolicy, Stats>::operator=(cow_vector other) noexcept {
+  this->swap(other);
+  return *this;
+}
+
+// Element access:
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_reference cow_vector<T, Allocator, GrowthPolicy, Stats>::at(size_type pos) const {
+  return this->values().at(pos);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_reference cow_vector<T, Allocator, GrowthPolicy, Stats>::operator[](size_type pos) const {
+  return this->values()[pos];
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_reference cow_vector<T, Allocator, GrowthPolicy, Stats>::front() const {
+  return this->values().front();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_reference cow_vector<T, Allocator, GrowthPolicy, Stats>::back() const {
+  return this->values().back();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+const T* cow_vector<T, Allocator, GrowthPolicy, Stats>::data() const noexcept {
+  return this->values().data();
+}
+
+// Iterators:
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_iterator cow_vector<T, Allocator, GrowthPolicy, Stats>::begin() const noexcept {
+  return this->values().begin();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_iterator cow_vector<T, Allocator, GrowthPolicy, Stats>::cbegin() const noexcept {
+  return this->values().cbegin();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_iterator cow_vector<T, Allocator, GrowthPolicy, Stats>::end() const noexcept {
+  return this->values().end();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_iterator cow_vector<T, Allocator, GrowthPolicy, Stats>::cend() const noexcept {
+  return this->values().cend();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_reverse_iterator cow_vector<T, Allocator, GrowthPolicy, Stats>::rbegin() const noexcept {
+  return const_reverse_iterator(this->end());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_reverse_iterator cow_vector<T, Allocator, GrowthPolicy, Stats>::crbegin() const noexcept {
+  return const_reverse_iterator(this->end());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_reverse_iterator cow_vector<T, Allocator, GrowthPolicy, Stats>::rend() const noexcept {
+  return const_reverse_iterator(this->begin());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_reverse_iterator cow_vector<T, Allocator, GrowthPolicy, Stats>::crend() const noexcept {
+  return const_reverse_iterator(this->begin());
+}
+
+// Capacity:
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool cow_vector<T, Allocator, GrowthPolicy, Stats>::empty() const noexcept {
+  return this->values().empty();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::size_type cow_vector<T, Allocator, GrowthPolicy, Stats>::size() const noexcept {
+  return this->values().size();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::size_type cow_vector<T, Allocator, GrowthPolicy, Stats>::max_size() const noexcept {
+  return this->values().max_size();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::size_type cow_vector<T, Allocator, GrowthPolicy, Stats>::capacity() const noexcept {
+  return this->values().capacity();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void cow_vector<T, Allocator, GrowthPolicy, Stats>::reserve(size_type new_cap) {
+  if (new_cap > this->capacity()) {
+    this->unshare().reserve(new_cap);
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void cow_vector<T, Allocator, GrowthPolicy, Stats>::shrink_to_fit() {
+  if (this->size() != this->capacity()) {
+    this->unshare().shrink_to_fit();
+  }
+}
+
+// Sharing:
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+const typename cow_vector<T, Allocator, GrowthPolicy, Stats>::vector_type& cow_vector<T, Allocator, GrowthPolicy, Stats>::values() const noexcept {
+  return this->block_ != nullptr ? this->block_->values : empty_values();
+}
+
+// Number of cow_vectors sharing the buffer, 0 for an empty one without a buffer
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::size_type cow_vector<T, Allocator, GrowthPolicy, Stats>::use_count() const noexcept {
+  return this->block_ != nullptr ? this->block_->references.load(std::memory_order_acquire) : 0;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool cow_vector<T, Allocator, GrowthPolicy, Stats>::unique() const noexcept {
+  return this->use_count() <= 1;
+}
+
+// Clones the elements if the buffer is shared, then gives the vector to change in place
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::vector_type& cow_vector<T, Allocator, GrowthPolicy, Stats>::unshare() {
+  if (this->block_ == nullptr) {
+    this->block_ = new block(vector_type());
+  } else if (this->block_->references.load(std::memory_order_acquire) != 1) {
+    block* copy = new block(this->block_->values);
+    this->release();
+    this->block_ = copy;
+  }
+  return this->block_->values;
+}
+
+// Modifier:
+// A shared buffer is only let go, nothing is copied
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void cow_vector<T, Allocator, GrowthPolicy, Stats>::clear() noexcept {
+  this->release();
+  this->block_ = nullptr;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void cow_vector<T, Allocator, GrowthPolicy, Stats>::set(size_type pos, const T& value) {
+  if (this->unique()) {
+    this->unshare()[pos] = value;
+  } else {
+    T copy(value); // value may live in the buffer about to be released
+    this->unshare()[pos] = std::move(copy);
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void cow_vector<T, Allocator, GrowthPolicy, Stats>::set(size_type pos, T&& value) {
+  this->unshare()[pos] = std::move(value);
+}
+
+// Positions are turned into indices first, they point into the buffer which unshare() may replace
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::iterator cow_vector<T, Allocator, GrowthPolicy, Stats>::insert(const_iterator pos, const T& value) {
+  size_type index = pos - this->cbegin();
+  if (this->unique()) {
+    vector_type& values = this->unshare();
+    return values.insert(values.begin() + index, value);
+  }
+  T copy(value); // value may live in the buffer about to be released
+  vector_type& values = this->unshare();
+  return values.insert(values.begin() + index, std::move(copy));
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::iterator cow_vector<T, Allocator, GrowthPolicy, Stats>::insert(const_iterator pos, T&& value) {
+  size_type index = pos - this->cbegin();
+  vector_type& values = this->unshare();
+  return values.insert(values.begin() + index, std::move(value));
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::iterator cow_vector<T, Allocator, GrowthPolicy, Stats>::erase(const_iterator pos) {
+  return this->erase(pos, pos + 1);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::iterator cow_vector<T, Allocator, GrowthPolicy, Stats>::erase(const_iterator first, const_iterator last) {
+  size_type index = first - this->cbegin();
+  size_type count = last - first;
+  vector_type& values = this->unshare();
+  return values.erase(values.begin() + index, values.begin() + index + count);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void cow_vector<T, Allocator, GrowthPolicy, Stats>::push_back(const T& value) {
+  this->emplace_back(value);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void cow_vector<T, Allocator, GrowthPolicy, Stats>::push_back(T&& value) {
+  this->emplace_back(std::move(value));
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+template<class... Args>
+typename cow_vector<T, Allocator, GrowthPolicy, Stats>::const_reference cow_vector<T, Allocator, GrowthPolicy, Stats>::emplace_back(Args&& ... args) {
+  if (this->unique()) {
+    return this->unshare().emplace_back(std::forward<Args>(args)...);
+  }
+  T element(std::forward<Args>(args)...); // args may refer to the buffer about to be released
+  return this->unshare().emplace_back(std::move(element));
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void cow_vector<T, Allocator, GrowthPolicy, Stats>::pop_back() {
+  this->unshare().pop_back();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void cow_vector<T, Allocator, GrowthPolicy, Stats>::resize(size_type count) {
+  if (count != this->size()) {
+    this->unshare().resize(count);
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void cow_vector<T, Allocator, GrowthPolicy, Stats>::resize(size_type count, const value_type& value) {
+  if (count != this->size()) {
+    this->unshare().resize(count, value);
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void cow_vector<T, Allocator, GrowthPolicy, Stats>::swap(cow_vector& other) noexcept {
+  std::swap(this->block_, other.block_);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+const typename cow_vector<T, Allocator, GrowthPolicy, Stats>::vector_type& cow_vector<T, Allocator, GrowthPolicy, Stats>::empty_values() noexcept {
+  static const vector_type values;
+  return values;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void cow_vector<T, Allocator, GrowthPolicy, Stats>::release() noexcept {
+  if (this->block_ != nullptr && this->block_->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this->block_;
+  }
+}
+
+// Operators
+// Copies sharing a buffer are equal without looking at the elements
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool operator==(const cow_vector<T, Allocator, GrowthPolicy, Stats>& lhs, const cow_vector<T, Allocator, GrowthPolicy, Stats>& rhs) {
+  return &lhs.values() == &rhs.values() || lhs.values() == rhs.values();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool operator!=(const cow_vector<T, Allocator, GrowthPolicy, Stats>& lhs, const cow_vector<T, Allocator, GrowthPolicy, Stats>& rhs) {
+  return !(lhs == rhs);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void swap(cow_vector<T, Allocator, GrowthPolicy, Stats>& lhs, cow_vector<T, Allocator, GrowthPolicy, Stats>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+} //namespace truefinch template library
@@ -0,0 +1,1018 @@
+//
+// Created by truefinch on 21.07.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "growth_policy.hpp"
+#include "iterator.hpp"
+#include "memory.hpp"
+
+namespace tftl {
+/**
+ * @brief tftl::devector is a contiguous sequence with spare capacity at both ends, so push_front,
+ * emplace_front and pop_front take amortized O(1) like their back counterparts.
+ *
+ * When one end runs out of room while at most half of the buffer is in use, the elements are
+ * centered again in place, otherwise the buffer grows by GrowthPolicy and the free space is split
+ * between both ends. A middle insert or erase shifts the elements on the shorter side of it.
+ * Iterators are tftl::iterator, plain random access pointers as those of tftl::vector.
+ *
+ * @tparam T The type of the elements.
+ * @tparam Allocator An allocator that is used to acquire/release memory
+ * and to construct/destroy the elements in that memory.
+ * @tparam GrowthPolicy A stateless policy choosing the new capacity, see growth_policy.hpp.
+ */
+template<typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = tftl::default_growth>
+class devector {
+ public:
+  // @formatter:off
+  typedef T                                      value_type;
+  typedef Allocator                              allocator_type;
+  typedef GrowthPolicy                           growth_policy;
+  typedef std::size_t                            size_type;
+  typedef std::ptrdiff_t                         difference_type;
+  typedef value_type&                            reference;
+  typedef const value_type&                      const_reference;
+  typedef T*                                     pointer;
+  typedef const T*                               const_pointer;
+  typedef tftl::iterator <value_type>            iterator;
+  typedef tftl::iterator <const value_type>      const_iterator;
+  typedef std::reverse_iterator <iterator>       reverse_iterator;
+  typedef std::reverse_iterator <const_iterator> const_reverse_iterator;
+  // @formatter:on
+
+  // construct/copy/destroy:
+  devector() noexcept(noexcept(Allocator())) = default;
+  explicit devector(const Allocator& alloc) noexcept;
+  explicit devector(size_type count, const Allocator& alloc = Allocator());
+  devector(size_type count, const T& value, const Allocator& alloc = Allocator());
+  template<typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+  devector(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+  devector(std::initializer_list<T> init, const Allocator& alloc = Allocator());
+  devector(const devector& other);
+  devector(devector&& other) noexcept;
+  ~devector();
+
+  devector& operator=(devector other) noexcept;
+
+  allocator_type get_allocator() const;
+
+  // Element access:
+  reference       at(size_type pos);
+  const_reference at(size_type pos) const;
+  reference       operator[](size_type pos);
+  const_reference operator[](size_type pos) const;
+  reference       front();
+  const_reference front() const;
+  reference       back();
+  const_reference back() const;
+  T*              data() noexcept;
+  const T*        data() const noexcept;
+
+  // Iterators:
+  iterator               begin() noexcept;
+  const_iterator         begin() const noexcept;
+  const_iterator         cbegin() const noexcept;
+  iterator               end() noexcept;
+  const_iterator         end() const noexcept;
+  const_iterator         cend() const noexcept;
+  reverse_iterator       rbegin() noexcept;
+  const_reverse_iterator rbegin() const noexcept;
+  reverse_iterator       rend() noexcept;
+  const_reverse_iterator rend() const noexcept;
+
+  // Capacity:
+  bool      empty() const noexcept;
+  size_type size() const noexcept;
+  size_type max_size() const noexcept;
+  size_type capacity() const noexcept;
+  size_type front_free_capacity() const noexcept;
+  size_type back_free_capacity() const noexcept;
+  void      reserve(size_type new_cap);
+  void      reserve_front(size_type count);
+  void      reserve_back(size_type count);
+  void      shrink_to_fit();
+
+  // Modifier:
+  void clear() noexcept;
+  iterator insert(const_iterator pos, const T& value);
+  iterator insert(const_iterator pos, T&& value);
+  template<class... Args>
+  iterator emplace(const_iterator pos, Args&&... args);
+  iterator erase(const_iterator pos);
+  iterator erase(const_iterator first, const_iterator last);
+  void push_front(const T& value);
+  void push_front(T&& value);
+  template<class... Args>
+  reference emplace_front(Args&&... args);
+  void pop_front();
+  void push_back(const T& value);
+  void push_back(T&& value);
+  template<class... Args>
+  reference emplace_back(Args&&... args);
+  void pop_back();
+  void resize(size_type count);
+  void resize(size_type count, const value_type& value);
+
+  void swap(devector& other) noexcept;
+
+ private:
+  typedef std::allocator_traits<Allocator> alloc_traits;
+
+  Allocator allocator_;
+
+  pointer storage_ = nullptr; //Start of the buffer
+  pointer head_ = nullptr;    //Pointer to the first element
+  pointer tail_ = nullptr;    //Pointer past the last element
+  pointer peak_ = nullptr;    //End of the buffer
+
+  // Methods to manipulate with memory by using allocator:
+  void make_room(size_type front, size_type back);
+  void reallocate(size_type new_capacity, size_type front_free);
+  void destroy(pointer first, pointer last) noexcept;
+  void recenter_if_empty() noexcept;
+};
+
+// construct/copy/destroy:
+template<typename T, typename Allocator, typename GrowthPolicy>
+devector<T, Allocator, GrowthPolicy>::devector(const Allocator& alloc) noexcept : allocator_(alloc) {
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+devector<T, Allocator, GrowthPolicy>::devector(size_type count, const Allocator& alloc) : devector(alloc) {
+  this->resize(count);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+devector<T, Allocator, GrowthPolicy>::devector(size_type count, const T& value, const Allocator& alloc) : devector(alloc) {
+  this->resize(count, value);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+template<typename InputIt, typename>
+devector<T, Allocator, GrowthPolicy>::devector(InputIt first, InputIt last, const Allocator& alloc) : devector(alloc) {
+  if constexpr (std::is_base_of<std::forward_iterator_tag,
+                                typename std::iterator_traits<InputIt>::iterator_category>::value) {
+    this->reserve(std::distance(first, last));
+  }
+  for (; first != last; ++first) {
+    this->emplace_back(*first);
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+devector<T, Allocator, GrowthPolicy>::devector(std::initializer_list<T> init, const Allocator& alloc)
+    : devector(init.begin(), init.end(), alloc) {
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+devector<T, Allocator, GrowthPolicy>::devector(const devector& other)
+    : devector(alloc_traits::select_on_container_copy_construction(other.allocator_)) {
+  this->reserve(other.size());
+  this->tail_ = tftl::uninitialized_copy_n(other.head_, other.size(), this->head_, this->allocator_);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+devector<T, Allocator, GrowthPolicy>::devector(devector&& other) noexcept
+    : allocator_(std::move(other.allocator_)), storage_(other.storage_), head_(other.head_), tail_(other.tail_),
+      peak_(other.peak_) {
+  other.storage_ = other.head_ = other.tail_ = other.peak_ = nullptr;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+devector<T, Allocator, GrowthPolicy>::~devector() {
+  this->destroy(this->head_, this->tail_);
+  alloc_traits::deallocate(this->allocator_, this->storage_, this->capacity());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+devector<T, Allocator, GrowthPolicy>& devector<T, Allocator, GrowthPolicy>::operator=(devector other) noexcept {
+  this->swap(other);
+  return *this;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::allocator_type devector<T, Allocator, GrowthPolicy>::get_allocator() const {
+  return this->allocator_;
+}
+
+// Element access:
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::reference devector<T, Allocator, GrowthPolicy>::at(size_type pos) {
+  if (pos >= this->size()) {
+    throw std::out_of_range("tftl::devector::at: index out of range");
+  }
+  return this->head_[pos];
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::const_reference devector<T, Allocator, GrowthPolicy>::at(size_type pos) const {
+  if (pos >= this->size()) {
+    throw std::out_of_range("tftl::devector::at: index out of range");
+  }
+  return this->head_[pos];
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::reference devector<T, Allocator, GrowthPolicy>::operator[](size_type pos) {
+  return this->head_[pos];
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::const_reference devector<T, Allocator, GrowthPolicy>::operator[](size_type pos) const {
+  return this->head_[pos];
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::reference devector<T, Allocator, GrowthPolicy>::front() {
+  return *this->head_;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::const_reference devector<T, Allocator, GrowthPolicy>::front() const {
+  return *this->head_;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::reference devector<T, Allocator, GrowthPolicy>::back() {
+  return *(this->tail_ - 1);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::const_reference devector<T, Allocator, GrowthPolicy>::back() const {
+  return *(this->tail_ - 1);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+T* devector<T, Allocator, GrowthPolicy>::data() noexcept {
+  return this->head_;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+const T* devector<T, Allocator, GrowthPolicy>::data() const noexcept {
+  return this->head_;
+}
+
+// Iterators:
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::iterator devector<T, Allocator, GrowthPolicy>::begin() noexcept {
+  return iterator(this->head_);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::const_iterator devector<T, Allocator, GrowthPolicy>::begin() const noexcept {
+  return const_iterator(this->head_);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::const_iterator devector<T, Allocator, GrowthPolicy>::cbegin() const noexcept {
+  return const_iterator(this->head_);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::iterator devector<T, Allocator, GrowthPolicy>::end() noexcept {
+  return iterator(this->tail_);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::const_iterator devector<T, Allocator, GrowthPolicy>::end() const noexcept {
+  return const_iterator(this->tail_);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::const_iterator devector<T, Allocator, GrowthPolicy>::cend() const noexcept {
+  return const_iterator(this->tail_);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::reverse_iterator devector<T, Allocator, GrowthPolicy>::rbegin() noexcept {
+  return reverse_iterator(this->end());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::const_reverse_iterator devector<T, Allocator, GrowthPolicy>::rbegin() const noexcept {
+  return const_reverse_iterator(this->end());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::reverse_iterator devector<T, Allocator, GrowthPolicy>::rend() noexcept {
+  return reverse_iterator(this->begin());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::const_reverse_iterator devector<T, Allocator, GrowthPolicy>::rend() const noexcept {
+  return const_reverse_iterator(this->begin());
+}
+
+// Capacity:
+template<typename T, typename Allocator, typename GrowthPolicy>
+bool devector<T, Allocator, GrowthPolicy>::empty() const noexcept {
+  return this->head_ == this->tail_;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::size_type devector<T, Allocator, GrowthPolicy>::size() const noexcept {
+  return this->tail_ - this->head_;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::size_type devector<T, Allocator, GrowthPolicy>::max_size() const noexcept {
+  return std::min<size_type>(alloc_traits::max_size(this->allocator_),
+                             std::numeric_limits<difference_type>::max() / sizeof(T));
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::size_type devector<T, Allocator, GrowthPolicy>::capacity() const noexcept {
+  return this->peak_ - this->storage_;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::size_type devector<T, Allocator, GrowthPolicy>::front_free_capacity() const noexcept {
+  return this->head_ - this->storage_;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::size_type devector<T, Allocator, GrowthPolicy>::back_free_capacity() const noexcept {
+  return this->peak_ - this->tail_;
+}
+
+// Room for new_cap elements in all, the new room is added at the back
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::reserve(size_type new_cap) {
+  if (new_cap > this->size() + this->back_free_capacity()) {
+    this->reserve_back(new_cap - this->size());
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::reserve_front(size_type count) {
+  if (count > this->front_free_capacity()) {
+    if (count > this->max_size() - this->size()) {
+      throw std::length_error("tftl::devector::reserve_front: count exceeds max_size()");
+    }
+    this->reallocate(this->size() + count + this->back_free_capacity(), count);
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::reserve_back(size_type count) {
+  if (count > this->back_free_capacity()) {
+    if (count > this->max_size() - this->size()) {
+      throw std::length_error("tftl::devector::reserve_back: count exceeds max_size()");
+    }
+    this->reallocate(this->front_free_capacity() + this->size() + count, this->front_free_capacity());
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::shrink_to_fit() {
+  if (this->size() != this->capacity()) {
+    this->reallocate(this->size(), 0);
+  }
+}
+
+// Modifier:
+// The buffer is kept, the next elements start from its middle
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::clear() noexcept {
+  this->destroy(this->head_, this->tail_);
+  this->tail_ = this->head_;
+  this->recenter_if_empty();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::iterator devector<T, Allocator, GrowthPolicy>::insert(const_iterator pos, const T& value) {
+  return this->emplace(pos, value);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::iterator devector<T, Allocator, GrowthPolicy>::insert(const_iterator pos, T&& value) {
+  return this->emplace(pos, std::move(value));
+}
+
+// The elements on the shorter side of pos make room, front ones move down and back ones up
+template<typename T, typename Allocator, typename GrowthPolicy>
+template<class... Args>
+typename devector<T, Allocator, GrowthPolicy>::iterator devector<T, Allocator, GrowthPolicy>::emplace(const_iterator pos, Args&& ... args) {
+  size_type index = pos - this->cbegin();
+  size_type size = this->size();
+  if (index == 0) {
+    this->emplace_front(std::forward<Args>(args)...);
+    return this->begin();
+  }
+  if (index == size) {
+    this->emplace_back(std::forward<Args>(args)...);
+    return this->begin() + index;
+  }
+
+  // Built aside first: args may refer to an element which is about to be shifted
+  value_type element(std::forward<Args>(args)...);
+  if (index < size - index) {
+    this->make_room(1, 0);
+    if constexpr (tftl::is_trivially_relocatable_v<T>) {
+      tftl::relocate_shift(this->head_, index, -1);
+      try {
+        alloc_traits::construct(this->allocator_, this->head_ - 1 + index, std::move(element));
+      } catch (...) {
+        tftl::relocate_shift(this->head_ - 1, index, 1);
+        throw;
+      }
+      --this->head_;
+    } else {
+      alloc_traits::construct(this->allocator_, this->head_ - 1, std::move(*this->head_));
+      --this->head_;
+      std::move(this->head_ + 2, this->head_ + 1 + index, this->head_ + 1);
+      this->head_[index] = std::move(element);
+    }
+  } else {
+    this->make_room(0, 1);
+    pointer position = this->head_ + index;
+    if constexpr (tftl::is_trivially_relocatable_v<T>) {
+      tftl::relocate_shift(position, size - index, 1);
+      try {
+        alloc_traits::construct(this->allocator_, position, std::move(element));
+      } catch (...) {
+        tftl::relocate_shift(position + 1, size - index, -1);
+        throw;
+      }
+      ++this->tail_;
+    } else {
+      alloc_traits::construct(this->allocator_, this->tail_, std::move(*(this->tail_ - 1)));
+      ++this->tail_;
+      std::move_backward(position, this->tail_ - 2, this->tail_ - 1);
+      *position = std::move(element);
+    }
+  }
+  return this->begin() + index;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::iterator devector<T, Allocator, GrowthPolicy>::erase(const_iterator pos) {
+  return this->erase(pos, pos + 1);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename devector<T, Allocator, GrowthPolicy>::iterator devector<T, Allocator, GrowthPolicy>::erase(const_iterator first, const_iterator last) {
+  size_type index = first - this->cbegin();
+  size_type count = last - first;
+  pointer position = this->head_ + index;
+  if (index < this->size() - index - count) {
+    std::move_backward(this->head_, position, position + count);
+    this->destroy(this->head_, this->head_ + count);
+    this->head_ += count;
+  } else {
+    std::move(position + count, this->tail_, position);
+    this->destroy(this->tail_ - count, this->tail_);
+    this->tail_ -= count;
+  }
+  this->recenter_if_empty();
+  return this->begin() + index;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::push_front(const T& value) {
+  this->emplace_front(value);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::push_front(T&& value) {
+  this->emplace_front(std::move(value));
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+template<class... Args>
+typename devector<T, Allocator, GrowthPolicy>::reference devector<T, Allocator, GrowthPolicy>::emplace_front(Args&& ... args) {
+  // With spare room args cannot refer to the raw slot, so the element is built in place
+  if (this->head_ != this->storage_) {
+    alloc_traits::construct(this->allocator_, this->head_ - 1, std::forward<Args>(args)...);
+  } else {
+    value_type element(std::forward<Args>(args)...);
+    this->make_room(1, 0);
+    alloc_traits::construct(this->allocator_, this->head_ - 1, std::move(element));
+  }
+  --this->head_;
+  return *this->head_;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::pop_front() {
+  alloc_traits::destroy(this->allocator_, this->head_);
+  ++this->head_;
+  this->recenter_if_empty();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::push_back(const T& value) {
+  this->emplace_back(value);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::push_back(T&& value) {
+  this->emplace_back(std::move(value));
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+template<class... Args>
+typename devector<T, Allocator, GrowthPolicy>::reference devector<T, Allocator, GrowthPolicy>::emplace_back(Args&& ... args) {
+  if (this->tail_ != this->peak_) {
+    alloc_traits::construct(this->allocator_, this->tail_, std::forward<Args>(args)...);
+  } else {
+    value_type element(std::forward<Args>(args)...);
+    this->make_room(0, 1);
+    alloc_traits::construct(this->allocator_, this->tail_, std::move(element));
+  }
+  ++this->tail_;
+  return *(this->tail_ - 1);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::pop_back() {
+  --this->tail_;
+  alloc_traits::destroy(this->allocator_, this->tail_);
+  this->recenter_if_empty();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::resize(size_type count) {
+  size_type size = this->size();
+  if (count <= size) {
+    this->destroy(this->head_ + count, this->tail_);
+    this->tail_ = this->head_ + count;
+    this->recenter_if_empty();
+  } else {
+    this->make_room(0, count - size);
+    this->tail_ = tftl::uninitialized_value_construct_n(this->tail_, count - size, this->allocator_);
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::resize(size_type count, const value_type& value) {
+  size_type size = this->size();
+  if (count <= size) {
+    this->resize(count);
+  } else {
+    value_type copy(value); // value may live inside the devector
+    this->make_room(0, count - size);
+    this->tail_ = tftl::uninitialized_fill_n(this->tail_, count - size, copy, this->allocator_);
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::swap(devector& other) noexcept {
+  std::swap(this->storage_, other.storage_);
+  std::swap(this->head_, other.head_);
+  std::swap(this->tail_, other.tail_);
+  std::swap(this->peak_, other.peak_);
+  if constexpr (alloc_traits::propagate_on_container_swap::value) {
+    std::swap(this->allocator_, other.allocator_);
+  }
+}
+
+// Methods to manipulate with memory by using allocator:
+/**
+ * Makes sure there are front free slots before the first element and back after the last one.
+ * A buffer at most half full is centered again without growing, which moves every element but leaves
+ * at least size() / 2 free slots at either end, so pushes on one end stay amortized O(1).
+ * Otherwise the buffer grows and the free space is split evenly beyond what was asked for.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::make_room(size_type front, size_type back) {
+  if (front <= this->front_free_capacity() && back <= this->back_free_capacity()) {
+    return;
+  }
+  size_type size = this->size();
+  size_type needed = size + front + back;
+  if (needed > this->max_size()) {
+    throw std::length_error("tftl::devector: size exceeds max_size()");
+  }
+
+  if constexpr (tftl::is_trivially_relocatable_v<T>) {
+    if (needed <= this->capacity() / 2) {
+      pointer new_head = this->storage_ + front + (this->capacity() - needed) / 2;
+      tftl::relocate_shift(this->head_, size, new_head - this->head_);
+      this->head_ = new_head;
+      this->tail_ = new_head + size;
+      return;
+    }
+  }
+
+  // Other types are centered through a buffer of the same size, which keeps the capacity bounded too
+  size_type new_capacity = needed <= this->capacity() / 2
+                           ? this->capacity()
+                           : std::min(GrowthPolicy::next_capacity(this->capacity(), needed, sizeof(T)), this->max_size());
+  this->reallocate(new_capacity, front + (new_capacity - needed) / 2);
+}
+
+// Moves the elements into a buffer of new_capacity, front_free slots after its start.
+// *this is left untouched if the relocation throws
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::reallocate(size_type new_capacity, size_type front_free) {
+  pointer new_storage = alloc_traits::allocate(this->allocator_, new_capacity);
+  pointer new_head = new_storage + front_free;
+  try {
+    tftl::uninitialized_relocate(this->head_, this->tail_, new_head, this->allocator_);
+  } catch (...) {
+    alloc_traits::deallocate(this->allocator_, new_storage, new_capacity);
+    throw;
+  }
+  alloc_traits::deallocate(this->allocator_, this->storage_, this->capacity());
+
+  this->tail_ = new_head + this->size();
+  this->head_ = new_head;
+  this->storage_ = new_storage;
+  this->peak_ = new_storage + new_capacity;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::destroy(pointer first, pointer last) noexcept {
+  if constexpr (!std::is_trivially_destructible<T>::value) {
+    for (; first != last; ++first) {
+      alloc_traits::destroy(this->allocator_, first);
+    }
+  }
+}
+
+// An empty devector starts again from the middle of its buffer, so either end may grow
+template<typename T, typename Allocator, typename GrowthPolicy>
+void devector<T, Allocator, GrowthPolicy>::recenter_if_empty() noexcept {
+  if (this->head_ == this->tail_) {
+    this->head_ = this->tail_ = this->storage_ + this->capacity() / 2;
+  }
+}
+
+// Operators
+template<typename T, typename Allocator, typename GrowthPolicy>
+bool operator==(const devector<T, Allocator, GrowthPolicy>& lhs, const devector<T, Allocator, GrowthPolicy>& rhs) {
+  return lhs.size() == rhs.size() && std::equal(lhs.data(), lhs.data() + lhs.size(), rhs.data());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+bool operator!=(const devector<T, Allocator, GrowthPolicy>& lhs, const devector<T, Allocator, GrowthPolicy>& rhs) {
+  return !(lhs == rhs);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void swap(devector<T, Allocator, GrowthPolicy>& lhs, devector<T, Allocator, GrowthPolicy>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+/**
+ * @brief tftl::gap_buffer keeps its free space as a gap at the cursor, as text editors do: inserting
+ * and erasing at the cursor take amortized O(1), and moving the cursor by k moves k elements across
+ * the gap. Editing that stays near one place therefore never shifts the rest of the buffer.
+ *
+ * Elements are moved across the gap one by one, so T must be trivially relocatable or nothrow move
+ * constructible. Iterators are tftl::indexed_iterator, which step over the gap.
+ */
+template<typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = tftl::default_growth>
+class gap_buffer {
+  static_assert(tftl::is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible<T>::value,
+                "tftl::gap_buffer: T must be trivially relocatable or nothrow move constructible");
+ public:
+  // @formatter:off
+  typedef T                                             value_type;
+  typedef Allocator                                     allocator_type;
+  typedef std::size_t                                   size_type;
+  typedef std::ptrdiff_t                                difference_type;
+  typedef value_type&                                   reference;
+  typedef const value_type&                             const_reference;
+  typedef indexed_iterator<gap_buffer, T>               iterator;
+  typedef indexed_iterator<const gap_buffer, const T>   const_iterator;
+  // @formatter:on
+
+  // construct/copy/destroy:
+  gap_buffer() noexcept(noexcept(Allocator())) = default;
+  explicit gap_buffer(const Allocator& alloc) noexcept;
+  template<typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+  gap_buffer(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+  gap_buffer(std::initializer_list<T> init, const Allocator& alloc = Allocator());
+  gap_buffer(const gap_buffer& other);
+  gap_buffer(gap_buffer&& other) noexcept;
+  ~gap_buffer();
+
+  gap_buffer& operator=(gap_buffer other) noexcept;
+
+  // Element access:
+  reference       at(size_type pos);
+  const_reference at(size_type pos) const;
+  reference       operator[](size_type pos);
+  const_reference operator[](size_type pos) const;
+
+  // Iterators:
+  iterator       begin() noexcept;
+  const_iterator begin() const noexcept;
+  iterator       end() noexcept;
+  const_iterator end() const noexcept;
+
+  // Capacity:
+  bool      empty() const noexcept;
+  size_type size() const noexcept;
+  size_type capacity() const noexcept;
+  void      reserve(size_type new_cap);
+
+  // Cursor, the index the next insert goes to:
+  size_type cursor() const noexcept;
+  void      move_cursor(size_type pos);
+
+  // Editing at the cursor:
+  void clear() noexcept;
+  template<class... Args>
+  reference emplace(Args&&... args);
+  void insert(const T& value);
+  void insert(T&& value);
+  template<typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+  void insert(InputIt first, InputIt last);
+  void erase_before(size_type count = 1);
+  void erase_after(size_type count = 1);
+
+  void swap(gap_buffer& other) noexcept;
+
+ private:
+  typedef std::allocator_traits<Allocator> alloc_traits;
+
+  Allocator allocator_;
+
+  T* storage_ = nullptr;   //Start of the buffer, the elements before the cursor follow
+  T* gap_begin_ = nullptr; //Cursor, start of the gap
+  T* gap_end_ = nullptr;   //End of the gap, the elements after the cursor follow
+  T* peak_ = nullptr;      //End of the buffer
+
+  void grow(size_type count);
+  void move_elements(T* first, size_type count, T* dest) noexcept;
+};
+
+// construct/copy/destroy:
+template<typename T, typename Allocator, typename GrowthPolicy>
+gap_buffer<T, Allocator, GrowthPolicy>::gap_buffer(const Allocator& alloc) noexcept : allocator_(alloc) {
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+template<typename InputIt, typename>
+gap_buffer<T, Allocator, GrowthPolicy>::gap_buffer(InputIt first, InputIt last, const Allocator& alloc) : gap_buffer(alloc) {
+  this->insert(first, last);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+gap_buffer<T, Allocator, GrowthPolicy>::gap_buffer(std::initializer_list<T> init, const Allocator& alloc)
+    : gap_buffer(init.begin(), init.end(), alloc) {
+}
+
+// The copy has its gap at the same cursor
+template<typename T, typename Allocator, typename GrowthPolicy>
+gap_buffer<T, Allocator, GrowthPolicy>::gap_buffer(const gap_buffer& other)
+    : gap_buffer(alloc_traits::select_on_container_copy_construction(other.allocator_)) {
+  this->reserve(other.size());
+  size_type after = other.peak_ - other.gap_end_;
+  this->gap_begin_ = tftl::uninitialized_copy_n(other.storage_, other.cursor(), this->storage_, this->allocator_);
+  tftl::uninitialized_copy_n(other.gap_end_, after, this->peak_ - after, this->allocator_);
+  this->gap_end_ = this->peak_ - after;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+gap_buffer<T, Allocator, GrowthPolicy>::gap_buffer(gap_buffer&& other) noexcept
+    : allocator_(std::move(other.allocator_)), storage_(other.storage_), gap_begin_(other.gap_begin_),
+      gap_end_(other.gap_end_), peak_(other.peak_) {
+  other.storage_ = other.gap_begin_ = other.gap_end_ = other.peak_ = nullptr;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+gap_buffer<T, Allocator, GrowthPolicy>::~gap_buffer() {
+  this->clear();
+  alloc_traits::deallocate(this->allocator_, this->storage_, this->capacity());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+gap_buffer<T, Allocator, GrowthPolicy>& gap_buffer<T, Allocator, GrowthPolicy>::operator=(gap_buffer other) noexcept {
+  this->swap(other);
+  return *this;
+}
+
+// Element access:
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename gap_buffer<T, Allocator, GrowthPolicy>::reference gap_buffer<T, Allocator, GrowthPolicy>::at(size_type pos) {
+  if (pos >= this->size()) {
+    throw std::out_of_range("tftl::gap_buffer::at: index out of range");
+  }
+  return (*this)[pos];
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename gap_buffer<T, Allocator, GrowthPolicy>::const_reference gap_buffer<T, Allocator, GrowthPolicy>::at(size_type pos) const {
+  if (pos >= this->size()) {
+    throw std::out_of_range("tftl::gap_buffer::at: index out of range");
+  }
+  return (*this)[pos];
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename gap_buffer<T, Allocator, GrowthPolicy>::reference gap_buffer<T, Allocator, GrowthPolicy>::operator[](size_type pos) {
+  return pos < this->cursor() ? this->storage_[pos] : this->gap_end_[pos - this->cursor()];
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename gap_buffer<T, Allocator, GrowthPolicy>::const_reference gap_buffer<T, Allocator, GrowthPolicy>::operator[](size_type pos) const {
+  return pos < this->cursor() ? this->storage_[pos] : this->gap_end_[pos - this->cursor()];
+}
+
+// Iterators:
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename gap_buffer<T, Allocator, GrowthPolicy>::iterator gap_buffer<T, Allocator, GrowthPolicy>::begin() noexcept {
+  return iterator(this, 0);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename gap_buffer<T, Allocator, GrowthPolicy>::const_iterator gap_buffer<T, Allocator, GrowthPolicy>::begin() const noexcept {
+  return const_iterator(this, 0);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename gap_buffer<T, Allocator, GrowthPolicy>::iterator gap_buffer<T, Allocator, GrowthPolicy>::end() noexcept {
+  return iterator(this, this->size());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename gap_buffer<T, Allocator, GrowthPolicy>::const_iterator gap_buffer<T, Allocator, GrowthPolicy>::end() const noexcept {
+  return const_iterator(this, this->size());
+}
+
+// Capacity:
+template<typename T, typename Allocator, typename GrowthPolicy>
+bool gap_buffer<T, Allocator, GrowthPolicy>::empty() const noexcept {
+  return this->size() == 0;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename gap_buffer<T, Allocator, GrowthPolicy>::size_type gap_buffer<T, Allocator, GrowthPolicy>::size() const noexcept {
+  return this->capacity() - (this->gap_end_ - this->gap_begin_);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename gap_buffer<T, Allocator, GrowthPolicy>::size_type gap_buffer<T, Allocator, GrowthPolicy>::capacity() const noexcept {
+  return this->peak_ - this->storage_;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void gap_buffer<T, Allocator, GrowthPolicy>::reserve(size_type new_cap) {
+  if (new_cap > this->capacity()) {
+    this->grow(new_cap - this->size());
+  }
+}
+
+// Cursor:
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename gap_buffer<T, Allocator, GrowthPolicy>::size_type gap_buffer<T, Allocator, GrowthPolicy>::cursor() const noexcept {
+  return this->gap_begin_ - this->storage_;
+}
+
+// Moves the elements between the old and the new cursor to the other side of the gap
+template<typename T, typename Allocator, typename GrowthPolicy>
+void gap_buffer<T, Allocator, GrowthPolicy>::move_cursor(size_type pos) {
+  if (pos > this->size()) {
+    throw std::out_of_range("tftl::gap_buffer::move_cursor: position out of range");
+  }
+  size_type cursor = this->cursor();
+  if (pos < cursor) {
+    size_type count = cursor - pos;
+    this->move_elements(this->storage_ + pos, count, this->gap_end_ - count);
+    this->gap_begin_ -= count;
+    this->gap_end_ -= count;
+  } else if (pos > cursor) {
+    size_type count = pos - cursor;
+    this->move_elements(this->gap_end_, count, this->gap_begin_);
+    this->gap_begin_ += count;
+    this->gap_end_ += count;
+  }
+}
+
+// Editing at the cursor:
+template<typename T, typename Allocator, typename GrowthPolicy>
+void gap_buffer<T, Allocator, GrowthPolicy>::clear() noexcept {
+  this->erase_before(this->cursor());
+  this->erase_after(this->peak_ - this->gap_end_);
+}
+
+// Inserts before the cursor, which stays after the new element as a typed character does
+template<typename T, typename Allocator, typename GrowthPolicy>
+template<class... Args>
+typename gap_buffer<T, Allocator, GrowthPolicy>::reference gap_buffer<T, Allocator, GrowthPolicy>::emplace(Args&& ... args) {
+  if (this->gap_begin_ != this->gap_end_) {
+    alloc_traits::construct(this->allocator_, this->gap_begin_, std::forward<Args>(args)...);
+  } else {
+    value_type element(std::forward<Args>(args)...); // args may refer to an element about to be moved
+    this->grow(1);
+    alloc_traits::construct(this->allocator_, this->gap_begin_, std::move(element));
+  }
+  ++this->gap_begin_;
+  return *(this->gap_begin_ - 1);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void gap_buffer<T, Allocator, GrowthPolicy>::insert(const T& value) {
+  this->emplace(value);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void gap_buffer<T, Allocator, GrowthPolicy>::insert(T&& value) {
+  this->emplace(std::move(value));
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+template<typename InputIt, typename>
+void gap_buffer<T, Allocator, GrowthPolicy>::insert(InputIt first, InputIt last) {
+  if constexpr (std::is_base_of<std::forward_iterator_tag,
+                                typename std::iterator_traits<InputIt>::iterator_category>::value) {
+    size_type count = std::distance(first, last);
+    if (count > static_cast<size_type>(this->gap_end_ - this->gap_begin_)) {
+      this->grow(count);
+    }
+  }
+  for (; first != last; ++first) {
+    this->emplace(*first);
+  }
+}
+
+// Erases count elements before the cursor, as backspace does
+template<typename T, typename Allocator, typename GrowthPolicy>
+void gap_buffer<T, Allocator, GrowthPolicy>::erase_before(size_type count) {
+  for (; count != 0; --count) {
+    --this->gap_begin_;
+    alloc_traits::destroy(this->allocator_, this->gap_begin_);
+  }
+}
+
+// Erases count elements after the cursor, as delete does
+template<typename T, typename Allocator, typename GrowthPolicy>
+void gap_buffer<T, Allocator, GrowthPolicy>::erase_after(size_type count) {
+  for (; count != 0; --count) {
+    alloc_traits::destroy(this->allocator_, this->gap_end_);
+    ++this->gap_end_;
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void gap_buffer<T, Allocator, GrowthPolicy>::swap(gap_buffer& other) noexcept {
+  std::swap(this->storage_, other.storage_);
+  std::swap(this->gap_begin_, other.gap_begin_);
+  std::swap(this->gap_end_, other.gap_end_);
+  std::swap(this->peak_, other.peak_);
+  if constexpr (alloc_traits::propagate_on_container_swap::value) {
+    std::swap(this->allocator_, other.allocator_);
+  }
+}
+
+// Makes the gap at least count long
+template<typename T, typename Allocator, typename GrowthPolicy>
+void gap_buffer<T, Allocator, GrowthPolicy>::grow(size_type count) {
+  size_type size = this->size();
+  size_type new_capacity = GrowthPolicy::next_capacity(this->capacity(), size + count, sizeof(T));
+  T* new_storage = alloc_traits::allocate(this->allocator_, new_capacity);
+  size_type before = this->cursor();
+  size_type after = this->peak_ - this->gap_end_;
+  tftl::uninitialized_relocate(this->storage_, this->gap_begin_, new_storage, this->allocator_);
+  tftl::uninitialized_relocate(this->gap_end_, this->peak_, new_storage + new_capacity - after, this->allocator_);
+  alloc_traits::deallocate(this->allocator_, this->storage_, this->capacity());
+
+  this->storage_ = new_storage;
+  this->gap_begin_ = new_storage + before;
+  this->peak_ = new_storage + new_capacity;
+  this->gap_end_ = this->peak_ - after;
+}
+
+// Relocates count elements from first to dest, the ranges may overlap.
+// A full buffer has an empty gap, the elements then stay where they are
+template<typename T, typename Allocator, typename GrowthPolicy>
+void gap_buffer<T, Allocator, GrowthPolicy>::move_elements(T* first, size_type count, T* dest) noexcept {
+  if (dest == first) {
+    return;
+  }
+  if constexpr (tftl::is_trivially_relocatable_v<T>) {
+    tftl::relocate_shift(first, count, dest - first);
+  } else if (dest < first) {
+    for (size_type i = 0; i < count; ++i) {
+      alloc_traits::construct(this->allocator_, dest + i, std::move(first[i]));
+      alloc_traits::destroy(this->allocator_, first + i);
+    }
+  } else {
+    for (size_type i = count; i != 0; --i) {
+      alloc_traits::construct(this->allocator_, dest + i - 1, std::move(first[i - 1]));
+      alloc_traits::destroy(this->allocator_, first + i - 1);
+    }
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void swap(gap_buffer<T, Allocator, GrowthPolicy>& lhs, gap_buffer<T, Allocator, GrowthPolicy>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+} //namespace truefinch template library
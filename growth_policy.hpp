@@ -0,0 +1,61 @@
+//
+// Created by truefinch on 18.06.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+namespace tftl {
+/**
+ * Growth policies decide the capacity a container reallocates to once it runs out of space.
+ * A policy is a stateless type with a single static function
+ *
+ *   static std::size_t next_capacity(std::size_t capacity, std::size_t required, std::size_t element_size);
+ *
+ * which returns at least required. It costs nothing per container instance.
+ */
+
+/**
+ * @brief Geometric growth: the capacity is multiplied by Numerator / Denominator.
+ *
+ * growth_factor<2> doubles the buffer, growth_factor<3, 2> grows it by half, which lets
+ * the allocator reuse the blocks freed by earlier steps.
+ */
+template<std::size_t Numerator, std::size_t Denominator = 1>
+struct growth_factor {
+  static_assert(Numerator > Denominator, "tftl::growth_factor: the factor must be greater than 1");
+
+  static std::size_t next_capacity(std::size_t capacity, std::size_t required, std::size_t) noexcept {
+    return std::max(required, capacity + capacity / Denominator * (Numerator - Denominator));
+  }
+};
+
+/**
+ * @brief Doubles the buffer and rounds its byte size up to a power of two,
+ * which every common malloc size class serves without slack.
+ */
+struct power_of_two_growth {
+  static std::size_t next_capacity(std::size_t capacity, std::size_t required, std::size_t element_size) noexcept {
+    std::size_t bytes = std::max(required, capacity * 2) * element_size;
+    std::size_t rounded = 1;
+    while (rounded < bytes && rounded != 0) {
+      rounded <<= 1;
+    }
+    return rounded == 0 ? required : std::max(required, rounded / element_size);
+  }
+};
+
+/**
+ * @brief Never reserves more than asked for. Meant for buffers which are sized once up front,
+ * every further append reallocates.
+ */
+struct exact_growth {
+  static std::size_t next_capacity(std::size_t, std::size_t required, std::size_t) noexcept {
+    return required;
+  }
+};
+
+typedef growth_factor<2> default_growth;
+} //namespace truefinch template library
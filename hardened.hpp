@@ -0,0 +1,104 @@
+//
+// Created by truefinch on 18.07.18.
+//
+
+#pragma once
+
+/**
+ * Hardened mode, for staging and canary builds: compile everything with -DTFTL_HARDENED.
+ *
+ * tftl::vector then checks indices, positions passed to insert and erase, and every dereference
+ * of its iterators against the generation of the buffer they were taken from. A failed check
+ * prints the message and aborts, or throws tftl::hardening_error when TFTL_HARDENED_THROW is
+ * defined as well. Without TFTL_HARDENED all of it compiles to nothing.
+ *
+ * The mode changes the layout of tftl::iterator and tftl::vector, so every translation unit
+ * of a program must be compiled with the same setting.
+ */
+
+#if defined(TFTL_HARDENED)
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace tftl {
+class hardening_error : public std::logic_error {
+ public:
+  using std::logic_error::logic_error;
+};
+
+namespace detail {
+[[noreturn]] inline void hardening_failure(const char* message) {
+#if defined(TFTL_HARDENED_THROW)
+  throw hardening_error(message);
+#else
+  std::fprintf(stderr, "tftl hardened mode: %s\n", message);
+  std::abort();
+#endif
+}
+
+/**
+ * Generation counters of the vectors. The slots are never freed: a released slot is bumped and
+ * handed out again with its count going on, so an iterator keeping a stale generation never
+ * matches again, even after its vector is gone.
+ */
+class generation_pool {
+ public:
+  static std::uint64_t* acquire() {
+    std::lock_guard<std::mutex> lock(instance().mutex_);
+    std::vector<std::uint64_t*>& free = instance().free_;
+    if (free.empty()) {
+      instance().blocks_.emplace_back(new std::uint64_t[block_size]());
+      for (std::size_t i = 0; i < block_size; ++i) {
+        free.push_back(instance().blocks_.back() + i);
+      }
+    }
+    std::uint64_t* slot = free.back();
+    free.pop_back();
+    return slot;
+  }
+
+  static void release(std::uint64_t* slot) noexcept {
+    if (slot == nullptr) {
+      return;
+    }
+    ++*slot;
+    std::lock_guard<std::mutex> lock(instance().mutex_);
+    try {
+      instance().free_.push_back(slot);
+    } catch (...) {
+      // Leaking a slot is harmless
+    }
+  }
+
+ private:
+  static constexpr std::size_t block_size = 1024;
+
+  std::mutex                  mutex_;
+  std::vector<std::uint64_t*> free_;
+  std::vector<std::uint64_t*> blocks_;
+
+  static generation_pool& instance() {
+    static generation_pool* pool = new generation_pool(); // outlives the vectors of other static objects
+    return *pool;
+  }
+};
+} // namespace detail
+} //namespace truefinch template library
+
+#define TFTL_HARDENED_CHECK(condition, message) \
+  do { \
+    if (__builtin_expect(!(condition), 0)) { \
+      tftl::detail::hardening_failure(message); \
+    } \
+  } while (false)
+
+#else
+
+#define TFTL_HARDENED_CHECK(condition, message) ((void) 0)
+
+#endif
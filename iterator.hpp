@@ -4,7 +4,12 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <memory>
+#include <type_traits>
+#include "hardened.hpp"
 
 namespace tftl {
 template<typename T>
@@ -41,7 +46,27 @@ class iterator {
   //constructors
   explicit iterator(pointer ptr = nullptr) : pointer_( ptr ) {};
 
+  // Checked iterator of a container whose buffer changes generation when it is reallocated
+#if defined(TFTL_HARDENED)
+  iterator(pointer ptr, const std::uint64_t* generation)
+      : pointer_( ptr ), generation_( generation ), stamp_( generation == nullptr ? 0 : *generation ) {};
+
+  iterator(const iterator& other) = default;
+#else
+  iterator(pointer ptr, const std::uint64_t*) : pointer_( ptr ) {};
+
   iterator(const iterator& other) : pointer_{other.pointer_} {};
+#endif
+
+  // iterator converts to the iterator over const elements
+  template<typename U, typename = typename std::enable_if<!std::is_same<U, T>::value
+                                                          && std::is_convertible<U*, T*>::value>::type>
+  iterator(const iterator<U>& other) : pointer_( other.pointer_ ) {
+#if defined(TFTL_HARDENED)
+    generation_ = other.generation_;
+    stamp_ = other.stamp_;
+#endif
+  };
 
   iterator&      operator=(const iterator&);
   iterator&      operator++();
@@ -68,11 +93,24 @@ class iterator {
 
  private:
   pointer pointer_;
+#if defined(TFTL_HARDENED)
+  const std::uint64_t* generation_ = nullptr; //Generation counter of the buffer, nullptr if unchecked
+  std::uint64_t        stamp_ = 0;            //Its value when the iterator was taken
+#endif
+
+  void check() const;
+
+  template<typename U>
+  friend class iterator;
 };
 template <typename T>
 iterator <T>& iterator <T>::operator=(const iterator& other)
 {
   pointer_ = other.pointer_;
+#if defined(TFTL_HARDENED)
+  generation_ = other.generation_;
+  stamp_ = other.stamp_;
+#endif
   return *this;
 }
 
@@ -129,33 +167,50 @@ typename iterator <T>::difference_type iterator <T>::operator-(const iterator& o
 template <typename T>
 iterator <T> iterator <T>::operator+(difference_type n) const
 {
-  return iterator( pointer_ + n );
+  iterator result( *this );
+  result.pointer_ += n;
+  return result;
 }
 
 template <typename T>
 iterator <T> iterator <T>::operator-(difference_type n) const
 {
-  return iterator( pointer_ - n );
+  iterator result( *this );
+  result.pointer_ -= n;
+  return result;
 }
 
 template <typename T>
 typename iterator <T>::reference iterator <T>::operator[](difference_type i) const
 {
+  check();
   return pointer_[i];
 }
 
 template <typename T>
 typename iterator <T>::reference iterator <T>::operator*() const
 {
+  check();
   return *pointer_;
 }
 
 template <typename T>
 typename iterator <T>::pointer iterator <T>::operator->() const
 {
+  check();
   return pointer_;
 }
 
+// Only the hardened mode checks, that the buffer was not reallocated since the iterator was taken
+template <typename T>
+inline void iterator <T>::check() const
+{
+#if defined(TFTL_HARDENED)
+  TFTL_HARDENED_CHECK(generation_ == nullptr || *generation_ == stamp_,
+                      "tftl::iterator: the buffer was reallocated or freed since the iterator was taken");
+#endif
+}
+
 template <typename T>
 bool iterator <T>::operator==(const iterator& other) const
 {
@@ -191,4 +246,188 @@ bool iterator <T>::operator>(const iterator& other) const
 {
   return pointer_ > other.pointer_;
 }
+
+/**
+ * @brief tftl::is_contiguous_iterator tells whether an iterator walks adjacent objects in memory,
+ * so [first, last) may be read as the bytes starting at &*first. C++17 cannot detect it,
+ * pointers and tftl::iterator are known to be.
+ */
+template<typename It>
+struct is_contiguous_iterator : std::is_pointer<It> {};
+
+template<typename T>
+struct is_contiguous_iterator<iterator<T>> : std::true_type {};
+
+/**
+ * @brief tftl::is_contiguous_range tells whether std::data and std::size apply to Range:
+ * arrays, std::vector, std::array, std::string, std::initializer_list, tftl::vector.
+ */
+template<typename Range, typename = void>
+struct is_contiguous_range : std::false_type {};
+
+template<typename Range>
+struct is_contiguous_range<Range, std::void_t<decltype(std::data(std::declval<Range&>())),
+                                              decltype(std::size(std::declval<Range&>()))>> : std::true_type {};
+/**
+ * @brief Random access iterator over an indexed container, with the same traits and operators as tftl::iterator.
+ * It keeps the index rather than a pointer, so it stays valid while the container grows.
+ */
+template<typename Container, typename Value>
+class indexed_iterator {
+ public:
+  // @formatter:off
+  typedef std::ptrdiff_t                  difference_type;
+  typedef Value                           value_type;
+  typedef Value*                          pointer;
+  typedef Value&                          reference;
+  typedef std::random_access_iterator_tag iterator_category;
+  // @formatter:on
+
+  indexed_iterator() noexcept = default;
+  indexed_iterator(Container* container, difference_type index) noexcept : container_(container), index_(index) {}
+
+  // iterator converts to const_iterator
+  template<typename OtherContainer, typename OtherValue,
+      typename = typename std::enable_if<std::is_convertible<OtherValue*, Value*>::value>::type>
+  indexed_iterator(const indexed_iterator<OtherContainer, OtherValue>& other) noexcept
+      : container_(other.container()), index_(other.index()) {}
+
+  Container*      container() const noexcept;
+  difference_type index() const noexcept;
+
+  indexed_iterator&      operator++();
+  indexed_iterator&      operator--();
+  const indexed_iterator operator++(int);
+  const indexed_iterator operator--(int);
+  indexed_iterator&      operator+=(difference_type);
+  indexed_iterator&      operator-=(difference_type);
+
+  difference_type  operator-(const indexed_iterator&) const;
+  indexed_iterator operator+(difference_type) const;
+  indexed_iterator operator-(difference_type) const;
+
+  reference operator*() const;
+  pointer   operator->() const;
+  reference operator[](difference_type) const;
+
+  bool operator==(const indexed_iterator&) const;
+  bool operator!=(const indexed_iterator&) const;
+  bool operator>(const indexed_iterator&) const;
+  bool operator<(const indexed_iterator&) const;
+  bool operator>=(const indexed_iterator&) const;
+  bool operator<=(const indexed_iterator&) const;
+
+ private:
+  Container*      container_ = nullptr;
+  difference_type index_ = 0;
+};
+
+template<typename Container, typename Value>
+Container* indexed_iterator<Container, Value>::container() const noexcept {
+  return this->container_;
+}
+
+template<typename Container, typename Value>
+typename indexed_iterator<Container, Value>::difference_type indexed_iterator<Container, Value>::index() const noexcept {
+  return this->index_;
+}
+
+template<typename Container, typename Value>
+indexed_iterator<Container, Value>& indexed_iterator<Container, Value>::operator++() {
+  ++this->index_;
+  return *this;
+}
+
+template<typename Container, typename Value>
+indexed_iterator<Container, Value>& indexed_iterator<Container, Value>::operator--() {
+  --this->index_;
+  return *this;
+}
+
+template<typename Container, typename Value>
+const indexed_iterator<Container, Value> indexed_iterator<Container, Value>::operator++(int) {
+  indexed_iterator result(*this);
+  ++this->index_;
+  return result;
+}
+
+template<typename Container, typename Value>
+const indexed_iterator<Container, Value> indexed_iterator<Container, Value>::operator--(int) {
+  indexed_iterator result(*this);
+  --this->index_;
+  return result;
+}
+
+template<typename Container, typename Value>
+indexed_iterator<Container, Value>& indexed_iterator<Container, Value>::operator+=(difference_type n) {
+  this->index_ += n;
+  return *this;
+}
+
+template<typename Container, typename Value>
+indexed_iterator<Container, Value>& indexed_iterator<Container, Value>::operator-=(difference_type n) {
+  this->index_ -= n;
+  return *this;
+}
+
+template<typename Container, typename Value>
+typename indexed_iterator<Container, Value>::difference_type
+indexed_iterator<Container, Value>::operator-(const indexed_iterator& other) const {
+  return this->index_ - other.index_;
+}
+
+template<typename Container, typename Value>
+indexed_iterator<Container, Value> indexed_iterator<Container, Value>::operator+(difference_type n) const {
+  return indexed_iterator(this->container_, this->index_ + n);
+}
+
+template<typename Container, typename Value>
+indexed_iterator<Container, Value> indexed_iterator<Container, Value>::operator-(difference_type n) const {
+  return indexed_iterator(this->container_, this->index_ - n);
+}
+
+template<typename Container, typename Value>
+typename indexed_iterator<Container, Value>::reference indexed_iterator<Container, Value>::operator*() const {
+  return (*this->container_)[this->index_];
+}
+
+template<typename Container, typename Value>
+typename indexed_iterator<Container, Value>::pointer indexed_iterator<Container, Value>::operator->() const {
+  return std::addressof((*this->container_)[this->index_]);
+}
+
+template<typename Container, typename Value>
+typename indexed_iterator<Container, Value>::reference indexed_iterator<Container, Value>::operator[](difference_type n) const {
+  return (*this->container_)[this->index_ + n];
+}
+
+template<typename Container, typename Value>
+bool indexed_iterator<Container, Value>::operator==(const indexed_iterator& other) const {
+  return this->index_ == other.index_;
+}
+
+template<typename Container, typename Value>
+bool indexed_iterator<Container, Value>::operator!=(const indexed_iterator& other) const {
+  return !(*this == other);
+}
+
+template<typename Container, typename Value>
+bool indexed_iterator<Container, Value>::operator>(const indexed_iterator& other) const {
+  return this->index_ > other.index_;
+}
+
+template<typename Container, typename Value>
+bool indexed_iterator<Container, Value>::operator<(const indexed_iterator& other) const {
+  return this->index_ < other.index_;
+}
+
+template<typename Container, typename Value>
+bool indexed_iterator<Container, Value>::operator>=(const indexed_iterator& other) const {
+  return this->index_ >= other.index_;
+}
+
+template<typename Container, typename Value>
+bool indexed_iterator<Container, Value>::operator<=(const indexed_iterator& other) const {
+  return this->index_ <= other.index_;
+}
 } //namespace truefinch template library
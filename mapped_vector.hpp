@@ -0,0 +1,576 @@
+//
+// Created by truefinch on 11.07.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "growth_policy.hpp"
+#include "iterator.hpp"
+
+namespace tftl {
+/**
+ * @brief How tftl::mapped_vector maps its file.
+ *
+ * read_only shares the pages of the page cache with every other process mapping the file.
+ * copy_on_write starts out the same, but an element written gets a private copy of its page
+ * and the file never changes. read_write writes through to the file, and only it can grow.
+ */
+enum class map_mode {
+  read_only,
+  copy_on_write,
+  read_write
+};
+
+/**
+ * @brief Access pattern hints for tftl::mapped_vector::advise, passed on to madvise.
+ */
+enum class access_advice {
+  normal,
+  sequential,
+  random,
+  will_need,
+  dont_need
+};
+
+/**
+ * @brief tftl::mapped_vector is a vector whose elements are the records of a file mapped with mmap.
+ *
+ * Opening costs no reading or copying, pages are faulted in when first touched.
+ * It offers the element access, iterators and capacity of tftl::vector; in read_write mode it also
+ * grows like one, the file being extended with ftruncate and the mapping with mremap.
+ * While it is open the file is as long as the capacity, close and shrink_to_fit trim it to the size.
+ * Writing an element of a read_only mapping faults.
+ */
+template<typename T, typename GrowthPolicy = tftl::default_growth>
+class mapped_vector {
+  static_assert(std::is_trivially_copyable<T>::value, "tftl::mapped_vector: T must be trivially copyable");
+ public:
+  // @formatter:off
+  typedef T                                      value_type;
+  typedef GrowthPolicy                           growth_policy;
+  typedef std::size_t                            size_type;
+  typedef std::ptrdiff_t                         difference_type;
+  typedef value_type&                            reference;
+  typedef const value_type&                      const_reference;
+  typedef value_type*                            pointer;
+  typedef const value_type*                      const_pointer;
+  typedef tftl::iterator <value_type>            iterator;
+  typedef const tftl::iterator <value_type>      const_iterator;
+  typedef std::reverse_iterator <iterator>       reverse_iterator;
+  typedef std::reverse_iterator <const_iterator> const_reverse_iterator;
+  // @formatter:on
+
+  mapped_vector() noexcept = default;
+  explicit mapped_vector(const std::string& path, map_mode mode = map_mode::read_only);
+  mapped_vector(const mapped_vector&) = delete;
+  mapped_vector(mapped_vector&& other) noexcept;
+  ~mapped_vector();
+
+  mapped_vector& operator=(const mapped_vector&) = delete;
+  mapped_vector& operator=(mapped_vector&& other) noexcept;
+
+  // read_write creates the file if it does not exist
+  void     open(const std::string& path, map_mode mode = map_mode::read_only);
+  void     close();
+  bool     is_open() const noexcept;
+  map_mode mode() const noexcept;
+
+  // Element access:
+  reference       at(size_type pos);
+  const_reference at(size_type pos) const;
+  reference       operator[](size_type pos);
+  const_reference operator[](size_type pos) const;
+  reference       front();
+  const_reference front() const;
+  reference       back();
+  const_reference back() const;
+  T*              data() noexcept;
+  const T*        data() const noexcept;
+
+  // Iterators:
+  iterator               begin() noexcept;
+  const_iterator         begin() const noexcept;
+  const_iterator         cbegin() const noexcept;
+  iterator               end() noexcept;
+  const_iterator         end() const noexcept;
+  const_iterator         cend() const noexcept;
+  reverse_iterator       rbegin() noexcept;
+  const_reverse_iterator rbegin() const noexcept;
+  reverse_iterator       rend() noexcept;
+  const_reverse_iterator rend() const noexcept;
+
+  // Capacity:
+  bool      empty() const noexcept;
+  size_type size() const noexcept;
+  size_type max_size() const noexcept;
+  size_type capacity() const noexcept;
+  void      reserve(size_type new_cap);
+  void      shrink_to_fit();
+
+  // Modifiers, read_write only:
+  void clear() noexcept;
+  void push_back(const T& value);
+  template<class... Args>
+  reference emplace_back(Args&& ... args);
+  template<class Range>
+  void append_range(Range&& range);
+  void pop_back();
+  void resize(size_type count);
+  void resize(size_type count, const value_type& value);
+
+  // Mapping control:
+  void sync(bool wait = true);
+  void advise(access_advice advice);
+  void advise(access_advice advice, size_type first, size_type count);
+
+  void swap(mapped_vector& other) noexcept;
+
+ private:
+  [[noreturn]] static void fail(const char* what);
+  void writable(const char* what) const;
+  void remap(size_type new_cap);
+  void grow(size_type required);
+  void unmap() noexcept;
+
+  int       fd_ = -1;
+  map_mode  mode_ = map_mode::read_only;
+  T*        data_ = nullptr;
+  size_type size_ = 0;
+  size_type capacity_ = 0;
+};
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::fail(const char* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::writable(const char* what) const {
+  if (this->mode_ != map_mode::read_write) {
+    throw std::logic_error(std::string(what) + ": the file is not mapped read_write");
+  }
+}
+
+template<typename T, typename GrowthPolicy>
+mapped_vector<T, GrowthPolicy>::mapped_vector(const std::string& path, map_mode mode) {
+  this->open(path, mode);
+}
+
+template<typename T, typename GrowthPolicy>
+mapped_vector<T, GrowthPolicy>::mapped_vector(mapped_vector&& other) noexcept {
+  this->swap(other);
+}
+
+template<typename T, typename GrowthPolicy>
+mapped_vector<T, GrowthPolicy>::~mapped_vector() {
+  try {
+    this->close();
+  } catch (...) {
+    // Like std::fstream, a destructor cannot report that trimming the file failed
+  }
+}
+
+template<typename T, typename GrowthPolicy>
+mapped_vector<T, GrowthPolicy>& mapped_vector<T, GrowthPolicy>::operator=(mapped_vector&& other) noexcept {
+  mapped_vector(std::move(other)).swap(*this);
+  return *this;
+}
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::open(const std::string& path, map_mode mode) {
+  this->close();
+  int fd = mode == map_mode::read_write ? ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)
+                                        : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    fail("tftl::mapped_vector::open");
+  }
+  struct stat status;
+  if (::fstat(fd, &status) != 0) {
+    int error = errno;
+    ::close(fd);
+    errno = error;
+    fail("tftl::mapped_vector::open: fstat");
+  }
+  if (static_cast<size_type>(status.st_size) % sizeof(T) != 0) {
+    ::close(fd);
+    throw std::invalid_argument("tftl::mapped_vector::open: the file size is not a multiple of sizeof(T)");
+  }
+
+  this->fd_ = fd;
+  this->mode_ = mode;
+  this->size_ = static_cast<size_type>(status.st_size) / sizeof(T);
+  try {
+    this->remap(this->size_);
+  } catch (...) {
+    this->close();
+    throw;
+  }
+}
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::close() {
+  if (this->fd_ < 0) {
+    return;
+  }
+  bool trim = this->mode_ == map_mode::read_write && this->capacity_ != this->size_;
+  this->unmap();
+  int result = trim ? ::ftruncate(this->fd_, static_cast<off_t>(this->size_ * sizeof(T))) : 0;
+  int error = errno;
+  ::close(this->fd_);
+  this->fd_ = -1;
+  this->size_ = 0;
+  if (result != 0) {
+    errno = error;
+    fail("tftl::mapped_vector::close: ftruncate");
+  }
+}
+
+template<typename T, typename GrowthPolicy>
+bool mapped_vector<T, GrowthPolicy>::is_open() const noexcept {
+  return this->fd_ >= 0;
+}
+
+template<typename T, typename GrowthPolicy>
+map_mode mapped_vector<T, GrowthPolicy>::mode() const noexcept {
+  return this->mode_;
+}
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::unmap() noexcept {
+  if (this->data_ != nullptr) {
+    ::munmap(this->data_, this->capacity_ * sizeof(T));
+  }
+  this->data_ = nullptr;
+  this->capacity_ = 0;
+}
+
+// Maps new_cap elements, the file must already be that long; mmap cannot map zero bytes
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::remap(size_type new_cap) {
+  if (new_cap == 0) {
+    this->unmap();
+    return;
+  }
+  std::size_t bytes = new_cap * sizeof(T);
+  void* memory;
+#ifdef MREMAP_MAYMOVE
+  if (this->data_ != nullptr) {
+    memory = ::mremap(this->data_, this->capacity_ * sizeof(T), bytes, MREMAP_MAYMOVE);
+  } else
+#endif
+  {
+    int protection = this->mode_ == map_mode::read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+    int flags = this->mode_ == map_mode::copy_on_write ? MAP_PRIVATE : MAP_SHARED;
+    memory = ::mmap(nullptr, bytes, protection, flags, this->fd_, 0);
+    if (memory != MAP_FAILED) {
+      this->unmap();
+    }
+  }
+  if (memory == MAP_FAILED) {
+    fail("tftl::mapped_vector: mmap");
+  }
+  this->data_ = static_cast<T*>(memory);
+  this->capacity_ = new_cap;
+}
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::grow(size_type required) {
+  if (required > this->max_size()) {
+    throw std::length_error("tftl::mapped_vector: size would exceed max_size()");
+  }
+  if (required > this->capacity_) {
+    this->reserve(std::min(this->max_size(), GrowthPolicy::next_capacity(this->capacity_, required, sizeof(T))));
+  }
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::reference mapped_vector<T, GrowthPolicy>::at(size_type pos) {
+  if (pos >= this->size_) {
+    throw std::out_of_range("tftl::mapped_vector::at: pos >= size()");
+  }
+  return this->data_[pos];
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::const_reference mapped_vector<T, GrowthPolicy>::at(size_type pos) const {
+  if (pos >= this->size_) {
+    throw std::out_of_range("tftl::mapped_vector::at: pos >= size()");
+  }
+  return this->data_[pos];
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::reference mapped_vector<T, GrowthPolicy>::operator[](size_type pos) {
+  return this->data_[pos];
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::const_reference mapped_vector<T, GrowthPolicy>::operator[](size_type pos) const {
+  return this->data_[pos];
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::reference mapped_vector<T, GrowthPolicy>::front() {
+  return this->data_[0];
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::const_reference mapped_vector<T, GrowthPolicy>::front() const {
+  return this->data_[0];
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::reference mapped_vector<T, GrowthPolicy>::back() {
+  return this->data_[this->size_ - 1];
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::const_reference mapped_vector<T, GrowthPolicy>::back() const {
+  return this->data_[this->size_ - 1];
+}
+
+template<typename T, typename GrowthPolicy>
+T* mapped_vector<T, GrowthPolicy>::data() noexcept {
+  return this->data_;
+}
+
+template<typename T, typename GrowthPolicy>
+const T* mapped_vector<T, GrowthPolicy>::data() const noexcept {
+  return this->data_;
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::iterator mapped_vector<T, GrowthPolicy>::begin() noexcept {
+  return iterator(this->data_);
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::const_iterator mapped_vector<T, GrowthPolicy>::begin() const noexcept {
+  return const_iterator(this->data_);
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::const_iterator mapped_vector<T, GrowthPolicy>::cbegin() const noexcept {
+  return this->begin();
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::iterator mapped_vector<T, GrowthPolicy>::end() noexcept {
+  return iterator(this->data_ + this->size_);
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::const_iterator mapped_vector<T, GrowthPolicy>::end() const noexcept {
+  return const_iterator(this->data_ + this->size_);
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::const_iterator mapped_vector<T, GrowthPolicy>::cend() const noexcept {
+  return this->end();
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::reverse_iterator mapped_vector<T, GrowthPolicy>::rbegin() noexcept {
+  return reverse_iterator(this->end());
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::const_reverse_iterator mapped_vector<T, GrowthPolicy>::rbegin() const noexcept {
+  return const_reverse_iterator(this->end());
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::reverse_iterator mapped_vector<T, GrowthPolicy>::rend() noexcept {
+  return reverse_iterator(this->begin());
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::const_reverse_iterator mapped_vector<T, GrowthPolicy>::rend() const noexcept {
+  return const_reverse_iterator(this->begin());
+}
+
+template<typename T, typename GrowthPolicy>
+bool mapped_vector<T, GrowthPolicy>::empty() const noexcept {
+  return this->size_ == 0;
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::size_type mapped_vector<T, GrowthPolicy>::size() const noexcept {
+  return this->size_;
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::size_type mapped_vector<T, GrowthPolicy>::max_size() const noexcept {
+  return static_cast<size_type>(std::numeric_limits<off_t>::max()) / sizeof(T);
+}
+
+template<typename T, typename GrowthPolicy>
+typename mapped_vector<T, GrowthPolicy>::size_type mapped_vector<T, GrowthPolicy>::capacity() const noexcept {
+  return this->capacity_;
+}
+
+// The file is extended first, so the new pages are backed and read as zeros
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::reserve(size_type new_cap) {
+  this->writable("tftl::mapped_vector::reserve");
+  if (new_cap <= this->capacity_) {
+    return;
+  }
+  if (new_cap > this->max_size()) {
+    throw std::length_error("tftl::mapped_vector::reserve: new_cap > max_size()");
+  }
+  if (::ftruncate(this->fd_, static_cast<off_t>(new_cap * sizeof(T))) != 0) {
+    fail("tftl::mapped_vector::reserve: ftruncate");
+  }
+  this->remap(new_cap);
+}
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::shrink_to_fit() {
+  this->writable("tftl::mapped_vector::shrink_to_fit");
+  if (this->capacity_ == this->size_) {
+    return;
+  }
+  this->remap(this->size_);
+  if (::ftruncate(this->fd_, static_cast<off_t>(this->size_ * sizeof(T))) != 0) {
+    fail("tftl::mapped_vector::shrink_to_fit: ftruncate");
+  }
+}
+
+// Elements are trivially destructible, clearing only forgets them; the file keeps its length until close
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::clear() noexcept {
+  if (this->mode_ == map_mode::read_write) {
+    this->size_ = 0;
+  }
+}
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::push_back(const T& value) {
+  this->emplace_back(value);
+}
+
+template<typename T, typename GrowthPolicy>
+template<class... Args>
+typename mapped_vector<T, GrowthPolicy>::reference mapped_vector<T, GrowthPolicy>::emplace_back(Args&& ... args) {
+  this->writable("tftl::mapped_vector::emplace_back");
+  T value(std::forward<Args>(args)...);  // args may refer into the mapping, which may move
+  this->grow(this->size_ + 1);
+  std::memcpy(this->data_ + this->size_, &value, sizeof(T));
+  return this->data_[this->size_++];
+}
+
+template<typename T, typename GrowthPolicy>
+template<class Range>
+void mapped_vector<T, GrowthPolicy>::append_range(Range&& range) {
+  this->writable("tftl::mapped_vector::append_range");
+  if constexpr (tftl::is_contiguous_range<Range>::value) {
+    size_type count = std::size(range);
+    if (count == 0) {
+      return;
+    }
+    const T* source = std::data(range);
+    if (source >= this->data_ && source < this->data_ + this->size_) {
+      // A range of this vector, copy it out before the mapping moves
+      std::string bytes(reinterpret_cast<const char*>(source), count * sizeof(T));
+      this->grow(this->size_ + count);
+      std::memcpy(this->data_ + this->size_, bytes.data(), bytes.size());
+    } else {
+      this->grow(this->size_ + count);
+      std::memcpy(this->data_ + this->size_, source, count * sizeof(T));
+    }
+    this->size_ += count;
+  } else {
+    for (auto&& value : range) {
+      this->emplace_back(std::forward<decltype(value)>(value));
+    }
+  }
+}
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::pop_back() {
+  this->writable("tftl::mapped_vector::pop_back");
+  --this->size_;
+}
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::resize(size_type count) {
+  this->resize(count, T());
+}
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::resize(size_type count, const value_type& value) {
+  this->writable("tftl::mapped_vector::resize");
+  if (count > this->size_) {
+    T copy = value;
+    this->grow(count);
+    for (size_type i = this->size_; i < count; ++i) {
+      std::memcpy(this->data_ + i, &copy, sizeof(T));
+    }
+  }
+  this->size_ = count;
+}
+
+// Writes dirty pages of a read_write mapping to the file; wait = false only schedules the writes
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::sync(bool wait) {
+  if (this->mode_ != map_mode::read_write || this->data_ == nullptr) {
+    return;
+  }
+  if (::msync(this->data_, this->capacity_ * sizeof(T), wait ? MS_SYNC : MS_ASYNC) != 0) {
+    fail("tftl::mapped_vector::sync: msync");
+  }
+}
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::advise(access_advice advice) {
+  this->advise(advice, 0, this->size_);
+}
+
+// The range is widened to whole pages, as madvise requires
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::advise(access_advice advice, size_type first, size_type count) {
+  if (first > this->size_) {
+    throw std::out_of_range("tftl::mapped_vector::advise: first > size()");
+  }
+  count = std::min(count, this->size_ - first);
+  if (count == 0) {
+    return;
+  }
+  static const int advices[] = {MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED};
+  std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  auto begin = reinterpret_cast<std::uintptr_t>(this->data_ + first) / page * page;
+  auto end = reinterpret_cast<std::uintptr_t>(this->data_ + first + count);
+  if (::madvise(reinterpret_cast<void*>(begin), end - begin, advices[static_cast<int>(advice)]) != 0) {
+    fail("tftl::mapped_vector::advise: madvise");
+  }
+}
+
+template<typename T, typename GrowthPolicy>
+void mapped_vector<T, GrowthPolicy>::swap(mapped_vector& other) noexcept {
+  std::swap(this->fd_, other.fd_);
+  std::swap(this->mode_, other.mode_);
+  std::swap(this->data_, other.data_);
+  std::swap(this->size_, other.size_);
+  std::swap(this->capacity_, other.capacity_);
+}
+} //namespace truefinch template library
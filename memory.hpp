@@ -0,0 +1,337 @@
+//
+// Created by truefinch on 14.06.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "iterator.hpp"
+
+namespace tftl {
+/**
+ * @brief tftl::is_trivially_relocatable tells whether moving an object to a new address
+ * and ending the lifetime of the source is the same as copying its bytes.
+ *
+ * Every trivially copyable type is relocatable. Most other types are too (anything that does
+ * not keep a pointer into itself), but it cannot be detected, so user types opt in by
+ * specializing the trait:
+ *
+ *   template<> struct tftl::is_trivially_relocatable<my_handle> : std::true_type {};
+ *
+ * @tparam T The type of the elements.
+ */
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template<typename T, typename Deleter>
+struct is_trivially_relocatable<std::unique_ptr<T, Deleter>> : is_trivially_relocatable<Deleter> {};
+
+template<typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+template<typename T>
+struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type {};
+
+template<typename T>
+constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+namespace detail {
+inline std::atomic<std::size_t>& streaming_threshold() noexcept {
+  static std::atomic<std::size_t> threshold{std::size_t(1) << 24};
+  return threshold;
+}
+} // namespace detail
+
+/**
+ * @brief Copies and fills of trivially copyable elements of at least that many bytes are written
+ * with non-temporal stores, which go around the caches: a multi-GB copy would otherwise evict
+ * the working set of every other thread sharing the last level cache. 16 MiB by default.
+ */
+inline std::size_t streaming_threshold() noexcept {
+  return detail::streaming_threshold().load(std::memory_order_relaxed);
+}
+
+inline void set_streaming_threshold(std::size_t bytes) noexcept {
+  detail::streaming_threshold().store(bytes, std::memory_order_relaxed);
+}
+
+namespace detail {
+// Copies bytes with non-temporal stores, the ranges must not overlap
+inline void stream_bytes(void* dest, const void* source, std::size_t bytes) noexcept {
+#if defined(__SSE2__)
+  char* out = static_cast<char*>(dest);
+  const char* in = static_cast<const char*>(source);
+  std::size_t head = std::min<std::size_t>((16 - reinterpret_cast<std::uintptr_t>(out) % 16) % 16, bytes);
+  std::memcpy(out, in, head);
+  out += head;
+  in += head;
+  bytes -= head;
+
+  __m128i* blocks = reinterpret_cast<__m128i*>(out);
+  const __m128i* sources = reinterpret_cast<const __m128i*>(in);
+  std::size_t count = bytes / 16;
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i first = _mm_loadu_si128(sources + i);
+    __m128i second = _mm_loadu_si128(sources + i + 1);
+    __m128i third = _mm_loadu_si128(sources + i + 2);
+    __m128i fourth = _mm_loadu_si128(sources + i + 3);
+    _mm_stream_si128(blocks + i, first);
+    _mm_stream_si128(blocks + i + 1, second);
+    _mm_stream_si128(blocks + i + 2, third);
+    _mm_stream_si128(blocks + i + 3, fourth);
+  }
+  for (; i < count; ++i) {
+    _mm_stream_si128(blocks + i, _mm_loadu_si128(sources + i));
+  }
+  _mm_sfence();
+  std::memcpy(out + count * 16, in + count * 16, bytes % 16);
+#else
+  std::memcpy(dest, source, bytes);
+#endif
+}
+
+// memcpy below the streaming threshold, non-temporal stores from it on
+inline void copy_bytes(void* dest, const void* source, std::size_t bytes) noexcept {
+  if (bytes == 0) {
+    return;
+  }
+  if (bytes >= streaming_threshold()) {
+    stream_bytes(dest, source, bytes);
+  } else {
+    std::memcpy(dest, source, bytes);
+  }
+}
+} // namespace detail
+
+/**
+ * @brief Moves [first, last) into the uninitialized memory at dest and destroys the source.
+ *
+ * Relocatable types are moved with a single memcpy. Other types are constructed
+ * with std::move_if_noexcept, so if a copy constructor throws the source is left untouched,
+ * the already built elements are destroyed and the exception is rethrown.
+ *
+ * @return pointer past the last relocated element in dest
+ */
+template<typename T, typename Allocator>
+T* uninitialized_relocate(T* first, T* last, T* dest, Allocator& alloc) {
+  if (first == last) {
+    return dest;
+  }
+
+  if constexpr (is_trivially_relocatable_v<T>) {
+    detail::copy_bytes(static_cast<void*>(dest), static_cast<const void*>(first), (last - first) * sizeof(T));
+    return dest + (last - first);
+  } else {
+    T* current = dest;
+    try {
+      for (T* it = first; it != last; ++it, ++current) {
+        std::allocator_traits<Allocator>::construct(alloc, current, std::move_if_noexcept(*it));
+      }
+    } catch (...) {
+      for (T* it = dest; it != current; ++it) {
+        std::allocator_traits<Allocator>::destroy(alloc, it);
+      }
+      throw;
+    }
+
+    for (T* it = first; it != last; ++it) {
+      std::allocator_traits<Allocator>::destroy(alloc, it);
+    }
+    return current;
+  }
+}
+
+/**
+ * @brief tftl::has_plain_construct tells whether constructing a T from Args through Allocator
+ * is a plain placement new, so the bulk primitives below may write the bytes of trivially
+ * copyable elements directly. Allocators with a construct of their own are always called.
+ */
+template<typename Allocator, typename T, typename... Args>
+struct has_plain_construct {
+ private:
+  template<typename A>
+  static auto test(int) -> decltype(std::declval<A&>().construct(std::declval<T*>(), std::declval<Args>()...),
+                                    std::false_type());
+  template<typename>
+  static std::true_type test(...);
+
+ public:
+  static constexpr bool value = decltype(test<Allocator>(0))::value;
+};
+
+template<typename U, typename T, typename... Args>
+struct has_plain_construct<std::allocator<U>, T, Args...> : std::true_type {};
+
+#if __has_include(<memory_resource>)
+template<typename U, typename T, typename... Args>
+struct has_plain_construct<std::pmr::polymorphic_allocator<U>, T, Args...>
+    : std::bool_constant<!std::uses_allocator<T, std::pmr::polymorphic_allocator<U>>::value> {};
+#endif
+
+namespace detail {
+// Writes count copies of the bytes of value: a memset when they are all the same byte,
+// non-temporal stores for big fills of other patterns
+template<typename T>
+void fill_bytes(T* dest, std::size_t count, const T& value) noexcept {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+  if (std::all_of(bytes + 1, bytes + sizeof(T), [bytes](unsigned char byte) { return byte == bytes[0]; })) {
+    std::memset(static_cast<void*>(dest), bytes[0], count * sizeof(T));
+    return;
+  }
+#if defined(__SSE2__)
+  if constexpr (16 % sizeof(T) == 0) {
+    if (count * sizeof(T) >= streaming_threshold()) {
+      for (; count != 0 && reinterpret_cast<std::uintptr_t>(dest) % 16 != 0; ++dest, --count) {
+        std::memcpy(static_cast<void*>(dest), &value, sizeof(T));
+      }
+      alignas(16) unsigned char pattern[16];
+      for (std::size_t i = 0; i < 16; i += sizeof(T)) {
+        std::memcpy(pattern + i, &value, sizeof(T));
+      }
+      __m128i block = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern));
+      __m128i* out = reinterpret_cast<__m128i*>(dest);
+      std::size_t blocks = count * sizeof(T) / 16;
+      for (std::size_t i = 0; i < blocks; ++i) {
+        _mm_stream_si128(out + i, block);
+      }
+      _mm_sfence();
+      dest += blocks * (16 / sizeof(T));
+      count -= blocks * (16 / sizeof(T));
+    }
+  }
+#endif
+  for (std::size_t i = 0; i < count; ++i) {
+    std::memcpy(static_cast<void*>(dest + i), &value, sizeof(T));
+  }
+}
+
+// Calls construct(slot) for count slots from dest on, destroying the built ones if one throws
+template<typename T, typename Allocator, typename Construct>
+T* construct_n(T* dest, std::size_t count, Allocator& alloc, Construct construct) {
+  T* current = dest;
+  try {
+    for (std::size_t i = 0; i < count; ++i, ++current) {
+      construct(current);
+    }
+  } catch (...) {
+    for (T* it = dest; it != current; ++it) {
+      std::allocator_traits<Allocator>::destroy(alloc, it);
+    }
+    throw;
+  }
+  return current;
+}
+} // namespace detail
+
+/**
+ * @brief Copies count elements starting at first into the uninitialized memory at dest.
+ *
+ * A contiguous source of the same trivially copyable type is copied with a single memcpy,
+ * anything else is constructed element by element; if a constructor throws the elements
+ * already built are destroyed and the exception is rethrown.
+ *
+ * @return pointer past the last copied element in dest
+ */
+template<typename InputIt, typename T, typename Allocator>
+T* uninitialized_copy_n(InputIt first, std::size_t count, T* dest, Allocator& alloc) {
+  typedef typename std::remove_cv<typename std::iterator_traits<InputIt>::value_type>::type source_type;
+  typedef typename std::iterator_traits<InputIt>::reference                                 source_reference;
+
+  if constexpr (is_contiguous_iterator<InputIt>::value && std::is_same<source_type, T>::value
+      && std::is_trivially_copyable<T>::value && has_plain_construct<Allocator, T, source_reference>::value) {
+    if (count != 0) {
+      detail::copy_bytes(static_cast<void*>(dest), static_cast<const void*>(&*first), count * sizeof(T));
+    }
+    return dest + count;
+  } else {
+    return detail::construct_n(dest, count, alloc, [&](T* slot) {
+      std::allocator_traits<Allocator>::construct(alloc, slot, *first);
+      ++first;
+    });
+  }
+}
+
+/**
+ * @brief Moves count elements starting at first into the uninitialized memory at dest,
+ * the source keeps its moved-from elements. Trivially copyable elements are moved by one memcpy.
+ *
+ * @return pointer past the last moved element in dest
+ */
+template<typename T, typename Allocator>
+T* uninitialized_move_n(T* first, std::size_t count, T* dest, Allocator& alloc) {
+  if constexpr (std::is_trivially_copyable<T>::value && has_plain_construct<Allocator, T, T&&>::value) {
+    detail::copy_bytes(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(T));
+    return dest + count;
+  } else {
+    return detail::construct_n(dest, count, alloc, [&](T* slot) {
+      std::allocator_traits<Allocator>::construct(alloc, slot, std::move(*first));
+      ++first;
+    });
+  }
+}
+
+/**
+ * @brief Constructs count copies of value in the uninitialized memory at dest.
+ * Trivially copyable elements are written as bytes, see detail::fill_bytes.
+ *
+ * @return pointer past the last constructed element
+ */
+template<typename T, typename Allocator>
+T* uninitialized_fill_n(T* dest, std::size_t count, const T& value, Allocator& alloc) {
+  if constexpr (std::is_trivially_copyable<T>::value && has_plain_construct<Allocator, T, const T&>::value) {
+    detail::fill_bytes(dest, count, value);
+    return dest + count;
+  } else {
+    return detail::construct_n(dest, count, alloc, [&](T* slot) {
+      std::allocator_traits<Allocator>::construct(alloc, slot, value);
+    });
+  }
+}
+
+/**
+ * @brief Value-initializes count elements in the uninitialized memory at dest, as T().
+ * For trivial types that is a fill with the bytes of T(), usually a memset to zero.
+ * An allocator with its own construct (tftl::default_init_allocator) decides what it does.
+ *
+ * @return pointer past the last constructed element
+ */
+template<typename T, typename Allocator>
+T* uninitialized_value_construct_n(T* dest, std::size_t count, Allocator& alloc) {
+  if constexpr (std::is_trivially_default_constructible<T>::value && std::is_trivially_copyable<T>::value
+      && has_plain_construct<Allocator, T>::value) {
+    const T zero = T();
+    detail::fill_bytes(dest, count, zero);
+    return dest + count;
+  } else {
+    return detail::construct_n(dest, count, alloc, [&](T* slot) {
+      std::allocator_traits<Allocator>::construct(alloc, slot);
+    });
+  }
+}
+
+/**
+ * @brief Shifts count relocatable elements starting at first by offset positions.
+ * The ranges may overlap, the vacated slots are left uninitialized.
+ */
+template<typename T>
+void relocate_shift(T* first, std::size_t count, std::ptrdiff_t offset) noexcept {
+  static_assert(is_trivially_relocatable_v<T>, "tftl::relocate_shift: T must be trivially relocatable");
+  if (count != 0 && offset != 0) {
+    std::memmove(static_cast<void*>(first + offset), static_cast<const void*>(first), count * sizeof(T));
+  }
+}
+} //namespace truefinch template library
@@ -0,0 +1,500 @@
+//
+// Created by truefinch on 04.07.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include "simd.hpp"
+#include "vector.hpp"
+
+namespace tftl {
+namespace numeric {
+/**
+ * Reductions and elementwise kernels over tftl::vector of arithmetic types.
+ *
+ * Every kernel is written once over 64-byte blocks of GCC vector extensions and compiled for each
+ * instruction set level by the target-attributed runners below, which pick the level detected
+ * by tftl::simd::detect(). A block is one zmm, two ymm or four xmm registers, so the lanes and the
+ * order in which they are combined are the same on every level.
+ */
+
+/**
+ * @brief How floating point sums are accumulated.
+ *
+ * fast uses the widest vectors and may fuse multiplies and adds, so results can differ
+ * in the last bits between CPUs. deterministic gives bit-identical results on every x86-64 CPU
+ * by never fusing. compensated is deterministic and carries a Kahan-Babuska error term per lane.
+ */
+enum class summation {
+  fast,
+  deterministic,
+  compensated
+};
+
+// Sums of integers are widened to 64 bits
+template<typename T>
+using accumulator_t = typename std::conditional<std::is_floating_point<T>::value, T,
+    typename std::conditional<std::is_signed<T>::value, std::int64_t, std::uint64_t>::type>::type;
+
+namespace detail {
+#define TFTL_ALWAYS_INLINE inline __attribute__((always_inline))
+// Blocks never cross a call boundary, every helper is inlined into a runner
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+constexpr std::size_t block_bytes = 64;
+constexpr std::size_t unroll = 4; //Independent accumulators, hides the latency of vector adds
+
+template<typename T>
+struct block {
+  typedef T type __attribute__((vector_size(block_bytes)));
+  static constexpr std::size_t lanes = block_bytes / sizeof(T);
+};
+
+template<typename T, typename Acc>
+struct accumulator_block {
+  typedef Acc type __attribute__((vector_size(block<T>::lanes * sizeof(Acc))));
+};
+
+template<typename Vector, typename T>
+TFTL_ALWAYS_INLINE Vector load(const T* data) {
+  Vector result;
+  std::memcpy(&result, data, sizeof(result));
+  return result;
+}
+
+template<typename Vector, typename T>
+TFTL_ALWAYS_INLINE void store(T* data, const Vector& value) {
+  std::memcpy(data, &value, sizeof(value));
+}
+
+// Adds the lanes pairwise, always in the same order
+template<typename Acc, std::size_t N>
+TFTL_ALWAYS_INLINE Acc reduce(Acc (&lanes)[N]) {
+  for (std::size_t width = N / 2; width > 0; width /= 2) {
+    for (std::size_t i = 0; i < width; ++i) {
+      lanes[i] += lanes[i + width];
+    }
+  }
+  return lanes[0];
+}
+
+template<typename T, typename Acc>
+TFTL_ALWAYS_INLINE Acc sum_kernel(const T* data, std::size_t count) {
+  typedef typename block<T>::type block_t;
+  typedef typename accumulator_block<T, Acc>::type acc_t;
+  constexpr std::size_t lanes = block<T>::lanes;
+
+  acc_t total[unroll] = {};
+  std::size_t i = 0;
+  for (; i + unroll * lanes <= count; i += unroll * lanes) {
+    for (std::size_t k = 0; k < unroll; ++k) {
+      total[k] += __builtin_convertvector(load<block_t>(data + i + k * lanes), acc_t);
+    }
+  }
+  for (std::size_t k = 0; i + lanes <= count; i += lanes, ++k) {
+    total[k] += __builtin_convertvector(load<block_t>(data + i), acc_t);
+  }
+
+  acc_t combined = (total[0] + total[1]) + (total[2] + total[3]);
+  Acc result[lanes];
+  store(result, combined);
+  for (std::size_t lane = 0; i < count; ++i, ++lane) {
+    result[lane] += data[i];
+  }
+  return reduce(result);
+}
+
+template<typename T>
+TFTL_ALWAYS_INLINE T dot_kernel(const T* lhs, const T* rhs, std::size_t count) {
+  typedef typename block<T>::type block_t;
+  constexpr std::size_t lanes = block<T>::lanes;
+
+  block_t total[unroll] = {};
+  std::size_t i = 0;
+  for (; i + unroll * lanes <= count; i += unroll * lanes) {
+    for (std::size_t k = 0; k < unroll; ++k) {
+      total[k] += load<block_t>(lhs + i + k * lanes) * load<block_t>(rhs + i + k * lanes);
+    }
+  }
+  for (std::size_t k = 0; i + lanes <= count; i += lanes, ++k) {
+    total[k] += load<block_t>(lhs + i) * load<block_t>(rhs + i);
+  }
+
+  block_t combined = (total[0] + total[1]) + (total[2] + total[3]);
+  T result[lanes];
+  store(result, combined);
+  for (std::size_t lane = 0; i < count; ++i, ++lane) {
+    result[lane] += lhs[i] * rhs[i];
+  }
+  return reduce(result);
+}
+
+// Kahan-Babuska (Neumaier) step: the error of the addition is recovered from the larger magnitude operand
+template<typename T>
+TFTL_ALWAYS_INLINE void compensated_add(T& total, T& error, T value) {
+  T next = total + value;
+  error += std::abs(total) >= std::abs(value) ? (total - next) + value : (value - next) + total;
+  total = next;
+}
+
+// The same step on every lane; magnitudes are compared as integers and selected with masks,
+// because a ?: on blocks wider than the registers is not vectorized
+template<typename T, typename Block>
+TFTL_ALWAYS_INLINE void compensated_add(Block& total, Block& error, const Block& value) {
+  typedef decltype(total < value) mask_t;
+  typedef typename std::conditional<sizeof(T) == 4, std::int32_t, std::int64_t>::type bits_t;
+  constexpr bits_t magnitude = std::numeric_limits<bits_t>::max();
+
+  mask_t total_bits = (mask_t) total;
+  mask_t value_bits = (mask_t) value;
+  mask_t larger = (total_bits & magnitude) >= (value_bits & magnitude);
+  Block big = (Block) ((larger & total_bits) | (~larger & value_bits));
+  Block small = (Block) ((~larger & total_bits) | (larger & value_bits));
+  Block next = total + value;
+  error += (big - next) + small;
+  total = next;
+}
+
+// Compensated sum of lhs * rhs, rhs == nullptr sums lhs alone
+template<typename T>
+TFTL_ALWAYS_INLINE T compensated_kernel(const T* lhs, const T* rhs, std::size_t count) {
+  typedef typename block<T>::type block_t;
+  constexpr std::size_t lanes = block<T>::lanes;
+
+  block_t totals[unroll] = {};
+  block_t errors[unroll] = {};
+  std::size_t i = 0;
+  for (; i + unroll * lanes <= count; i += unroll * lanes) {
+    for (std::size_t k = 0; k < unroll; ++k) {
+      const T* left = lhs + i + k * lanes;
+      block_t value = rhs == nullptr ? load<block_t>(left) : load<block_t>(left) * load<block_t>(rhs + i + k * lanes);
+      compensated_add<T>(totals[k], errors[k], value);
+    }
+  }
+  for (std::size_t k = 0; i + lanes <= count; i += lanes, ++k) {
+    block_t value = rhs == nullptr ? load<block_t>(lhs + i) : load<block_t>(lhs + i) * load<block_t>(rhs + i);
+    compensated_add<T>(totals[k], errors[k], value);
+  }
+
+  T sums[unroll * lanes];
+  T corrections[unroll * lanes];
+  store(sums, totals);
+  store(corrections, errors);
+  T result = 0;
+  T error = 0;
+  for (std::size_t lane = 0; lane < unroll * lanes; ++lane) {
+    compensated_add(result, error, sums[lane]);
+    compensated_add(result, error, corrections[lane]);
+  }
+  for (; i < count; ++i) {
+    compensated_add(result, error, rhs == nullptr ? lhs[i] : lhs[i] * rhs[i]);
+  }
+  return result + error;
+}
+
+// Smallest (Greater = false) or largest element of a non-empty array
+template<bool Greater, typename T>
+TFTL_ALWAYS_INLINE T extremum_kernel(const T* data, std::size_t count) {
+  typedef typename block<T>::type block_t;
+  constexpr std::size_t lanes = block<T>::lanes;
+
+  if (count < lanes) {
+    return Greater ? *std::max_element(data, data + count) : *std::min_element(data, data + count);
+  }
+
+  block_t best = load<block_t>(data);
+  std::size_t i = lanes;
+  for (; i + lanes <= count; i += lanes) {
+    block_t value = load<block_t>(data + i);
+    best = Greater ? (best < value ? value : best) : (value < best ? value : best);
+  }
+
+  T result[lanes];
+  store(result, best);
+  T extremum = Greater ? *std::max_element(result, result + lanes) : *std::min_element(result, result + lanes);
+  for (; i < count; ++i) {
+    if (Greater ? extremum < data[i] : data[i] < extremum) {
+      extremum = data[i];
+    }
+  }
+  return extremum;
+}
+
+template<typename T>
+TFTL_ALWAYS_INLINE void axpy_kernel(T factor, const T* x, T* y, std::size_t count) {
+  typedef typename block<T>::type block_t;
+  constexpr std::size_t lanes = block<T>::lanes;
+
+  std::size_t i = 0;
+  for (; i + lanes <= count; i += lanes) {
+    store(y + i, load<block_t>(y + i) + factor * load<block_t>(x + i));
+  }
+  for (; i < count; ++i) {
+    y[i] += factor * x[i];
+  }
+}
+
+template<typename T>
+TFTL_ALWAYS_INLINE void scale_kernel(T factor, T* data, std::size_t count) {
+  typedef typename block<T>::type block_t;
+  constexpr std::size_t lanes = block<T>::lanes;
+
+  std::size_t i = 0;
+  for (; i + lanes <= count; i += lanes) {
+    store(data + i, factor * load<block_t>(data + i));
+  }
+  for (; i < count; ++i) {
+    data[i] *= factor;
+  }
+}
+
+template<typename T>
+TFTL_ALWAYS_INLINE void clamp_kernel(T low, T high, T* data, std::size_t count) {
+  typedef typename block<T>::type block_t;
+  constexpr std::size_t lanes = block<T>::lanes;
+
+  block_t lows = low + block_t{};
+  block_t highs = high + block_t{};
+  std::size_t i = 0;
+  for (; i + lanes <= count; i += lanes) {
+    block_t value = load<block_t>(data + i);
+    value = value < lows ? lows : value;
+    value = highs < value ? highs : value;
+    store(data + i, value);
+  }
+  for (; i < count; ++i) {
+    data[i] = std::clamp(data[i], low, high);
+  }
+}
+
+// The kernel lambdas are always_inline, so their blocks are compiled for the runner's target
+#if TFTL_SIMD_X86
+template<typename Kernel>
+__attribute__((target("avx512f")))
+auto run_avx512(const Kernel& kernel) {
+  return kernel();
+}
+
+template<typename Kernel>
+__attribute__((target("avx2")))
+auto run_avx2(const Kernel& kernel) {
+  return kernel();
+}
+
+template<typename Kernel>
+__attribute__((target("sse2")))
+auto run_sse2(const Kernel& kernel) {
+  return kernel();
+}
+#endif
+
+template<typename Kernel>
+auto run(tftl::simd::isa level, const Kernel& kernel) {
+#if TFTL_SIMD_X86
+  switch (level) {
+    case tftl::simd::isa::avx512: return run_avx512(kernel);
+    case tftl::simd::isa::avx2: return run_avx2(kernel);
+    case tftl::simd::isa::sse2: return run_sse2(kernel);
+    default: break;
+  }
+#endif
+  return kernel();
+}
+
+// AVX-512 implies FMA, which would fuse multiplies and adds, so exact modes stop at AVX2
+inline tftl::simd::isa level(summation mode) noexcept {
+  tftl::simd::isa best = tftl::simd::detect();
+  if (mode != summation::fast && best == tftl::simd::isa::avx512) {
+    return tftl::simd::isa::avx2;
+  }
+  return best;
+}
+
+#pragma GCC diagnostic pop
+
+// data() with the alignment its allocator promises, so the kernels may use aligned loads
+template<typename Vector>
+auto aligned_data(Vector& values) noexcept {
+  return tftl::assume_aligned<Vector::data_alignment>(values.data());
+}
+
+template<typename T>
+void check_arithmetic() {
+  static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+                "tftl::numeric: the elements must be arithmetic");
+}
+} // namespace detail
+
+/**
+ * @brief Sum of all elements, integers are summed in 64 bits.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+accumulator_t<T> sum(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& values,
+                     summation mode = summation::fast) {
+  detail::check_arithmetic<T>();
+  const T* data = detail::aligned_data(values);
+  std::size_t count = values.size();
+  if constexpr (std::is_floating_point<T>::value) {
+    if (mode == summation::compensated) {
+      return detail::run(detail::level(mode), [=]() __attribute__((always_inline)) {
+        return detail::compensated_kernel<T>(data, nullptr, count);
+      });
+    }
+  }
+  return detail::run(detail::level(mode), [=]() __attribute__((always_inline)) {
+    return detail::sum_kernel<T, accumulator_t<T>>(data, count);
+  });
+}
+
+/**
+ * @brief Dot product of two vectors of the same size.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+T dot(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& lhs, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& rhs,
+      summation mode = summation::fast) {
+  detail::check_arithmetic<T>();
+  if (lhs.size() != rhs.size()) {
+    throw std::invalid_argument("tftl::numeric::dot: the vectors differ in size");
+  }
+  const T* left = detail::aligned_data(lhs);
+  const T* right = detail::aligned_data(rhs);
+  std::size_t count = lhs.size();
+  if constexpr (std::is_floating_point<T>::value) {
+    if (mode == summation::compensated) {
+      return detail::run(detail::level(mode), [=]() __attribute__((always_inline)) {
+        return detail::compensated_kernel<T>(left, right, count);
+      });
+    }
+  }
+  return detail::run(detail::level(mode), [=]() __attribute__((always_inline)) {
+    return detail::dot_kernel<T>(left, right, count);
+  });
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+T min(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& values) {
+  detail::check_arithmetic<T>();
+  if (values.empty()) {
+    throw std::out_of_range("tftl::numeric::min: the vector is empty");
+  }
+  const T* data = detail::aligned_data(values);
+  std::size_t count = values.size();
+  return detail::run(tftl::simd::detect(), [=]() __attribute__((always_inline)) {
+    return detail::extremum_kernel<false, T>(data, count);
+  });
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+T max(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& values) {
+  detail::check_arithmetic<T>();
+  if (values.empty()) {
+    throw std::out_of_range("tftl::numeric::max: the vector is empty");
+  }
+  const T* data = detail::aligned_data(values);
+  std::size_t count = values.size();
+  return detail::run(tftl::simd::detect(), [=]() __attribute__((always_inline)) {
+    return detail::extremum_kernel<true, T>(data, count);
+  });
+}
+
+/**
+ * @brief Index of the first smallest element like std::min_element, 0 for an empty vector.
+ * The minimum is found by the vector kernel first and then searched for, NaN elements give an unspecified index.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+std::size_t argmin(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& values) {
+  if (values.empty()) {
+    return 0;
+  }
+  T smallest = numeric::min(values);
+  return std::find(values.data(), values.data() + values.size(), smallest) - values.data();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+std::size_t argmax(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& values) {
+  if (values.empty()) {
+    return 0;
+  }
+  T largest = numeric::max(values);
+  return std::find(values.data(), values.data() + values.size(), largest) - values.data();
+}
+
+/**
+ * @brief y += factor * x, as BLAS axpy.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void axpy(T factor, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& x, tftl::vector<T, Allocator, GrowthPolicy, Stats>& y) {
+  detail::check_arithmetic<T>();
+  if (x.size() != y.size()) {
+    throw std::invalid_argument("tftl::numeric::axpy: the vectors differ in size");
+  }
+  const T* source = detail::aligned_data(x);
+  T* target = detail::aligned_data(y);
+  std::size_t count = x.size();
+  detail::run(tftl::simd::detect(), [=]() __attribute__((always_inline)) {
+    detail::axpy_kernel<T>(factor, source, target, count);
+  });
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void scale(tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, T factor) {
+  detail::check_arithmetic<T>();
+  T* data = detail::aligned_data(values);
+  std::size_t count = values.size();
+  detail::run(tftl::simd::detect(), [=]() __attribute__((always_inline)) {
+    detail::scale_kernel<T>(factor, data, count);
+  });
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void clamp(tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, T low, T high) {
+  detail::check_arithmetic<T>();
+  if (high < low) {
+    throw std::invalid_argument("tftl::numeric::clamp: high is less than low");
+  }
+  T* data = detail::aligned_data(values);
+  std::size_t count = values.size();
+  detail::run(tftl::simd::detect(), [=]() __attribute__((always_inline)) {
+    detail::clamp_kernel<T>(low, high, data, count);
+  });
+}
+
+/**
+ * @brief Replaces every element by the sum of itself and all before it (inclusive scan).
+ *
+ * A scan carries one running sum, so it is left sequential and gives exactly the results of
+ * std::partial_sum; compensated keeps a Kahan-Babuska error term alongside the running sum of floating point elements.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void prefix_sum(tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, summation mode = summation::fast) {
+  detail::check_arithmetic<T>();
+  T* data = detail::aligned_data(values);
+  T total = 0;
+  if constexpr (std::is_floating_point<T>::value) {
+    if (mode == summation::compensated) {
+      T error = 0;
+      for (std::size_t i = 0; i < values.size(); ++i) {
+        detail::compensated_add(total, error, data[i]);
+        data[i] = total + error;
+      }
+      return;
+    }
+  }
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    total += data[i];
+    data[i] = total;
+  }
+}
+
+#undef TFTL_ALWAYS_INLINE
+} // namespace numeric
+} //namespace truefinch template library
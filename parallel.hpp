@@ -0,0 +1,640 @@
+//
+// Created by truefinch on 06.07.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "vector.hpp"
+
+namespace tftl {
+namespace parallel {
+/**
+ * Parallel algorithms over tftl::vector.
+ *
+ * Work is cut into chunks of at least grain_bytes, rounded to whole cache lines so that no two
+ * threads write the same line. A range of one chunk, or a pool of one thread, runs the serial
+ * standard algorithm on the calling thread without touching the pool.
+ */
+constexpr std::size_t cache_line = 64;
+
+/**
+ * @brief tftl::parallel::thread_pool is a work-stealing pool: every worker owns a deque, takes
+ * its own newest task first and steals the oldest tasks of the others when it runs dry.
+ * A thread waiting for its tasks runs queued tasks meanwhile, so nested fork-join never deadlocks.
+ */
+class thread_pool {
+ public:
+  // @formatter:off
+  typedef std::function<void()> task;
+  // @formatter:on
+
+  // threads counts the calling thread, which always takes part, so threads - 1 workers are started
+  explicit thread_pool(std::size_t threads = std::thread::hardware_concurrency(), std::size_t grain_bytes = 64 * 1024);
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+  ~thread_pool();
+
+  static thread_pool& shared();
+
+  std::size_t concurrency() const noexcept;
+  std::size_t grain_bytes() const noexcept;
+
+  // Calls body(i) for every i in [0, count) and returns when all are done, rethrowing the first exception
+  template<class Body>
+  void parallel_for(std::size_t count, const Body& body);
+
+  // Runs both functions, possibly at the same time
+  template<class First, class Second>
+  void invoke(const First& first, const Second& second);
+
+ private:
+  struct group {
+    std::atomic<std::size_t> pending{0};
+    std::mutex               mutex;
+    std::exception_ptr       error;
+
+    void fail(std::exception_ptr exception);
+  };
+
+  struct worker {
+    std::mutex       mutex;
+    std::deque<task> tasks;
+  };
+
+  void submit(task work);
+  bool run_one();
+  void wait(group& tasks);
+  void work(std::size_t index);
+
+  std::vector<std::unique_ptr<worker>> workers_;
+  std::vector<std::thread>             threads_;
+  std::size_t                          grain_bytes_;
+  std::atomic<std::size_t>             queued_{0};
+  std::atomic<std::size_t>             next_{0};
+  std::mutex                           sleep_mutex_;
+  std::condition_variable              wake_;
+  bool                                 stopping_ = false;
+
+  // The pool and index of the worker running on this thread, if any
+  static inline thread_local thread_pool* current_pool_ = nullptr;
+  static inline thread_local std::size_t  current_index_ = 0;
+};
+
+inline void thread_pool::group::fail(std::exception_ptr exception) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (!this->error) {
+    this->error = exception;
+  }
+}
+
+inline thread_pool::thread_pool(std::size_t threads, std::size_t grain_bytes)
+    : grain_bytes_(std::max(grain_bytes, cache_line)) {
+  std::size_t count = threads > 1 ? threads - 1 : 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    this->workers_.emplace_back(new worker);
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    this->threads_.emplace_back(&thread_pool::work, this, i);
+  }
+}
+
+inline thread_pool::~thread_pool() {
+  {
+    std::lock_guard<std::mutex> lock(this->sleep_mutex_);
+    this->stopping_ = true;
+  }
+  this->wake_.notify_all();
+  for (auto& thread : this->threads_) {
+    thread.join();
+  }
+}
+
+// Never destroyed, like the stats registry: algorithms may still run during static destruction
+inline thread_pool& thread_pool::shared() {
+  static thread_pool* pool = new thread_pool;
+  return *pool;
+}
+
+inline std::size_t thread_pool::concurrency() const noexcept {
+  return this->workers_.size() + 1;
+}
+
+inline std::size_t thread_pool::grain_bytes() const noexcept {
+  return this->grain_bytes_;
+}
+
+inline void thread_pool::submit(task work) {
+  std::size_t index = current_pool_ == this ? current_index_
+                                            : this->next_.fetch_add(1, std::memory_order_relaxed) % this->workers_.size();
+  {
+    std::lock_guard<std::mutex> lock(this->workers_[index]->mutex);
+    this->workers_[index]->tasks.push_back(std::move(work));
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->sleep_mutex_);
+    this->queued_.fetch_add(1);
+  }
+  this->wake_.notify_one();
+}
+
+// Pops the newest task of this thread's own deque or steals the oldest of another one
+inline bool thread_pool::run_one() {
+  std::size_t count = this->workers_.size();
+  std::size_t own = current_pool_ == this ? current_index_ : 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    std::size_t index = (own + i) % count;
+    worker& victim = *this->workers_[index];
+    task work;
+    {
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (victim.tasks.empty()) {
+        continue;
+      }
+      if (current_pool_ == this && i == 0) {
+        work = std::move(victim.tasks.back());
+        victim.tasks.pop_back();
+      } else {
+        work = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+      }
+    }
+    this->queued_.fetch_sub(1);
+    work();
+    return true;
+  }
+  return false;
+}
+
+inline void thread_pool::wait(group& tasks) {
+  while (tasks.pending.load(std::memory_order_acquire) != 0) {
+    if (!this->run_one()) {
+      std::this_thread::yield();
+    }
+  }
+  if (tasks.error) {
+    std::rethrow_exception(tasks.error);
+  }
+}
+
+inline void thread_pool::work(std::size_t index) {
+  current_pool_ = this;
+  current_index_ = index;
+  while (true) {
+    if (this->run_one()) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(this->sleep_mutex_);
+    this->wake_.wait(lock, [this] { return this->stopping_ || this->queued_.load() != 0; });
+    if (this->stopping_) {
+      return;
+    }
+  }
+}
+
+template<class Body>
+void thread_pool::parallel_for(std::size_t count, const Body& body) {
+  if (count == 0) {
+    return;
+  }
+  if (this->workers_.empty() || count == 1) {
+    for (std::size_t i = 0; i < count; ++i) {
+      body(i);
+    }
+    return;
+  }
+
+  group tasks;
+  tasks.pending = count - 1;
+  for (std::size_t i = 1; i < count; ++i) {
+    try {
+      this->submit([&tasks, &body, i] {
+        try {
+          body(i);
+        } catch (...) {
+          tasks.fail(std::current_exception());
+        }
+        tasks.pending.fetch_sub(1, std::memory_order_release);
+      });
+    } catch (...) {
+      // The queued tasks refer to tasks and body, so they must finish before this frame unwinds
+      tasks.fail(std::current_exception());
+      tasks.pending.fetch_sub(count - i, std::memory_order_release);
+      this->wait(tasks);
+    }
+  }
+  try {
+    body(0);
+  } catch (...) {
+    tasks.fail(std::current_exception());
+  }
+  this->wait(tasks);
+}
+
+template<class First, class Second>
+void thread_pool::invoke(const First& first, const Second& second) {
+  if (this->workers_.empty()) {
+    first();
+    second();
+    return;
+  }
+
+  // A throwing submit has queued nothing, so no task can outlive this frame
+  group tasks;
+  tasks.pending = 1;
+  this->submit([&tasks, &second] {
+    try {
+      second();
+    } catch (...) {
+      tasks.fail(std::current_exception());
+    }
+    tasks.pending.fetch_sub(1, std::memory_order_release);
+  });
+  try {
+    first();
+  } catch (...) {
+    tasks.fail(std::current_exception());
+  }
+  this->wait(tasks);
+}
+
+namespace detail {
+// Elements per chunk: at least grain_bytes, in whole cache lines when T packs into them
+template<typename T>
+std::size_t grain(const thread_pool& pool) noexcept {
+  std::size_t elements = std::max<std::size_t>(pool.grain_bytes() / sizeof(T), 1);
+  if (cache_line % sizeof(T) == 0) {
+    std::size_t line = cache_line / sizeof(T);
+    elements = (elements + line - 1) / line * line;
+  }
+  return elements;
+}
+
+template<typename T>
+bool serial(const thread_pool& pool, std::size_t count) noexcept {
+  return pool.concurrency() == 1 || count <= grain<T>(pool);
+}
+
+// Calls body(first, last) on consecutive chunks of [0, count)
+template<typename T, class Body>
+void for_chunks(thread_pool& pool, std::size_t count, const Body& body) {
+  std::size_t size = grain<T>(pool);
+  pool.parallel_for((count + size - 1) / size, [&](std::size_t chunk) {
+    body(chunk * size, std::min(count, (chunk + 1) * size));
+  });
+}
+
+// Moves the stable merge of two sorted ranges to out, splitting it at the middle of the longer range
+template<class It, class Out, class Compare>
+void merge(thread_pool& pool, std::size_t grain, It first1, It last1, It first2, It last2, Out out, const Compare& comp) {
+  std::size_t count1 = last1 - first1;
+  std::size_t count2 = last2 - first2;
+  auto serial_merge = [&] {
+    std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1), std::make_move_iterator(first2),
+               std::make_move_iterator(last2), out, comp);
+  };
+  if (count1 + count2 <= grain || count1 <= 1 || count2 <= 1) {
+    serial_merge();
+    return;
+  }
+
+  It middle1, middle2;
+  if (count1 >= count2) {
+    middle1 = first1 + count1 / 2;
+    middle2 = std::lower_bound(first2, last2, *middle1, comp);
+  } else {
+    middle2 = first2 + count2 / 2;
+    middle1 = std::upper_bound(first1, last1, *middle2, comp);
+  }
+  // With a grain of one element the split may leave one half empty and the other as big as the input
+  std::size_t left = (middle1 - first1) + (middle2 - first2);
+  if (left == 0 || left == count1 + count2) {
+    serial_merge();
+    return;
+  }
+  Out out_middle = out + left;
+  pool.invoke([&] { detail::merge(pool, grain, first1, middle1, first2, middle2, out, comp); },
+              [&] { detail::merge(pool, grain, middle1, last1, middle2, last2, out_middle, comp); });
+}
+
+// Sorts [data, data + count); the result is left in buffer instead when to_buffer is set
+template<bool Stable, typename T, class Compare>
+void merge_sort(thread_pool& pool, std::size_t grain, T* data, T* buffer, std::size_t count, bool to_buffer,
+                const Compare& comp) {
+  if (count <= grain) {
+    if (Stable) {
+      std::stable_sort(data, data + count, comp);
+    } else {
+      std::sort(data, data + count, comp);
+    }
+    if (to_buffer) {
+      std::move(data, data + count, buffer);
+    }
+    return;
+  }
+
+  std::size_t half = count / 2;
+  pool.invoke([&] { detail::merge_sort<Stable>(pool, grain, data, buffer, half, !to_buffer, comp); },
+              [&] { detail::merge_sort<Stable>(pool, grain, data + half, buffer + half, count - half, !to_buffer, comp); });
+  if (to_buffer) {
+    detail::merge(pool, grain, data, data + half, data + half, data + count, buffer, comp);
+  } else {
+    detail::merge(pool, grain, buffer, buffer + half, buffer + half, buffer + count, data, comp);
+  }
+}
+
+template<bool Stable, typename T, typename Allocator, typename GrowthPolicy, typename Stats, class Compare>
+void sort(thread_pool& pool, tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, const Compare& comp) {
+  if (serial<T>(pool, values.size())) {
+    if (Stable) {
+      std::stable_sort(values.begin(), values.end(), comp);
+    } else {
+      std::sort(values.begin(), values.end(), comp);
+    }
+    return;
+  }
+
+  static_assert(std::is_default_constructible<T>::value, "tftl::parallel::sort: the merge buffer needs default constructible elements");
+  tftl::vector<T> buffer;
+  buffer.resize_for_overwrite(values.size());
+  std::size_t leaf = std::max(grain<T>(pool), values.size() / (pool.concurrency() * 4));
+  detail::merge_sort<Stable>(pool, leaf, values.data(), buffer.data(), values.size(), false, comp);
+}
+
+/**
+ * Compacts the chunks of values in parallel, keep(values, i, kept) deciding on element i given the last kept
+ * element of the chunk or nullptr, then moves the kept prefixes together and erases the rest.
+ * Returns the number of elements kept.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class Keep>
+std::size_t compact(thread_pool& pool, tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, const Keep& keep) {
+  std::size_t size = grain<T>(pool);
+  std::size_t chunks = (values.size() + size - 1) / size;
+  std::vector<std::size_t> kept(chunks);
+  T* data = values.data();
+
+  pool.parallel_for(chunks, [&](std::size_t chunk) {
+    std::size_t first = chunk * size;
+    std::size_t last = std::min(values.size(), first + size);
+    std::size_t out = first;
+    for (std::size_t i = first; i < last; ++i) {
+      if (keep(data, i, out == first ? nullptr : data + out - 1)) {
+        if (out != i) {
+          data[out] = std::move(data[i]);
+        }
+        ++out;
+      }
+    }
+    kept[chunk] = out - first;
+  });
+
+  std::size_t total = chunks == 0 ? 0 : kept[0];
+  for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+    T* first = data + chunk * size;
+    if (first != data + total) {
+      std::move(first, first + kept[chunk], data + total);
+    }
+    total += kept[chunk];
+  }
+  values.erase(values.begin() + total, values.end());
+  return total;
+}
+} // namespace detail
+
+/**
+ * @brief Calls function on every element.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class Function>
+void for_each(thread_pool& pool, tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, Function function) {
+  if (detail::serial<T>(pool, values.size())) {
+    std::for_each(values.begin(), values.end(), function);
+    return;
+  }
+  T* data = values.data();
+  detail::for_chunks<T>(pool, values.size(), [&](std::size_t first, std::size_t last) {
+    std::for_each(data + first, data + last, function);
+  });
+}
+
+/**
+ * @brief Replaces every element by op(element).
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class UnaryOperation>
+void transform(thread_pool& pool, tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, UnaryOperation op) {
+  T* data = values.data();
+  if (detail::serial<T>(pool, values.size())) {
+    std::transform(data, data + values.size(), data, op);
+    return;
+  }
+  detail::for_chunks<T>(pool, values.size(), [&](std::size_t first, std::size_t last) {
+    std::transform(data + first, data + last, data + first, op);
+  });
+}
+
+/**
+ * @brief Makes output hold op(element) for every element of input.
+ * The results are assigned over default-initialized elements, as resize_for_overwrite leaves them.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, typename U, typename OutAllocator,
+    typename OutGrowthPolicy, typename OutStats, class UnaryOperation>
+void transform(thread_pool& pool, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& input,
+               tftl::vector<U, OutAllocator, OutGrowthPolicy, OutStats>& output, UnaryOperation op) {
+  output.clear();
+  output.resize_for_overwrite(input.size());
+  const T* source = input.data();
+  U* target = output.data();
+  if (detail::serial<T>(pool, input.size())) {
+    std::transform(source, source + input.size(), target, op);
+    return;
+  }
+  detail::for_chunks<T>(pool, input.size(), [&](std::size_t first, std::size_t last) {
+    std::transform(source + first, source + last, target + first, op);
+  });
+}
+
+/**
+ * @brief Folds every element into init with op, which must be associative.
+ * Chunks are summed and their results folded in order, and the chunks depend only on the grain,
+ * so the result does not change with the number of threads.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, typename U, class BinaryOperation = std::plus<>>
+U reduce(thread_pool& pool, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, U init,
+         BinaryOperation op = BinaryOperation()) {
+  const T* data = values.data();
+  if (values.empty()) {
+    return init;
+  }
+  if (values.size() <= detail::grain<T>(pool)) {
+    U result = std::move(init);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      result = op(std::move(result), data[i]);
+    }
+    return result;
+  }
+
+  std::size_t size = detail::grain<T>(pool);
+  std::size_t chunks = (values.size() + size - 1) / size;
+  std::vector<std::unique_ptr<U>> partials(chunks);
+  detail::for_chunks<T>(pool, values.size(), [&](std::size_t first, std::size_t last) {
+    std::unique_ptr<U> partial(new U(data[first]));
+    for (std::size_t i = first + 1; i < last; ++i) {
+      *partial = op(std::move(*partial), data[i]);
+    }
+    partials[first / size] = std::move(partial);
+  });
+  U result = std::move(init);
+  for (auto& partial : partials) {
+    result = op(std::move(result), std::move(*partial));
+  }
+  return result;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class Compare = std::less<>>
+void sort(thread_pool& pool, tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, Compare comp = Compare()) {
+  detail::sort<false>(pool, values, comp);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class Compare = std::less<>>
+void stable_sort(thread_pool& pool, tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, Compare comp = Compare()) {
+  detail::sort<true>(pool, values, comp);
+}
+
+/**
+ * @brief Appends the elements satisfying pred to output, in order. Returns how many were appended.
+ * pred is called twice per element, once to size the output and once to copy.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, typename OutAllocator,
+    typename OutGrowthPolicy, typename OutStats, class Predicate>
+std::size_t copy_if(thread_pool& pool, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& input,
+                    tftl::vector<T, OutAllocator, OutGrowthPolicy, OutStats>& output, Predicate pred) {
+  const T* data = input.data();
+  if (detail::serial<T>(pool, input.size())) {
+    std::size_t before = output.size();
+    for (std::size_t i = 0; i < input.size(); ++i) {
+      if (pred(data[i])) {
+        output.push_back(data[i]);
+      }
+    }
+    return output.size() - before;
+  }
+
+  std::size_t size = detail::grain<T>(pool);
+  std::size_t chunks = (input.size() + size - 1) / size;
+  std::vector<std::size_t> offsets(chunks + 1);
+  detail::for_chunks<T>(pool, input.size(), [&](std::size_t first, std::size_t last) {
+    offsets[first / size + 1] = std::count_if(data + first, data + last, pred);
+  });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  std::size_t before = output.size();
+  output.resize_for_overwrite(before + offsets.back());
+  T* target = output.data() + before;
+  detail::for_chunks<T>(pool, input.size(), [&](std::size_t first, std::size_t last) {
+    std::copy_if(data + first, data + last, target + offsets[first / size], pred);
+  });
+  return offsets.back();
+}
+
+/**
+ * @brief Erases the elements satisfying pred, keeping the order of the rest. Returns the new size.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class Predicate>
+std::size_t remove_if(thread_pool& pool, tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, Predicate pred) {
+  if (detail::serial<T>(pool, values.size())) {
+    values.erase(std::remove_if(values.begin(), values.end(), pred), values.end());
+    return values.size();
+  }
+  return detail::compact(pool, values, [&](const T* data, std::size_t i, const T*) { return !pred(data[i]); });
+}
+
+/**
+ * @brief Erases all but the first of every run of consecutive equivalent elements. Returns the new size.
+ * pred must be an equivalence relation, as for std::unique.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class BinaryPredicate = std::equal_to<>>
+std::size_t unique(thread_pool& pool, tftl::vector<T, Allocator, GrowthPolicy, Stats>& values,
+                   BinaryPredicate pred = BinaryPredicate()) {
+  if (detail::serial<T>(pool, values.size())) {
+    values.erase(std::unique(values.begin(), values.end(), pred), values.end());
+    return values.size();
+  }
+
+  // The first element of a chunk is compared with the end of the previous chunk before any chunk is compacted
+  std::size_t size = detail::grain<T>(pool);
+  std::vector<char> starts_run((values.size() + size - 1) / size);
+  const T* data = values.data();
+  pool.parallel_for(starts_run.size(), [&](std::size_t chunk) {
+    starts_run[chunk] = chunk == 0 || !pred(data[chunk * size - 1], data[chunk * size]);
+  });
+  return detail::compact(pool, values, [&](const T* elements, std::size_t i, const T* last_kept) {
+    if (i % size == 0) {
+      return static_cast<bool>(starts_run[i / size]);
+    }
+    return !pred(last_kept != nullptr ? *last_kept : elements[i - 1], elements[i]);
+  });
+}
+
+// The same algorithms on the shared pool
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class Function>
+void for_each(tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, Function function) {
+  parallel::for_each(thread_pool::shared(), values, function);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class UnaryOperation>
+void transform(tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, UnaryOperation op) {
+  parallel::transform(thread_pool::shared(), values, op);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, typename U, typename OutAllocator, typename OutGrowthPolicy,
+    typename OutStats, class UnaryOperation>
+void transform(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& input, tftl::vector<U, OutAllocator, OutGrowthPolicy, OutStats>& output,
+               UnaryOperation op) {
+  parallel::transform(thread_pool::shared(), input, output, op);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, typename U, class BinaryOperation = std::plus<>>
+U reduce(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, U init, BinaryOperation op = BinaryOperation()) {
+  return parallel::reduce(thread_pool::shared(), values, std::move(init), op);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class Compare = std::less<>>
+void sort(tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, Compare comp = Compare()) {
+  parallel::sort(thread_pool::shared(), values, comp);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class Compare = std::less<>>
+void stable_sort(tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, Compare comp = Compare()) {
+  parallel::stable_sort(thread_pool::shared(), values, comp);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, typename OutAllocator, typename OutGrowthPolicy, typename OutStats, class Predicate>
+std::size_t copy_if(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& input, tftl::vector<T, OutAllocator, OutGrowthPolicy, OutStats>& output,
+                    Predicate pred) {
+  return parallel::copy_if(thread_pool::shared(), input, output, pred);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class Predicate>
+std::size_t remove_if(tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, Predicate pred) {
+  return parallel::remove_if(thread_pool::shared(), values, pred);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats, class BinaryPredicate = std::equal_to<>>
+std::size_t unique(tftl::vector<T, Allocator, GrowthPolicy, Stats>& values, BinaryPredicate pred = BinaryPredicate()) {
+  return parallel::unique(thread_pool::shared(), values, pred);
+}
+} // namespace parallel
+} //namespace truefinch template library
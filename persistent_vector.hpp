@@ -0,0 +1,803 @@
+//
+// Created by truefinch on 19.07.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "span.hpp"
+#include "vector.hpp"
+
+namespace tftl {
+template<typename T>
+class persistent_vector;
+
+template<typename T>
+class transient_vector;
+
+/**
+ * @brief Random access iterator over a tftl::persistent_vector. It remembers the leaf it last read,
+ * so walking the vector costs one trie lookup per chunk of 32 elements instead of one per element.
+ */
+template<typename T>
+class persistent_iterator {
+ public:
+  // @formatter:off
+  typedef std::ptrdiff_t                  difference_type;
+  typedef T                               value_type;
+  typedef const T*                        pointer;
+  typedef const T&                        reference;
+  typedef std::random_access_iterator_tag iterator_category;
+  // @formatter:on
+
+  persistent_iterator() noexcept = default;
+  persistent_iterator(const persistent_vector<T>* vector, difference_type index) noexcept
+      : vector_(vector), index_(index) {}
+
+  difference_type index() const noexcept;
+
+  persistent_iterator&      operator++();
+  persistent_iterator&      operator--();
+  const persistent_iterator operator++(int);
+  const persistent_iterator operator--(int);
+  persistent_iterator&      operator+=(difference_type);
+  persistent_iterator&      operator-=(difference_type);
+
+  difference_type     operator-(const persistent_iterator&) const;
+  persistent_iterator operator+(difference_type) const;
+  persistent_iterator operator-(difference_type) const;
+
+  reference operator*() const;
+  pointer   operator->() const;
+  reference operator[](difference_type) const;
+
+  bool operator==(const persistent_iterator&) const;
+  bool operator!=(const persistent_iterator&) const;
+  bool operator>(const persistent_iterator&) const;
+  bool operator<(const persistent_iterator&) const;
+  bool operator>=(const persistent_iterator&) const;
+  bool operator<=(const persistent_iterator&) const;
+
+ private:
+  const persistent_vector<T>* vector_ = nullptr;
+  difference_type             index_ = 0;
+  mutable const T*            chunk_ = nullptr; //Elements of the leaf holding chunk_index_
+  mutable difference_type     chunk_index_ = 0; //Index of its first element
+};
+
+/**
+ * @brief tftl::persistent_vector is an immutable sequence: push_back and set leave the vector alone
+ * and return a new version, which shares everything but the changed path with the old one.
+ *
+ * The elements live in a radix balanced trie of 32-way nodes with the last, incomplete leaf kept
+ * aside as the tail, as in Clojure's vector: push_back, set and operator[] take O(log32 n), which
+ * is at most 7 levels for 2^32 elements, and a new version copies at most one node per level.
+ * Nodes are reference counted, so versions can be handed to readers on other threads.
+ *
+ * Batches of updates go through transient(): the tftl::transient_vector it returns changes nodes
+ * that nobody else holds in place, and persistent() turns it back into a vector.
+ *
+ * @tparam T The type of the elements, which must be CopyConstructible.
+ */
+template<typename T>
+class persistent_vector {
+ public:
+  // @formatter:off
+  typedef T                                     value_type;
+  typedef std::size_t                           size_type;
+  typedef std::ptrdiff_t                        difference_type;
+  typedef const T&                              reference;
+  typedef const T&                              const_reference;
+  typedef const T*                              pointer;
+  typedef const T*                              const_pointer;
+  typedef persistent_iterator<T>                iterator;
+  typedef persistent_iterator<T>                const_iterator;
+  typedef std::reverse_iterator<const_iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+  // @formatter:on
+
+  static constexpr size_type chunk_size = 32; //Elements per leaf
+
+  // construct/copy/destroy:
+  persistent_vector() noexcept = default;
+  template<class InputIt, typename = typename std::enable_if<
+      std::is_base_of<std::input_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value>::type>
+  persistent_vector(InputIt first, InputIt last);
+  persistent_vector(std::initializer_list<T> init);
+  template<typename Allocator, typename GrowthPolicy, typename Stats>
+  explicit persistent_vector(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& values);
+  persistent_vector(const persistent_vector& other) noexcept;
+  persistent_vector(persistent_vector&& other) noexcept;
+  ~persistent_vector();
+
+  persistent_vector& operator=(persistent_vector other) noexcept;
+
+  // Element access:
+  const_reference at(size_type pos) const;
+  const_reference operator[](size_type pos) const noexcept;
+  const_reference front() const noexcept;
+  const_reference back() const noexcept;
+
+  // Iterators:
+  const_iterator         begin() const noexcept;
+  const_iterator         cbegin() const noexcept;
+  const_iterator         end() const noexcept;
+  const_iterator         cend() const noexcept;
+  const_reverse_iterator rbegin() const noexcept;
+  const_reverse_iterator rend() const noexcept;
+
+  // Calls f with a tftl::span<const T> of every leaf in order, the fastest way to read everything
+  template<class Function>
+  void for_each_chunk(Function f) const;
+
+  // Capacity:
+  bool      empty() const noexcept;
+  size_type size() const noexcept;
+
+  // New versions:
+  persistent_vector push_back(const T& value) const;
+  persistent_vector push_back(T&& value) const;
+  persistent_vector set(size_type pos, const T& value) const;
+  persistent_vector set(size_type pos, T&& value) const;
+
+  transient_vector<T> transient() const& noexcept;
+  transient_vector<T> transient() && noexcept;
+
+  // Conversion:
+  template<class Vector = tftl::vector<T>>
+  Vector to_vector() const;
+
+  void swap(persistent_vector& other) noexcept;
+
+ private:
+  friend class persistent_iterator<T>;
+  friend class transient_vector<T>;
+
+  static constexpr unsigned  bits = 5;
+  static constexpr size_type mask = chunk_size - 1;
+
+  struct node {
+    std::atomic<std::size_t> references{1};
+    bool                     is_leaf;
+
+    explicit node(bool is_leaf) noexcept : is_leaf(is_leaf) {}
+  };
+
+  struct branch : node {
+    node* children[chunk_size] = {};
+
+    branch() noexcept : node(false) {}
+  };
+
+  struct leaf : node {
+    size_type size = 0;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type values[chunk_size];
+
+    leaf() noexcept : node(true) {}
+    T*       data() noexcept { return reinterpret_cast<T*>(this->values); }
+    const T* data() const noexcept { return reinterpret_cast<const T*>(this->values); }
+  };
+
+  size_type size_ = 0;
+  unsigned  shift_ = bits;   //Level of the root, the bits of an index it is selected by start here
+  branch*   root_ = nullptr; //Trie of the full leaves, nullptr up to chunk_size elements
+  leaf*     tail_ = nullptr; //Last leaf, nullptr if the vector is empty
+
+  size_type tail_offset() const noexcept;
+  leaf*     leaf_for(size_type pos) const noexcept;
+  template<class Function>
+  static void walk(const node* current, Function& f);
+
+  // Methods to change the vector in place, copying every node on the way that is shared:
+  template<class Value>
+  void push_back_in_place(Value&& value);
+  template<class Value>
+  void set_in_place(size_type pos, Value&& value);
+  void push_tail();
+  void push_tail(branch* parent, unsigned level);
+  static node* new_path(unsigned level, leaf* tail);
+
+  // Methods to manage the nodes:
+  template<class Node>
+  static Node* own(Node* current);
+  static leaf*   clone(const leaf* other);
+  static branch* clone(const branch* other);
+  static void    retain(node* current) noexcept;
+  static void    release(node* current) noexcept;
+};
+
+/**
+ * @brief tftl::transient_vector is the mutable form of a tftl::persistent_vector, for batches of
+ * updates: push_back and set change the vector itself, and only the first change of a node that
+ * is still shared with a persistent version copies it. persistent() hands the result back in O(1).
+ */
+template<typename T>
+class transient_vector {
+ public:
+  // @formatter:off
+  typedef T              value_type;
+  typedef std::size_t    size_type;
+  typedef const T&       const_reference;
+  // @formatter:on
+
+  transient_vector() noexcept = default;
+  explicit transient_vector(persistent_vector<T> vector) noexcept : vector_(std::move(vector)) {}
+
+  const_reference operator[](size_type pos) const noexcept;
+  bool            empty() const noexcept;
+  size_type       size() const noexcept;
+
+  void push_back(const T& value);
+  void push_back(T&& value);
+  void set(size_type pos, const T& value);
+  void set(size_type pos, T&& value);
+
+  // Returns the vector, the transient is left empty
+  persistent_vector<T> persistent() noexcept;
+
+ private:
+  persistent_vector<T> vector_;
+};
+
+template<typename T>
+constexpr typename persistent_vector<T>::size_type persistent_vector<T>::chunk_size;
+
+// construct/copy/destroy:
+template<typename T>
+template<class InputIt, typename>
+persistent_vector<T>::persistent_vector(InputIt first, InputIt last) : persistent_vector() {
+  // Delegating first lets the destructor free the nodes built so far if a copy throws
+  for (; first != last; ++first) {
+    this->push_back_in_place(*first);
+  }
+}
+
+template<typename T>
+persistent_vector<T>::persistent_vector(std::initializer_list<T> init) : persistent_vector(init.begin(), init.end()) {
+}
+
+template<typename T>
+template<typename Allocator, typename GrowthPolicy, typename Stats>
+persistent_vector<T>::persistent_vector(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& values)
+    : persistent_vector(values.data(), values.data() + values.size()) {
+}
+
+template<typename T>
+persistent_vector<T>::persistent_vector(const persistent_vector& other) noexcept
+    : size_(other.size_), shift_(other.shift_), root_(other.root_), tail_(other.tail_) {
+  retain(this->root_);
+  retain(this->tail_);
+}
+
+template<typename T>
+persistent_vector<T>::persistent_vector(persistent_vector&& other) noexcept
+    : size_(other.size_), shift_(other.shift_), root_(other.root_), tail_(other.tail_) {
+  other.size_ = 0;
+  other.shift_ = bits;
+  other.root_ = nullptr;
+  other.tail_ = nullptr;
+}
+
+template<typename T>
+persistent_vector<T>::~persistent_vector() {
+  release(this->root_);
+  release(this->tail_);
+}
+
+template<typename T>
+persistent_vector<T>& persistent_vector<T>::operator=(persistent_vector other) noexcept {
+  this->swap(other);
+  return *this;
+}
+
+// Element access:
+template<typename T>
+typename persistent_vector<T>::const_reference persistent_vector<T>::at(size_type pos) const {
+  if (pos >= this->size_) {
+    throw std::out_of_range("tftl::persistent_vector::at: index out of range");
+  }
+  return (*this)[pos];
+}
+
+template<typename T>
+typename persistent_vector<T>::const_reference persistent_vector<T>::operator[](size_type pos) const noexcept {
+  return this->leaf_for(pos)->data()[pos & mask];
+}
+
+template<typename T>
+typename persistent_vector<T>::const_reference persistent_vector<T>::front() const noexcept {
+  return (*this)[0];
+}
+
+template<typename T>
+typename persistent_vector<T>::const_reference persistent_vector<T>::back() const noexcept {
+  return this->tail_->data()[this->tail_->size - 1];
+}
+
+// Iterators:
+template<typename T>
+typename persistent_vector<T>::const_iterator persistent_vector<T>::begin() const noexcept {
+  return const_iterator(this, 0);
+}
+
+template<typename T>
+typename persistent_vector<T>::const_iterator persistent_vector<T>::cbegin() const noexcept {
+  return const_iterator(this, 0);
+}
+
+template<typename T>
+typename persistent_vector<T>::const_iterator persistent_vector<T>::end() const noexcept {
+  return const_iterator(this, this->size_);
+}
+
+template<typename T>
+typename persistent_vector<T>::const_iterator persistent_vector<T>::cend() const noexcept {
+  return const_iterator(this, this->size_);
+}
+
+template<typename T>
+typename persistent_vector<T>::const_reverse_iterator persistent_vector<T>::rbegin() const noexcept {
+  return const_reverse_iterator(this->end());
+}
+
+template<typename T>
+typename persistent_vector<T>::const_reverse_iterator persistent_vector<T>::rend() const noexcept {
+  return const_reverse_iterator(this->begin());
+}
+
+template<typename T>
+template<class Function>
+void persistent_vector<T>::for_each_chunk(Function f) const {
+  if (this->root_ != nullptr) {
+    walk(this->root_, f);
+  }
+  if (this->tail_ != nullptr) {
+    f(tftl::span<const T>(this->tail_->data(), this->tail_->size));
+  }
+}
+
+// Capacity:
+template<typename T>
+bool persistent_vector<T>::empty() const noexcept {
+  return this->size_ == 0;
+}
+
+template<typename T>
+typename persistent_vector<T>::size_type persistent_vector<T>::size() const noexcept {
+  return this->size_;
+}
+
+// New versions:
+template<typename T>
+persistent_vector<T> persistent_vector<T>::push_back(const T& value) const {
+  persistent_vector result(*this);
+  result.push_back_in_place(value);
+  return result;
+}
+
+template<typename T>
+persistent_vector<T> persistent_vector<T>::push_back(T&& value) const {
+  persistent_vector result(*this);
+  result.push_back_in_place(std::move(value));
+  return result;
+}
+
+template<typename T>
+persistent_vector<T> persistent_vector<T>::set(size_type pos, const T& value) const {
+  persistent_vector result(*this);
+  result.set_in_place(pos, value);
+  return result;
+}
+
+template<typename T>
+persistent_vector<T> persistent_vector<T>::set(size_type pos, T&& value) const {
+  persistent_vector result(*this);
+  result.set_in_place(pos, std::move(value));
+  return result;
+}
+
+template<typename T>
+transient_vector<T> persistent_vector<T>::transient() const& noexcept {
+  return transient_vector<T>(*this);
+}
+
+template<typename T>
+transient_vector<T> persistent_vector<T>::transient() && noexcept {
+  return transient_vector<T>(std::move(*this));
+}
+
+// Conversion:
+template<typename T>
+template<class Vector>
+Vector persistent_vector<T>::to_vector() const {
+  Vector result;
+  result.reserve(this->size_);
+  this->for_each_chunk([&result](tftl::span<const T> chunk) {
+    result.insert(result.end(), chunk.data(), chunk.data() + chunk.size());
+  });
+  return result;
+}
+
+template<typename T>
+void persistent_vector<T>::swap(persistent_vector& other) noexcept {
+  std::swap(this->size_, other.size_);
+  std::swap(this->shift_, other.shift_);
+  std::swap(this->root_, other.root_);
+  std::swap(this->tail_, other.tail_);
+}
+
+// Index of the first element of the tail, all elements before it are in the trie
+template<typename T>
+typename persistent_vector<T>::size_type persistent_vector<T>::tail_offset() const noexcept {
+  return this->size_ <= chunk_size ? 0 : (this->size_ - 1) & ~mask;
+}
+
+template<typename T>
+typename persistent_vector<T>::leaf* persistent_vector<T>::leaf_for(size_type pos) const noexcept {
+  if (pos >= this->tail_offset()) {
+    return this->tail_;
+  }
+  const node* current = this->root_;
+  for (unsigned level = this->shift_; level > 0; level -= bits) {
+    current = static_cast<const branch*>(current)->children[(pos >> level) & mask];
+  }
+  return static_cast<leaf*>(const_cast<node*>(current));
+}
+
+template<typename T>
+template<class Function>
+void persistent_vector<T>::walk(const node* current, Function& f) {
+  if (current->is_leaf) {
+    const leaf* values = static_cast<const leaf*>(current);
+    f(tftl::span<const T>(values->data(), values->size));
+    return;
+  }
+  for (const node* child : static_cast<const branch*>(current)->children) {
+    if (child == nullptr) {
+      return; // the trie is filled from the left
+    }
+    walk(child, f);
+  }
+}
+
+// value may refer to an element of the vector: a shared node it lives in is copied, never freed
+template<typename T>
+template<class Value>
+void persistent_vector<T>::push_back_in_place(Value&& value) {
+  if (this->tail_ != nullptr && this->size_ - this->tail_offset() < chunk_size) {
+    this->tail_ = own(this->tail_);
+    ::new(static_cast<void*>(this->tail_->data() + this->tail_->size)) T(std::forward<Value>(value));
+    ++this->tail_->size;
+    ++this->size_;
+    return;
+  }
+
+  // The tail is full: the new element starts the next one, and the full one moves into the trie
+  leaf* next = new leaf();
+  try {
+    ::new(static_cast<void*>(next->data())) T(std::forward<Value>(value));
+  } catch (...) {
+    delete next;
+    throw;
+  }
+  next->size = 1;
+  if (this->tail_ != nullptr) {
+    try {
+      this->push_tail();
+    } catch (...) {
+      release(next);
+      throw;
+    }
+  }
+  this->tail_ = next;
+  ++this->size_;
+}
+
+template<typename T>
+template<class Value>
+void persistent_vector<T>::set_in_place(size_type pos, Value&& value) {
+  if (pos >= this->size_) {
+    throw std::out_of_range("tftl::persistent_vector::set: index out of range");
+  }
+  if (pos >= this->tail_offset()) {
+    this->tail_ = own(this->tail_);
+    this->tail_->data()[pos & mask] = std::forward<Value>(value);
+    return;
+  }
+
+  branch* parent = this->root_ = own(this->root_);
+  for (unsigned level = this->shift_; level > bits; level -= bits) {
+    node*& child = parent->children[(pos >> level) & mask];
+    child = parent = own(static_cast<branch*>(child));
+  }
+  node*& slot = parent->children[(pos >> bits) & mask];
+  leaf* target = own(static_cast<leaf*>(slot));
+  slot = target;
+  target->data()[pos & mask] = std::forward<Value>(value);
+}
+
+// Moves the full tail into the trie, which gets a new root level when it is full itself
+template<typename T>
+void persistent_vector<T>::push_tail() {
+  if (this->root_ == nullptr) {
+    this->root_ = new branch();
+    this->root_->children[0] = this->tail_;
+  } else if ((this->size_ >> bits) > (size_type(1) << this->shift_)) {
+    branch* grown = new branch();
+    try {
+      grown->children[1] = new_path(this->shift_, this->tail_);
+    } catch (...) {
+      delete grown;
+      throw;
+    }
+    grown->children[0] = this->root_;
+    this->root_ = grown;
+    this->shift_ += bits;
+  } else {
+    this->root_ = own(this->root_);
+    this->push_tail(this->root_, this->shift_);
+  }
+}
+
+template<typename T>
+void persistent_vector<T>::push_tail(branch* parent, unsigned level) {
+  node*& child = parent->children[((this->size_ - 1) >> level) & mask];
+  if (level == bits) {
+    child = this->tail_;
+  } else if (child == nullptr) {
+    child = new_path(level - bits, this->tail_);
+  } else {
+    branch* owned = own(static_cast<branch*>(child));
+    child = owned;
+    this->push_tail(owned, level - bits);
+  }
+}
+
+// Chain of branches from level down to tail, nothing is left behind if an allocation throws
+template<typename T>
+typename persistent_vector<T>::node* persistent_vector<T>::new_path(unsigned level, leaf* tail) {
+  if (level == 0) {
+    return tail;
+  }
+  branch* result = new branch();
+  try {
+    result->children[0] = new_path(level - bits, tail);
+  } catch (...) {
+    delete result;
+    throw;
+  }
+  return result;
+}
+
+// Returns current if nobody else holds it, otherwise a copy which takes over the reference of the caller
+template<typename T>
+template<class Node>
+Node* persistent_vector<T>::own(Node* current) {
+  if (current->references.load(std::memory_order_acquire) == 1) {
+    return current;
+  }
+  Node* copy = clone(current);
+  release(current);
+  return copy;
+}
+
+template<typename T>
+typename persistent_vector<T>::leaf* persistent_vector<T>::clone(const leaf* other) {
+  leaf* result = new leaf();
+  try {
+    std::uninitialized_copy_n(other->data(), other->size, result->data());
+  } catch (...) {
+    delete result;
+    throw;
+  }
+  result->size = other->size;
+  return result;
+}
+
+template<typename T>
+typename persistent_vector<T>::branch* persistent_vector<T>::clone(const branch* other) {
+  branch* result = new branch();
+  for (size_type i = 0; i < chunk_size; ++i) {
+    result->children[i] = other->children[i];
+    retain(result->children[i]);
+  }
+  return result;
+}
+
+template<typename T>
+void persistent_vector<T>::retain(node* current) noexcept {
+  if (current != nullptr) {
+    current->references.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+template<typename T>
+void persistent_vector<T>::release(node* current) noexcept {
+  if (current == nullptr || current->references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  if (current->is_leaf) {
+    leaf* values = static_cast<leaf*>(current);
+    std::destroy_n(values->data(), values->size);
+    delete values;
+  } else {
+    branch* parent = static_cast<branch*>(current);
+    for (node* child : parent->children) {
+      release(child);
+    }
+    delete parent;
+  }
+}
+
+template<typename T>
+void swap(persistent_vector<T>& lhs, persistent_vector<T>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+// transient_vector:
+template<typename T>
+typename transient_vector<T>::const_reference transient_vector<T>::operator[](size_type pos) const noexcept {
+  return this->vector_[pos];
+}
+
+template<typename T>
+bool transient_vector<T>::empty() const noexcept {
+  return this->vector_.empty();
+}
+
+template<typename T>
+typename transient_vector<T>::size_type transient_vector<T>::size() const noexcept {
+  return this->vector_.size();
+}
+
+template<typename T>
+void transient_vector<T>::push_back(const T& value) {
+  this->vector_.push_back_in_place(value);
+}
+
+template<typename T>
+void transient_vector<T>::push_back(T&& value) {
+  this->vector_.push_back_in_place(std::move(value));
+}
+
+template<typename T>
+void transient_vector<T>::set(size_type pos, const T& value) {
+  this->vector_.set_in_place(pos, value);
+}
+
+template<typename T>
+void transient_vector<T>::set(size_type pos, T&& value) {
+  this->vector_.set_in_place(pos, std::move(value));
+}
+
+template<typename T>
+persistent_vector<T> transient_vector<T>::persistent() noexcept {
+  return std::move(this->vector_);
+}
+
+// persistent_iterator:
+template<typename T>
+typename persistent_iterator<T>::difference_type persistent_iterator<T>::index() const noexcept {
+  return this->index_;
+}
+
+template<typename T>
+persistent_iterator<T>& persistent_iterator<T>::operator++() {
+  ++this->index_;
+  return *this;
+}
+
+template<typename T>
+persistent_iterator<T>& persistent_iterator<T>::operator--() {
+  --this->index_;
+  return *this;
+}
+
+template<typename T>
+const persistent_iterator<T> persistent_iterator<T>::operator++(int) {
+  persistent_iterator result(*this);
+  ++this->index_;
+  return result;
+}
+
+template<typename T>
+const persistent_iterator<T> persistent_iterator<T>::operator--(int) {
+  persistent_iterator result(*this);
+  --this->index_;
+  return result;
+}
+
+template<typename T>
+persistent_iterator<T>& persistent_iterator<T>::operator+=(difference_type n) {
+  this->index_ += n;
+  return *this;
+}
+
+template<typename T>
+persistent_iterator<T>& persistent_iterator<T>::operator-=(difference_type n) {
+  this->index_ -= n;
+  return *this;
+}
+
+template<typename T>
+typename persistent_iterator<T>::difference_type persistent_iterator<T>::operator-(const persistent_iterator& other) const {
+  return this->index_ - other.index_;
+}
+
+template<typename T>
+persistent_iterator<T> persistent_iterator<T>::operator+(difference_type n) const {
+  persistent_iterator result(*this);
+  result.index_ += n;
+  return result;
+}
+
+template<typename T>
+persistent_iterator<T> persistent_iterator<T>::operator-(difference_type n) const {
+  persistent_iterator result(*this);
+  result.index_ -= n;
+  return result;
+}
+
+// Only the first element of every leaf walks the trie, the rest are read from the remembered leaf
+template<typename T>
+typename persistent_iterator<T>::reference persistent_iterator<T>::operator*() const {
+  typedef typename persistent_vector<T>::size_type size_type;
+  if (this->chunk_ == nullptr
+      || static_cast<size_type>(this->index_ - this->chunk_index_) >= persistent_vector<T>::chunk_size) {
+    size_type pos = static_cast<size_type>(this->index_);
+    this->chunk_ = this->vector_->leaf_for(pos)->data();
+    this->chunk_index_ = this->index_ - static_cast<difference_type>(pos & persistent_vector<T>::mask);
+  }
+  return this->chunk_[this->index_ - this->chunk_index_];
+}
+
+template<typename T>
+typename persistent_iterator<T>::pointer persistent_iterator<T>::operator->() const {
+  return std::addressof(**this);
+}
+
+template<typename T>
+typename persistent_iterator<T>::reference persistent_iterator<T>::operator[](difference_type n) const {
+  return *(*this + n);
+}
+
+template<typename T>
+bool persistent_iterator<T>::operator==(const persistent_iterator& other) const {
+  return this->index_ == other.index_;
+}
+
+template<typename T>
+bool persistent_iterator<T>::operator!=(const persistent_iterator& other) const {
+  return this->index_ != other.index_;
+}
+
+template<typename T>
+bool persistent_iterator<T>::operator>(const persistent_iterator& other) const {
+  return this->index_ > other.index_;
+}
+
+template<typename T>
+bool persistent_iterator<T>::operator<(const persistent_iterator& other) const {
+  return this->index_ < other.index_;
+}
+
+template<typename T>
+bool persistent_iterator<T>::operator>=(const persistent_iterator& other) const {
+  return this->index_ >= other.index_;
+}
+
+template<typename T>
+bool persistent_iterator<T>::operator<=(const persistent_iterator& other) const {
+  return this->index_ <= other.index_;
+}
+} //namespace truefinch template library
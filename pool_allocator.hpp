@@ -0,0 +1,330 @@
+//
+// Created by truefinch on 25.06.18.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tftl {
+/**
+ * @brief tftl::pool_resource keeps a free list per power-of-two size class, from 16 bytes up to
+ * max_pooled, and carves the blocks out of big chunks. Bigger or over-aligned requests go to
+ * operator new. Freed blocks are reused by later requests of the same class and all chunks
+ * are returned by release() or the destructor. It is not thread safe.
+ */
+class pool_resource {
+ public:
+  static constexpr std::size_t min_pooled = 16;
+  static constexpr std::size_t max_pooled = 4096;
+  static constexpr std::size_t class_count = 9;
+
+  explicit pool_resource(std::size_t chunk_size = 64 * 1024) noexcept;
+  pool_resource(const pool_resource&) = delete;
+  pool_resource& operator=(const pool_resource&) = delete;
+  ~pool_resource();
+
+  void* allocate(std::size_t bytes, std::size_t alignment);
+  void  deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept;
+  void  release() noexcept;
+
+  static bool        is_pooled(std::size_t bytes, std::size_t alignment) noexcept;
+  static std::size_t size_class(std::size_t bytes) noexcept;
+
+ private:
+  struct node {
+    node* next;
+  };
+
+  node*       free_[class_count] = {}; //Free list per size class
+  node*       chunks_ = nullptr;       //Chunks taken from malloc
+  std::size_t chunk_size_;
+
+  void refill(std::size_t index);
+};
+
+inline pool_resource::pool_resource(std::size_t chunk_size) noexcept
+    : chunk_size_(chunk_size < 2 * max_pooled ? 2 * max_pooled : chunk_size) {}
+
+inline pool_resource::~pool_resource() {
+  this->release();
+}
+
+inline bool pool_resource::is_pooled(std::size_t bytes, std::size_t alignment) noexcept {
+  return bytes <= max_pooled && alignment <= alignof(std::max_align_t);
+}
+
+inline std::size_t pool_resource::size_class(std::size_t bytes) noexcept {
+  std::size_t index = 0;
+  for (std::size_t size = min_pooled; size < bytes; size <<= 1) {
+    ++index;
+  }
+  return index;
+}
+
+inline void* pool_resource::allocate(std::size_t bytes, std::size_t alignment) {
+  if (!is_pooled(bytes, alignment)) {
+    return ::operator new(bytes, std::align_val_t(alignment));
+  }
+
+  std::size_t index = size_class(bytes);
+  if (this->free_[index] == nullptr) {
+    this->refill(index);
+  }
+  node* block = this->free_[index];
+  this->free_[index] = block->next;
+  return block;
+}
+
+inline void pool_resource::deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  if (!is_pooled(bytes, alignment)) {
+    ::operator delete(ptr, std::align_val_t(alignment));
+    return;
+  }
+
+  std::size_t index = size_class(bytes);
+  node* block = static_cast<node*>(ptr);
+  block->next = this->free_[index];
+  this->free_[index] = block;
+}
+
+inline void pool_resource::release() noexcept {
+  while (this->chunks_ != nullptr) {
+    node* next = this->chunks_->next;
+    std::free(this->chunks_);
+    this->chunks_ = next;
+  }
+  for (std::size_t i = 0; i < class_count; ++i) {
+    this->free_[i] = nullptr;
+  }
+}
+
+// Splits a new chunk into blocks of one size class, the chunk header takes the first block
+inline void pool_resource::refill(std::size_t index) {
+  std::size_t block_size = min_pooled << index;
+  char* chunk = static_cast<char*>(std::malloc(this->chunk_size_));
+  if (chunk == nullptr) {
+    throw std::bad_alloc();
+  }
+  reinterpret_cast<node*>(chunk)->next = this->chunks_;
+  this->chunks_ = reinterpret_cast<node*>(chunk);
+
+  std::size_t first = block_size < alignof(std::max_align_t) ? alignof(std::max_align_t) : block_size;
+  for (std::size_t offset = first; offset + block_size <= this->chunk_size_; offset += block_size) {
+    node* block = reinterpret_cast<node*>(chunk + offset);
+    block->next = this->free_[index];
+    this->free_[index] = block;
+  }
+}
+
+/**
+ * @brief tftl::pool_allocator allocates from a tftl::pool_resource it does not own.
+ * It never propagates, allocators are equal when they share the pool.
+ *
+ * @tparam T The type of the elements.
+ */
+template<typename T>
+class pool_allocator {
+ public:
+  // @formatter:off
+  typedef T               value_type;
+  typedef T*              pointer;
+  typedef std::size_t     size_type;
+  typedef std::false_type propagate_on_container_copy_assignment;
+  typedef std::false_type propagate_on_container_move_assignment;
+  typedef std::false_type propagate_on_container_swap;
+  typedef std::false_type is_always_equal;
+  // @formatter:on
+
+  pool_allocator(pool_resource& pool) noexcept : pool_(&pool) {}
+
+  template<typename U>
+  pool_allocator(const pool_allocator<U>& other) noexcept : pool_(other.pool()) {}
+
+  pointer allocate(size_type n) {
+    return static_cast<pointer>(this->pool_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(pointer ptr, size_type n) noexcept {
+    this->pool_->deallocate(ptr, n * sizeof(T), alignof(T));
+  }
+
+  pool_resource* pool() const noexcept {
+    return this->pool_;
+  }
+
+ private:
+  pool_resource* pool_;
+};
+
+template<typename T, typename U>
+bool operator==(const pool_allocator<T>& lhs, const pool_allocator<U>& rhs) noexcept {
+  return lhs.pool() == rhs.pool();
+}
+
+template<typename T, typename U>
+bool operator!=(const pool_allocator<T>& lhs, const pool_allocator<U>& rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+/**
+ * @brief tftl::thread_cache is a per-thread front end to one process-wide, locked pool_resource.
+ *
+ * Each thread keeps up to max_cached free blocks per size class and only takes the lock
+ * to move batches of blocks from or to the shared pool. A block may be freed by another thread
+ * than the one which allocated it, it then simply joins that thread's cache.
+ */
+class thread_cache {
+ public:
+  static constexpr std::size_t max_cached = 64;
+  static constexpr std::size_t batch = max_cached / 2;
+
+  static thread_cache& local();
+
+  void* allocate(std::size_t bytes, std::size_t alignment);
+  void  deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept;
+
+  thread_cache() = default;
+  thread_cache(const thread_cache&) = delete;
+  thread_cache& operator=(const thread_cache&) = delete;
+  ~thread_cache();
+
+ private:
+  struct shared_pool {
+    std::mutex    mutex;
+    pool_resource pool;
+  };
+
+  struct node {
+    node* next;
+  };
+
+  node*       free_[pool_resource::class_count] = {};
+  std::size_t count_[pool_resource::class_count] = {};
+
+  static shared_pool& shared();
+  void flush(std::size_t index, std::size_t keep) noexcept;
+};
+
+// Never destroyed: thread caches may flush into it during static destruction
+inline thread_cache::shared_pool& thread_cache::shared() {
+  static shared_pool* pool = new shared_pool;
+  return *pool;
+}
+
+inline thread_cache& thread_cache::local() {
+  thread_local thread_cache cache;
+  return cache;
+}
+
+inline thread_cache::~thread_cache() {
+  for (std::size_t i = 0; i < pool_resource::class_count; ++i) {
+    this->flush(i, 0);
+  }
+}
+
+inline void* thread_cache::allocate(std::size_t bytes, std::size_t alignment) {
+  if (!pool_resource::is_pooled(bytes, alignment)) {
+    return ::operator new(bytes, std::align_val_t(alignment));
+  }
+
+  std::size_t index = pool_resource::size_class(bytes);
+  if (this->free_[index] == nullptr) {
+    shared_pool& pool = shared();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    for (std::size_t i = 0; i < batch; ++i) {
+      node* block = static_cast<node*>(pool.pool.allocate(pool_resource::min_pooled << index, alignment));
+      block->next = this->free_[index];
+      this->free_[index] = block;
+    }
+    this->count_[index] += batch;
+  }
+
+  node* block = this->free_[index];
+  this->free_[index] = block->next;
+  --(this->count_[index]);
+  return block;
+}
+
+inline void thread_cache::deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  if (!pool_resource::is_pooled(bytes, alignment)) {
+    ::operator delete(ptr, std::align_val_t(alignment));
+    return;
+  }
+
+  std::size_t index = pool_resource::size_class(bytes);
+  node* block = static_cast<node*>(ptr);
+  block->next = this->free_[index];
+  this->free_[index] = block;
+  if (++(this->count_[index]) > max_cached) {
+    this->flush(index, batch);
+  }
+}
+
+// Gives all but keep cached blocks of a size class back to the shared pool
+inline void thread_cache::flush(std::size_t index, std::size_t keep) noexcept {
+  if (this->count_[index] <= keep) {
+    return;
+  }
+  shared_pool& pool = shared();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  while (this->count_[index] > keep) {
+    node* block = this->free_[index];
+    this->free_[index] = block->next;
+    pool.pool.deallocate(block, pool_resource::min_pooled << index, alignof(std::max_align_t));
+    --(this->count_[index]);
+  }
+}
+
+/**
+ * @brief tftl::thread_cache_allocator allocates through the calling thread's tftl::thread_cache.
+ * It is stateless, so all instances are equal.
+ *
+ * @tparam T The type of the elements.
+ */
+template<typename T>
+class thread_cache_allocator {
+ public:
+  // @formatter:off
+  typedef T              value_type;
+  typedef T*             pointer;
+  typedef std::size_t    size_type;
+  typedef std::true_type is_always_equal;
+  // @formatter:on
+
+  thread_cache_allocator() noexcept = default;
+
+  template<typename U>
+  thread_cache_allocator(const thread_cache_allocator<U>&) noexcept {}
+
+  pointer allocate(size_type n) {
+    return static_cast<pointer>(thread_cache::local().allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(pointer ptr, size_type n) noexcept {
+    thread_cache::local().deallocate(ptr, n * sizeof(T), alignof(T));
+  }
+};
+
+template<typename T, typename U>
+bool operator==(const thread_cache_allocator<T>&, const thread_cache_allocator<U>&) noexcept {
+  return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const thread_cache_allocator<T>&, const thread_cache_allocator<U>&) noexcept {
+  return false;
+}
+} //namespace truefinch template library
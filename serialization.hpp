@@ -0,0 +1,588 @@
+//
+// Created by truefinch on 12.07.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "vector.hpp"
+
+namespace tftl {
+namespace serialization {
+/**
+ * A versioned binary format for tftl::vector of trivially copyable elements.
+ *
+ * A record is a 64-byte header followed by the elements exactly as they are in memory, zero padded
+ * to a multiple of 64 bytes so that records can be concatenated and every payload stays aligned.
+ * Writing is one writev of the header and data(), reading one read straight into data() of a vector
+ * grown with resize_for_overwrite, and tftl::serialization::view uses a record in place.
+ */
+
+constexpr std::uint16_t format_version = 1;
+constexpr std::uint16_t byte_order_mark = 0x0102;
+constexpr std::size_t   alignment = 64;
+
+/**
+ * @brief The record header. Its fields are in the byte order of the writer, which byte_order_mark
+ * identifies. checksum covers the header, with checksum itself zeroed, and the payload.
+ */
+struct header {
+  char          magic[4];
+  std::uint16_t version;
+  std::uint16_t byte_order;
+  std::uint32_t element_size;
+  std::uint32_t flags;        //Reserved, 0
+  std::uint64_t type_tag;
+  std::uint64_t count;
+  std::uint64_t checksum;
+  unsigned char reserved[24];
+};
+static_assert(sizeof(header) == alignment, "tftl::serialization::header must fill one alignment unit");
+
+/**
+ * @brief Thrown when a record is malformed, truncated, corrupted or holds elements of another type.
+ */
+class format_error : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief tftl::serialization::type_tag identifies the element type of a record.
+ *
+ * Arithmetic types are tagged by kind and size. Other types default to 0, for which only the element
+ * size is checked; specialize type_tag with a distinct value to have records of them told apart.
+ */
+template<typename T>
+struct type_tag {
+  static constexpr std::uint64_t kind = std::is_same<T, bool>::value ? 'b'
+                                        : std::is_floating_point<T>::value ? 'f'
+                                        : std::is_signed<T>::value ? 'i' : 'u';
+  static constexpr std::uint64_t value = std::is_arithmetic<T>::value ? kind << 8 | sizeof(T) : 0;
+};
+
+namespace detail {
+constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t prime3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+inline std::uint64_t rotl(std::uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+// Words are read little endian, so a checksum is the same on every host
+template<typename Word>
+inline std::uint64_t load(const unsigned char* data) {
+  Word word;
+  std::memcpy(&word, data, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = sizeof(Word) == 8 ? __builtin_bswap64(word) : __builtin_bswap32(word);
+#endif
+  return word;
+}
+
+inline std::uint64_t round(std::uint64_t acc, std::uint64_t input) {
+  return rotl(acc + input * prime2, 31) * prime1;
+}
+
+inline std::uint64_t merge(std::uint64_t acc, std::uint64_t lane) {
+  return (acc ^ round(0, lane)) * prime1 + prime4;
+}
+
+// Consumes the whole 32-byte stripes of data
+inline void stripes(std::uint64_t (&lanes)[4], const unsigned char* data, std::size_t size) {
+  for (const unsigned char* last = data + size / 32 * 32; data != last; data += 32) {
+    for (int i = 0; i < 4; ++i) {
+      lanes[i] = round(lanes[i], load<std::uint64_t>(data + 8 * i));
+    }
+  }
+}
+
+// Mixes the lanes with the tail of fewer than 32 bytes left over from a total of size bytes
+inline std::uint64_t finish(const std::uint64_t (&lanes)[4], std::uint64_t seed,
+                            const unsigned char* tail, std::size_t size) {
+  std::uint64_t hash;
+  if (size >= 32) {
+    hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+    for (std::uint64_t lane : lanes) {
+      hash = merge(hash, lane);
+    }
+  } else {
+    hash = seed + prime5;
+  }
+  hash += size;
+
+  const unsigned char* last = tail + size % 32;
+  for (; last - tail >= 8; tail += 8) {
+    hash = rotl(hash ^ round(0, load<std::uint64_t>(tail)), 27) * prime1 + prime4;
+  }
+  if (last - tail >= 4) {
+    hash = rotl(hash ^ load<std::uint32_t>(tail) * prime1, 23) * prime2 + prime3;
+    tail += 4;
+  }
+  for (; tail != last; ++tail) {
+    hash = rotl(hash ^ *tail * prime5, 11) * prime1;
+  }
+
+  hash = (hash ^ (hash >> 33)) * prime2;
+  hash = (hash ^ (hash >> 29)) * prime3;
+  return hash ^ (hash >> 32);
+}
+
+/**
+ * @brief The XXH64 hash of size bytes. Its four independent lanes keep it near memory bandwidth.
+ */
+inline std::uint64_t checksum(const void* data, std::size_t size, std::uint64_t seed = 0) {
+  auto bytes = static_cast<const unsigned char*>(data);
+  std::uint64_t lanes[4] = {seed + prime1 + prime2, seed + prime2, seed, seed - prime1};
+  stripes(lanes, bytes, size);
+  return finish(lanes, seed, bytes + size / 32 * 32, size);
+}
+
+/**
+ * @brief Copies size bytes and returns their checksum in the same pass: each chunk is hashed
+ * while it is still in L1, so memory is read once instead of twice.
+ */
+inline std::uint64_t copy_checksum(void* target, const void* source, std::size_t size, std::uint64_t seed = 0) {
+  constexpr std::size_t chunk = 16 * 1024; //A multiple of the stripe, well inside L1
+  auto to = static_cast<unsigned char*>(target);
+  auto from = static_cast<const unsigned char*>(source);
+  std::uint64_t lanes[4] = {seed + prime1 + prime2, seed + prime2, seed, seed - prime1};
+  for (std::size_t done = 0; done < size; done += chunk) {
+    std::size_t count = std::min(chunk, size - done);
+    std::memcpy(to + done, from + done, count);
+    stripes(lanes, to + done, count);
+  }
+  return finish(lanes, seed, to + size / 32 * 32, size);
+}
+
+template<typename Word>
+inline Word swap_bytes(Word word) {
+  switch (sizeof(Word)) {
+    case 2: return static_cast<Word>(__builtin_bswap16(static_cast<std::uint16_t>(word)));
+    case 4: return static_cast<Word>(__builtin_bswap32(static_cast<std::uint32_t>(word)));
+    default: return static_cast<Word>(__builtin_bswap64(static_cast<std::uint64_t>(word)));
+  }
+}
+
+// Arithmetic elements written on a host of the other byte order are swapped in place
+template<typename T>
+void swap_elements(T* data, std::size_t count) {
+  if constexpr (std::is_arithmetic<T>::value && sizeof(T) > 1) {
+    typedef typename std::conditional<sizeof(T) == 2, std::uint16_t,
+        typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type>::type word;
+    static_assert(sizeof(word) == sizeof(T), "tftl::serialization: unexpected arithmetic type size");
+    for (std::size_t i = 0; i < count; ++i) {
+      word value;
+      std::memcpy(&value, data + i, sizeof(T));
+      value = swap_bytes(value);
+      std::memcpy(data + i, &value, sizeof(T));
+    }
+  }
+}
+
+inline std::size_t padding(std::size_t bytes) {
+  return (alignment - bytes % alignment) % alignment;
+}
+
+template<typename T>
+header make_header(std::size_t count, std::uint64_t payload_checksum) {
+  header result{};
+  std::memcpy(result.magic, "TFTL", 4);
+  result.version = format_version;
+  result.byte_order = byte_order_mark;
+  result.element_size = sizeof(T);
+  result.type_tag = type_tag<T>::value;
+  result.count = count;
+  result.checksum = checksum(&result, sizeof(result), payload_checksum);
+  return result;
+}
+
+/**
+ * @brief Checks a header read as raw bytes and converts it to host byte order.
+ * Returns whether the record was written on a host of the other byte order.
+ */
+template<typename T>
+bool validate(header& head) {
+  if (std::memcmp(head.magic, "TFTL", 4) != 0) {
+    throw format_error("tftl::serialization: not a tftl record");
+  }
+  bool swapped = head.byte_order == swap_bytes(byte_order_mark);
+  if (!swapped && head.byte_order != byte_order_mark) {
+    throw format_error("tftl::serialization: unknown byte order");
+  }
+  if (swapped) {
+    head.version = swap_bytes(head.version);
+    head.element_size = swap_bytes(head.element_size);
+    head.flags = swap_bytes(head.flags);
+    head.type_tag = swap_bytes(head.type_tag);
+    head.count = swap_bytes(head.count);
+    head.checksum = swap_bytes(head.checksum);
+  }
+  if (head.version == 0 || head.version > format_version || head.flags != 0) {
+    throw format_error("tftl::serialization: unsupported format version");
+  }
+  if (head.element_size != sizeof(T) || head.type_tag != type_tag<T>::value) {
+    throw format_error("tftl::serialization: the record holds elements of another type");
+  }
+  if (swapped && !std::is_arithmetic<T>::value) {
+    throw format_error("tftl::serialization: cannot convert the byte order of non-arithmetic elements");
+  }
+  if (head.count > std::numeric_limits<std::size_t>::max() / sizeof(T) - alignment) {
+    throw format_error("tftl::serialization: element count out of range");
+  }
+  return swapped;
+}
+
+// raw is the header exactly as it was read, whose checksum field still holds the writer's bytes
+inline void verify(const header& raw, std::uint64_t expected, std::uint64_t payload_checksum) {
+  header zeroed = raw;
+  zeroed.checksum = 0;
+  if (checksum(&zeroed, sizeof(zeroed), payload_checksum) != expected) {
+    throw format_error("tftl::serialization: checksum mismatch");
+  }
+}
+
+// Bytes left after the current offset of a regular file, or the largest size for pipes and sockets
+inline std::uint64_t remaining_bytes(int fd) noexcept {
+  struct stat status;
+  if (::fstat(fd, &status) == 0 && S_ISREG(status.st_mode)) {
+    off_t offset = ::lseek(fd, 0, SEEK_CUR);
+    if (offset >= 0 && offset <= status.st_size) {
+      return static_cast<std::uint64_t>(status.st_size - offset);
+    }
+  }
+  return std::numeric_limits<std::uint64_t>::max();
+}
+
+// Reads exactly size bytes unless the file ends first, returns how many were read
+inline std::size_t read_fully(int fd, void* buffer, std::size_t size) {
+  auto target = static_cast<char*>(buffer);
+  std::size_t done = 0;
+  while (done < size) {
+    ssize_t result = ::read(fd, target + done, size - done);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(), "tftl::serialization: read");
+    }
+    if (result == 0) {
+      break;
+    }
+    done += static_cast<std::size_t>(result);
+  }
+  return done;
+}
+} // namespace detail
+
+/**
+ * @brief How many bytes the record of vector takes, header and padding included.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+std::size_t serialized_size(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& vector) noexcept {
+  std::size_t bytes = vector.size() * sizeof(T);
+  return sizeof(header) + bytes + detail::padding(bytes);
+}
+
+/**
+ * @brief Writes the record of vector to a file descriptor with writev, retrying short writes.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void serialize_to(int fd, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& vector) {
+  static_assert(std::is_trivially_copyable<T>::value, "tftl::serialization: T must be trivially copyable");
+  static const unsigned char zeros[alignment] = {};
+  std::size_t bytes = vector.size() * sizeof(T);
+  header head = detail::make_header<T>(vector.size(), detail::checksum(vector.data(), bytes));
+  iovec parts[3] = {
+      {&head, sizeof(head)},
+      {const_cast<T*>(vector.data()), bytes},
+      {const_cast<unsigned char*>(zeros), detail::padding(bytes)}
+  };
+
+  iovec* part = parts;
+  int remaining = 3;
+  while (remaining > 0) {
+    ssize_t written = ::writev(fd, part, remaining);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(), "tftl::serialization::serialize_to: writev");
+    }
+    auto done = static_cast<std::size_t>(written);
+    while (remaining > 0 && done >= part->iov_len) {
+      done -= part->iov_len;
+      ++part;
+      --remaining;
+    }
+    if (remaining > 0) {
+      part->iov_base = static_cast<char*>(part->iov_base) + done;
+      part->iov_len -= done;
+    }
+  }
+}
+
+/**
+ * @brief Copies the record of vector into buffer, which must hold serialized_size(vector) bytes.
+ * Returns the number of bytes written.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+std::size_t serialize_to(void* buffer, std::size_t size, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& vector) {
+  static_assert(std::is_trivially_copyable<T>::value, "tftl::serialization: T must be trivially copyable");
+  std::size_t total = serialized_size(vector);
+  if (size < total) {
+    throw std::length_error("tftl::serialization::serialize_to: buffer too small");
+  }
+  std::size_t bytes = vector.size() * sizeof(T);
+  auto target = static_cast<unsigned char*>(buffer);
+  std::uint64_t payload_checksum = detail::copy_checksum(target + sizeof(header), vector.data(), bytes);
+  header head = detail::make_header<T>(vector.size(), payload_checksum);
+  std::memcpy(target, &head, sizeof(head));
+  std::memset(target + sizeof(head) + bytes, 0, detail::padding(bytes));
+  return total;
+}
+
+/**
+ * @brief Reads one record from a file descriptor into vector, replacing its contents.
+ * The elements are read straight into vector.data(). If it throws, vector is left empty.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void deserialize_from(int fd, tftl::vector<T, Allocator, GrowthPolicy, Stats>& vector, bool verify = true) {
+  static_assert(std::is_trivially_copyable<T>::value, "tftl::serialization: T must be trivially copyable");
+  header raw;
+  if (detail::read_fully(fd, &raw, sizeof(raw)) != sizeof(raw)) {
+    throw format_error("tftl::serialization::deserialize_from: truncated header");
+  }
+  header head = raw;
+  bool swapped = detail::validate<T>(head);
+  std::size_t bytes = head.count * sizeof(T);
+  // The count is not verified yet: a corrupted one must not turn into a huge allocation
+  if (bytes > detail::remaining_bytes(fd) || head.count > vector.max_size()) {
+    throw format_error("tftl::serialization::deserialize_from: truncated payload");
+  }
+
+  vector.clear();
+  try {
+    vector.resize_for_overwrite(head.count);
+    unsigned char padding[alignment];
+    if (detail::read_fully(fd, vector.data(), bytes) != bytes
+        || detail::read_fully(fd, padding, detail::padding(bytes)) != detail::padding(bytes)) {
+      throw format_error("tftl::serialization::deserialize_from: truncated payload");
+    }
+    if (verify) {
+      detail::verify(raw, head.checksum, detail::checksum(vector.data(), bytes));
+    }
+  } catch (...) {
+    vector.clear();
+    throw;
+  }
+  if (swapped) {
+    detail::swap_elements(vector.data(), vector.size());
+  }
+}
+
+/**
+ * @brief Reads the record at the start of buffer into vector, replacing its contents, checking the
+ * checksum while copying. Returns the number of bytes the record takes, where the next one would start.
+ * If it throws, vector is left empty.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+std::size_t deserialize_from(const void* buffer, std::size_t size, tftl::vector<T, Allocator, GrowthPolicy, Stats>& vector,
+                             bool verify = true) {
+  static_assert(std::is_trivially_copyable<T>::value, "tftl::serialization: T must be trivially copyable");
+  if (size < sizeof(header)) {
+    throw format_error("tftl::serialization::deserialize_from: truncated header");
+  }
+  auto source = static_cast<const unsigned char*>(buffer);
+  header raw;
+  std::memcpy(&raw, source, sizeof(raw));
+  header head = raw;
+  bool swapped = detail::validate<T>(head);
+  std::size_t bytes = head.count * sizeof(T);
+  std::size_t total = sizeof(header) + bytes + detail::padding(bytes);
+  if (size < total) {
+    throw format_error("tftl::serialization::deserialize_from: truncated payload");
+  }
+
+  vector.clear();
+  vector.resize_for_overwrite(head.count);
+  if (verify) {
+    try {
+      detail::verify(raw, head.checksum, detail::copy_checksum(vector.data(), source + sizeof(header), bytes));
+    } catch (...) {
+      vector.clear();
+      throw;
+    }
+  } else if (bytes > 0) {
+    std::memcpy(vector.data(), source + sizeof(header), bytes);
+  }
+  if (swapped) {
+    detail::swap_elements(vector.data(), vector.size());
+  }
+  return total;
+}
+
+/**
+ * @brief tftl::serialization::view reads the elements of a record in place, without copying them.
+ *
+ * The buffer must outlive the view, be in host byte order and place the payload at an address
+ * aligned for T, which any buffer aligned to 64 bytes does. Unless verify is false, constructing
+ * a view reads the whole payload once to check the checksum.
+ */
+template<typename T>
+class view {
+  static_assert(std::is_trivially_copyable<T>::value, "tftl::serialization: T must be trivially copyable");
+ public:
+  // @formatter:off
+  typedef T                                      value_type;
+  typedef std::size_t                            size_type;
+  typedef std::ptrdiff_t                         difference_type;
+  typedef const value_type&                      const_reference;
+  typedef const value_type*                      const_pointer;
+  typedef const_pointer                          const_iterator;
+  typedef std::reverse_iterator <const_iterator> const_reverse_iterator;
+  // @formatter:on
+
+  view(const void* buffer, std::size_t size, bool verify = true);
+
+  const_reference at(size_type pos) const;
+  const_reference operator[](size_type pos) const noexcept;
+  const_reference front() const noexcept;
+  const_reference back() const noexcept;
+  const_pointer   data() const noexcept;
+
+  const_iterator         begin() const noexcept;
+  const_iterator         cbegin() const noexcept;
+  const_iterator         end() const noexcept;
+  const_iterator         cend() const noexcept;
+  const_reverse_iterator rbegin() const noexcept;
+  const_reverse_iterator rend() const noexcept;
+
+  bool      empty() const noexcept;
+  size_type size() const noexcept;
+  // Bytes the whole record takes in the buffer, where the next one would start
+  size_type record_size() const noexcept;
+
+ private:
+  const T*  data_;
+  size_type size_;
+};
+
+template<typename T>
+view<T>::view(const void* buffer, std::size_t size, bool verify) {
+  if (size < sizeof(header)) {
+    throw format_error("tftl::serialization::view: truncated header");
+  }
+  auto source = static_cast<const unsigned char*>(buffer);
+  header raw;
+  std::memcpy(&raw, source, sizeof(raw));
+  header head = raw;
+  if (detail::validate<T>(head)) {
+    throw format_error("tftl::serialization::view: the record is in the other byte order");
+  }
+  std::size_t bytes = head.count * sizeof(T);
+  if (size < sizeof(header) + bytes + detail::padding(bytes)) {
+    throw format_error("tftl::serialization::view: truncated payload");
+  }
+  if (reinterpret_cast<std::uintptr_t>(source + sizeof(header)) % alignof(T) != 0) {
+    throw std::invalid_argument("tftl::serialization::view: the payload is not aligned for T");
+  }
+  if (verify) {
+    detail::verify(raw, head.checksum, detail::checksum(source + sizeof(header), bytes));
+  }
+  this->data_ = reinterpret_cast<const T*>(source + sizeof(header));
+  this->size_ = head.count;
+}
+
+template<typename T>
+typename view<T>::const_reference view<T>::at(size_type pos) const {
+  if (pos >= this->size_) {
+    throw std::out_of_range("tftl::serialization::view::at: pos >= size()");
+  }
+  return this->data_[pos];
+}
+
+template<typename T>
+typename view<T>::const_reference view<T>::operator[](size_type pos) const noexcept {
+  return this->data_[pos];
+}
+
+template<typename T>
+typename view<T>::const_reference view<T>::front() const noexcept {
+  return this->data_[0];
+}
+
+template<typename T>
+typename view<T>::const_reference view<T>::back() const noexcept {
+  return this->data_[this->size_ - 1];
+}
+
+template<typename T>
+typename view<T>::const_pointer view<T>::data() const noexcept {
+  return this->data_;
+}
+
+template<typename T>
+typename view<T>::const_iterator view<T>::begin() const noexcept {
+  return this->data_;
+}
+
+template<typename T>
+typename view<T>::const_iterator view<T>::cbegin() const noexcept {
+  return this->data_;
+}
+
+template<typename T>
+typename view<T>::const_iterator view<T>::end() const noexcept {
+  return this->data_ + this->size_;
+}
+
+template<typename T>
+typename view<T>::const_iterator view<T>::cend() const noexcept {
+  return this->data_ + this->size_;
+}
+
+template<typename T>
+typename view<T>::const_reverse_iterator view<T>::rbegin() const noexcept {
+  return const_reverse_iterator(this->end());
+}
+
+template<typename T>
+typename view<T>::const_reverse_iterator view<T>::rend() const noexcept {
+  return const_reverse_iterator(this->begin());
+}
+
+template<typename T>
+bool view<T>::empty() const noexcept {
+  return this->size_ == 0;
+}
+
+template<typename T>
+typename view<T>::size_type view<T>::size() const noexcept {
+  return this->size_;
+}
+
+template<typename T>
+typename view<T>::size_type view<T>::record_size() const noexcept {
+  std::size_t bytes = this->size_ * sizeof(T);
+  return sizeof(header) + bytes + detail::padding(bytes);
+}
+} // namespace serialization
+} //namespace truefinch template library
@@ -0,0 +1,289 @@
+//
+// Created by truefinch on 02.07.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TFTL_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define TFTL_SIMD_X86 0
+#endif
+
+namespace tftl {
+namespace simd {
+/**
+ * Comparison kernels for contiguous arrays of arithmetic and other bitwise comparable types.
+ *
+ * Every instruction set level is compiled in with target attributes and the best one the CPU
+ * supports is picked once at run time, so the library needs no -mavx2 or similar flags.
+ */
+enum class isa {
+  generic,
+  sse2,
+  avx2,
+  avx512
+};
+
+inline const char* name(isa level) noexcept {
+  switch (level) {
+    case isa::sse2: return "sse2";
+    case isa::avx2: return "avx2";
+    case isa::avx512: return "avx512";
+    default: return "generic";
+  }
+}
+
+/**
+ * @brief The best instruction set level of the running CPU, detected on the first call.
+ */
+inline isa detect() noexcept {
+#if TFTL_SIMD_X86
+  static const isa level = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+      return isa::avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return isa::avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+      return isa::sse2;
+    }
+    return isa::generic;
+  }();
+  return level;
+#else
+  return isa::generic;
+#endif
+}
+
+/**
+ * @brief Types whose == is plain bitwise equality, so they can be compared by memcmp
+ * and byte-wise kernels. Floating point types get kernels of their own.
+ */
+template<typename T>
+struct is_bitwise_comparable
+    : std::integral_constant<bool, std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value> {};
+
+template<typename T>
+struct is_vectorizable
+    : std::integral_constant<bool, is_bitwise_comparable<T>::value || std::is_same<T, float>::value
+        || std::is_same<T, double>::value> {};
+
+namespace detail {
+template<typename T>
+std::size_t mismatch_generic(const T* lhs, const T* rhs, std::size_t count) noexcept {
+  for (std::size_t i = 0; i < count; ++i) {
+    if (!(lhs[i] == rhs[i])) {
+      return i;
+    }
+  }
+  return count;
+}
+
+#if TFTL_SIMD_X86
+__attribute__((target("sse2")))
+inline std::size_t mismatch_bytes_sse2(const unsigned char* lhs, const unsigned char* rhs, std::size_t count) noexcept {
+  std::size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i)),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i)));
+    unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(equal)) & 0xFFFFu;
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + mismatch_generic(lhs + i, rhs + i, count - i);
+}
+
+__attribute__((target("avx2")))
+inline std::size_t mismatch_bytes_avx2(const unsigned char* lhs, const unsigned char* rhs, std::size_t count) noexcept {
+  std::size_t i = 0;
+  for (; i + 32 <= count; i += 32) {
+    __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)),
+                                      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i)));
+    unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(equal));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + mismatch_bytes_sse2(lhs + i, rhs + i, count - i);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+inline std::size_t mismatch_bytes_avx512(const unsigned char* lhs, const unsigned char* rhs, std::size_t count) noexcept {
+  std::size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    __mmask64 mask = _mm512_cmpneq_epi8_mask(_mm512_loadu_si512(lhs + i), _mm512_loadu_si512(rhs + i));
+    if (mask != 0) {
+      return i + __builtin_ctzll(mask);
+    }
+  }
+  return i + mismatch_bytes_avx2(lhs + i, rhs + i, count - i);
+}
+
+// Floating point kernels compare with ==, so -0.0 equals 0.0 and NaN equals nothing
+__attribute__((target("sse2")))
+inline std::size_t mismatch_sse2(const float* lhs, const float* rhs, std::size_t count) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    unsigned mask = ~static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(lhs + i), _mm_loadu_ps(rhs + i))))
+        & 0xFu;
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + mismatch_generic(lhs + i, rhs + i, count - i);
+}
+
+__attribute__((target("sse2")))
+inline std::size_t mismatch_sse2(const double* lhs, const double* rhs, std::size_t count) noexcept {
+  std::size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    unsigned mask = ~static_cast<unsigned>(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(lhs + i), _mm_loadu_pd(rhs + i))))
+        & 0x3u;
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + mismatch_generic(lhs + i, rhs + i, count - i);
+}
+
+__attribute__((target("avx2")))
+inline std::size_t mismatch_avx2(const float* lhs, const float* rhs, std::size_t count) noexcept {
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 equal = _mm256_cmp_ps(_mm256_loadu_ps(lhs + i), _mm256_loadu_ps(rhs + i), _CMP_EQ_OQ);
+    unsigned mask = ~static_cast<unsigned>(_mm256_movemask_ps(equal)) & 0xFFu;
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + mismatch_sse2(lhs + i, rhs + i, count - i);
+}
+
+__attribute__((target("avx2")))
+inline std::size_t mismatch_avx2(const double* lhs, const double* rhs, std::size_t count) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256d equal = _mm256_cmp_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i), _CMP_EQ_OQ);
+    unsigned mask = ~static_cast<unsigned>(_mm256_movemask_pd(equal)) & 0xFu;
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + mismatch_sse2(lhs + i, rhs + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+inline std::size_t mismatch_avx512(const float* lhs, const float* rhs, std::size_t count) noexcept {
+  std::size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __mmask16 mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(lhs + i), _mm512_loadu_ps(rhs + i), _CMP_NEQ_UQ);
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + mismatch_avx2(lhs + i, rhs + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+inline std::size_t mismatch_avx512(const double* lhs, const double* rhs, std::size_t count) noexcept {
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __mmask8 mask = _mm512_cmp_pd_mask(_mm512_loadu_pd(lhs + i), _mm512_loadu_pd(rhs + i), _CMP_NEQ_UQ);
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + mismatch_avx2(lhs + i, rhs + i, count - i);
+}
+#endif
+} // namespace detail
+
+/**
+ * @brief Index of the first i with !(lhs[i] == rhs[i]), count if the arrays are equal,
+ * computed with the kernels of the given level.
+ */
+template<typename T>
+std::size_t mismatch(const T* lhs, const T* rhs, std::size_t count, isa level) noexcept {
+  static_assert(is_vectorizable<T>::value, "tftl::simd::mismatch: T has no kernel");
+#if TFTL_SIMD_X86
+  if constexpr (is_bitwise_comparable<T>::value) {
+    const unsigned char* left = reinterpret_cast<const unsigned char*>(lhs);
+    const unsigned char* right = reinterpret_cast<const unsigned char*>(rhs);
+    std::size_t bytes = count * sizeof(T);
+    switch (level) {
+      case isa::avx512: return detail::mismatch_bytes_avx512(left, right, bytes) / sizeof(T);
+      case isa::avx2: return detail::mismatch_bytes_avx2(left, right, bytes) / sizeof(T);
+      case isa::sse2: return detail::mismatch_bytes_sse2(left, right, bytes) / sizeof(T);
+      default: break;
+    }
+  } else {
+    switch (level) {
+      case isa::avx512: return detail::mismatch_avx512(lhs, rhs, count);
+      case isa::avx2: return detail::mismatch_avx2(lhs, rhs, count);
+      case isa::sse2: return detail::mismatch_sse2(lhs, rhs, count);
+      default: break;
+    }
+  }
+#endif
+  return detail::mismatch_generic(lhs, rhs, count);
+}
+
+template<typename T>
+std::size_t mismatch(const T* lhs, const T* rhs, std::size_t count) noexcept {
+  return simd::mismatch(lhs, rhs, count, detect());
+}
+
+/**
+ * @brief Whether two arrays of count elements are equal, bitwise comparable types go to memcmp.
+ */
+template<typename T>
+bool equal(const T* lhs, const T* rhs, std::size_t count) noexcept {
+  if constexpr (is_bitwise_comparable<T>::value) {
+    return count == 0 || std::memcmp(lhs, rhs, count * sizeof(T)) == 0;
+  } else {
+    return simd::mismatch(lhs, rhs, count) == count;
+  }
+}
+
+/**
+ * @brief Three-way lexicographical comparison: negative, zero or positive as lhs is less than,
+ * equivalent to or greater than rhs. Like std::lexicographical_compare unordered elements (NaN) are equivalent.
+ */
+template<typename T>
+int compare(const T* lhs, std::size_t lhs_count, const T* rhs, std::size_t rhs_count, isa level) noexcept {
+  std::size_t count = std::min(lhs_count, rhs_count);
+
+  if constexpr (std::is_same<T, unsigned char>::value) {
+    int result = count == 0 ? 0 : std::memcmp(lhs, rhs, count);
+    if (result != 0) {
+      return result < 0 ? -1 : 1;
+    }
+  } else {
+    for (std::size_t i = 0; (i += simd::mismatch(lhs + i, rhs + i, count - i, level)) < count; ++i) {
+      if (lhs[i] < rhs[i]) {
+        return -1;
+      }
+      if (rhs[i] < lhs[i]) {
+        return 1;
+      }
+    }
+  }
+  return lhs_count < rhs_count ? -1 : (rhs_count < lhs_count ? 1 : 0);
+}
+
+template<typename T>
+int compare(const T* lhs, std::size_t lhs_count, const T* rhs, std::size_t rhs_count) noexcept {
+  return simd::compare(lhs, lhs_count, rhs, rhs_count, detect());
+}
+} // namespace simd
+} //namespace truefinch template library
@@ -0,0 +1,778 @@
+//
+// Created by truefinch on 21.06.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include "growth_policy.hpp"
+#include "iterator.hpp"
+#include "memory.hpp"
+
+namespace tftl {
+/**
+ * @brief tftl::small_vector is a tftl::vector which keeps up to N elements inline,
+ * inside the object itself, and only goes to the allocator once it outgrows them.
+ *
+ * It has the interface of tftl::vector. Moves and swaps of inline vectors move the elements,
+ * so unlike tftl::vector they invalidate iterators.
+ *
+ * @tparam T The type of the elements.
+ * @tparam N The number of elements stored inline.
+ * @tparam Allocator An allocator that is used to acquire/release memory once N is exceeded.
+ * @tparam GrowthPolicy A stateless policy choosing the new capacity, see growth_policy.hpp.
+ */
+template<typename T, std::size_t N, typename Allocator = std::allocator<T>, typename GrowthPolicy = tftl::default_growth>
+class small_vector {
+  static_assert(N > 0, "tftl::small_vector: the inline capacity must not be zero");
+
+  // @formatter:off
+ public:
+  ///This is Member types
+  typedef T                                      value_type;
+  typedef Allocator                              allocator_type;
+  typedef GrowthPolicy                           growth_policy;
+  typedef std::size_t                            size_type;
+  typedef std::ptrdiff_t                         difference_type;
+  typedef value_type&                            reference;
+  typedef const value_type&                      const_reference;
+  typedef typename std::allocator_traits         <Allocator>::pointer pointer;
+  typedef typename std::allocator_traits         <Allocator>::const_pointer const_pointer;
+  typedef tftl::iterator <value_type>            iterator;
+  typedef const tftl::iterator <value_type>      const_iterator;
+  typedef std::reverse_iterator <iterator>       reverse_iterator;
+  typedef std::reverse_iterator <const_iterator> const_reverse_iterator;
+
+  static constexpr size_type inline_capacity = N;
+
+  // construct/copy/destroy:
+  small_vector() noexcept ( noexcept(Allocator()) ) = default;
+  explicit small_vector( const Allocator& alloc ) noexcept;
+  small_vector( size_type count, const T& value, const Allocator& alloc = Allocator() );
+  explicit small_vector( size_type count, const Allocator& alloc = Allocator() );
+  template<typename InputIt, typename = typename std::enable_if <!std::is_integral <InputIt>::value>::type>
+  small_vector( InputIt first, InputIt last, const Allocator& alloc = Allocator() );
+  small_vector( const small_vector& other );
+  small_vector( small_vector&& other ) noexcept( std::is_nothrow_move_constructible<T>::value );
+  small_vector( std::initializer_list<T> init, const Allocator& alloc = Allocator() );
+
+  ~small_vector();
+
+  // Operators and assignment:
+  small_vector& operator=( const small_vector& other );
+  small_vector& operator=( small_vector&& other );
+  small_vector& operator=( std::initializer_list<T> ilist );
+
+  void assign( size_type count, const T& value );
+  template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
+  void assign( InputIt first, InputIt last );
+  void assign( std::initializer_list<T> ilist );
+
+  allocator_type get_allocator() const;
+
+
+  // Element access:
+  reference       at( size_type pos );
+  const_reference at( size_type pos ) const;
+
+  reference       operator[]( size_type pos );
+  const_reference operator[]( size_type pos ) const;
+
+  reference       front();
+  const_reference front() const;
+
+  reference       back();
+  const_reference back() const;
+
+
+  // Data access:
+  T*        data() noexcept;
+  const T*  data() const noexcept;
+
+  // Iterators:
+  iterator                begin() noexcept;
+  const_iterator          begin() const noexcept;
+  const_iterator          cbegin() const noexcept;
+
+  iterator                end() noexcept;
+  const_iterator          end() const noexcept;
+  const_iterator          cend() const noexcept;
+
+  reverse_iterator        rbegin() noexcept;
+  const_reverse_iterator  rbegin() const noexcept;
+  const_reverse_iterator  crbegin() const noexcept;
+
+  reverse_iterator        rend() noexcept;
+  const_reverse_iterator  rend() const noexcept;
+  const_reverse_iterator  crend() const noexcept;
+
+  // Capacity:
+  bool      empty() const noexcept;
+  size_type size() const noexcept;
+  size_type max_size() const noexcept;
+  void      reserve( size_type new_cap );
+  size_type capacity() const noexcept;
+  void      shrink_to_fit();
+  bool      is_inline() const noexcept;
+
+  // Modifiers:
+  void clear() noexcept;
+
+  iterator  insert( const_iterator pos, const T& value );
+  iterator  insert( const_iterator pos, T&& value );
+  iterator  insert( const_iterator pos, size_type count, const T& value );
+  template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
+  iterator  insert( const_iterator pos, InputIt first, InputIt last );
+  iterator  insert( const_iterator pos, std::initializer_list<T> ilist );
+
+  template< class... Args >
+  iterator  emplace( const_iterator pos, Args&&... args );
+
+  iterator  erase( const_iterator pos );
+  iterator  erase( const_iterator first, const_iterator last );
+
+  void      push_back( const T& value );
+  void      push_back( T&& value );
+
+  template< class... Args >
+  reference emplace_back( Args&&... args );
+
+  void      pop_back();
+
+  void      resize( size_type count );
+  void      resize( size_type count, const value_type& value );
+
+  void      swap( small_vector& other );
+
+ private:
+  typedef std::allocator_traits<Allocator> alloc_traits;
+
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer_[N]; //Inline storage
+
+  Allocator allocator_;
+
+  pointer head_ = reinterpret_cast<pointer>(buffer_);     //Pointer to the first element of the vector
+  pointer tail_ = reinterpret_cast<pointer>(buffer_);     //Pointer to the past-the-last element of the vector
+  pointer peak_ = reinterpret_cast<pointer>(buffer_) + N; //Pointer to the end of available space of the vector
+
+  // Methods to manipulate with memory by using allocator:
+  pointer inline_data() noexcept;
+  void    reallocate(size_type new_cap);
+  void    grow(size_type required);
+  void    release() noexcept;
+  void    destroy(pointer first, pointer last) noexcept;
+  void    steal(small_vector& other);
+  template< class... Args >
+  void    construct_back(size_type count, Args&&... args);
+  template< class InputIt >
+  void    construct_back_range(InputIt first, InputIt last);
+
+  // @formatter:on
+};
+
+// construct/copy/destroy:
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+small_vector<T, N, Allocator, GrowthPolicy>::small_vector(const Allocator& alloc) noexcept : allocator_(alloc) {}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+small_vector<T, N, Allocator, GrowthPolicy>::small_vector(size_type count, const T& value, const Allocator& alloc)
+    : allocator_(alloc) {
+  this->assign(count, value);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+small_vector<T, N, Allocator, GrowthPolicy>::small_vector(size_type count, const Allocator& alloc) : allocator_(alloc) {
+  this->resize(count);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+template<class InputIt, typename isIterator>
+small_vector<T, N, Allocator, GrowthPolicy>::small_vector(InputIt first, InputIt last, const Allocator& alloc)
+    : allocator_(alloc) {
+  this->assign(first, last);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+small_vector<T, N, Allocator, GrowthPolicy>::small_vector(const small_vector& other)
+    : allocator_(alloc_traits::select_on_container_copy_construction(other.allocator_)) {
+  this->assign(other.begin(), other.end());
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+small_vector<T, N, Allocator, GrowthPolicy>::small_vector(small_vector&& other) noexcept(
+std::is_nothrow_move_constructible<T>::value) : allocator_(std::move(other.allocator_)) {
+  this->steal(other);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+small_vector<T, N, Allocator, GrowthPolicy>::small_vector(std::initializer_list<T> init, const Allocator& alloc)
+    : allocator_(alloc) {
+  this->assign(init.begin(), init.end());
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+small_vector<T, N, Allocator, GrowthPolicy>::~small_vector() {
+  this->release();
+}
+
+// Operators and assigment:
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+small_vector<T, N, Allocator, GrowthPolicy>& small_vector<T, N, Allocator, GrowthPolicy>::operator=(const small_vector& other) {
+  if (this != &other) {
+    if (alloc_traits::propagate_on_container_copy_assignment::value && this->allocator_ != other.allocator_) {
+      this->release();
+    }
+    if (alloc_traits::propagate_on_container_copy_assignment::value) {
+      this->allocator_ = other.allocator_;
+    }
+    this->assign(other.begin(), other.end());
+  }
+  return *this;
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+small_vector<T, N, Allocator, GrowthPolicy>& small_vector<T, N, Allocator, GrowthPolicy>::operator=(small_vector&& other) {
+  if (this == &other) {
+    return *this;
+  }
+
+  if (alloc_traits::propagate_on_container_move_assignment::value || this->allocator_ == other.allocator_) {
+    this->release();
+    if (alloc_traits::propagate_on_container_move_assignment::value) {
+      this->allocator_ = std::move(other.allocator_);
+    }
+    this->steal(other);
+  } else {
+    // The heap block belongs to another allocator, only the elements can be moved
+    this->assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+    other.clear();
+  }
+  return *this;
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+small_vector<T, N, Allocator, GrowthPolicy>& small_vector<T, N, Allocator, GrowthPolicy>::operator=(std::initializer_list<T> ilist) {
+  this->assign(ilist.begin(), ilist.end());
+  return *this;
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::assign(size_type count, const T& value) {
+  value_type copy(value); // value may live inside the vector
+  this->clear();
+  this->grow(count);
+  this->construct_back(count, copy);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+template<class InputIt, typename isIterator>
+void small_vector<T, N, Allocator, GrowthPolicy>::assign(InputIt first, InputIt last) {
+  this->clear();
+  this->construct_back_range(first, last);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::assign(std::initializer_list<T> ilist) {
+  this->assign(ilist.begin(), ilist.end());
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::allocator_type small_vector<T, N, Allocator, GrowthPolicy>::get_allocator() const {
+  return this->allocator_;
+}
+
+// Element access:
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::reference small_vector<T, N, Allocator, GrowthPolicy>::at(size_type pos) {
+  if (pos >= this->size()) {
+    throw std::out_of_range("tftl::small_vector::at: accessed element out of range");
+  }
+  return this->head_[pos];
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::const_reference small_vector<T, N, Allocator, GrowthPolicy>::at(size_type pos) const {
+  if (pos >= this->size()) {
+    throw std::out_of_range("tftl::small_vector::at: accessed element out of range");
+  }
+  return this->head_[pos];
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::reference small_vector<T, N, Allocator, GrowthPolicy>::operator[](size_type pos) {
+  return this->head_[pos];
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::const_reference small_vector<T, N, Allocator, GrowthPolicy>::operator[](size_type pos) const {
+  return this->head_[pos];
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::reference small_vector<T, N, Allocator, GrowthPolicy>::front() {
+  return *(this->head_);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::const_reference small_vector<T, N, Allocator, GrowthPolicy>::front() const {
+  return *(this->head_);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::reference small_vector<T, N, Allocator, GrowthPolicy>::back() {
+  return *(this->tail_ - 1);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::const_reference small_vector<T, N, Allocator, GrowthPolicy>::back() const {
+  return *(this->tail_ - 1);
+}
+
+// Data access:
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+T* small_vector<T, N, Allocator, GrowthPolicy>::data() noexcept {
+  return this->head_;
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+const T* small_vector<T, N, Allocator, GrowthPolicy>::data() const noexcept {
+  return this->head_;
+}
+
+// Iterators:
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::iterator small_vector<T, N, Allocator, GrowthPolicy>::begin() noexcept {
+  return iterator(this->head_);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::const_iterator small_vector<T, N, Allocator, GrowthPolicy>::begin() const noexcept {
+  return const_iterator(this->head_);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::const_iterator small_vector<T, N, Allocator, GrowthPolicy>::cbegin() const noexcept {
+  return const_iterator(this->head_);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::iterator small_vector<T, N, Allocator, GrowthPolicy>::end() noexcept {
+  return iterator(this->tail_);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::const_iterator small_vector<T, N, Allocator, GrowthPolicy>::end() const noexcept {
+  return const_iterator(this->tail_);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::const_iterator small_vector<T, N, Allocator, GrowthPolicy>::cend() const noexcept {
+  return const_iterator(this->tail_);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::reverse_iterator small_vector<T, N, Allocator, GrowthPolicy>::rbegin() noexcept {
+  return reverse_iterator(this->end());
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::const_reverse_iterator small_vector<T, N, Allocator, GrowthPolicy>::rbegin() const noexcept {
+  return const_reverse_iterator(this->end());
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::const_reverse_iterator small_vector<T, N, Allocator, GrowthPolicy>::crbegin() const noexcept {
+  return const_reverse_iterator(this->end());
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::reverse_iterator small_vector<T, N, Allocator, GrowthPolicy>::rend() noexcept {
+  return reverse_iterator(this->begin());
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::const_reverse_iterator small_vector<T, N, Allocator, GrowthPolicy>::rend() const noexcept {
+  return const_reverse_iterator(this->begin());
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::const_reverse_iterator small_vector<T, N, Allocator, GrowthPolicy>::crend() const noexcept {
+  return const_reverse_iterator(this->begin());
+}
+
+// Capacity:
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+bool small_vector<T, N, Allocator, GrowthPolicy>::empty() const noexcept {
+  return this->head_ == this->tail_;
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::size_type small_vector<T, N, Allocator, GrowthPolicy>::size() const noexcept {
+  return this->tail_ - this->head_;
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::size_type small_vector<T, N, Allocator, GrowthPolicy>::max_size() const noexcept {
+  return std::min<size_type>(alloc_traits::max_size(this->allocator_),
+                             std::numeric_limits<difference_type>::max() / sizeof(T));
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::reserve(size_type new_cap) {
+  if (new_cap > this->max_size()) {
+    throw std::length_error("tftl::small_vector::reserve(): new_cap is too big, not enough memory to reserve");
+  }
+  if (new_cap > this->capacity()) {
+    this->reallocate(new_cap);
+  }
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::size_type small_vector<T, N, Allocator, GrowthPolicy>::capacity() const noexcept {
+  return this->peak_ - this->head_;
+}
+
+// Moves the elements back inline once they fit there again
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::shrink_to_fit() {
+  if (!this->is_inline() && this->size() < this->capacity()) {
+    this->reallocate(this->size());
+  }
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+bool small_vector<T, N, Allocator, GrowthPolicy>::is_inline() const noexcept {
+  return this->head_ == reinterpret_cast<const T*>(this->buffer_);
+}
+
+// Modifiers:
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::clear() noexcept {
+  this->destroy(this->head_, this->tail_);
+  this->tail_ = this->head_;
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::iterator small_vector<T, N, Allocator, GrowthPolicy>::insert(const_iterator pos,
+                                                                                                                   const T& value) {
+  return this->emplace(pos, value);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::iterator small_vector<T, N, Allocator, GrowthPolicy>::insert(const_iterator pos,
+                                                                                                                   T&& value) {
+  return this->emplace(pos, std::move(value));
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::iterator small_vector<T, N, Allocator, GrowthPolicy>::insert(const_iterator pos,
+                                                                                                                   size_type count,
+                                                                                                                   const T& value) {
+  size_type index = pos - this->begin();
+  size_type old_size = this->size();
+  value_type copy(value); // value may live inside the vector
+
+  this->grow(old_size + count);
+  this->construct_back(count, copy);
+  std::rotate(this->head_ + index, this->head_ + old_size, this->tail_);
+  return this->begin() + index;
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+template<class InputIt, typename isIterator>
+typename small_vector<T, N, Allocator, GrowthPolicy>::iterator small_vector<T, N, Allocator, GrowthPolicy>::insert(const_iterator pos,
+                                                                                                                   InputIt first,
+                                                                                                                   InputIt last) {
+  size_type index = pos - this->begin();
+  size_type old_size = this->size();
+
+  this->construct_back_range(first, last);
+  std::rotate(this->head_ + index, this->head_ + old_size, this->tail_);
+  return this->begin() + index;
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::iterator small_vector<T, N, Allocator, GrowthPolicy>::insert(const_iterator pos,
+                                                                                                                   std::initializer_list<T> ilist) {
+  return this->insert(pos, ilist.begin(), ilist.end());
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+template<class... Args>
+typename small_vector<T, N, Allocator, GrowthPolicy>::iterator small_vector<T, N, Allocator, GrowthPolicy>::emplace(const_iterator pos,
+                                                                                                                    Args&& ... args) {
+  size_type index = pos - this->begin();
+  if (index == this->size()) {
+    this->emplace_back(std::forward<Args>(args)...);
+    return this->begin() + index;
+  }
+
+  // args may refer to an element which is about to be shifted
+  value_type value(std::forward<Args>(args)...);
+  this->grow(this->size() + 1);
+  if constexpr (tftl::is_trivially_relocatable_v<T>) {
+    tftl::relocate_shift(this->head_ + index, this->size() - index, 1);
+    alloc_traits::construct(this->allocator_, this->head_ + index, std::move(value));
+    ++(this->tail_);
+  } else {
+    alloc_traits::construct(this->allocator_, this->tail_, std::move(this->tail_[-1]));
+    ++(this->tail_);
+    std::move_backward(this->head_ + index, this->tail_ - 2, this->tail_ - 1);
+    this->head_[index] = std::move(value);
+  }
+  return this->begin() + index;
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::iterator small_vector<T, N, Allocator, GrowthPolicy>::erase(const_iterator pos) {
+  return this->erase(pos, pos + 1);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::iterator small_vector<T, N, Allocator, GrowthPolicy>::erase(const_iterator first,
+                                                                                                                  const_iterator last) {
+  pointer from = &*first;
+  pointer to = &*last;
+  if (from == to) {
+    return first;
+  }
+
+  if constexpr (tftl::is_trivially_relocatable_v<T>) {
+    this->destroy(from, to);
+    tftl::relocate_shift(to, this->tail_ - to, from - to);
+  } else {
+    std::move(to, this->tail_, from);
+    this->destroy(this->tail_ - (to - from), this->tail_);
+  }
+  this->tail_ -= to - from;
+  return first;
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::push_back(const T& value) {
+  this->emplace_back(value);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::push_back(T&& value) {
+  this->emplace_back(std::move(value));
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+template<class... Args>
+typename small_vector<T, N, Allocator, GrowthPolicy>::reference small_vector<T, N, Allocator, GrowthPolicy>::emplace_back(Args&& ... args) {
+  if (this->tail_ == this->peak_) {
+    // args may refer to an element of the old buffer
+    value_type value(std::forward<Args>(args)...);
+    this->grow(this->size() + 1);
+    alloc_traits::construct(this->allocator_, this->tail_, std::move(value));
+  } else {
+    alloc_traits::construct(this->allocator_, this->tail_, std::forward<Args>(args)...);
+  }
+  return *(this->tail_++);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::pop_back() {
+  alloc_traits::destroy(this->allocator_, --(this->tail_));
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::resize(size_type count) {
+  if (count < this->size()) {
+    this->destroy(this->head_ + count, this->tail_);
+    this->tail_ = this->head_ + count;
+  } else {
+    this->grow(count);
+    this->construct_back(count - this->size());
+  }
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::resize(size_type count, const value_type& value) {
+  if (count < this->size()) {
+    this->resize(count);
+  } else {
+    value_type copy(value);
+    this->grow(count);
+    this->construct_back(count - this->size(), copy);
+  }
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::swap(small_vector& other) {
+  if (this == &other) {
+    return;
+  }
+
+  if (!this->is_inline() && !other.is_inline()) {
+    std::swap(this->head_, other.head_);
+    std::swap(this->tail_, other.tail_);
+    std::swap(this->peak_, other.peak_);
+  } else if (this->is_inline() && other.is_inline()) {
+    small_vector& shorter = this->size() < other.size() ? *this : other;
+    small_vector& longer = this->size() < other.size() ? other : *this;
+    size_type common = shorter.size();
+    std::swap_ranges(shorter.head_, shorter.tail_, longer.head_);
+    shorter.tail_ = tftl::uninitialized_relocate(longer.head_ + common, longer.tail_, shorter.tail_, this->allocator_);
+    longer.tail_ = longer.head_ + common;
+  } else {
+    small_vector& local = this->is_inline() ? *this : other;
+    small_vector& heap = this->is_inline() ? other : *this;
+    // Fill the unused inline buffer of the heap vector first, nothing changes if that throws
+    pointer tail = tftl::uninitialized_relocate(local.head_, local.tail_, heap.inline_data(), this->allocator_);
+    local.head_ = heap.head_;
+    local.tail_ = heap.tail_;
+    local.peak_ = heap.peak_;
+    heap.head_ = heap.inline_data();
+    heap.tail_ = tail;
+    heap.peak_ = heap.head_ + N;
+  }
+
+  if (alloc_traits::propagate_on_container_swap::value) {
+    std::swap(this->allocator_, other.allocator_);
+  }
+}
+
+// Methods to manipulate with memory by using allocator:
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+typename small_vector<T, N, Allocator, GrowthPolicy>::pointer small_vector<T, N, Allocator, GrowthPolicy>::inline_data() noexcept {
+  return reinterpret_cast<pointer>(this->buffer_);
+}
+
+// Moves the elements to a buffer of new_cap elements, the inline one if they fit there
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::reallocate(size_type new_cap) {
+  if (this->is_inline() && new_cap <= N) {
+    return;
+  }
+
+  bool to_inline = new_cap <= N;
+  pointer new_begin = to_inline ? this->inline_data() : alloc_traits::allocate(this->allocator_, new_cap);
+  pointer new_end;
+  try {
+    new_end = tftl::uninitialized_relocate(this->head_, this->tail_, new_begin, this->allocator_);
+  } catch (...) {
+    if (!to_inline) {
+      alloc_traits::deallocate(this->allocator_, new_begin, new_cap);
+    }
+    throw;
+  }
+
+  if (!this->is_inline()) {
+    alloc_traits::deallocate(this->allocator_, this->head_, this->capacity());
+  }
+  this->head_ = new_begin;
+  this->tail_ = new_end;
+  this->peak_ = new_begin + (to_inline ? N : new_cap);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::grow(size_type required) {
+  if (required > this->capacity()) {
+    if (required > this->max_size()) {
+      throw std::length_error("tftl::small_vector: the vector would exceed max_size()");
+    }
+    this->reallocate(std::min(GrowthPolicy::next_capacity(this->capacity(), required, sizeof(T)), this->max_size()));
+  }
+}
+
+// Destroys the elements and gives the heap block back, leaving an empty inline vector
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::release() noexcept {
+  this->clear();
+  if (!this->is_inline()) {
+    alloc_traits::deallocate(this->allocator_, this->head_, this->capacity());
+    this->head_ = this->tail_ = this->inline_data();
+    this->peak_ = this->head_ + N;
+  }
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::destroy(pointer first, pointer last) noexcept {
+  for (; first != last; ++first) {
+    alloc_traits::destroy(this->allocator_, first);
+  }
+}
+
+// Takes the heap block of an empty-handed *this from other, or moves other's inline elements
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::steal(small_vector& other) {
+  if (other.is_inline()) {
+    this->tail_ = tftl::uninitialized_relocate(other.head_, other.tail_, this->head_, this->allocator_);
+    other.tail_ = other.head_;
+  } else {
+    this->head_ = other.head_;
+    this->tail_ = other.tail_;
+    this->peak_ = other.peak_;
+    other.head_ = other.tail_ = other.inline_data();
+    other.peak_ = other.head_ + N;
+  }
+}
+
+// Constructs count elements from args past the end, all or none
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+template<class... Args>
+void small_vector<T, N, Allocator, GrowthPolicy>::construct_back(size_type count, Args&& ... args) {
+  pointer current = this->tail_;
+  try {
+    for (; count != 0; --count, ++current) {
+      alloc_traits::construct(this->allocator_, current, args...);
+    }
+  } catch (...) {
+    this->destroy(this->tail_, current);
+    throw;
+  }
+  this->tail_ = current;
+}
+
+// Appends [first, last), reserving once for forward ranges
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+template<class InputIt>
+void small_vector<T, N, Allocator, GrowthPolicy>::construct_back_range(InputIt first, InputIt last) {
+  typedef typename std::iterator_traits<InputIt>::iterator_category category;
+  if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+    this->grow(this->size() + std::distance(first, last));
+    pointer current = this->tail_;
+    try {
+      for (; first != last; ++first, ++current) {
+        alloc_traits::construct(this->allocator_, current, *first);
+      }
+    } catch (...) {
+      this->destroy(this->tail_, current);
+      throw;
+    }
+    this->tail_ = current;
+  } else {
+    for (; first != last; ++first) {
+      this->emplace_back(*first);
+    }
+  }
+}
+
+// Operators
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+bool operator==(const small_vector<T, N, Allocator, GrowthPolicy>& lhs, const small_vector<T, N, Allocator, GrowthPolicy>& rhs) {
+  return lhs.size() == rhs.size() && std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin());
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+bool operator!=(const small_vector<T, N, Allocator, GrowthPolicy>& lhs, const small_vector<T, N, Allocator, GrowthPolicy>& rhs) {
+  return !(lhs == rhs);
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+bool operator<(const small_vector<T, N, Allocator, GrowthPolicy>& lhs, const small_vector<T, N, Allocator, GrowthPolicy>& rhs) {
+  return std::lexicographical_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend());
+}
+
+template<typename T, std::size_t N, typename Allocator, typename GrowthPolicy>
+void swap(small_vector<T, N, Allocator, GrowthPolicy>& lhs, small_vector<T, N, Allocator, GrowthPolicy>& rhs) {
+  lhs.swap(rhs);
+}
+} //namespace truefinch template library
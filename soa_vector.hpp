@@ -0,0 +1,709 @@
+//
+// Created by truefinch on 16.07.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "growth_policy.hpp"
+#include "memory.hpp"
+#include "span.hpp"
+
+namespace tftl {
+/**
+ * @brief tftl::soa_reference is what dereferencing a tftl::soa_vector iterator gives: one reference
+ * per column, gathered in a std::tuple it derives from, so std::get<I> reads a field.
+ *
+ * It behaves as a reference to the row: assigning to it assigns the fields, swap exchanges
+ * two rows and it converts to the value_type tuple, which is what std::sort and friends need.
+ */
+template<bool Const, typename... Ts>
+class soa_reference : public std::tuple<typename std::conditional<Const, const Ts&, Ts&>::type...> {
+  typedef std::tuple<typename std::conditional<Const, const Ts&, Ts&>::type...> base;
+ public:
+  typedef std::tuple<Ts...> value_type;
+
+  using base::base;
+  soa_reference(const soa_reference&) = default;
+  template<bool OtherConst, typename = typename std::enable_if<Const && !OtherConst>::type>
+  soa_reference(const soa_reference<OtherConst, Ts...>& other) : base(other.fields()) {}
+
+  // Assignment writes through, it never rebinds
+  soa_reference& operator=(const soa_reference& other) {
+    this->fields() = other.fields();
+    return *this;
+  }
+  soa_reference& operator=(soa_reference&& other) {
+    this->assign(std::move(other), std::index_sequence_for<Ts...>());
+    return *this;
+  }
+  soa_reference& operator=(const value_type& value) {
+    this->fields() = value;
+    return *this;
+  }
+  soa_reference& operator=(value_type&& value) {
+    this->fields() = std::move(value);
+    return *this;
+  }
+
+  operator value_type() const& { return value_type(this->fields()); }
+  operator value_type() && { return this->take(std::index_sequence_for<Ts...>()); }
+
+  base&       fields() noexcept { return *this; }
+  const base& fields() const noexcept { return *this; }
+
+  friend void swap(soa_reference lhs, soa_reference rhs) {
+    lhs.swap_fields(rhs, std::index_sequence_for<Ts...>());
+  }
+
+ private:
+  template<std::size_t... I>
+  void assign(soa_reference&& other, std::index_sequence<I...>) {
+    ((std::get<I>(this->fields()) = std::move(std::get<I>(other.fields()))), ...);
+  }
+
+  template<std::size_t... I>
+  value_type take(std::index_sequence<I...>) {
+    return value_type(std::move(std::get<I>(this->fields()))...);
+  }
+
+  template<std::size_t... I>
+  void swap_fields(soa_reference& other, std::index_sequence<I...>) {
+    using std::swap;
+    (swap(std::get<I>(this->fields()), std::get<I>(other.fields())), ...);
+  }
+};
+
+/**
+ * @brief tftl::soa_iterator walks the rows of a tftl::soa_vector, it holds the column pointers
+ * and a row index and offers every operator of tftl::iterator.
+ */
+template<bool Const, typename... Ts>
+class soa_iterator {
+ public:
+  // @formatter:off
+  typedef std::ptrdiff_t                                                     difference_type;
+  typedef std::tuple<Ts...>                                                  value_type;
+  typedef soa_reference<Const, Ts...>                                        reference;
+  typedef void                                                               pointer;
+  typedef std::random_access_iterator_tag                                    iterator_category;
+  typedef std::tuple<typename std::conditional<Const, const Ts*, Ts*>::type...> columns;
+  // @formatter:on
+
+  soa_iterator() noexcept = default;
+  soa_iterator(const columns& base, difference_type index) noexcept : columns_(base), index_(index) {}
+  template<bool OtherConst, typename = typename std::enable_if<Const && !OtherConst>::type>
+  soa_iterator(const soa_iterator<OtherConst, Ts...>& other) noexcept
+      : columns_(other.base_columns()), index_(other.index()) {}
+
+  soa_iterator& operator++() noexcept { ++this->index_; return *this; }
+  soa_iterator& operator--() noexcept { --this->index_; return *this; }
+  soa_iterator  operator++(int) noexcept { soa_iterator copy(*this); ++this->index_; return copy; }
+  soa_iterator  operator--(int) noexcept { soa_iterator copy(*this); --this->index_; return copy; }
+  soa_iterator& operator+=(difference_type n) noexcept { this->index_ += n; return *this; }
+  soa_iterator& operator-=(difference_type n) noexcept { this->index_ -= n; return *this; }
+
+  difference_type operator-(const soa_iterator& other) const noexcept { return this->index_ - other.index_; }
+  soa_iterator    operator+(difference_type n) const noexcept { return soa_iterator(*this) += n; }
+  soa_iterator    operator-(difference_type n) const noexcept { return soa_iterator(*this) -= n; }
+
+  reference operator*() const noexcept { return (*this)[0]; }
+  reference operator[](difference_type n) const noexcept {
+    return this->row(this->index_ + n, std::index_sequence_for<Ts...>());
+  }
+
+  bool operator==(const soa_iterator& other) const noexcept { return this->index_ == other.index_; }
+  bool operator!=(const soa_iterator& other) const noexcept { return this->index_ != other.index_; }
+  bool operator<(const soa_iterator& other) const noexcept { return this->index_ < other.index_; }
+  bool operator>(const soa_iterator& other) const noexcept { return this->index_ > other.index_; }
+  bool operator<=(const soa_iterator& other) const noexcept { return this->index_ <= other.index_; }
+  bool operator>=(const soa_iterator& other) const noexcept { return this->index_ >= other.index_; }
+
+  const columns&  base_columns() const noexcept { return this->columns_; }
+  difference_type index() const noexcept { return this->index_; }
+
+ private:
+  template<std::size_t... I>
+  reference row(difference_type index, std::index_sequence<I...>) const noexcept {
+    return reference(std::get<I>(this->columns_)[index]...);
+  }
+
+  columns         columns_;
+  difference_type index_ = 0;
+};
+
+template<bool Const, typename... Ts>
+soa_iterator<Const, Ts...> operator+(typename soa_iterator<Const, Ts...>::difference_type n,
+                                     const soa_iterator<Const, Ts...>& it) noexcept {
+  return it + n;
+}
+
+/**
+ * @brief tftl::basic_soa_vector stores rows of fields Ts... as a structure of arrays: each field
+ * in its own contiguous column, so a loop reading one field streams only that field through the cache.
+ *
+ * All columns live in a single allocation, each starting on a 64-byte boundary, and share one size,
+ * one capacity and one growth path driven by GrowthPolicy. data<I>() and column<I>() expose a column
+ * for SIMD kernels such as tftl::numeric. Reallocation gives the strong guarantee, like tftl::vector.
+ */
+template<typename GrowthPolicy, typename... Ts>
+class basic_soa_vector {
+  static_assert(sizeof...(Ts) > 0, "tftl::soa_vector: at least one column is needed");
+ public:
+  // @formatter:off
+  typedef std::tuple<Ts...>               value_type;
+  typedef GrowthPolicy                    growth_policy;
+  typedef std::size_t                     size_type;
+  typedef std::ptrdiff_t                  difference_type;
+  typedef soa_reference<false, Ts...>     reference;
+  typedef soa_reference<true, Ts...>      const_reference;
+  typedef soa_iterator<false, Ts...>      iterator;
+  typedef soa_iterator<true, Ts...>       const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+  template<std::size_t I>
+  using column_type = typename std::tuple_element<I, value_type>::type;
+  // @formatter:on
+
+  static constexpr std::size_t columns = sizeof...(Ts);
+  static constexpr std::size_t column_alignment = std::max({std::size_t(64), alignof(Ts)...});
+
+  // construct/copy/destroy:
+  basic_soa_vector() noexcept = default;
+  explicit basic_soa_vector(size_type count);
+  basic_soa_vector(size_type count, const value_type& value);
+  basic_soa_vector(const basic_soa_vector& other);
+  basic_soa_vector(basic_soa_vector&& other) noexcept;
+  ~basic_soa_vector();
+
+  basic_soa_vector& operator=(basic_soa_vector other) noexcept;
+
+  // Element access:
+  reference       at(size_type pos);
+  const_reference at(size_type pos) const;
+  reference       operator[](size_type pos) noexcept;
+  const_reference operator[](size_type pos) const noexcept;
+  reference       front() noexcept;
+  const_reference front() const noexcept;
+  reference       back() noexcept;
+  const_reference back() const noexcept;
+
+  // Column access:
+  template<std::size_t I>
+  column_type<I>*                    data() noexcept;
+  template<std::size_t I>
+  const column_type<I>*              data() const noexcept;
+  template<std::size_t I>
+  tftl::span<column_type<I>>         column() noexcept;
+  template<std::size_t I>
+  tftl::span<const column_type<I>>   column() const noexcept;
+
+  // Iterators:
+  iterator               begin() noexcept;
+  const_iterator         begin() const noexcept;
+  const_iterator         cbegin() const noexcept;
+  iterator               end() noexcept;
+  const_iterator         end() const noexcept;
+  const_iterator         cend() const noexcept;
+  reverse_iterator       rbegin() noexcept;
+  const_reverse_iterator rbegin() const noexcept;
+  reverse_iterator       rend() noexcept;
+  const_reverse_iterator rend() const noexcept;
+
+  // Capacity:
+  bool      empty() const noexcept;
+  size_type size() const noexcept;
+  size_type max_size() const noexcept;
+  size_type capacity() const noexcept;
+  void      reserve(size_type new_cap);
+  void      shrink_to_fit();
+
+  // Modifiers:
+  void clear() noexcept;
+  void push_back(const value_type& value);
+  void push_back(value_type&& value);
+  // One argument per column, each column is constructed from its own
+  template<class... Args>
+  reference emplace_back(Args&& ... args);
+  void pop_back();
+  void resize(size_type count);
+  void resize(size_type count, const value_type& value);
+  void swap(basic_soa_vector& other) noexcept;
+
+ private:
+  typedef std::tuple<Ts*...> pointers;
+
+  static size_type bytes(size_type capacity) noexcept;
+  static pointers  layout(void* block, size_type capacity) noexcept;
+
+  void reallocate(size_type new_cap);
+  void grow(size_type required);
+  void release() noexcept;
+
+  template<std::size_t I, bool MayThrow>
+  void move_columns(const pointers& target);
+  template<std::size_t I>
+  void copy_columns(const basic_soa_vector& other);
+  template<std::size_t I, class Tuple>
+  void construct_row(size_type index, Tuple&& args);
+  void destroy_rows(size_type first, size_type last) noexcept;
+
+  template<std::size_t... I>
+  reference row(size_type index, std::index_sequence<I...>) noexcept;
+  template<std::size_t... I>
+  const_reference row(size_type index, std::index_sequence<I...>) const noexcept;
+  template<std::size_t... I>
+  typename const_iterator::columns const_columns(std::index_sequence<I...>) const noexcept;
+
+  void*     block_ = nullptr;
+  pointers  columns_{};
+  size_type size_ = 0;
+  size_type capacity_ = 0;
+};
+
+/**
+ * @brief tftl::soa_vector<Ts...> is basic_soa_vector with the growth policy of tftl::vector.
+ */
+template<typename... Ts>
+using soa_vector = basic_soa_vector<tftl::default_growth, Ts...>;
+
+// construct/copy/destroy:
+template<typename GrowthPolicy, typename... Ts>
+basic_soa_vector<GrowthPolicy, Ts...>::basic_soa_vector(size_type count) {
+  this->resize(count);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+basic_soa_vector<GrowthPolicy, Ts...>::basic_soa_vector(size_type count, const value_type& value) {
+  this->resize(count, value);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+basic_soa_vector<GrowthPolicy, Ts...>::basic_soa_vector(const basic_soa_vector& other) : basic_soa_vector() {
+  // Delegating first lets the destructor free the block if a copy throws
+  this->reallocate(other.size_);
+  this->copy_columns<0>(other);
+  this->size_ = other.size_;
+}
+
+template<typename GrowthPolicy, typename... Ts>
+basic_soa_vector<GrowthPolicy, Ts...>::basic_soa_vector(basic_soa_vector&& other) noexcept {
+  this->swap(other);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+basic_soa_vector<GrowthPolicy, Ts...>::~basic_soa_vector() {
+  this->release();
+}
+
+template<typename GrowthPolicy, typename... Ts>
+basic_soa_vector<GrowthPolicy, Ts...>& basic_soa_vector<GrowthPolicy, Ts...>::operator=(basic_soa_vector other) noexcept {
+  this->swap(other);
+  return *this;
+}
+
+// Element access:
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::reference basic_soa_vector<GrowthPolicy, Ts...>::at(size_type pos) {
+  if (pos >= this->size_) {
+    throw std::out_of_range("tftl::soa_vector::at: accessed element out of range");
+  }
+  return (*this)[pos];
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::const_reference basic_soa_vector<GrowthPolicy, Ts...>::at(size_type pos) const {
+  if (pos >= this->size_) {
+    throw std::out_of_range("tftl::soa_vector::at: accessed element out of range");
+  }
+  return (*this)[pos];
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::reference basic_soa_vector<GrowthPolicy, Ts...>::operator[](size_type pos) noexcept {
+  return this->row(pos, std::index_sequence_for<Ts...>());
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::const_reference basic_soa_vector<GrowthPolicy, Ts...>::operator[](size_type pos) const noexcept {
+  return this->row(pos, std::index_sequence_for<Ts...>());
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::reference basic_soa_vector<GrowthPolicy, Ts...>::front() noexcept {
+  return (*this)[0];
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::const_reference basic_soa_vector<GrowthPolicy, Ts...>::front() const noexcept {
+  return (*this)[0];
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::reference basic_soa_vector<GrowthPolicy, Ts...>::back() noexcept {
+  return (*this)[this->size_ - 1];
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::const_reference basic_soa_vector<GrowthPolicy, Ts...>::back() const noexcept {
+  return (*this)[this->size_ - 1];
+}
+
+// Column access:
+template<typename GrowthPolicy, typename... Ts>
+template<std::size_t I>
+typename basic_soa_vector<GrowthPolicy, Ts...>::template column_type<I>* basic_soa_vector<GrowthPolicy, Ts...>::data() noexcept {
+  return std::get<I>(this->columns_);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+template<std::size_t I>
+const typename basic_soa_vector<GrowthPolicy, Ts...>::template column_type<I>* basic_soa_vector<GrowthPolicy, Ts...>::data() const noexcept {
+  return std::get<I>(this->columns_);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+template<std::size_t I>
+tftl::span<typename basic_soa_vector<GrowthPolicy, Ts...>::template column_type<I>> basic_soa_vector<GrowthPolicy, Ts...>::column() noexcept {
+  return tftl::span<column_type<I>>(std::get<I>(this->columns_), this->size_);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+template<std::size_t I>
+tftl::span<const typename basic_soa_vector<GrowthPolicy, Ts...>::template column_type<I>> basic_soa_vector<GrowthPolicy, Ts...>::column() const noexcept {
+  return tftl::span<const column_type<I>>(std::get<I>(this->columns_), this->size_);
+}
+
+// Iterators:
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::iterator basic_soa_vector<GrowthPolicy, Ts...>::begin() noexcept {
+  return iterator(this->columns_, 0);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::const_iterator basic_soa_vector<GrowthPolicy, Ts...>::begin() const noexcept {
+  return const_iterator(this->const_columns(std::index_sequence_for<Ts...>()), 0);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::const_iterator basic_soa_vector<GrowthPolicy, Ts...>::cbegin() const noexcept {
+  return this->begin();
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::iterator basic_soa_vector<GrowthPolicy, Ts...>::end() noexcept {
+  return iterator(this->columns_, static_cast<difference_type>(this->size_));
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::const_iterator basic_soa_vector<GrowthPolicy, Ts...>::end() const noexcept {
+  return const_iterator(this->const_columns(std::index_sequence_for<Ts...>()), static_cast<difference_type>(this->size_));
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::const_iterator basic_soa_vector<GrowthPolicy, Ts...>::cend() const noexcept {
+  return this->end();
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::reverse_iterator basic_soa_vector<GrowthPolicy, Ts...>::rbegin() noexcept {
+  return reverse_iterator(this->end());
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::const_reverse_iterator basic_soa_vector<GrowthPolicy, Ts...>::rbegin() const noexcept {
+  return const_reverse_iterator(this->end());
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::reverse_iterator basic_soa_vector<GrowthPolicy, Ts...>::rend() noexcept {
+  return reverse_iterator(this->begin());
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::const_reverse_iterator basic_soa_vector<GrowthPolicy, Ts...>::rend() const noexcept {
+  return const_reverse_iterator(this->begin());
+}
+
+// Capacity:
+template<typename GrowthPolicy, typename... Ts>
+bool basic_soa_vector<GrowthPolicy, Ts...>::empty() const noexcept {
+  return this->size_ == 0;
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::size_type basic_soa_vector<GrowthPolicy, Ts...>::size() const noexcept {
+  return this->size_;
+}
+
+// Every column is padded to the alignment, so a row costs at most that much more
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::size_type basic_soa_vector<GrowthPolicy, Ts...>::max_size() const noexcept {
+  return (static_cast<size_type>(std::numeric_limits<difference_type>::max()) - columns * column_alignment)
+      / (sizeof(Ts) + ...);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::size_type basic_soa_vector<GrowthPolicy, Ts...>::capacity() const noexcept {
+  return this->capacity_;
+}
+
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::reserve(size_type new_cap) {
+  if (new_cap > this->max_size()) {
+    throw std::length_error("tftl::soa_vector::reserve(): new_cap is too big, not enough memory to reserve");
+  }
+  if (new_cap > this->capacity_) {
+    this->reallocate(new_cap);
+  }
+}
+
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::shrink_to_fit() {
+  if (this->capacity_ != this->size_) {
+    this->reallocate(this->size_);
+  }
+}
+
+// Modifiers:
+// Like tftl::vector::clear, the memory goes back too
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::clear() noexcept {
+  this->release();
+  this->block_ = nullptr;
+  this->columns_ = pointers();
+  this->size_ = this->capacity_ = 0;
+}
+
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::push_back(const value_type& value) {
+  std::apply([this](const Ts& ... fields) { this->emplace_back(fields...); }, value);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::push_back(value_type&& value) {
+  std::apply([this](Ts& ... fields) { this->emplace_back(std::move(fields)...); }, value);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+template<class... Args>
+typename basic_soa_vector<GrowthPolicy, Ts...>::reference basic_soa_vector<GrowthPolicy, Ts...>::emplace_back(Args&& ... args) {
+  static_assert(sizeof...(Args) == sizeof...(Ts), "tftl::soa_vector::emplace_back: one argument per column");
+  if (this->size_ == this->capacity_) {
+    value_type row(std::forward<Args>(args)...); // args may refer into this vector, which is about to move
+    this->grow(this->size_ + 1);
+    this->construct_row<0>(this->size_, std::move(row));
+  } else {
+    this->construct_row<0>(this->size_, std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+  return (*this)[this->size_++];
+}
+
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::pop_back() {
+  this->destroy_rows(this->size_ - 1, this->size_);
+  --this->size_;
+}
+
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::resize(size_type count) {
+  this->resize(count, value_type());
+}
+
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::resize(size_type count, const value_type& value) {
+  if (count < this->size_) {
+    this->destroy_rows(count, this->size_);
+    this->size_ = count;
+    return;
+  }
+  this->reserve(count);
+  while (this->size_ < count) {
+    this->construct_row<0>(this->size_, value);
+    ++this->size_;
+  }
+}
+
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::swap(basic_soa_vector& other) noexcept {
+  std::swap(this->block_, other.block_);
+  std::swap(this->columns_, other.columns_);
+  std::swap(this->size_, other.size_);
+  std::swap(this->capacity_, other.capacity_);
+}
+
+// Memory:
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::size_type basic_soa_vector<GrowthPolicy, Ts...>::bytes(size_type capacity) noexcept {
+  size_type total = 0;
+  ((total += (capacity * sizeof(Ts) + column_alignment - 1) / column_alignment * column_alignment), ...);
+  return total;
+}
+
+// Column I starts where column I - 1 ends, rounded up to the alignment
+template<typename GrowthPolicy, typename... Ts>
+typename basic_soa_vector<GrowthPolicy, Ts...>::pointers basic_soa_vector<GrowthPolicy, Ts...>::layout(void* block, size_type capacity) noexcept {
+  auto next = static_cast<unsigned char*>(block);
+  auto place = [&next, capacity](std::size_t size) {
+    unsigned char* start = next;
+    next += (capacity * size + column_alignment - 1) / column_alignment * column_alignment;
+    return start;
+  };
+  return pointers(reinterpret_cast<Ts*>(place(sizeof(Ts)))...);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::grow(size_type required) {
+  if (required > this->max_size()) {
+    throw std::length_error("tftl::soa_vector: size would exceed max_size()");
+  }
+  this->reallocate(std::min(GrowthPolicy::next_capacity(this->capacity_, required, (sizeof(Ts) + ...)),
+                            this->max_size()));
+}
+
+/**
+ * Columns which may throw while moving are first copied into the new block column by column.
+ * Only once all of them are there are the nothrow columns moved, the old elements destroyed
+ * and the relocatable columns memcpy'd, so a throwing copy leaves the vector untouched.
+ */
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::reallocate(size_type new_cap) {
+  void* block = new_cap == 0 ? nullptr : ::operator new(bytes(new_cap), std::align_val_t(column_alignment));
+  pointers target = block == nullptr ? pointers() : layout(block, new_cap);
+  try {
+    this->move_columns<0, true>(target);
+  } catch (...) {
+    ::operator delete(block, std::align_val_t(column_alignment));
+    throw;
+  }
+  this->move_columns<0, false>(target);
+
+  auto finish = [this](auto* source, auto* destination) {
+    typedef typename std::remove_pointer<decltype(source)>::type T;
+    if constexpr (tftl::is_trivially_relocatable_v<T>) {
+      if (this->size_ != 0) {
+        std::memcpy(static_cast<void*>(destination), static_cast<const void*>(source), this->size_ * sizeof(T));
+      }
+    } else if constexpr (!std::is_trivially_destructible<T>::value) {
+      for (size_type i = 0; i < this->size_; ++i) {
+        source[i].~T();
+      }
+    }
+  };
+  std::apply([&](Ts* ... sources) {
+    std::apply([&](Ts* ... destinations) { (finish(sources, destinations), ...); }, target);
+  }, this->columns_);
+
+  ::operator delete(this->block_, std::align_val_t(column_alignment));
+  this->block_ = block;
+  this->columns_ = target;
+  this->capacity_ = new_cap;
+}
+
+// Builds the columns from I on that cannot be memcpy'd and whose move may or may not throw as MayThrow says,
+// undoing them all if one throws
+template<typename GrowthPolicy, typename... Ts>
+template<std::size_t I, bool MayThrow>
+void basic_soa_vector<GrowthPolicy, Ts...>::move_columns(const pointers& target) {
+  if constexpr (I < columns) {
+    typedef column_type<I> T;
+    if constexpr (tftl::is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible<T>::value == MayThrow) {
+      this->move_columns<I + 1, MayThrow>(target);
+    } else {
+      T* source = std::get<I>(this->columns_);
+      T* destination = std::get<I>(target);
+      size_type built = 0;
+      try {
+        for (; built < this->size_; ++built) {
+          ::new(static_cast<void*>(destination + built)) T(std::move_if_noexcept(source[built]));
+        }
+        this->move_columns<I + 1, MayThrow>(target);
+      } catch (...) {
+        for (size_type i = 0; i < built; ++i) {
+          destination[i].~T();
+        }
+        throw;
+      }
+    }
+  }
+}
+
+template<typename GrowthPolicy, typename... Ts>
+template<std::size_t I>
+void basic_soa_vector<GrowthPolicy, Ts...>::copy_columns(const basic_soa_vector& other) {
+  if constexpr (I < columns) {
+    typedef column_type<I> T;
+    std::allocator<T> allocator;
+    T* destination = std::get<I>(this->columns_);
+    tftl::uninitialized_copy_n(std::get<I>(other.columns_), other.size_, destination, allocator);
+    try {
+      this->copy_columns<I + 1>(other);
+    } catch (...) {
+      std::destroy_n(destination, other.size_);
+      throw;
+    }
+  }
+}
+
+// Constructs column I onwards of row index from the matching elements of args
+template<typename GrowthPolicy, typename... Ts>
+template<std::size_t I, class Tuple>
+void basic_soa_vector<GrowthPolicy, Ts...>::construct_row(size_type index, Tuple&& args) {
+  if constexpr (I < columns) {
+    typedef column_type<I> T;
+    T* element = std::get<I>(this->columns_) + index;
+    ::new(static_cast<void*>(element)) T(std::get<I>(std::forward<Tuple>(args)));
+    try {
+      this->construct_row<I + 1>(index, std::forward<Tuple>(args));
+    } catch (...) {
+      element->~T();
+      throw;
+    }
+  }
+}
+
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::destroy_rows(size_type first, size_type last) noexcept {
+  std::apply([first, last](Ts* ... column) {
+    (std::destroy(column + first, column + last), ...);
+  }, this->columns_);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+void basic_soa_vector<GrowthPolicy, Ts...>::release() noexcept {
+  this->destroy_rows(0, this->size_);
+  ::operator delete(this->block_, std::align_val_t(column_alignment));
+}
+
+template<typename GrowthPolicy, typename... Ts>
+template<std::size_t... I>
+typename basic_soa_vector<GrowthPolicy, Ts...>::reference basic_soa_vector<GrowthPolicy, Ts...>::row(size_type index,
+                                                                                                   std::index_sequence<I...>) noexcept {
+  return reference(std::get<I>(this->columns_)[index]...);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+template<std::size_t... I>
+typename basic_soa_vector<GrowthPolicy, Ts...>::const_reference basic_soa_vector<GrowthPolicy, Ts...>::row(size_type index,
+                                                                                                         std::index_sequence<I...>) const noexcept {
+  return const_reference(std::get<I>(this->columns_)[index]...);
+}
+
+template<typename GrowthPolicy, typename... Ts>
+template<std::size_t... I>
+typename basic_soa_vector<GrowthPolicy, Ts...>::const_iterator::columns basic_soa_vector<GrowthPolicy, Ts...>::const_columns(
+    std::index_sequence<I...>) const noexcept {
+  return typename const_iterator::columns(std::get<I>(this->columns_)...);
+}
+} //namespace truefinch template library
@@ -0,0 +1,587 @@
+//
+// Created by truefinch on 13.07.18.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#if __has_include(<span>)
+#include <span>
+#endif
+
+#include "iterator.hpp"
+
+namespace tftl {
+template<typename T>
+class span;
+template<typename T>
+class strided_span;
+
+// Passed as a count, takes everything up to the end
+constexpr std::size_t dynamic_extent = std::numeric_limits<std::size_t>::max();
+
+namespace detail {
+// A qualification conversion, U* to const U*, never a derived to base one
+template<typename From, typename To>
+using is_array_convertible = std::is_convertible<From (*)[], To (*)[]>;
+
+template<typename T>
+T* to_address(T* pointer) noexcept {
+  return pointer;
+}
+
+// Does not dereference, so it is valid for end()
+template<typename T>
+T* to_address(const tftl::iterator<T>& it) noexcept {
+  return it.operator->();
+}
+} // namespace detail
+
+/**
+ * @brief tftl::span_chunks splits a span into consecutive chunks, all of them subspans sharing its memory.
+ *
+ * Produced by split(parts), which balances the sizes to differ by at most one, and by chunks(size),
+ * whose last chunk takes what is left. Chunk i is computed from i alone, so workers can each take theirs
+ * with operator[] without walking the others.
+ */
+template<typename Span>
+class span_chunks {
+ public:
+  // @formatter:off
+  typedef Span        value_type;
+  typedef std::size_t size_type;
+  // @formatter:on
+
+  class iterator {
+   public:
+    // @formatter:off
+    typedef std::ptrdiff_t            difference_type;
+    typedef Span                      value_type;
+    typedef const Span*               pointer;
+    typedef Span                      reference;
+    typedef std::forward_iterator_tag iterator_category;
+    // @formatter:on
+
+    iterator() noexcept = default;
+    iterator(const span_chunks* chunks, size_type index) noexcept : chunks_(chunks), index_(index) {}
+
+    Span      operator*() const { return (*this->chunks_)[this->index_]; }
+    iterator& operator++() noexcept { ++this->index_; return *this; }
+    iterator  operator++(int) noexcept { iterator copy(*this); ++this->index_; return copy; }
+    bool      operator==(const iterator& other) const noexcept { return this->index_ == other.index_; }
+    bool      operator!=(const iterator& other) const noexcept { return this->index_ != other.index_; }
+
+   private:
+    const span_chunks* chunks_ = nullptr;
+    size_type          index_ = 0;
+  };
+
+  span_chunks(Span whole, size_type base, size_type extra, size_type count) noexcept;
+
+  Span      operator[](size_type index) const;
+  size_type size() const noexcept;
+  bool      empty() const noexcept;
+  iterator  begin() const noexcept;
+  iterator  end() const noexcept;
+
+ private:
+  Span      whole_;
+  size_type base_;  //Elements in a chunk
+  size_type extra_; //The first extra chunks take one element more
+  size_type count_;
+};
+
+template<typename Span>
+span_chunks<Span>::span_chunks(Span whole, size_type base, size_type extra, size_type count) noexcept
+    : whole_(whole), base_(base), extra_(extra), count_(count) {}
+
+template<typename Span>
+Span span_chunks<Span>::operator[](size_type index) const {
+  size_type first = index * this->base_ + std::min(index, this->extra_);
+  size_type count = std::min(this->base_ + (index < this->extra_ ? 1 : 0), this->whole_.size() - first);
+  return this->whole_.subspan(first, count);
+}
+
+template<typename Span>
+typename span_chunks<Span>::size_type span_chunks<Span>::size() const noexcept {
+  return this->count_;
+}
+
+template<typename Span>
+bool span_chunks<Span>::empty() const noexcept {
+  return this->count_ == 0;
+}
+
+template<typename Span>
+typename span_chunks<Span>::iterator span_chunks<Span>::begin() const noexcept {
+  return iterator(this, 0);
+}
+
+template<typename Span>
+typename span_chunks<Span>::iterator span_chunks<Span>::end() const noexcept {
+  return iterator(this, this->count_);
+}
+
+namespace detail {
+template<typename Span>
+span_chunks<Span> split(const Span& whole, std::size_t parts) {
+  if (parts == 0) {
+    throw std::invalid_argument("tftl::span::split: parts == 0");
+  }
+  parts = std::min(parts, whole.size());
+  return parts == 0 ? span_chunks<Span>(whole, 0, 0, 0)
+                    : span_chunks<Span>(whole, whole.size() / parts, whole.size() % parts, parts);
+}
+
+template<typename Span>
+span_chunks<Span> chunks(const Span& whole, std::size_t size) {
+  if (size == 0) {
+    throw std::invalid_argument("tftl::span::chunks: size == 0");
+  }
+  return span_chunks<Span>(whole, size, 0, whole.size() / size + (whole.size() % size != 0 ? 1 : 0));
+}
+} // namespace detail
+
+/**
+ * @brief tftl::span refers to a contiguous run of elements owned by someone else, typically part of
+ * a tftl::vector, and is cheap to copy and hand to another thread.
+ *
+ * Slicing with first, last, subspan, split and chunks never allocates nor copies an element.
+ * Constness is shallow as with std::span: a const span<int> still gives int&, span<const int> does not.
+ * It converts to and from std::span when the standard library has it.
+ */
+template<typename T>
+class span {
+ public:
+  // @formatter:off
+  typedef T                                 element_type;
+  typedef typename std::remove_cv<T>::type  value_type;
+  typedef std::size_t                       size_type;
+  typedef std::ptrdiff_t                    difference_type;
+  typedef T*                                pointer;
+  typedef const T*                          const_pointer;
+  typedef T&                                reference;
+  typedef const T&                          const_reference;
+  typedef tftl::iterator <T>                iterator;
+  typedef std::reverse_iterator <iterator>  reverse_iterator;
+  // @formatter:on
+
+  span() noexcept = default;
+  span(pointer data, size_type count) noexcept;
+  span(pointer first, pointer last) noexcept;
+  template<typename U, typename = typename std::enable_if<detail::is_array_convertible<U, T>::value>::type>
+  span(tftl::iterator<U> first, size_type count) noexcept;
+  template<typename U, typename = typename std::enable_if<detail::is_array_convertible<U, T>::value>::type>
+  span(tftl::iterator<U> first, tftl::iterator<U> last) noexcept;
+  // tftl::vector, std::vector, std::array, arrays, std::span and anything else with std::data and std::size
+  template<class Range, typename = typename std::enable_if<
+      !std::is_same<typename std::decay<Range>::type, span>::value && tftl::is_contiguous_range<Range>::value
+      && detail::is_array_convertible<typename std::remove_pointer<decltype(std::data(std::declval<Range&>()))>::type,
+                                      T>::value>::type>
+  span(Range&& range) noexcept;
+  template<typename U, typename = typename std::enable_if<detail::is_array_convertible<U, T>::value>::type>
+  span(const span<U>& other) noexcept;
+
+#if defined(__cpp_lib_span)
+  operator std::span<T>() const noexcept;
+#endif
+
+  // Element access:
+  reference at(size_type pos) const;
+  reference operator[](size_type pos) const noexcept;
+  reference front() const noexcept;
+  reference back() const noexcept;
+  pointer   data() const noexcept;
+
+  // Iterators:
+  iterator         begin() const noexcept;
+  iterator         end() const noexcept;
+  reverse_iterator rbegin() const noexcept;
+  reverse_iterator rend() const noexcept;
+
+  // Observers:
+  bool      empty() const noexcept;
+  size_type size() const noexcept;
+  size_type size_bytes() const noexcept;
+
+  // Subviews, out of range arguments throw std::out_of_range:
+  span                     first(size_type count) const;
+  span                     last(size_type count) const;
+  span                     subspan(size_type offset, size_type count = dynamic_extent) const;
+  strided_span<T>          strided(size_type step) const;
+  span_chunks<span>        split(size_type parts) const;
+  span_chunks<span>        chunks(size_type size) const;
+
+ private:
+  pointer   data_ = nullptr;
+  size_type size_ = 0;
+};
+
+template<typename T>
+span<T>::span(pointer data, size_type count) noexcept : data_(data), size_(count) {}
+
+template<typename T>
+span<T>::span(pointer first, pointer last) noexcept : data_(first), size_(static_cast<size_type>(last - first)) {}
+
+template<typename T>
+template<typename U, typename>
+span<T>::span(tftl::iterator<U> first, size_type count) noexcept : data_(detail::to_address(first)), size_(count) {}
+
+template<typename T>
+template<typename U, typename>
+span<T>::span(tftl::iterator<U> first, tftl::iterator<U> last) noexcept
+    : data_(detail::to_address(first)), size_(static_cast<size_type>(last - first)) {}
+
+template<typename T>
+template<class Range, typename>
+span<T>::span(Range&& range) noexcept : data_(std::data(range)), size_(std::size(range)) {}
+
+template<typename T>
+template<typename U, typename>
+span<T>::span(const span<U>& other) noexcept : data_(other.data()), size_(other.size()) {}
+
+#if defined(__cpp_lib_span)
+template<typename T>
+span<T>::operator std::span<T>() const noexcept {
+  return std::span<T>(this->data_, this->size_);
+}
+#endif
+
+template<typename T>
+typename span<T>::reference span<T>::at(size_type pos) const {
+  if (pos >= this->size_) {
+    throw std::out_of_range("tftl::span::at: pos >= size()");
+  }
+  return this->data_[pos];
+}
+
+template<typename T>
+typename span<T>::reference span<T>::operator[](size_type pos) const noexcept {
+  return this->data_[pos];
+}
+
+template<typename T>
+typename span<T>::reference span<T>::front() const noexcept {
+  return this->data_[0];
+}
+
+template<typename T>
+typename span<T>::reference span<T>::back() const noexcept {
+  return this->data_[this->size_ - 1];
+}
+
+template<typename T>
+typename span<T>::pointer span<T>::data() const noexcept {
+  return this->data_;
+}
+
+template<typename T>
+typename span<T>::iterator span<T>::begin() const noexcept {
+  return iterator(this->data_);
+}
+
+template<typename T>
+typename span<T>::iterator span<T>::end() const noexcept {
+  return iterator(this->data_ + this->size_);
+}
+
+template<typename T>
+typename span<T>::reverse_iterator span<T>::rbegin() const noexcept {
+  return reverse_iterator(this->end());
+}
+
+template<typename T>
+typename span<T>::reverse_iterator span<T>::rend() const noexcept {
+  return reverse_iterator(this->begin());
+}
+
+template<typename T>
+bool span<T>::empty() const noexcept {
+  return this->size_ == 0;
+}
+
+template<typename T>
+typename span<T>::size_type span<T>::size() const noexcept {
+  return this->size_;
+}
+
+template<typename T>
+typename span<T>::size_type span<T>::size_bytes() const noexcept {
+  return this->size_ * sizeof(T);
+}
+
+template<typename T>
+span<T> span<T>::first(size_type count) const {
+  if (count > this->size_) {
+    throw std::out_of_range("tftl::span::first: count > size()");
+  }
+  return span(this->data_, count);
+}
+
+template<typename T>
+span<T> span<T>::last(size_type count) const {
+  if (count > this->size_) {
+    throw std::out_of_range("tftl::span::last: count > size()");
+  }
+  return span(this->data_ + (this->size_ - count), count);
+}
+
+template<typename T>
+span<T> span<T>::subspan(size_type offset, size_type count) const {
+  if (offset > this->size_) {
+    throw std::out_of_range("tftl::span::subspan: offset > size()");
+  }
+  if (count == dynamic_extent) {
+    count = this->size_ - offset;
+  } else if (count > this->size_ - offset) {
+    throw std::out_of_range("tftl::span::subspan: offset + count > size()");
+  }
+  return span(this->data_ + offset, count);
+}
+
+// Every step-th element, starting with the first
+template<typename T>
+strided_span<T> span<T>::strided(size_type step) const {
+  return strided_span<T>(this->data_, this->size_, 1).strided(step);
+}
+
+template<typename T>
+span_chunks<span<T>> span<T>::split(size_type parts) const {
+  return detail::split(*this, parts);
+}
+
+template<typename T>
+span_chunks<span<T>> span<T>::chunks(size_type size) const {
+  return detail::chunks(*this, size);
+}
+
+/**
+ * @brief tftl::strided_iterator walks elements stride apart, a column of a row-major matrix for instance.
+ * It keeps an index rather than a moving pointer, so end() never points outside the memory.
+ */
+template<typename T>
+class strided_iterator {
+ public:
+  // @formatter:off
+  typedef std::ptrdiff_t                   difference_type;
+  typedef typename std::remove_cv<T>::type value_type;
+  typedef T*                               pointer;
+  typedef T&                               reference;
+  typedef std::random_access_iterator_tag  iterator_category;
+  // @formatter:on
+
+  strided_iterator() noexcept = default;
+  strided_iterator(pointer base, difference_type index, difference_type stride) noexcept
+      : base_(base), index_(index), stride_(stride) {}
+
+  strided_iterator& operator++() noexcept { ++this->index_; return *this; }
+  strided_iterator& operator--() noexcept { --this->index_; return *this; }
+  strided_iterator  operator++(int) noexcept { strided_iterator copy(*this); ++this->index_; return copy; }
+  strided_iterator  operator--(int) noexcept { strided_iterator copy(*this); --this->index_; return copy; }
+  strided_iterator& operator+=(difference_type n) noexcept { this->index_ += n; return *this; }
+  strided_iterator& operator-=(difference_type n) noexcept { this->index_ -= n; return *this; }
+
+  difference_type  operator-(const strided_iterator& other) const noexcept { return this->index_ - other.index_; }
+  strided_iterator operator+(difference_type n) const noexcept { return strided_iterator(*this) += n; }
+  strided_iterator operator-(difference_type n) const noexcept { return strided_iterator(*this) -= n; }
+
+  reference operator*() const noexcept { return this->base_[this->index_ * this->stride_]; }
+  pointer   operator->() const noexcept { return &**this; }
+  reference operator[](difference_type n) const noexcept { return this->base_[(this->index_ + n) * this->stride_]; }
+
+  bool operator==(const strided_iterator& other) const noexcept { return this->index_ == other.index_; }
+  bool operator!=(const strided_iterator& other) const noexcept { return this->index_ != other.index_; }
+  bool operator<(const strided_iterator& other) const noexcept { return this->index_ < other.index_; }
+  bool operator>(const strided_iterator& other) const noexcept { return this->index_ > other.index_; }
+  bool operator<=(const strided_iterator& other) const noexcept { return this->index_ <= other.index_; }
+  bool operator>=(const strided_iterator& other) const noexcept { return this->index_ >= other.index_; }
+
+ private:
+  pointer         base_ = nullptr;
+  difference_type index_ = 0;
+  difference_type stride_ = 1;
+};
+
+/**
+ * @brief tftl::strided_span refers to size elements stride apart, starting at data, and slices
+ * like tftl::span. Its elements are not contiguous, so it has no std::span counterpart.
+ */
+template<typename T>
+class strided_span {
+ public:
+  // @formatter:off
+  typedef T                                        element_type;
+  typedef typename std::remove_cv<T>::type         value_type;
+  typedef std::size_t                              size_type;
+  typedef std::ptrdiff_t                           difference_type;
+  typedef T*                                       pointer;
+  typedef T&                                       reference;
+  typedef strided_iterator <T>                     iterator;
+  typedef std::reverse_iterator <iterator>         reverse_iterator;
+  // @formatter:on
+
+  strided_span() noexcept = default;
+  // stride is in elements and may be negative, to walk backwards from data
+  strided_span(pointer data, size_type count, difference_type stride) noexcept;
+  template<typename U, typename = typename std::enable_if<detail::is_array_convertible<U, T>::value>::type>
+  strided_span(const strided_span<U>& other) noexcept;
+
+  // Element access:
+  reference at(size_type pos) const;
+  reference operator[](size_type pos) const noexcept;
+  reference front() const noexcept;
+  reference back() const noexcept;
+  pointer   data() const noexcept;
+
+  // Iterators:
+  iterator         begin() const noexcept;
+  iterator         end() const noexcept;
+  reverse_iterator rbegin() const noexcept;
+  reverse_iterator rend() const noexcept;
+
+  // Observers:
+  bool            empty() const noexcept;
+  size_type       size() const noexcept;
+  difference_type stride() const noexcept;
+
+  // Subviews, out of range arguments throw std::out_of_range:
+  strided_span              first(size_type count) const;
+  strided_span              last(size_type count) const;
+  strided_span              subspan(size_type offset, size_type count = dynamic_extent) const;
+  strided_span              strided(size_type step) const;
+  span_chunks<strided_span> split(size_type parts) const;
+  span_chunks<strided_span> chunks(size_type size) const;
+
+ private:
+  pointer         data_ = nullptr;
+  size_type       size_ = 0;
+  difference_type stride_ = 1;
+};
+
+template<typename T>
+strided_span<T>::strided_span(pointer data, size_type count, difference_type stride) noexcept
+    : data_(data), size_(count), stride_(stride) {}
+
+template<typename T>
+template<typename U, typename>
+strided_span<T>::strided_span(const strided_span<U>& other) noexcept
+    : data_(other.data()), size_(other.size()), stride_(other.stride()) {}
+
+template<typename T>
+typename strided_span<T>::reference strided_span<T>::at(size_type pos) const {
+  if (pos >= this->size_) {
+    throw std::out_of_range("tftl::strided_span::at: pos >= size()");
+  }
+  return (*this)[pos];
+}
+
+template<typename T>
+typename strided_span<T>::reference strided_span<T>::operator[](size_type pos) const noexcept {
+  return this->data_[static_cast<difference_type>(pos) * this->stride_];
+}
+
+template<typename T>
+typename strided_span<T>::reference strided_span<T>::front() const noexcept {
+  return *this->data_;
+}
+
+template<typename T>
+typename strided_span<T>::reference strided_span<T>::back() const noexcept {
+  return (*this)[this->size_ - 1];
+}
+
+template<typename T>
+typename strided_span<T>::pointer strided_span<T>::data() const noexcept {
+  return this->data_;
+}
+
+template<typename T>
+typename strided_span<T>::iterator strided_span<T>::begin() const noexcept {
+  return iterator(this->data_, 0, this->stride_);
+}
+
+template<typename T>
+typename strided_span<T>::iterator strided_span<T>::end() const noexcept {
+  return iterator(this->data_, static_cast<difference_type>(this->size_), this->stride_);
+}
+
+template<typename T>
+typename strided_span<T>::reverse_iterator strided_span<T>::rbegin() const noexcept {
+  return reverse_iterator(this->end());
+}
+
+template<typename T>
+typename strided_span<T>::reverse_iterator strided_span<T>::rend() const noexcept {
+  return reverse_iterator(this->begin());
+}
+
+template<typename T>
+bool strided_span<T>::empty() const noexcept {
+  return this->size_ == 0;
+}
+
+template<typename T>
+typename strided_span<T>::size_type strided_span<T>::size() const noexcept {
+  return this->size_;
+}
+
+template<typename T>
+typename strided_span<T>::difference_type strided_span<T>::stride() const noexcept {
+  return this->stride_;
+}
+
+template<typename T>
+strided_span<T> strided_span<T>::first(size_type count) const {
+  if (count > this->size_) {
+    throw std::out_of_range("tftl::strided_span::first: count > size()");
+  }
+  return strided_span(this->data_, count, this->stride_);
+}
+
+template<typename T>
+strided_span<T> strided_span<T>::last(size_type count) const {
+  if (count > this->size_) {
+    throw std::out_of_range("tftl::strided_span::last: count > size()");
+  }
+  return this->subspan(this->size_ - count, count);
+}
+
+template<typename T>
+strided_span<T> strided_span<T>::subspan(size_type offset, size_type count) const {
+  if (offset > this->size_) {
+    throw std::out_of_range("tftl::strided_span::subspan: offset > size()");
+  }
+  if (count == dynamic_extent) {
+    count = this->size_ - offset;
+  } else if (count > this->size_ - offset) {
+    throw std::out_of_range("tftl::strided_span::subspan: offset + count > size()");
+  }
+  // An empty tail keeps data() in bounds rather than pointing past the last element
+  pointer start = count == 0 ? this->data_ : this->data_ + static_cast<difference_type>(offset) * this->stride_;
+  return strided_span(start, count, this->stride_);
+}
+
+template<typename T>
+strided_span<T> strided_span<T>::strided(size_type step) const {
+  if (step == 0) {
+    throw std::invalid_argument("tftl::strided_span::strided: step == 0");
+  }
+  return strided_span(this->data_, (this->size_ + step - 1) / step, this->stride_ * static_cast<difference_type>(step));
+}
+
+template<typename T>
+span_chunks<strided_span<T>> strided_span<T>::split(size_type parts) const {
+  return detail::split(*this, parts);
+}
+
+template<typename T>
+span_chunks<strided_span<T>> strided_span<T>::chunks(size_type size) const {
+  return detail::chunks(*this, size);
+}
+} //namespace truefinch template library
@@ -0,0 +1,189 @@
+//
+// Created by truefinch on 29.06.18.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace tftl {
+/**
+ * Stats policies observe what a container does with its memory. A policy is a type with the static functions
+ *
+ *   static void on_construct(std::size_t count);
+ *   static void on_destroy(std::size_t count);
+ *   static void on_reallocate(std::size_t old_bytes, std::size_t new_bytes, std::size_t moved_bytes, bool in_place);
+ *   static void on_sample(std::size_t size_bytes, std::size_t capacity_bytes);
+ *
+ * on_sample is called whenever the size is about to shrink or the capacity changes, so it sees every peak.
+ * Like growth policies they cost nothing per container instance.
+ */
+
+/**
+ * @brief The default policy, every hook is empty and compiles away.
+ */
+struct no_stats {
+  static void on_construct(std::size_t) noexcept {}
+  static void on_destroy(std::size_t) noexcept {}
+  static void on_reallocate(std::size_t, std::size_t, std::size_t, bool) noexcept {}
+  static void on_sample(std::size_t, std::size_t) noexcept {}
+};
+
+/**
+ * @brief Counters shared by all containers of one tag, safe to update from several threads.
+ */
+struct stats_record {
+  std::atomic<std::uint64_t> constructions{0};
+  std::atomic<std::uint64_t> destructions{0};
+  std::atomic<std::uint64_t> reallocations{0};
+  std::atomic<std::uint64_t> in_place_expansions{0};
+  std::atomic<std::uint64_t> bytes_moved{0};
+  std::atomic<std::uint64_t> peak_size_bytes{0};
+  std::atomic<std::uint64_t> peak_capacity_bytes{0};
+  std::atomic<std::uint64_t> peak_wasted_bytes{0};  //Largest capacity - size seen on one container
+
+  void reset() noexcept;
+};
+
+inline void stats_record::reset() noexcept {
+  this->constructions = 0;
+  this->destructions = 0;
+  this->reallocations = 0;
+  this->in_place_expansions = 0;
+  this->bytes_moved = 0;
+  this->peak_size_bytes = 0;
+  this->peak_capacity_bytes = 0;
+  this->peak_wasted_bytes = 0;
+}
+
+/**
+ * @brief tftl::stats_registry knows the record of every tag in use, so they can be dumped together.
+ */
+class stats_registry {
+ public:
+  static stats_registry& instance();
+
+  void add(const char* tag, stats_record* record);
+  void dump(std::ostream& out) const;
+  void reset() noexcept;
+
+ private:
+  mutable std::mutex                                mutex_;
+  std::vector<std::pair<const char*, stats_record*>> records_;
+};
+
+// Never destroyed: containers may report into it during static destruction
+inline stats_registry& stats_registry::instance() {
+  static stats_registry* registry = new stats_registry;
+  return *registry;
+}
+
+inline void stats_registry::add(const char* tag, stats_record* record) {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  this->records_.emplace_back(tag, record);
+}
+
+inline void stats_registry::reset() noexcept {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  for (auto& entry : this->records_) {
+    entry.second->reset();
+  }
+}
+
+// Writes one JSON object keyed by tag
+inline void stats_registry::dump(std::ostream& out) const {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  out << "{";
+  for (std::size_t i = 0; i < this->records_.size(); ++i) {
+    const stats_record& record = *this->records_[i].second;
+    out << (i == 0 ? "\n" : ",\n") << "  \"" << this->records_[i].first << "\": {"
+        << "\"constructions\": " << record.constructions
+        << ", \"destructions\": " << record.destructions
+        << ", \"reallocations\": " << record.reallocations
+        << ", \"in_place_expansions\": " << record.in_place_expansions
+        << ", \"bytes_moved\": " << record.bytes_moved
+        << ", \"peak_size_bytes\": " << record.peak_size_bytes
+        << ", \"peak_capacity_bytes\": " << record.peak_capacity_bytes
+        << ", \"peak_wasted_bytes\": " << record.peak_wasted_bytes << "}";
+  }
+  out << "\n}\n";
+}
+
+inline void dump_stats(std::ostream& out) {
+  stats_registry::instance().dump(out);
+}
+
+/**
+ * @brief Aggregates the counters of all containers using the same Tag.
+ *
+ * Tag names a call site or a subsystem and must provide static constexpr const char* name,
+ * a local struct per call site is enough:
+ *
+ *   struct parser_tokens { static constexpr const char* name = "parser.tokens"; };
+ *   tftl::vector<token, std::allocator<token>, tftl::default_growth, tftl::tagged_stats<parser_tokens>> tokens;
+ */
+template<typename Tag>
+struct tagged_stats {
+  static stats_record& record();
+
+  static void on_construct(std::size_t count) noexcept;
+  static void on_destroy(std::size_t count) noexcept;
+  static void on_reallocate(std::size_t old_bytes, std::size_t new_bytes, std::size_t moved_bytes, bool in_place) noexcept;
+  static void on_sample(std::size_t size_bytes, std::size_t capacity_bytes) noexcept;
+
+ private:
+  static void raise(std::atomic<std::uint64_t>& peak, std::uint64_t value) noexcept;
+};
+
+template<typename Tag>
+stats_record& tagged_stats<Tag>::record() {
+  static stats_record* record = [] {
+    auto* result = new stats_record;
+    stats_registry::instance().add(Tag::name, result);
+    return result;
+  }();
+  return *record;
+}
+
+template<typename Tag>
+void tagged_stats<Tag>::raise(std::atomic<std::uint64_t>& peak, std::uint64_t value) noexcept {
+  std::uint64_t current = peak.load(std::memory_order_relaxed);
+  while (current < value && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+template<typename Tag>
+void tagged_stats<Tag>::on_construct(std::size_t count) noexcept {
+  record().constructions.fetch_add(count, std::memory_order_relaxed);
+}
+
+template<typename Tag>
+void tagged_stats<Tag>::on_destroy(std::size_t count) noexcept {
+  record().destructions.fetch_add(count, std::memory_order_relaxed);
+}
+
+template<typename Tag>
+void tagged_stats<Tag>::on_reallocate(std::size_t, std::size_t new_bytes, std::size_t moved_bytes, bool in_place) noexcept {
+  stats_record& stats = record();
+  stats.reallocations.fetch_add(1, std::memory_order_relaxed);
+  if (in_place) {
+    stats.in_place_expansions.fetch_add(1, std::memory_order_relaxed);
+  }
+  stats.bytes_moved.fetch_add(moved_bytes, std::memory_order_relaxed);
+  raise(stats.peak_capacity_bytes, new_bytes);
+}
+
+template<typename Tag>
+void tagged_stats<Tag>::on_sample(std::size_t size_bytes, std::size_t capacity_bytes) noexcept {
+  stats_record& stats = record();
+  raise(stats.peak_size_bytes, size_bytes);
+  raise(stats.peak_capacity_bytes, capacity_bytes);
+  raise(stats.peak_wasted_bytes, capacity_bytes - size_bytes);
+}
+} //namespace truefinch template library
@@ -4,9 +4,24 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
 #include <memory>
+#include <stdexcept>
 #include <vector>
+#include "allocator.hpp"
+#include "growth_policy.hpp"
+#include "hardened.hpp"
 #include "iterator.hpp"
+#include "memory.hpp"
+#include "simd.hpp"
+#include "stats_policy.hpp"
 
 namespace tftl {
 /**
@@ -17,33 +32,37 @@ namespace tftl {
  * and to construct/destroy the elements in that memory.
  * The type must meet the requirements of Allocator.
  * The behavior is undefined if Allocator::value_type is not the same as T.
+ * @tparam GrowthPolicy A stateless policy choosing the new capacity when the vector
+ * runs out of space, see growth_policy.hpp.
+ * @tparam Stats A policy observing constructions, reallocations and peak sizes, see stats_policy.hpp.
  */
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
 class vector;
-} //namespace truefinch template library
 
-template<typename T, typename Allocator>
-bool operator==(const tftl::vector<T, Allocator>& lhs, const std::vector<T, Allocator>& rhs);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool operator==(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& lhs, const std::vector<T, Allocator>& rhs);
 
-template<typename T, typename Allocator>
-bool operator==(const tftl::vector<T, Allocator>& lhs, const tftl::vector<T, Allocator>& rhs);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool operator==(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& lhs, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& rhs);
 
-template<typename T, typename Allocator>
-bool operator<(const tftl::vector<T, Allocator>& lhs, const tftl::vector<T, Allocator>& rhs);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool operator<(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& lhs, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& rhs);
 
-namespace tftl {
 /**
  *
  * @tparam T
  * @tparam Allocator
  */
-template<typename T, typename Allocator = std::allocator<T>>
+template<typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = tftl::default_growth,
+    typename Stats = tftl::no_stats>
 class vector {
   // @formatter:off
  public:
   ///This is Member types
   typedef T                                      value_type;
   typedef Allocator                              allocator_type;
+  typedef GrowthPolicy                           growth_policy;
+  typedef Stats                                  stats_policy;
   typedef std::size_t                            size_type;
   typedef std::ptrdiff_t                         difference_type;
   typedef value_type&                            reference;
@@ -80,6 +99,7 @@ class vector {
   template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
   void assign( InputIt first, InputIt last );
   void assign( std::initializer_list<T> ilist );
+  void copy_streaming( const vector& other );
 
   allocator_type get_allocator() const;
 
@@ -102,6 +122,9 @@ class vector {
   T*        data() noexcept;
   const T*  data() const noexcept;
 
+  ///data() is aligned to that many bytes, see tftl::allocator_alignment and tftl::assume_aligned
+  static constexpr std::size_t data_alignment = tftl::allocator_alignment_v<Allocator>;
+
   // Iterators:
   iterator                begin() noexcept;
   const_iterator          begin() const noexcept;
@@ -137,6 +160,13 @@ class vector {
   iterator  insert( const_iterator pos, InputIt first, InputIt last );
   iterator  insert( const_iterator pos, std::initializer_list<T> ilist );
 
+  template< class Range >
+  iterator  insert_range( const_iterator pos, Range&& range );
+  template< class Range >
+  void      append_range( Range&& range );
+  template< class Range >
+  void      assign_range( Range&& range );
+
   template< class... Args >
   iterator  emplace( const_iterator pos, Args&&... args );
 
@@ -153,300 +183,361 @@ class vector {
 
   void      resize( size_type count );
   void      resize( size_type count, const value_type& value );
+  void      resize_for_overwrite( size_type count );
+  template< class Operation >
+  void      resize_and_overwrite( size_type count, Operation op );
 
   void      swap( vector& other ) noexcept(std::allocator_traits<Allocator>::propagate_on_container_swap::value
       || std::allocator_traits<Allocator>::is_always_equal::value);
 
  private:
-  Allocator allocator_; // allocator TODO: replace by my own
+  typedef std::allocator_traits<Allocator> alloc_traits;
+
+  Allocator allocator_; // see allocator.hpp, arena_allocator.hpp and pool_allocator.hpp
 
 
   pointer head_ = nullptr; //Pointer to the first element of the vector
   pointer tail_ = nullptr; //Pointer to the past-the-last element of the vector
   pointer peak_ = nullptr; //Pointer to the end of available space of the vector
-
-  const float vector_growth_factor_ = 2.0;
+#if defined(TFTL_HARDENED)
+  std::uint64_t* generation_ = nullptr; //Bumped whenever the buffer changes, see hardened.hpp
+#endif
 
   // Methods to manipulate with memory by using allocator:
   void reallocate(size_type new_size);
   void init(iterator start, iterator finish);
   void deallocate(iterator start, iterator finish);
+  void steal(vector& other) noexcept;
+  template<class ForwardIt>
+  iterator insert_n(size_type index, ForwardIt first, size_type count);
+  template<class... Args>
+  void construct_element(pointer element, Args&&... args);
+  void destroy_element(pointer element) noexcept;
+  void sample() const noexcept;
+
+  // Methods of the hardened mode, which compile to nothing otherwise:
+  const std::uint64_t* generation() const noexcept;
+  void invalidate_iterators() noexcept;
+  size_type index_of(const_iterator pos) const;
+
+  // Methods to shift trivially relocatable elements by raw byte moves:
+  pointer open_gap(size_type index, size_type count);
+  void close_gap(size_type index, size_type count) noexcept;
 
   // @formatter:on
 };
 
 // construct/copy/destroy:
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(const Allocator& alloc) noexcept {
-  this->allocator_ = alloc;
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+vector<T, Allocator, GrowthPolicy, Stats>::vector(const Allocator& alloc) noexcept : allocator_(alloc) {
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(vector::size_type count, const T& value, const Allocator& alloc) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+vector<T, Allocator, GrowthPolicy, Stats>::vector(vector::size_type count, const T& value, const Allocator& alloc)
+    : allocator_(alloc) {
   this->assign(count, value);
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(vector::size_type count, const Allocator& alloc) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+vector<T, Allocator, GrowthPolicy, Stats>::vector(vector::size_type count, const Allocator& alloc) : allocator_(alloc) {
   this->reallocate( count );
+  this->init( this->begin(), this->begin() + count );
   this->tail_ = this->head_ + count;
-  this->init( this->begin(), this->end());
 }
 
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
 template<class InputIt, typename isIterator>
-vector<T, Allocator>::vector(InputIt first, InputIt last, const Allocator& alloc) {
+vector<T, Allocator, GrowthPolicy, Stats>::vector(InputIt first, InputIt last, const Allocator& alloc) : allocator_(alloc) {
   this->assign(first, last);
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(const vector& other) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+vector<T, Allocator, GrowthPolicy, Stats>::vector(const vector& other)
+    : allocator_(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.allocator_)) {
   size_type other_size = other.size();
   this->reallocate(other_size);
-  for (size_type i = 0; i < other_size; ++i) {
-    this->allocator_.construct(this->head_ + i, other[i]);
-  }
+  this->tail_ = tftl::uninitialized_copy_n(other.head_, other_size, this->head_, this->allocator_);
+  Stats::on_construct(other_size);
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(vector&& other) noexcept
-    : allocator_{other.allocator_}, head_{other.head_}, tail_{other.tail_}, peak_{other.tail_} {
-  other.head_ = other.tail_ = other.peak_ = nullptr;
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+vector<T, Allocator, GrowthPolicy, Stats>::vector(vector&& other) noexcept
+    : allocator_{other.allocator_} {
+  this->steal(other);
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(vector&& other, const Allocator& alloc)
-    : allocator_{alloc}, head_{other.head_}, tail_{other.tail_}, peak_{other.tail_} {
-  other.head_ = other.tail_ = other.peak_ = nullptr;
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+vector<T, Allocator, GrowthPolicy, Stats>::vector(vector&& other, const Allocator& alloc) : allocator_{alloc} {
+  if (std::allocator_traits<Allocator>::is_always_equal::value || this->allocator_ == other.allocator_) {
+    this->steal(other);
+  } else {
+    // The buffer belongs to another allocator, only the elements can be moved
+    this->assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+  }
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(std::initializer_list<T> init, const Allocator& alloc) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+vector<T, Allocator, GrowthPolicy, Stats>::vector(std::initializer_list<T> init, const Allocator& alloc) : allocator_(alloc) {
   assign(init.begin(), init.end());
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::~vector() {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+vector<T, Allocator, GrowthPolicy, Stats>::~vector() {
   this->deallocate(this->begin(), this->end());
-  this->allocator_.deallocate(head_, this->capacity());
+  alloc_traits::deallocate(this->allocator_, head_, this->capacity());
+#if defined(TFTL_HARDENED)
+  tftl::detail::generation_pool::release(this->generation_);
+#endif
 }
 
 // Operators and assigment:
-template<typename T, typename Allocator>
-vector<T, Allocator>& vector<T, Allocator>::operator=(const vector& other) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+vector<T, Allocator, GrowthPolicy, Stats>& vector<T, Allocator, GrowthPolicy, Stats>::operator=(const vector& other) {
   if (this != &other) {
+    if constexpr (std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value) {
+      if (this->allocator_ != other.allocator_) {
+        this->clear(); // the buffer must go back to the allocator which made it
+      }
+      this->allocator_ = other.allocator_;
+    }
+
     this->erase(this->begin(), this->end());
     if (other.size() > capacity()) {
       reallocate(other.size());
     }
 
-    for (size_type i = 0; i < other.size(); ++i) {
-      this->allocator_.construct(this->head_ + i, other[i]);
-    }
-
-    this->tail_ = this->head_ + other.size();
+    this->tail_ = tftl::uninitialized_copy_n(other.head_, other.size(), this->head_, this->allocator_);
+    Stats::on_construct(other.size());
   }
   return *this;
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>& vector<T, Allocator>::operator=(vector&& other) noexcept(
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+vector<T, Allocator, GrowthPolicy, Stats>& vector<T, Allocator, GrowthPolicy, Stats>::operator=(vector&& other) noexcept(
 std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value
     || std::allocator_traits<Allocator>::is_always_equal::value) {
   if (this == &other) {
     return *this;
   }
-  this->clear();
-  this->swap(other);
+
+  if (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value
+      || std::allocator_traits<Allocator>::is_always_equal::value
+      || this->allocator_ == other.allocator_) {
+    this->clear();
+    if constexpr (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
+      this->allocator_ = std::move(other.allocator_);
+    }
+    this->steal(other);
+  } else {
+    // The buffer belongs to another allocator, only the elements can be moved
+    this->assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+    other.clear();
+  }
   return *this;
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>& vector<T, Allocator>::operator=(std::initializer_list<T> ilist) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+vector<T, Allocator, GrowthPolicy, Stats>& vector<T, Allocator, GrowthPolicy, Stats>::operator=(std::initializer_list<T> ilist) {
   this->assign(ilist.begin(), ilist.end());
   return *this;
 }
 
 // Replaces the contents with count copies of value value
-template<typename T, typename Allocator>
-void vector<T, Allocator>::assign(vector::size_type count, const T& value) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::assign(vector::size_type count, const T& value) {
   this->erase(this->begin(), end());
 
   if (count > capacity()) {
     reallocate(count);
   }
 
-  for (size_type i = 0; i < count; ++i) {
-    allocator_.construct(this->head_ + i, value);
-  }
-
-  this->tail_ = this->head_ + count;
+  this->tail_ = tftl::uninitialized_fill_n(this->head_, count, value, this->allocator_);
+  Stats::on_construct(count);
 }
 
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
 template<class InputIt, typename isIterator>
-void vector<T, Allocator>::assign(InputIt first, InputIt last) {
+void vector<T, Allocator, GrowthPolicy, Stats>::assign(InputIt first, InputIt last) {
   this->erase(this->begin(), this->end());
-  typename vector<T, Allocator>::iterator::difference_type count = std::distance(first, last);
-
-  if (this->capacity() < count) {
-    this->reallocate(count);
-  }
-
-  for (auto it = this->begin(); first != last; ++it, ++first) {
-    this->allocator_.construct(&*it, value_type(*first));
-  }
-
-  this->tail_ = this->head_ + count;
+  this->insert(this->end(), first, last);
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::assign(std::initializer_list<T> ilist) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::assign(std::initializer_list<T> ilist) {
   this->assign(ilist.begin(), ilist.end());
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::allocator_type vector<T, Allocator>::get_allocator() const {
+/**
+ * Replaces the contents with a copy of other written with non-temporal stores whatever its size,
+ * for a copy which will not be read soon. Implicit copies only stream from tftl::streaming_threshold() on.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::copy_streaming(const vector& other) {
+  static_assert(std::is_trivially_copyable<T>::value && tftl::has_plain_construct<Allocator, T, const T&>::value,
+                "tftl::vector::copy_streaming: T must be trivially copyable");
+  if (this == &other) {
+    return;
+  }
+  this->erase(this->begin(), this->end());
+  if (other.size() > this->capacity()) {
+    this->reallocate(other.size());
+  }
+  if (!other.empty()) {
+    tftl::detail::stream_bytes(this->head_, other.head_, other.size() * sizeof(T));
+  }
+  this->tail_ = this->head_ + other.size();
+  Stats::on_construct(other.size());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::allocator_type vector<T, Allocator, GrowthPolicy, Stats>::get_allocator() const {
   return this->allocator_;
 }
 
 // Element access:
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::reference vector<T, Allocator>::at(vector::size_type pos) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::reference vector<T, Allocator, GrowthPolicy, Stats>::at(vector::size_type pos) {
   if (pos >= this->size()) {
     throw std::out_of_range("tftl::vector::at: accessed element out of range");
   }
   return this->head_[pos];
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_reference vector<T, Allocator>::at(vector::size_type pos) const {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::const_reference vector<T, Allocator, GrowthPolicy, Stats>::at(vector::size_type pos) const {
   if (pos >= this->size()) {
     throw std::out_of_range("tftl::vector::at: accessed element out of range");
   }
   return this->head_[pos];
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::reference vector<T, Allocator>::operator[](vector::size_type pos) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::reference vector<T, Allocator, GrowthPolicy, Stats>::operator[](vector::size_type pos) {
+  TFTL_HARDENED_CHECK(pos < this->size(), "tftl::vector::operator[]: index out of range");
   return this->head_[pos];
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_reference vector<T, Allocator>::operator[](vector::size_type pos) const {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::const_reference vector<T, Allocator, GrowthPolicy, Stats>::operator[](vector::size_type pos) const {
+  TFTL_HARDENED_CHECK(pos < this->size(), "tftl::vector::operator[]: index out of range");
   return this->head_[pos];
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::reference vector<T, Allocator>::front() {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::reference vector<T, Allocator, GrowthPolicy, Stats>::front() {
+  TFTL_HARDENED_CHECK(!this->empty(), "tftl::vector::front: the vector is empty");
   return *(this->head_);
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_reference vector<T, Allocator>::front() const {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::const_reference vector<T, Allocator, GrowthPolicy, Stats>::front() const {
+  TFTL_HARDENED_CHECK(!this->empty(), "tftl::vector::front: the vector is empty");
   return *(this->head_);
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::reference vector<T, Allocator>::back() {
-  return *(--this->tail_);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::reference vector<T, Allocator, GrowthPolicy, Stats>::back() {
+  TFTL_HARDENED_CHECK(!this->empty(), "tftl::vector::back: the vector is empty");
+  return *(this->tail_ - 1);
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_reference vector<T, Allocator>::back() const {
-  return *(this->tail_);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::const_reference vector<T, Allocator, GrowthPolicy, Stats>::back() const {
+  TFTL_HARDENED_CHECK(!this->empty(), "tftl::vector::back: the vector is empty");
+  return *(this->tail_ - 1);
 }
 
 // Data access:
-template<typename T, typename Allocator>
-T* vector<T, Allocator>::data() noexcept {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+T* vector<T, Allocator, GrowthPolicy, Stats>::data() noexcept {
   return this->head_;
 }
 
-template<typename T, typename Allocator>
-const T* vector<T, Allocator>::data() const noexcept {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+const T* vector<T, Allocator, GrowthPolicy, Stats>::data() const noexcept {
   return this->head_;
 }
 
 // Iterators:
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::begin() noexcept {
-  return tftl::vector<T, Allocator>::iterator(this->head_);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::iterator vector<T, Allocator, GrowthPolicy, Stats>::begin() noexcept {
+  return tftl::vector<T, Allocator, GrowthPolicy, Stats>::iterator(this->head_, this->generation());
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_iterator vector<T, Allocator>::begin() const noexcept {
-  return tftl::vector<T, Allocator>::const_iterator(this->head_);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::const_iterator vector<T, Allocator, GrowthPolicy, Stats>::begin() const noexcept {
+  return tftl::vector<T, Allocator, GrowthPolicy, Stats>::const_iterator(this->head_, this->generation());
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_iterator vector<T, Allocator>::cbegin() const noexcept {
-  return tftl::vector<T, Allocator>::const_iterator(this->head_);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::const_iterator vector<T, Allocator, GrowthPolicy, Stats>::cbegin() const noexcept {
+  return tftl::vector<T, Allocator, GrowthPolicy, Stats>::const_iterator(this->head_, this->generation());
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::end() noexcept {
-  return tftl::vector<T, Allocator>::iterator(this->tail_);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::iterator vector<T, Allocator, GrowthPolicy, Stats>::end() noexcept {
+  return tftl::vector<T, Allocator, GrowthPolicy, Stats>::iterator(this->tail_, this->generation());
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_iterator vector<T, Allocator>::end() const noexcept {
-  return tftl::vector<T, Allocator>::const_iterator(this->tail_);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::const_iterator vector<T, Allocator, GrowthPolicy, Stats>::end() const noexcept {
+  return tftl::vector<T, Allocator, GrowthPolicy, Stats>::const_iterator(this->tail_, this->generation());
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_iterator vector<T, Allocator>::cend() const noexcept {
-  return tftl::vector<T, Allocator>::const_iterator(this->tail_);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::const_iterator vector<T, Allocator, GrowthPolicy, Stats>::cend() const noexcept {
+  return tftl::vector<T, Allocator, GrowthPolicy, Stats>::const_iterator(this->tail_, this->generation());
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::reverse_iterator vector<T, Allocator>::rbegin() noexcept {
-  return tftl::vector<T, Allocator>::reverse_iterator(this->head_ + this->size());
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::reverse_iterator vector<T, Allocator, GrowthPolicy, Stats>::rbegin() noexcept {
+  return tftl::vector<T, Allocator, GrowthPolicy, Stats>::reverse_iterator(this->head_ + this->size());
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_reverse_iterator vector<T, Allocator>::rbegin() const noexcept {
-  return tftl::vector<T, Allocator>::const_reverse_iterator(this->tail_ - 1);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::const_reverse_iterator vector<T, Allocator, GrowthPolicy, Stats>::rbegin() const noexcept {
+  return tftl::vector<T, Allocator, GrowthPolicy, Stats>::const_reverse_iterator(this->tail_ - 1);
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_reverse_iterator vector<T, Allocator>::crbegin() const noexcept {
-  return tftl::vector<T, Allocator>::const_reverse_iterator(this->tail_ - 1);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::const_reverse_iterator vector<T, Allocator, GrowthPolicy, Stats>::crbegin() const noexcept {
+  return tftl::vector<T, Allocator, GrowthPolicy, Stats>::const_reverse_iterator(this->tail_ - 1);
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::reverse_iterator vector<T, Allocator>::rend() noexcept {
-  return tftl::vector<T, Allocator>::reverse_iterator(this->head_ - 1);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::reverse_iterator vector<T, Allocator, GrowthPolicy, Stats>::rend() noexcept {
+  return tftl::vector<T, Allocator, GrowthPolicy, Stats>::reverse_iterator(this->head_ - 1);
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_reverse_iterator vector<T, Allocator>::rend() const noexcept {
-  return tftl::vector<T, Allocator>::const_reverse_iterator(this->head_ - 1);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::const_reverse_iterator vector<T, Allocator, GrowthPolicy, Stats>::rend() const noexcept {
+  return tftl::vector<T, Allocator, GrowthPolicy, Stats>::const_reverse_iterator(this->head_ - 1);
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_reverse_iterator vector<T, Allocator>::crend() const noexcept {
-  return tftl::vector<T, Allocator>::const_reverse_iterator(this->head_ - 1);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::const_reverse_iterator vector<T, Allocator, GrowthPolicy, Stats>::crend() const noexcept {
+  return tftl::vector<T, Allocator, GrowthPolicy, Stats>::const_reverse_iterator(this->head_ - 1);
 }
 
 // Capacity:
-template<typename T, typename Allocator>
-bool vector<T, Allocator>::empty() const noexcept {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool vector<T, Allocator, GrowthPolicy, Stats>::empty() const noexcept {
   return this->size() == 0;
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::size_type vector<T, Allocator>::size() const noexcept {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::size_type vector<T, Allocator, GrowthPolicy, Stats>::size() const noexcept {
   return this->tail_ - this->head_;
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::size_type vector<T, Allocator>::max_size() const noexcept {
-  return static_cast<size_type>(SIZE_MAX / sizeof(T));
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::size_type vector<T, Allocator, GrowthPolicy, Stats>::max_size() const noexcept {
+  return std::min<size_type>(std::allocator_traits<Allocator>::max_size(this->allocator_),
+                             std::numeric_limits<difference_type>::max() / sizeof(T));
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::reserve(vector::size_type new_cap) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::reserve(vector::size_type new_cap) {
   if (new_cap > this->max_size()) {
     throw std::length_error("tftl::vector::reserve(): new_cap is too big, not enough memory to reserve");
   };
@@ -455,287 +546,598 @@ void vector<T, Allocator>::reserve(vector::size_type new_cap) {
   }
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::size_type vector<T, Allocator>::capacity() const noexcept {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::size_type vector<T, Allocator, GrowthPolicy, Stats>::capacity() const noexcept {
   return this->peak_ - this->head_;
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::shrink_to_fit() {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::shrink_to_fit() {
   this->reallocate(this->size());
 }
 
 // Modifier:
-template<typename T, typename Allocator>
-void vector<T, Allocator>::clear() noexcept {
-  this->allocator_.deallocate(this->head_, this->capacity());
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::clear() noexcept {
+  this->deallocate(this->begin(), this->end());
+  alloc_traits::deallocate(this->allocator_, this->head_, this->capacity());
   this->head_ = this->tail_ = this->peak_ = nullptr;
+  this->invalidate_iterators();
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::insert(const_iterator pos, const T& value) {
-  size_type index = pos - this->begin();
-  if (size() + 1 > this->capacity()) {
-    this->reallocate(size() + 1);
-  }
-
-  auto iter = this->begin() + index;
-  std::copy_backward(iter, this->end(), iter + this->size() - index + 1);
-  *iter = value;
-  ++(this->tail_);
-  return iter;
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::iterator vector<T, Allocator, GrowthPolicy, Stats>::insert(const_iterator pos, const T& value) {
+  return this->emplace(pos, value);
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::insert(const_iterator pos, T&& value) {
-  size_type index = pos - this->begin();
-
-  size_type new_size = this->size() + 1;
-  if ((new_size) > this->capacity()) {
-    this->reallocate(new_size);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::iterator vector<T, Allocator, GrowthPolicy, Stats>::insert(const_iterator pos, T&& value) {
+  if constexpr (tftl::is_trivially_relocatable_v<T>) {
+    return this->emplace(pos, std::move(value));
+  } else {
+    // An rvalue argument may be assumed not to alias the vector, so no temporary is needed
+    return this->insert_n(this->index_of(pos), std::make_move_iterator(std::addressof(value)), 1);
   }
-
-  auto iter = this->begin() + index;
-  std::copy_backward(iter, this->end(), this->end() + 1);
-  *iter = value;
-  ++(this->tail_);
-  return iter;
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::insert(const_iterator pos,
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::iterator vector<T, Allocator, GrowthPolicy, Stats>::insert(const_iterator pos,
                                                                      size_type count,
                                                                      const T& value) {
-  size_type index = pos - begin();
-
-  size_type new_size = size() + count;
-  if (new_size > capacity()) {
-    reallocate(new_size);
+  size_type index = this->index_of(pos);
+
+  if constexpr (tftl::is_trivially_relocatable_v<T>) {
+    // value may live inside the vector, so it is copied aside first through the allocator as elements are
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer;
+    pointer copy = reinterpret_cast<pointer>(&buffer);
+    this->construct_element(copy, value);
+    pointer gap;
+    try {
+      gap = this->open_gap(index, count);
+      try {
+        tftl::uninitialized_fill_n(gap, count, *copy, this->allocator_);
+      } catch (...) {
+        this->close_gap(index, count);
+        throw;
+      }
+    } catch (...) {
+      this->destroy_element(copy);
+      throw;
+    }
+    this->destroy_element(copy);
+    Stats::on_construct(count);
+    return iterator(gap, this->generation());
+  } else {
+    // The tail is moved up, not rotated: the slots past the old end are constructed, the rest assigned.
+    // value may live inside the vector, so it is copied aside first through the allocator as elements are
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer;
+    pointer copy = reinterpret_cast<pointer>(&buffer);
+    this->construct_element(copy, value);
+    pointer position;
+    try {
+      this->reserve(this->size() + count);
+      position = this->head_ + index;
+      pointer old_end = this->tail_;
+      size_type after = old_end - position;
+      if (after > count) {
+        this->tail_ = tftl::uninitialized_move_n(old_end - count, count, old_end, this->allocator_);
+        std::move_backward(position, old_end - count, old_end);
+        std::fill_n(position, count, *copy);
+      } else {
+        this->tail_ = tftl::uninitialized_fill_n(old_end, count - after, *copy, this->allocator_);
+        this->tail_ = tftl::uninitialized_move_n(position, after, this->tail_, this->allocator_);
+        std::fill_n(position, after, *copy);
+      }
+    } catch (...) {
+      this->destroy_element(copy);
+      throw;
+    }
+    this->destroy_element(copy);
+    Stats::on_construct(count);
+    return iterator(position, this->generation());
   }
-
-  auto iter = begin() + index;
-  std::copy_backward(iter, end(), end() + count);
-  std::fill(iter, iter + count, value);
-  this->tail_ = this->head_ + new_size;
-  return iter;
 }
 
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
 template<class InputIt, typename isIterator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::insert(const_iterator pos, InputIt first, InputIt last) {
-  difference_type count = std::distance(first, last);
-  size_type index = pos - this->begin();
+typename vector<T, Allocator, GrowthPolicy, Stats>::iterator vector<T, Allocator, GrowthPolicy, Stats>::insert(const_iterator pos, InputIt first, InputIt last) {
+  size_type index = this->index_of(pos);
 
-  size_type new_size = this->size() + count;
-  if (new_size > this->capacity()) {
-    this->reallocate(new_size);
+  if constexpr (std::is_base_of<std::forward_iterator_tag,
+                                typename std::iterator_traits<InputIt>::iterator_category>::value) {
+    return this->insert_n(index, first, std::distance(first, last));
+  } else {
+    // An input range can be walked only once: it is appended with geometric growth and rotated into place
+    size_type old_size = this->size();
+    try {
+      for (; first != last; ++first) {
+        this->emplace_back(*first);
+      }
+    } catch (...) {
+      this->deallocate(this->begin() + old_size, this->end());
+      this->tail_ = this->head_ + old_size;
+      throw;
+    }
+    std::rotate(this->head_ + index, this->head_ + old_size, this->tail_);
+    return this->begin() + index;
   }
-
-  auto iter = this->begin() + index;
-  std::copy_backward(iter, this->end(), this->end() + count);
-  std::copy(first, last, iter);
-  this->tail_ = this->head_ + new_size;
-  return iter;
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::insert(const_iterator pos,
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::iterator vector<T, Allocator, GrowthPolicy, Stats>::insert(const_iterator pos,
                                                                      std::initializer_list<T> ilist) {
   return this->insert(pos, ilist.begin(), ilist.end());
 }
 
-template<typename T, typename Allocator>
-template<class... Args>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::emplace(const_iterator pos, Args&& ... args) {
-  size_type index = pos - this->begin();
-
-  size_type new_size = this->size() + 1;
-  if (new_size > this->capacity()) {
-    this->reallocate(new_size);
+// Contiguous ranges are read through a pointer, so trivially copyable elements are copied by one memcpy
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+template<class Range>
+typename vector<T, Allocator, GrowthPolicy, Stats>::iterator vector<T, Allocator, GrowthPolicy, Stats>::insert_range(const_iterator pos,
+                                                                                                       Range&& range) {
+  if constexpr (tftl::is_contiguous_range<Range>::value) {
+    return this->insert_n(this->index_of(pos), std::data(range), std::size(range));
+  } else {
+    return this->insert(pos, std::begin(range), std::end(range));
   }
-
-  auto iter = this->begin() + index;
-  std::copy_backward(iter, this->end(), ++(this->tail_));
-  allocator_.construct(&*iter, std::forward<Args>(args)...);
-  return iter;
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::erase(const_iterator pos) {
-  allocator_.destroy(&*pos);
-  std::copy(pos + 1, this->end(), pos);
-  --(this->tail_);
-  return pos;
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+template<class Range>
+void vector<T, Allocator, GrowthPolicy, Stats>::append_range(Range&& range) {
+  this->insert_range(this->end(), std::forward<Range>(range));
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::erase(const_iterator first, const_iterator last) {
-  for (auto it = first; it != last; ++it) {
-    allocator_.destroy(&*it);
-  }
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+template<class Range>
+void vector<T, Allocator, GrowthPolicy, Stats>::assign_range(Range&& range) {
+  this->erase(this->begin(), this->end());
+  this->insert_range(this->end(), std::forward<Range>(range));
+}
 
-  if (this->end() > (last + 1)) {
-    std::copy(last + 1, this->end(), first + 1);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+template<class... Args>
+typename vector<T, Allocator, GrowthPolicy, Stats>::iterator vector<T, Allocator, GrowthPolicy, Stats>::emplace(const_iterator pos, Args&& ... args) {
+  size_type index = this->index_of(pos);
+
+  if constexpr (tftl::is_trivially_relocatable_v<T>) {
+    // Build the element aside first: args may refer to an element which is about to be shifted,
+    // afterwards its bytes are simply relocated into the gap.
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer;
+    pointer element = reinterpret_cast<pointer>(&buffer);
+    this->construct_element(element, std::forward<Args>(args)...);
+    pointer gap;
+    try {
+      gap = this->open_gap(index, 1);
+    } catch (...) {
+      this->destroy_element(element);
+      throw;
+    }
+    std::memcpy(static_cast<void*>(gap), static_cast<const void*>(element), sizeof(T));
+    return iterator(gap, this->generation());
+  } else {
+    // Built aside through the allocator for the same reason, then moved in like a range of one
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer;
+    pointer element = reinterpret_cast<pointer>(&buffer);
+    this->construct_element(element, std::forward<Args>(args)...);
+    iterator result;
+    try {
+      result = this->insert_n(index, std::make_move_iterator(element), 1);
+    } catch (...) {
+      this->destroy_element(element);
+      throw;
+    }
+    this->destroy_element(element);
+    return result;
   }
+}
 
-  this->tail_ -= std::distance(first, last);
-  return first;
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::iterator vector<T, Allocator, GrowthPolicy, Stats>::erase(const_iterator pos) {
+  return this->erase(pos, pos + 1);
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::push_back(const T& value) {
-  size_type new_size = this->size() + 1;
-  if (new_size >= this->capacity()) {
-    this->reallocate(new_size);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::iterator vector<T, Allocator, GrowthPolicy, Stats>::erase(const_iterator first, const_iterator last) {
+  TFTL_HARDENED_CHECK(this->index_of(first) <= this->index_of(last), "tftl::vector::erase: invalid range");
+  if constexpr (tftl::is_trivially_relocatable_v<T>) {
+    size_type index = first - this->begin();
+    size_type count = last - first;
+    this->deallocate(first, last);
+    this->close_gap(index, count);
+    return this->begin() + index;
+  } else {
+    size_type index = first - this->begin();
+    iterator new_end = std::move(this->begin() + (last - this->begin()), this->end(), this->begin() + index);
+    this->deallocate(new_end, this->end());
+    this->tail_ = this->head_ + (new_end - this->begin());
+    return this->begin() + index;
   }
-  allocator_.construct(this->tail_++, T(value));
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::push_back(T&& value) {
-  size_type new_size = this->size() + 1;
-  if (new_size >= this->capacity()) {
-    this->reallocate(new_size);
-  }
-  std::swap(*(this->tail_++), value);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::push_back(const T& value) {
+  this->emplace_back(value);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::push_back(T&& value) {
+  this->emplace_back(std::move(value));
 }
 
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
 template<class... Args>
-typename vector<T, Allocator>::reference vector<T, Allocator>::emplace_back(Args&& ... args) {
-  emplace(this->end(), std::forward<Args>(args)...);
-  return *(this->tail_);
+typename vector<T, Allocator, GrowthPolicy, Stats>::reference vector<T, Allocator, GrowthPolicy, Stats>::emplace_back(Args&& ... args) {
+  // With spare capacity args cannot refer to the raw slot, so the element is built in place
+  if (this->tail_ != this->peak_) {
+    this->construct_element(this->tail_, std::forward<Args>(args)...);
+    ++(this->tail_);
+  } else {
+    this->emplace(this->end(), std::forward<Args>(args)...);
+  }
+  return *(this->tail_ - 1);
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::pop_back() {
-  allocator_.destroy((this->tail_)--);
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::pop_back() {
+  TFTL_HARDENED_CHECK(!this->empty(), "tftl::vector::pop_back: the vector is empty");
+  this->sample();
+  this->destroy_element(--(this->tail_));
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::resize(vector::size_type count) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::resize(vector::size_type count) {
   size_type index = this->size();
   if (count > this->capacity()) {
     this->reallocate(count);
   }
 
+  if (index < count) {
+    this->init(this->begin() + index, this->begin() + count);
+  } else {
+    this->deallocate(this->begin() + count, this->end());
+  }
   this->tail_ = this->head_ + count;
-  if (index < this->size()) {
-    this->init(this->begin() + index, this->end());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::resize(size_type count, const value_type& value) {
+  if (count <= this->size()) {
+    this->resize(count);
   } else {
-    this->deallocate(this->end(), this->begin() + index);
+    this->insert(this->end(), count - this->size(), value);
   }
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::resize(size_type count, const value_type& value) {
-  size_type prev_size = size();
-  resize(count);
-  if (count <= prev_size) {
+// New elements are default-initialized as by new T, so trivial types are left uninitialized.
+// An allocator with its own construct (a polymorphic_allocator of strings) is still called
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::resize_for_overwrite(size_type count) {
+  if (count <= this->size()) {
+    this->resize(count);
     return;
   }
 
-  for (size_type i = prev_size; i < count; ++i) {
-    allocator_.construct(this->head_ + i, value);
+  this->reserve(count);
+  pointer last = this->head_ + count;
+  if constexpr (!tftl::has_plain_construct<Allocator, T>::value) {
+    tftl::uninitialized_value_construct_n(this->tail_, last - this->tail_, this->allocator_);
+  } else if constexpr (!std::is_trivially_default_constructible<T>::value) {
+    pointer current = this->tail_;
+    try {
+      for (; current != last; ++current) {
+        ::new(static_cast<void*>(current)) T;
+      }
+    } catch (...) {
+      for (pointer it = this->tail_; it != current; ++it) {
+        it->~T();
+      }
+      throw;
+    }
+  }
+  Stats::on_construct(last - this->tail_);
+  this->tail_ = last;
+}
+
+/**
+ * Grows the vector to count uninitialized elements and lets op fill them, op(data(), count) returns
+ * how many elements it wrote and the vector is cut back to that size. Meant for read() and decoders.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+template<class Operation>
+void vector<T, Allocator, GrowthPolicy, Stats>::resize_and_overwrite(size_type count, Operation op) {
+  static_assert(std::is_trivially_default_constructible<T>::value && std::is_trivially_destructible<T>::value,
+                "tftl::vector::resize_and_overwrite: T must be trivial");
+  this->resize_for_overwrite(count);
+  size_type written = static_cast<size_type>(op(this->data(), count));
+  if (written < count) {
+    Stats::on_destroy(count - written);
+    this->tail_ = this->head_ + written;
   }
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::swap(vector& other) noexcept(
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::swap(vector& other) noexcept(
 std::allocator_traits<Allocator>::propagate_on_container_swap::value
     || std::allocator_traits<Allocator>::is_always_equal::value) {
   std::swap(this->head_, other.head_);
   std::swap(this->tail_, other.tail_);
   std::swap(this->peak_, other.peak_);
-  std::swap(this->allocator_, other.allocator_);
+#if defined(TFTL_HARDENED)
+  std::swap(this->generation_, other.generation_); // iterators stay valid and follow their elements
+#endif
+  if constexpr (std::allocator_traits<Allocator>::propagate_on_container_swap::value) {
+    std::swap(this->allocator_, other.allocator_);
+  }
 }
 
 // Methods to manipulate with memory by using allocator:
-template<typename T, typename Allocator>
-void vector<T, Allocator>::reallocate(size_type new_size) {
-  if (new_size >= capacity()) {
-    new_size *= this->vector_growth_factor_;
-  }
-
-  pointer new_begin = this->allocator_.allocate(new_size);
-  if (new_begin == this->head_) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::reallocate(size_type new_size) {
+  if (new_size > this->capacity()) {
+    new_size = std::min(GrowthPolicy::next_capacity(this->capacity(), new_size, sizeof(T)), this->max_size());
+  } else if (new_size == this->capacity()) {
     return;
   }
-
-  if (!std::is_null_pointer<decltype(this->head_)>()) {
-    try {
-      std::copy(this->head_, this->head_ + std::min(this->size(), new_size), new_begin);
-    } catch (...) {
-      this->allocator_.deallocate(new_begin, new_size);
-      throw std::range_error("tftl::vector::reallocate: invalid memory copy");
+  this->sample();
+#if defined(TFTL_HARDENED)
+  if (this->generation_ == nullptr) {
+    this->generation_ = tftl::detail::generation_pool::acquire(); // before the buffer changes, it may throw
+  }
+#endif
+
+  // Allocators providing try_expand may grow the block in place (realloc, mremap),
+  // which only moves bytes, so that is reserved to relocatable elements
+  if constexpr (tftl::is_trivially_relocatable_v<T> && tftl::has_try_expand_v<Allocator>) {
+    if (this->head_ != nullptr && new_size >= this->size()) {
+      pointer expanded = tftl::try_expand(this->allocator_, this->head_, this->capacity(), new_size);
+      if (expanded != nullptr) {
+        Stats::on_reallocate(this->capacity() * sizeof(T), new_size * sizeof(T), 0, true);
+        this->tail_ = expanded + this->size();
+        this->head_ = expanded;
+        this->peak_ = expanded + new_size;
+        this->invalidate_iterators();
+        return;
+      }
     }
-    this->allocator_.deallocate(this->head_, this->capacity());
   }
 
-  this->tail_ = new_begin + size();
+  pointer new_begin = alloc_traits::allocate(this->allocator_, new_size);
+  size_type kept = std::min(this->size(), new_size);
+
+  // Relocatable elements are moved with one memcpy, the rest by move_if_noexcept,
+  // either way *this is left untouched if the relocation throws
+  try {
+    tftl::uninitialized_relocate(this->head_, this->head_ + kept, new_begin, this->allocator_);
+  } catch (...) {
+    alloc_traits::deallocate(this->allocator_, new_begin, new_size);
+    throw std::range_error("tftl::vector::reallocate: invalid memory copy");
+  }
+  this->deallocate(this->begin() + kept, this->end());
+  alloc_traits::deallocate(this->allocator_, this->head_, this->capacity());
+  Stats::on_reallocate(this->capacity() * sizeof(T), new_size * sizeof(T), kept * sizeof(T), false);
+
+  this->tail_ = new_begin + kept;
   this->head_ = new_begin;
   this->peak_ = new_begin + new_size;
+  this->invalidate_iterators();
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::init(iterator start, iterator finish) {
+  tftl::uninitialized_value_construct_n(start.operator->(), finish - start, this->allocator_);
+  Stats::on_construct(finish - start);
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::init(iterator start, iterator finish) {
-  for (auto it = start; it != finish; ++it) {
-    this->allocator_.construct(&*it, value_type());
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::deallocate(iterator start, iterator finish) {
+  this->sample();
+  for (pointer it = start.operator->(), last = finish.operator->(); it != last; ++it) {
+    this->destroy_element(it);
   }
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::deallocate(iterator start, iterator finish) {
-  for (auto it = start; it != finish; ++it) {
-    this->allocator_.destroy(&*it);
+// Takes the buffer of other, *this must not own one
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::steal(vector& other) noexcept {
+  this->head_ = other.head_;
+  this->tail_ = other.tail_;
+  this->peak_ = other.peak_;
+  other.head_ = other.tail_ = other.peak_ = nullptr;
+#if defined(TFTL_HARDENED)
+  tftl::detail::generation_pool::release(this->generation_);
+  this->generation_ = other.generation_;
+  other.generation_ = nullptr;
+#endif
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+template<class... Args>
+void vector<T, Allocator, GrowthPolicy, Stats>::construct_element(pointer element, Args&& ... args) {
+  alloc_traits::construct(this->allocator_, element, std::forward<Args>(args)...);
+  Stats::on_construct(1);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::destroy_element(pointer element) noexcept {
+  alloc_traits::destroy(this->allocator_, element);
+  Stats::on_destroy(1);
+}
+
+// Reports the current size and capacity, called before either of them goes down
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::sample() const noexcept {
+  Stats::on_sample(this->size() * sizeof(T), this->capacity() * sizeof(T));
+}
+
+// Generation counter given to the iterators, nullptr leaves them unchecked
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+const std::uint64_t* vector<T, Allocator, GrowthPolicy, Stats>::generation() const noexcept {
+#if defined(TFTL_HARDENED)
+  return this->generation_;
+#else
+  return nullptr;
+#endif
+}
+
+// Makes every iterator taken so far stale, called whenever the buffer is replaced or freed
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::invalidate_iterators() noexcept {
+#if defined(TFTL_HARDENED)
+  if (this->generation_ != nullptr) {
+    ++*this->generation_;
+  }
+#endif
+}
+
+// Index of a position passed to insert or erase, the hardened mode checks that it lies in [begin(), end()]
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::size_type vector<T, Allocator, GrowthPolicy, Stats>::index_of(const_iterator pos) const {
+#if defined(TFTL_HARDENED)
+  const T* position = pos.operator->(); // checks the generation
+  TFTL_HARDENED_CHECK(std::less_equal<const T*>()(this->head_, position)
+                          && std::less_equal<const T*>()(position, this->tail_),
+                      "tftl::vector: the position is not an iterator of this vector");
+#endif
+  return pos - this->begin();
+}
+
+// Inserts count elements of a sized range at index with at most one reallocation
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+template<class ForwardIt>
+typename vector<T, Allocator, GrowthPolicy, Stats>::iterator vector<T, Allocator, GrowthPolicy, Stats>::insert_n(size_type index,
+                                                                                                   ForwardIt first,
+                                                                                                   size_type count) {
+  if constexpr (tftl::is_trivially_relocatable_v<T>) {
+    pointer gap = this->open_gap(index, count);
+    try {
+      tftl::uninitialized_copy_n(first, count, gap, this->allocator_);
+    } catch (...) {
+      this->close_gap(index, count);
+      throw;
+    }
+    Stats::on_construct(count);
+    return iterator(gap, this->generation());
+  } else {
+    // The tail is moved up, not rotated: the slots past the old end are constructed, the rest assigned
+    this->reserve(this->size() + count);
+    pointer position = this->head_ + index;
+    pointer old_end = this->tail_;
+    size_type after = old_end - position;
+    if (after > count) {
+      this->tail_ = tftl::uninitialized_move_n(old_end - count, count, old_end, this->allocator_);
+      std::move_backward(position, old_end - count, old_end);
+      std::copy_n(first, count, position);
+    } else {
+      ForwardIt middle = std::next(first, after);
+      this->tail_ = tftl::uninitialized_copy_n(middle, count - after, old_end, this->allocator_);
+      this->tail_ = tftl::uninitialized_move_n(position, after, this->tail_, this->allocator_);
+      std::copy_n(first, after, position);
+    }
+    Stats::on_construct(count);
+    return iterator(position, this->generation());
   }
 }
 
-} //namespace truefinch template library
+// Makes room for count elements at index and returns the first (uninitialized) slot
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename vector<T, Allocator, GrowthPolicy, Stats>::pointer vector<T, Allocator, GrowthPolicy, Stats>::open_gap(size_type index, size_type count) {
+  size_type new_size = this->size() + count;
+  if (new_size > this->capacity()) {
+    this->reallocate(new_size);
+  }
+
+  tftl::relocate_shift(this->head_ + index, this->size() - index, count);
+  this->tail_ += count;
+  return this->head_ + index;
+}
+
+// Closes count uninitialized slots at index by moving the tail down
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void vector<T, Allocator, GrowthPolicy, Stats>::close_gap(size_type index, size_type count) noexcept {
+  tftl::relocate_shift(this->head_ + index + count, this->size() - index - count, -static_cast<difference_type>(count));
+  this->tail_ -= count;
+}
 
 // Operators
-template<typename T, typename Allocator>
-bool operator==(const tftl::vector<T, Allocator>& lhs, const std::vector<T, Allocator>& rhs) {
+// Arithmetic and pointer elements are compared by the kernels of simd.hpp, everything else element by element
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool operator==(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& lhs, const std::vector<T, Allocator>& rhs) {
   if (lhs.size() != rhs.size()) {
     return false;
   }
-
-  for (auto i = 0; i < lhs.size(); ++i) {
-    if (lhs[i] != rhs[i]) {
-      return false;
-    }
+  if constexpr (tftl::simd::is_vectorizable<T>::value) {
+    return tftl::simd::equal(lhs.data(), rhs.data(), lhs.size());
+  } else {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin());
   }
-
-  return true;
 }
 
-template<typename T, typename Allocator>
-bool operator==(const tftl::vector<T, Allocator>& lhs, const tftl::vector<T, Allocator>& rhs) {
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool operator==(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& lhs, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& rhs) {
   if (lhs.size() != rhs.size()) {
     return false;
   }
+  if constexpr (tftl::simd::is_vectorizable<T>::value) {
+    return tftl::simd::equal(lhs.data(), rhs.data(), lhs.size());
+  } else {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+  }
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool operator!=(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& lhs, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& rhs) {
+  return !(lhs == rhs);
+}
 
-  for (auto i = 0; i < lhs.size(); ++i) {
-    if (lhs[i] != rhs[i]) {
-      return false;
+/**
+ * @brief Three-way lexicographical comparison of two vectors,
+ * negative, zero or positive as lhs is less than, equivalent to or greater than rhs.
+ */
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+int compare(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& lhs, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& rhs) {
+  if constexpr (tftl::simd::is_vectorizable<T>::value) {
+    return tftl::simd::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size());
+  } else {
+    if (std::lexicographical_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend())) {
+      return -1;
     }
+    return std::lexicographical_compare(rhs.cbegin(), rhs.cend(), lhs.cbegin(), lhs.cend()) ? 1 : 0;
   }
+}
 
-  return true;
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool operator<(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& lhs, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& rhs) {
+  if constexpr (tftl::simd::is_vectorizable<T>::value) {
+    return tftl::compare(lhs, rhs) < 0;
+  } else {
+    return std::lexicographical_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend());
+  }
 }
 
-template<typename T, typename Allocator>
-bool operator<(const tftl::vector<T, Allocator>& lhs, const tftl::vector<T, Allocator>& rhs) {
-  return std::lexicographical_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend());
-//  if (lhs.size() == rhs.size()) {
-//    return false;
-//  }
-//
-//  for (auto i = 0; i < lhs.size(); ++i) {
-//    if (lhs[i] >= rhs[i]) {
-//      return false;
-//    }
-//  }
-//
-//  return true;
-};
\ No newline at end of file
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool operator>(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& lhs, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& rhs) {
+  return rhs < lhs;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool operator<=(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& lhs, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& rhs) {
+  return !(rhs < lhs);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool operator>=(const tftl::vector<T, Allocator, GrowthPolicy, Stats>& lhs, const tftl::vector<T, Allocator, GrowthPolicy, Stats>& rhs) {
+  return !(lhs < rhs);
+}
+
+#if __has_include(<memory_resource>)
+namespace pmr {
+/**
+ * @brief tftl::vector taking its memory from a std::pmr::memory_resource.
+ * Elements which use allocators themselves (std::pmr::string, nested vectors, ...)
+ * get the same resource through uses-allocator construction.
+ */
+template<typename T, typename GrowthPolicy = tftl::default_growth>
+using vector = tftl::vector<T, std::pmr::polymorphic_allocator<T>, GrowthPolicy, tftl::no_stats>;
+} // namespace pmr
+#endif
+} //namespace truefinch template library